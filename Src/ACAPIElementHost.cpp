@@ -0,0 +1,605 @@
+#include "APIEnvir.h"
+#include "ACAPinc.h"   // Also includes APIdefs.h
+#include "ACAPIElementHost.hpp"
+#include <cstring>
+#include <memory>
+#include "ElementChangeTracker.hpp"
+
+
+static API_Guid ToAPIGuid(const HostGuid& guid) {
+    static_assert(sizeof(API_Guid) == sizeof(HostGuid), "API_Guid layout changed");
+    API_Guid apiGuid;
+    memcpy(&apiGuid, &guid, sizeof(API_Guid));
+    return apiGuid;
+}
+
+static HostGuid ToHostGuid(const API_Guid& apiGuid) {
+    HostGuid guid;
+    memcpy(&guid, &apiGuid, sizeof(HostGuid));
+    return guid;
+}
+
+static API_ElemTypeID ToAPIElemTypeID(HostElemType type) {
+    switch (type) {
+    case HostElemType::Wall:        return API_WallID;
+    case HostElemType::Slab:        return API_SlabID;
+    case HostElemType::Zone:        return API_ZoneID;
+    case HostElemType::Door:        return API_DoorID;
+    case HostElemType::Dimension:   return API_DimensionID;
+    case HostElemType::Label:       return API_LabelID;
+    case HostElemType::Detail:      return API_DetailID;
+    default:                        return API_ZombieElemID;
+    }
+}
+
+static HostElemType ToHostElemType(const API_ElemType& type) {
+    switch (type.typeID) {
+    case API_WallID:        return HostElemType::Wall;
+    case API_SlabID:        return HostElemType::Slab;
+    case API_ZoneID:        return HostElemType::Zone;
+    case API_DoorID:        return HostElemType::Door;
+    case API_DimensionID:   return HostElemType::Dimension;
+    case API_LabelID:       return HostElemType::Label;
+    case API_DetailID:      return HostElemType::Detail;
+    default:                return HostElemType::Unknown;
+    }
+}
+
+static API_Coord ToAPICoord(const HostCoord& c) {
+    API_Coord coord;
+    coord.x = c.x;
+    coord.y = c.y;
+    return coord;
+}
+
+static HostCoord ToHostCoord(const API_Coord& c) {
+    return { c.x, c.y };
+}
+
+static API_TextWayID ToAPITextWay(HostTextWay textWay) {
+    switch (textWay) {
+    case HostTextWay::Vertical:     return APIDir_Vertical;
+    case HostTextWay::Parallel:     return APIDir_Parallel;
+    default:                        return APIDir_Horizontal;
+    }
+}
+
+static std::string ToStdString(const GS::UniString& str) {
+    return (const char*)str.ToCStr().Get();
+}
+
+static void	ReplaceEmptyTextWithPredefined(API_ElementMemo& memo, const char* predefinedContent)
+{
+    if (memo.textContent == nullptr || Strlen32(*memo.textContent) < 2) {
+        BMhKill(&memo.textContent);
+        memo.textContent = BMhAllClear(Strlen32(predefinedContent) + 1);
+        strcpy(*memo.textContent, predefinedContent);
+        (*memo.paragraphs)[0].run[0].range = Strlen32(predefinedContent);
+    }
+}
+
+
+HostError ACAPIElementHost::GetElemList(HostElemType type, std::vector<HostGuid>& guids) {
+    GS::Array<API_Guid> elementList;
+    GSErrCode err = ACAPI_Element_GetElemList(ToAPIElemTypeID(type), &elementList);
+    guids.clear();
+    if (err == NoError) {
+        guids.reserve(elementList.GetSize());
+        for (const API_Guid& elementGuid : elementList)
+            guids.push_back(ToHostGuid(elementGuid));
+    }
+    return err;
+}
+
+HostError ACAPIElementHost::GetElement(const HostGuid& guid, HostElement& element) {
+    API_Element apiElement;
+    BNZeroMemory(&apiElement, sizeof(API_Element));
+    apiElement.header.guid = ToAPIGuid(guid);
+
+    GSErrCode err = ACAPI_Element_Get(&apiElement);
+    if (err != NoError)
+        return err;
+
+    element = HostElement();
+    element.guid = guid;
+    element.type = ToHostElemType(apiElement.header.type);
+    element.modiStamp = apiElement.header.modiStamp;
+
+    switch (apiElement.header.type.typeID) {
+    case API_WallID:
+        element.wall.begC = ToHostCoord(apiElement.wall.begC);
+        element.wall.endC = ToHostCoord(apiElement.wall.endC);
+        element.wall.thickness = apiElement.wall.thickness;
+        element.wall.height = apiElement.wall.height;
+        break;
+    case API_DoorID:
+        element.door.width = apiElement.door.openingBase.width;
+        element.door.height = apiElement.door.openingBase.height;
+        element.door.markGuid = ToHostGuid(apiElement.door.openingBase.markGuid);
+        element.owner = ToHostGuid(apiElement.door.owner);
+        break;
+    case API_LabelID:
+        element.owner = ToHostGuid(apiElement.label.parent);
+        break;
+    case API_ZoneID:
+        element.zone.stampGuid = ToHostGuid(apiElement.zone.stampGuid);
+        element.zone.pos = ToHostCoord(apiElement.zone.pos);
+        element.zone.roomName = ToStdString(GS::UniString(apiElement.zone.roomName));
+        element.zone.roomNoStr = ToStdString(GS::UniString(apiElement.zone.roomNoStr));
+        element.zone.roomHeight = apiElement.zone.roomHeight;
+        break;
+    default:
+        break;
+    }
+
+    return NoError;
+}
+
+HostError ACAPIElementHost::CalcBounds(const HostGuid& guid, HostBox3D& box) {
+    API_Elem_Head header;
+    BNZeroMemory(&header, sizeof(API_Elem_Head));
+    header.guid = ToAPIGuid(guid);
+
+    API_Box3D extent3D;
+    GSErrCode err = ACAPI_Element_CalcBounds(&header, &extent3D);
+    if (err == NoError)
+        box = { extent3D.xMin, extent3D.yMin, extent3D.zMin, extent3D.xMax, extent3D.yMax, extent3D.zMax };
+    return err;
+}
+
+HostError ACAPIElementHost::GetMemo(const HostGuid& guid, HostElementMemo& memo) {
+    API_ElementMemo apiMemo;
+    BNZeroMemory(&apiMemo, sizeof(API_ElementMemo));
+
+    GSErrCode err = ACAPI_Element_GetMemo(ToAPIGuid(guid), &apiMemo);
+    if (err != NoError)
+        return err;
+
+    memo.wallDoors.clear();
+    memo.dimElems.clear();
+
+    if (apiMemo.wallDoors != nullptr) {
+        GSSize doorCount = BMGetPtrSize(reinterpret_cast<GSPtr>(apiMemo.wallDoors)) / sizeof(API_Guid);
+        memo.wallDoors.reserve(doorCount);
+        for (GSSize i = 0; i < doorCount; i++)
+            memo.wallDoors.push_back(ToHostGuid(apiMemo.wallDoors[i]));
+    }
+
+    if (apiMemo.dimElems != nullptr) {
+        Int32 numDimElems = BMGetHandleSize((GSHandle)apiMemo.dimElems) / sizeof(API_DimElem);
+        memo.dimElems.reserve(numDimElems);
+        for (Int32 i = 0; i < numDimElems; ++i) {
+            const API_DimElem& dimElem = (*apiMemo.dimElems)[i];
+            HostDimElem hostDimElem;
+            hostDimElem.baseGuid = ToHostGuid(dimElem.base.base.guid);
+            hostDimElem.baseType = ToHostElemType(dimElem.base.base.type);
+            hostDimElem.pos = ToHostCoord(dimElem.pos);
+            hostDimElem.notePos = ToHostCoord(dimElem.note.pos);
+            hostDimElem.dimVal = dimElem.dimVal;
+            hostDimElem.noteText = ToStdString((dimElem.note.contentUStr != nullptr) ?
+                *(dimElem.note.contentUStr) :
+                GS::UniString(dimElem.note.content));
+            memo.dimElems.push_back(hostDimElem);
+        }
+    }
+
+    ACAPI_DisposeElemMemoHdls(&apiMemo);
+    return NoError;
+}
+
+HostError ACAPIElementHost::GetConnectedLabels(const HostGuid& guid, std::vector<HostGuid>& labels) {
+    GS::Array<API_Guid> connectedLabels;
+    GSErrCode err = ACAPI_Grouping_GetConnectedElements(ToAPIGuid(guid), API_LabelID, &connectedLabels);
+    labels.clear();
+    if (err == NoError) {
+        labels.reserve(connectedLabels.GetSize());
+        for (const API_Guid& labelGuid : connectedLabels)
+            labels.push_back(ToHostGuid(labelGuid));
+    }
+    return err;
+}
+
+HostError ACAPIElementHost::GetElementInfoString(const HostGuid& guid, std::string& infoString) {
+    API_Guid apiGuid = ToAPIGuid(guid);
+    GS::UniString infoUStr;
+    GSErrCode err = ACAPI_Element_GetElementInfoString(&apiGuid, &infoUStr);
+    if (err == NoError)
+        infoString = ToStdString(infoUStr);
+    return err;
+}
+
+HostError ACAPIElementHost::GetElemTypeName(HostElemType type, std::string& name) {
+    GS::UniString elemName;
+    GSErrCode err = ACAPI_Element_GetElemTypeName(ToAPIElemTypeID(type), elemName);
+    if (err == NoError)
+        name = ToStdString(elemName);
+    return err;
+}
+
+// Defaults template of one element type. The element is copied and the memo cloned for every created element.
+struct ElementDefaults {
+    bool            fetched = false;
+    GSErrCode       err = NoError;
+    API_Element     element = {};
+    API_ElementMemo memo = {};
+    bool            hasMarker = false;
+    API_SubElement  marker = {};
+};
+
+struct ACAPIElementHost::DefaultsCache {
+    ElementDefaults dimension;
+    ElementDefaults label;
+    ElementDefaults parentedLabel;      // labels with a parent get different defaults
+    ElementDefaults zone;
+    ElementDefaults detail;             // detail with main marker, for door markers
+
+    ~DefaultsCache() {
+        for (ElementDefaults* defaults : { &dimension, &label, &parentedLabel, &zone, &detail }) {
+            ACAPI_DisposeElemMemoHdls(&defaults->memo);
+            if (defaults->hasMarker)
+                ACAPI_DisposeElemMemoHdls(&defaults->marker.memo);
+        }
+    }
+};
+
+template <typename T>
+static GSErrCode CloneHandle(T** source, T**& dest) {
+    dest = nullptr;
+    if (source == nullptr)
+        return NoError;
+
+    GSHandle copy = nullptr;
+    if (BMHandleToHandle(reinterpret_cast<GSConstHandle>(source), &copy) != NoError || copy == nullptr)
+        return APIERR_MEMFULL;
+
+    dest = reinterpret_cast<T**>(copy);
+    return NoError;
+}
+
+template <typename T>
+static GSErrCode ClonePtr(T* source, T*& dest) {
+    dest = nullptr;
+    if (source == nullptr)
+        return NoError;
+
+    GSSize size = BMGetPtrSize(reinterpret_cast<GSConstPtr>(source));
+    GSPtr copy = BMAllocatePtr(size, 0, 0);
+    if (copy == nullptr)
+        return APIERR_MEMFULL;
+
+    memcpy(copy, source, size);
+    dest = reinterpret_cast<T*>(copy);
+    return NoError;
+}
+
+// Paragraphs own their runs, line ends and tabs, so they need a deep copy
+static GSErrCode CloneParagraphs(API_ParagraphType** source, API_ParagraphType**& dest) {
+    GSErrCode err = CloneHandle(source, dest);
+    if (err != NoError || dest == nullptr)
+        return err;
+
+    Int32 count = BMGetHandleSize(reinterpret_cast<GSConstHandle>(dest)) / sizeof(API_ParagraphType);
+    for (Int32 i = 0; i < count; ++i) {
+        (*dest)[i].run = nullptr;
+        (*dest)[i].eolPos = nullptr;
+        (*dest)[i].tab = nullptr;
+    }
+
+    for (Int32 i = 0; i < count && err == NoError; ++i) {
+        err = ClonePtr((*source)[i].run, (*dest)[i].run);
+        if (err == NoError)
+            err = ClonePtr((*source)[i].eolPos, (*dest)[i].eolPos);
+        if (err == NoError)
+            err = ClonePtr((*source)[i].tab, (*dest)[i].tab);
+    }
+
+    return err;
+}
+
+// Array parameters keep their values in a separate handle
+static GSErrCode CloneParams(API_AddParType** source, API_AddParType**& dest) {
+    GSErrCode err = CloneHandle(source, dest);
+    if (err != NoError || dest == nullptr)
+        return err;
+
+    Int32 count = BMGetHandleSize(reinterpret_cast<GSConstHandle>(dest)) / sizeof(API_AddParType);
+    for (Int32 i = 0; i < count; ++i) {
+        if ((*dest)[i].typeMod == API_ParArray)
+            (*dest)[i].value.array = nullptr;
+    }
+
+    for (Int32 i = 0; i < count && err == NoError; ++i) {
+        if ((*source)[i].typeMod == API_ParArray)
+            err = CloneHandle((*source)[i].value.array, (*dest)[i].value.array);
+    }
+
+    return err;
+}
+
+// Copies the memo parts used by the defaults of the created element types, the rest stays empty
+static GSErrCode CloneMemo(const API_ElementMemo& source, API_ElementMemo& dest) {
+    BNZeroMemory(&dest, sizeof(API_ElementMemo));
+
+    GSErrCode err = CloneHandle(source.coords, dest.coords);
+    if (err == NoError)
+        err = CloneHandle(source.pends, dest.pends);
+    if (err == NoError)
+        err = CloneHandle(source.parcs, dest.parcs);
+    if (err == NoError)
+        err = CloneHandle(source.vertexIDs, dest.vertexIDs);
+    if (err == NoError)
+        err = CloneHandle(source.dimElems, dest.dimElems);
+    if (err == NoError)
+        err = CloneHandle(source.textContent, dest.textContent);
+    if (err == NoError)
+        err = CloneParagraphs(source.paragraphs, dest.paragraphs);
+    if (err == NoError)
+        err = CloneParams(source.params, dest.params);
+
+    if (err != NoError)
+        ACAPI_DisposeElemMemoHdls(&dest);
+    return err;
+}
+
+ACAPIElementHost::ACAPIElementHost() = default;
+
+ACAPIElementHost::~ACAPIElementHost() = default;
+
+void ACAPIElementHost::BeginAnnotationRun() {
+    runDefaults = std::make_unique<DefaultsCache>();
+}
+
+void ACAPIElementHost::EndAnnotationRun() {
+    runDefaults.reset();
+}
+
+// Outside a run the defaults live only for the one call
+ACAPIElementHost::DefaultsCache& ACAPIElementHost::GetDefaultsCache(std::unique_ptr<DefaultsCache>& callCache) {
+    if (runDefaults != nullptr)
+        return *runDefaults;
+
+    callCache = std::make_unique<DefaultsCache>();
+    return *callCache;
+}
+
+HostError ACAPIElementHost::CreateDimension(const HostDimensionSpec& spec, HostGuid* newGuid) {
+    std::unique_ptr<DefaultsCache> callCache;
+    ElementDefaults& defaults = GetDefaultsCache(callCache).dimension;
+    if (!defaults.fetched) {
+        defaults.fetched = true;
+        defaults.element.header.type = API_DimensionID;
+        defaults.err = ACAPI_Element_GetDefaults(&defaults.element, &defaults.memo);
+
+        // Pre-size the template for the two points of a linear dimension
+        if (defaults.err == NoError) {
+            BMhKill(reinterpret_cast<GSHandle*>(&defaults.memo.dimElems));
+            defaults.memo.dimElems = reinterpret_cast<API_DimElem**>(BMAllocateHandle(2 * sizeof(API_DimElem), ALLOCATE_CLEAR, 0));
+            if (defaults.memo.dimElems == nullptr)
+                defaults.err = APIERR_MEMFULL;
+        }
+    }
+    if (defaults.err != NoError)
+        return defaults.err;
+
+    API_Element element = defaults.element;
+    API_ElementMemo memo;
+    GSErrCode err = CloneMemo(defaults.memo, memo);
+    if (err != NoError)
+        return err;
+
+    element.dimension.textWay = ToAPITextWay(spec.textWay);
+    element.dimension.dimAppear = APIApp_Normal;
+    element.dimension.textPos = (spec.textPos == HostTextPos::Below) ? APIPos_Below : APIPos_Above;
+    element.dimension.nDimElem = 2; // Only two points needed for linear dimension
+    element.dimension.refC = ToAPICoord(spec.refC);
+    element.dimension.direction = ToAPICoord(spec.direction);
+
+    for (Int32 i = 0; i < element.dimension.nDimElem; ++i)
+        (*memo.dimElems)[i].base.loc = ToAPICoord(spec.dimElems[i]);
+
+    err = ACAPI_Element_Create(&element, &memo);
+    if (err == NoError && newGuid != nullptr)
+        *newGuid = ToHostGuid(element.header.guid);
+
+    ACAPI_DisposeElemMemoHdls(&memo);
+    return err;
+}
+
+HostError ACAPIElementHost::CreateLabel(const HostLabelSpec& spec, HostGuid* newGuid) {
+    std::unique_ptr<DefaultsCache> callCache;
+    DefaultsCache& cache = GetDefaultsCache(callCache);
+    bool hasParent = (spec.parent != HostNullGuid);
+    ElementDefaults& defaults = hasParent ? cache.parentedLabel : cache.label;
+    if (!defaults.fetched) {
+        defaults.fetched = true;
+
+        // Set up label element
+        defaults.element.header.type = API_LabelID;
+        if (hasParent)
+            defaults.element.label.parentType = API_ObjectID;
+
+        // Get default properties for the label
+        defaults.err = ACAPI_Element_GetDefaults(&defaults.element, &defaults.memo);
+    }
+    if (defaults.err != NoError)
+        return defaults.err;
+
+    API_Element element = defaults.element;
+    API_ElementMemo memo;
+    GSErrCode err = CloneMemo(defaults.memo, memo);
+    if (err != NoError)
+        return err;
+
+    element.label.parent = ToAPIGuid(spec.parent);
+    element.label.begC = ToAPICoord(spec.begC);
+    element.label.midC = ToAPICoord(spec.midC);
+    element.label.endC = ToAPICoord(spec.endC);
+
+    // If the label is of type text, replace empty text with predefined content
+    if (element.label.labelClass == APILblClass_Text) {
+        ReplaceEmptyTextWithPredefined(memo, spec.predefinedText.c_str());
+        element.label.u.text.nonBreaking = true;
+    }
+
+    if (spec.textWay != HostTextWay::Default)
+        element.label.textWay = ToAPITextWay(spec.textWay);
+
+    err = ACAPI_Element_Create(&element, &memo);
+    if (err == NoError && newGuid != nullptr)
+        *newGuid = ToHostGuid(element.header.guid);
+
+    ACAPI_DisposeElemMemoHdls(&memo);
+    return err;
+}
+
+HostError ACAPIElementHost::CreateZone(const HostZoneSpec& spec, HostGuid* newGuid) {
+    std::unique_ptr<DefaultsCache> callCache;
+    ElementDefaults& defaults = GetDefaultsCache(callCache).zone;
+    if (!defaults.fetched) {
+        defaults.fetched = true;
+        defaults.element.header.type = API_ZoneID;
+        defaults.err = ACAPI_Element_GetDefaults(&defaults.element, &defaults.memo);
+    }
+    if (defaults.err != NoError)
+        return defaults.err;
+
+    API_Element element = defaults.element;
+    API_ElementMemo memo;
+    GSErrCode err = CloneMemo(defaults.memo, memo);
+    if (err != NoError)
+        return err;
+
+    element.header.type = API_ZoneID;
+    element.zone.catInd = ACAPI_CreateAttributeIndex(1);
+    element.zone.manual = false;
+
+    GS::UniString roomName = spec.roomName.c_str();
+    GS::UniString roomNoStr = spec.roomNoStr.c_str();
+    GS::snuprintf(element.zone.roomName, sizeof(element.zone.roomName), roomName.ToUStr());
+    GS::snuprintf(element.zone.roomNoStr, sizeof(element.zone.roomNoStr), roomNoStr.ToUStr());
+
+    element.zone.pos = ToAPICoord(spec.pos);
+    element.zone.refPos = ToAPICoord(spec.pos);
+
+    err = ACAPI_Element_Create(&element, &memo);
+    if (err == NoError && newGuid != nullptr)
+        *newGuid = ToHostGuid(element.header.guid);
+
+    ACAPI_DisposeElemMemoHdls(&memo);
+    return err;
+}
+
+HostError ACAPIElementHost::CreateDoorMarker(const HostDoorMarkerSpec& spec, HostGuid* newGuid) {
+    std::unique_ptr<DefaultsCache> callCache;
+    ElementDefaults& defaults = GetDefaultsCache(callCache).detail;
+    if (!defaults.fetched) {
+        defaults.fetched = true;
+        defaults.hasMarker = true;
+        defaults.element.header.type = API_DetailID;
+        defaults.marker.subType = (API_SubElementType)(APISubElement_MainMarker | APISubElement_NoParams);
+        defaults.err = ACAPI_Element_GetDefaultsExt(&defaults.element, &defaults.memo, 1UL, &defaults.marker);
+
+        // Pre-size the template for the closed five point outline
+        if (defaults.err == NoError) {
+            BMhKill(reinterpret_cast<GSHandle*>(&defaults.memo.coords));
+            BMhKill(reinterpret_cast<GSHandle*>(&defaults.memo.pends));
+            defaults.memo.coords = (API_Coord**)BMAllocateHandle((5 + 1) * sizeof(API_Coord), ALLOCATE_CLEAR, 0);
+            defaults.memo.pends = (Int32**)BMAllocateHandle((1 + 1) * sizeof(Int32), ALLOCATE_CLEAR, 0);
+            if (defaults.memo.coords == nullptr || defaults.memo.pends == nullptr)
+                defaults.err = APIERR_MEMFULL;
+        }
+    }
+    if (defaults.err != NoError)
+        return defaults.err;
+
+    API_Element element = defaults.element;
+    API_ElementMemo memo;
+    API_SubElement marker = defaults.marker;
+    GSErrCode err = CloneMemo(defaults.memo, memo);
+    if (err != NoError)
+        return err;
+    err = CloneMemo(defaults.marker.memo, marker.memo);
+    if (err != NoError) {
+        ACAPI_DisposeElemMemoHdls(&memo);
+        return err;
+    }
+
+    // Set up detail element
+    element.detail.pos = ToAPICoord(spec.pos);
+    element.detail.poly.nCoords = 5;
+    element.detail.poly.nSubPolys = 1;
+    element.detail.poly.nArcs = 0;
+    for (Int32 i = 0; i < element.detail.poly.nCoords; ++i)
+        (*memo.coords)[i + 1] = ToAPICoord(spec.poly[i]);
+
+    (*memo.pends)[0] = 0;
+    (*memo.pends)[1] = element.detail.poly.nCoords;
+
+    // Set up door marker
+    marker.subElem.object.pen = spec.markerPen;
+    marker.subElem.object.useObjPens = true;
+    marker.subElem.object.pos = ToAPICoord(spec.markerPos);
+    marker.subType = APISubElement_MainMarker;
+
+    // Create detail element and door marker
+    err = ACAPI_Element_CreateExt(&element, &memo, 1UL, &marker);
+    if (err == NoError && newGuid != nullptr)
+        *newGuid = ToHostGuid(element.header.guid);
+
+    ACAPI_DisposeElemMemoHdls(&memo);
+    ACAPI_DisposeElemMemoHdls(&marker.memo);
+    return err;
+}
+
+HostError ACAPIElementHost::DeleteElements(const std::vector<HostGuid>& guids) {
+    GS::Array<API_Guid> elementList;
+    for (const HostGuid& guid : guids)
+        elementList.Push(ToAPIGuid(guid));
+    return ACAPI_Element_Delete(elementList);
+}
+
+static ElementChangeTracker* observedChanges = nullptr;
+
+static GSErrCode __ACENV_CALL ElementEventHandler(const API_NotifyElementType* elemType) {
+    if (observedChanges == nullptr)
+        return NoError;
+
+    HostElemType type = ToHostElemType(elemType->elemHead.type);
+    if (type == HostElemType::Unknown || type == HostElemType::Detail)
+        return NoError;
+
+    // Elements created from now on are observed as well
+    if (elemType->notifID == APINotifyElement_New || elemType->notifID == APINotifyElement_Copy)
+        ACAPI_Element_AttachObserver(elemType->elemHead.guid);
+
+    observedChanges->MarkDirty(ToHostGuid(elemType->elemHead.guid), type);
+    return NoError;
+}
+
+HostError StartElementObserver(ElementChangeTracker& tracker) {
+    observedChanges = &tracker;
+
+    GSErrCode err = ACAPI_Element_CatchNewElement(nullptr, ElementEventHandler);
+    if (err == NoError)
+        err = ACAPI_Element_InstallElementObserver(ElementEventHandler);
+    if (err != NoError) {
+        StopElementObserver();
+        return err;
+    }
+
+    const API_ElemTypeID observedTypes[] = { API_DimensionID, API_WallID, API_SlabID, API_ZoneID, API_DoorID, API_LabelID };
+    for (API_ElemTypeID typeID : observedTypes) {
+        GS::Array<API_Guid> elementList;
+        if (ACAPI_Element_GetElemList(typeID, &elementList) != NoError)
+            continue;
+        for (const API_Guid& elementGuid : elementList)
+            ACAPI_Element_AttachObserver(elementGuid);
+    }
+    return NoError;
+}
+
+void StopElementObserver() {
+    ACAPI_Element_CatchNewElement(nullptr, nullptr);
+    ACAPI_Element_InstallElementObserver(nullptr);
+    observedChanges = nullptr;
+}
@@ -0,0 +1,47 @@
+#ifndef ACAPI_ELEMENT_HOST_HPP
+#define ACAPI_ELEMENT_HOST_HPP
+
+#include <memory>
+#include "ElementHost.hpp"
+
+class ElementChangeTracker;
+
+// IElementHost backend that forwards every call to the Archicad API
+class ACAPIElementHost : public IElementHost {
+public:
+    ACAPIElementHost();
+    ~ACAPIElementHost() override;
+
+    HostError GetElemList(HostElemType type, std::vector<HostGuid>& guids) override;
+    HostError GetElement(const HostGuid& guid, HostElement& element) override;
+    HostError CalcBounds(const HostGuid& guid, HostBox3D& box) override;
+    HostError GetMemo(const HostGuid& guid, HostElementMemo& memo) override;
+    HostError GetConnectedLabels(const HostGuid& guid, std::vector<HostGuid>& labels) override;
+    HostError GetElementInfoString(const HostGuid& guid, std::string& infoString) override;
+    HostError GetElemTypeName(HostElemType type, std::string& name) override;
+
+    HostError CreateDimension(const HostDimensionSpec& spec, HostGuid* newGuid) override;
+    HostError CreateLabel(const HostLabelSpec& spec, HostGuid* newGuid) override;
+    HostError CreateZone(const HostZoneSpec& spec, HostGuid* newGuid) override;
+    HostError CreateDoorMarker(const HostDoorMarkerSpec& spec, HostGuid* newGuid) override;
+
+    HostError DeleteElements(const std::vector<HostGuid>& guids) override;
+
+    // Element defaults are fetched once per run instead of once per created element
+    void      BeginAnnotationRun() override;
+    void      EndAnnotationRun() override;
+
+private:
+    struct DefaultsCache;
+
+    DefaultsCache& GetDefaultsCache(std::unique_ptr<DefaultsCache>& callCache);
+
+    std::unique_ptr<DefaultsCache> runDefaults;
+};
+
+// Marks dimensions, walls, slabs, zones, doors and labels in tracker whenever Archicad reports them
+// created, modified or deleted, until StopElementObserver. The add-on has to stay in memory meanwhile.
+HostError StartElementObserver(ElementChangeTracker& tracker);
+void      StopElementObserver();
+
+#endif // ACAPI_ELEMENT_HOST_HPP
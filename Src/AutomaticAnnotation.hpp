@@ -1,7 +1,10 @@
 #ifndef AUTOMATIC_ANNOTATION_HPP
 #define AUTOMATIC_ANNOTATION_HPP
 
-// Declaration of the AutomaticAnnotation function
-void AutomaticAnnotation();
+#include "ElementHost.hpp"
+#include "TraceRecorder.hpp"
+
+// Declaration of the AutomaticAnnotation function, creating through host; rows and create calls are traced when trace is not null
+void AutomaticAnnotation(IElementHost& host, TraceRecorder* trace = nullptr);
 
 #endif // AUTOMATIC_ANNOTATION_HPP
\ No newline at end of file
@@ -0,0 +1,395 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "AnnotationCreation.hpp"
+#include "ElementExtraction.hpp"
+#include "GnnInference.hpp"
+#include "GnnKernels.hpp"
+#include "IncrementalExtraction.hpp"
+#include "MemoryElementHost.hpp"
+#include "SyntheticModel.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// Runs extraction, label type prediction, prediction CSV planning and annotation commit over
+// generated models and reports the throughput of each stage and the peak memory of the process.
+//
+// Usage: Extraction_V2Benchmark [-n <elements>[,<elements>...]] [-f <floors> -r <rooms per floor>] [-d <doors per wall>]
+//     [-j <threads>] [-w <model snapshot>] [-k <work directory>] [-c <classifier weights>] [-x <classifier out>]
+//     [-i scalar|avx2|neon]
+//
+// -n benchmarks a model of about each size (default 10,1000,10000,100000), -f and -r give the shape of a
+// single model instead. -w saves the last generated model as a snapshot for Extraction_V2Standalone.
+// Prediction runs the classifier given with -c, by default a synthetic one (MakeSyntheticGnnModel)
+// that -x saves for Extraction_V2Standalone -n; a float classifier is also run quantized to int8,
+// calibrated on the model itself. Repredict deletes a few doors and predicts again incrementally
+// (GnnInference::RunIncremental), which must match a full prediction. The classifier kernels use
+// the best instruction set of the CPU, -i picks one for comparing. Annotate repeats Automatic
+// Annotation from the classifier (extract, predict, commit) on the annotated model, the last time
+// as after a restart; a repeat without edits that creates or replaces anything fails the benchmark. Before the models, every SIMD instruction set the CPU supports is
+// checked against the scalar kernels; a larger difference than rounding fails the benchmark.
+// Reports and prediction files go to the work directory (default: the system temp directory).
+// Peak memory only grows, run the sizes in increasing order to read it per model.
+
+static double SecondsSince(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double PeakMemoryMB() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0.0;
+    return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0.0;
+#if defined(__APPLE__)
+    return usage.ru_maxrss / (1024.0 * 1024.0);     // bytes
+#else
+    return usage.ru_maxrss / 1024.0;                // kilobytes
+#endif
+#endif
+}
+
+static void PrintStage(size_t modelSize, const char* stage, double seconds, size_t itemCount, const char* itemName) {
+    char line[256];
+    snprintf(line, sizeof(line), "%10zu  %-10s %10.3f s  %10zu %-9s %12.0f %s/s  peak %8.1f MB",
+        modelSize, stage, seconds, itemCount, itemName, seconds > 0.0 ? itemCount / seconds : 0.0, itemName, PeakMemoryMB());
+    std::cout << line << std::endl;
+}
+
+static void PrintUsage() {
+    std::cerr << "Usage: Extraction_V2Benchmark [-n <elements>[,<elements>...]] [-f <floors> -r <rooms per floor>] [-d <doors per wall>]"
+        " [-j <threads>] [-w <model snapshot>] [-k <work directory>] [-c <classifier weights>] [-x <classifier out>]"
+        " [-i scalar|avx2|neon]" << std::endl;
+}
+
+static bool ParseKernelIsa(const char* str, GnnKernelIsa& isa) {
+    for (GnnKernelIsa candidate : { GnnKernelIsa::Scalar, GnnKernelIsa::Avx2, GnnKernelIsa::Neon }) {
+        if (strcmp(str, GnnKernelIsaName(candidate)) == 0) {
+            isa = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Compares the SIMD kernels with the scalar ones, with a column count that is a multiple of every
+// vector width and one that leaves tails. False if one differs by more than rounding.
+static bool CheckGnnKernels() {
+    const double MaxRelativeError = 1e-4;
+    for (GnnKernelIsa isa : { GnnKernelIsa::Avx2, GnnKernelIsa::Neon }) {
+        if (!IsGnnKernelIsaSupported(isa))
+            continue;
+        double error = std::max(CompareGnnKernels(isa, 4096, 64, 8, 1), CompareGnnKernels(isa, 1001, 45, 3, 2));
+        char line[128];
+        snprintf(line, sizeof(line), "kernels %-6s relative error %.2e against scalar", GnnKernelIsaName(isa), error);
+        std::cout << line << std::endl;
+        if (!(error <= MaxRelativeError)) {
+            std::cerr << GnnKernelIsaName(isa) << " kernels differ from the scalar ones" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool ParseSizes(const char* str, std::vector<size_t>& sizes) {
+    sizes.clear();
+    while (*str != '\0') {
+        char* end = nullptr;
+        unsigned long long size = std::strtoull(str, &end, 10);
+        if (end == str || size == 0)
+            return false;
+        sizes.push_back(static_cast<size_t>(size));
+        str = *end == ',' ? end + 1 : end;
+    }
+    return !sizes.empty();
+}
+
+// Deletes a few doors after a prediction that fills the cache of an incremental one, then times
+// the incremental prediction, graph included, and checks it against a full run on the same graph
+static bool RunIncrementalPrediction(MemoryElementHost& host, ExtractionSession& session, ExtractionSnapshot& extractionSnapshot,
+    const GnnModel& classifier, size_t threadCount, const std::string& reportPath)
+{
+    const size_t EditedDoorCount = 8;
+    size_t modelSize = host.GetElementCount();
+    ElementGraph graph;
+    BuildElementGraph(extractionSnapshot, graph, threadCount);
+    GnnInference inference;
+    std::vector<GnnPrediction> predictions;
+    std::vector<GnnPredictionDelta> deltas;
+    ElementChangeTracker changes;
+    if (inference.RunIncremental(classifier, graph, changes, predictions, deltas, threadCount) != HostNoError)
+        return false;
+
+    std::vector<HostGuid> doors;
+    host.GetElemList(HostElemType::Door, doors);
+    std::vector<HostGuid> deletedDoors;
+    for (size_t i = 0; i < EditedDoorCount && i < doors.size(); ++i)
+        deletedDoors.push_back(doors[i * doors.size() / EditedDoorCount]);
+    host.SetChangeTracker(&changes);
+    host.DeleteElements(deletedDoors);
+    host.SetChangeTracker(nullptr);
+    // Extraction clears the changes, prediction needs them after it
+    ElementChangeTracker dirtyElements = changes;
+    if (WriteIncrementalTextReport(host, session, extractionSnapshot, changes, reportPath) != HostNoError) {
+        std::cerr << "Failed to write " << reportPath << std::endl;
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    BuildElementGraph(extractionSnapshot, graph, threadCount);
+    if (inference.RunIncremental(classifier, graph, dirtyElements, predictions, deltas, threadCount) != HostNoError)
+        return false;
+    PrintStage(modelSize, "repredict", SecondsSince(start), modelSize, "elements");
+
+    GnnInference fullInference;
+    std::vector<GnnPrediction> fullPredictions;
+    if (fullInference.Run(classifier, graph, fullPredictions, threadCount) != HostNoError)
+        return false;
+    bool same = predictions.size() == fullPredictions.size();
+    for (size_t i = 0; same && i < predictions.size(); ++i) {
+        same = predictions[i].type == fullPredictions[i].type && predictions[i].row == fullPredictions[i].row &&
+            predictions[i].labelType == fullPredictions[i].labelType && predictions[i].confidence == fullPredictions[i].confidence;
+    }
+    std::cout << "            " << inference.GetUpdatedNodeCount() << " of " << inference.GetNodeCount() << " nodes recomputed, "
+        << deltas.size() << " label types changed" << std::endl;
+    if (!same)
+        std::cerr << "The incremental prediction differs from a full one" << std::endl;
+    return same;
+}
+
+// Annotates from the classifier as Automatic Annotation does, then again twice with the changes
+// the annotations made; the last time with the annotation record saved and loaded and without the
+// embeddings, as after a restart. False if a repeat creates or replaces anything.
+static bool RunRepeatedAnnotation(MemoryElementHost& host, ExtractionSession& session, ExtractionSnapshot& extractionSnapshot,
+    const GnnModel& classifier, size_t threadCount, const std::string& reportPath, const std::string& recordPath)
+{
+    const int PassCount = 3;
+    size_t modelSize = host.GetElementCount();
+    GnnInference inference;
+    PredictedAnnotations annotations;
+    ElementChangeTracker changes;
+    MarkChangesSinceSnapshot(host, extractionSnapshot, changes);
+    host.SetChangeTracker(&changes);
+
+    bool unchanged = true;
+    for (int pass = 0; pass < PassCount && unchanged; ++pass) {
+        if (pass == PassCount - 1) {
+            inference.ClearCache();
+            if (annotations.Save(recordPath) != HostNoError || annotations.Load(recordPath) != HostNoError) {
+                std::cerr << "Failed to write " << recordPath << std::endl;
+                host.SetChangeTracker(nullptr);
+                return false;
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+        // Extraction clears the changes, prediction needs them after it
+        ElementChangeTracker dirtyElements = changes;
+        if (WriteIncrementalTextReport(host, session, extractionSnapshot, changes, reportPath) != HostNoError) {
+            std::cerr << "Failed to write " << reportPath << std::endl;
+            host.SetChangeTracker(nullptr);
+            return false;
+        }
+        AnnotationPlan plan;
+        if (PlanModelAnnotationUpdate(inference, annotations, classifier, extractionSnapshot, dirtyElements, plan, threadCount) != HostNoError) {
+            host.SetChangeTracker(nullptr);
+            return false;
+        }
+        std::vector<HostGuid> created;
+        size_t createdCount = CommitAnnotationPlan(host, plan, nullptr, &created);
+        annotations.Record(plan, created);
+        PrintStage(modelSize, pass == 0 ? "annotate" : "reannotate", SecondsSince(start), createdCount, "elements");
+
+        if (pass > 0 && (createdCount != 0 || !plan.replaced.empty())) {
+            std::cerr << "Annotating again without edits created " << createdCount << " and replaced "
+                << plan.replaced.size() << " elements" << std::endl;
+            unchanged = false;
+        }
+    }
+    host.SetChangeTracker(nullptr);
+    return unchanged;
+}
+
+// Generates one model and runs every stage on it, false if a file could not be written
+static bool RunBenchmark(const SyntheticModelParams& params, const GnnModel& classifier, size_t threadCount, const std::filesystem::path& workDir,
+    const std::string& snapshotPath)
+{
+    MemoryElementHost host;
+    auto start = std::chrono::steady_clock::now();
+    GenerateSyntheticModel(params, host);
+    size_t modelSize = host.GetElementCount();
+    PrintStage(modelSize, "generate", SecondsSince(start), modelSize, "elements");
+
+    if (!snapshotPath.empty() && host.SaveSnapshot(snapshotPath) != HostNoError) {
+        std::cerr << "Failed to save snapshot " << snapshotPath << std::endl;
+        return false;
+    }
+
+    std::string reportPath = (workDir / "Benchmark_ElementInfo.txt").string();
+    ExtractionSession session;
+    start = std::chrono::steady_clock::now();
+    if (WriteTextReport(host, session, reportPath) != HostNoError) {
+        std::cerr << "Failed to write " << reportPath << std::endl;
+        return false;
+    }
+    PrintStage(modelSize, "extract", SecondsSince(start), modelSize, "elements");
+
+    // The classifier works on the extraction snapshot, made by an untimed second run
+    ExtractionSnapshot extractionSnapshot;
+    ElementChangeTracker changes;
+    if (WriteIncrementalTextReport(host, session, extractionSnapshot, changes, reportPath) != HostNoError) {
+        std::cerr << "Failed to write " << reportPath << std::endl;
+        return false;
+    }
+    AnnotationPlan predictedPlan;
+    start = std::chrono::steady_clock::now();
+    if (PlanModelAnnotation(classifier, extractionSnapshot, predictedPlan, threadCount) != HostNoError)
+        return false;
+    PrintStage(modelSize, "predict", SecondsSince(start), modelSize, "elements");
+
+    // The same with the classifier quantized to int8, calibrated on this model untimed
+    if (!classifier.quantized) {
+        ElementGraph graph;
+        BuildElementGraph(extractionSnapshot, graph, threadCount);
+        GnnInference inference;
+        std::vector<GnnPrediction> predictions;
+        GnnActivationRanges ranges;
+        GnnModel quantizedClassifier;
+        if (inference.Run(classifier, graph, predictions, threadCount, nullptr, &ranges) != HostNoError ||
+            QuantizeGnnModel(classifier, ranges, quantizedClassifier) != HostNoError)
+            return false;
+        AnnotationPlan quantizedPlan;
+        start = std::chrono::steady_clock::now();
+        if (PlanModelAnnotation(quantizedClassifier, extractionSnapshot, quantizedPlan, threadCount) != HostNoError)
+            return false;
+        PrintStage(modelSize, "predict-i8", SecondsSince(start), modelSize, "elements");
+    }
+
+    if (!RunIncrementalPrediction(host, session, extractionSnapshot, classifier, threadCount, reportPath))
+        return false;
+
+    std::string predictionPath = (workDir / "Benchmark_predictions.csv").string();
+    size_t rowCount = WriteSyntheticPredictions(host, predictionPath);
+    if (rowCount == 0) {
+        std::cerr << "Failed to write " << predictionPath << std::endl;
+        return false;
+    }
+
+    AnnotationPlan plan;
+    start = std::chrono::steady_clock::now();
+    if (PlanAutomaticAnnotation(predictionPath, plan, threadCount) != HostNoError)
+        return false;
+    PrintStage(modelSize, "plan", SecondsSince(start), rowCount, "rows");
+
+    start = std::chrono::steady_clock::now();
+    size_t createdCount = CommitAnnotationPlan(host, plan);
+    PrintStage(modelSize, "commit", SecondsSince(start), createdCount, "elements");
+
+    std::string recordPath = (workDir / "Benchmark_annotations.bin").string();
+    bool annotated = RunRepeatedAnnotation(host, session, extractionSnapshot, classifier, threadCount, reportPath, recordPath);
+
+    std::error_code errorCode;
+    std::filesystem::remove(reportPath, errorCode);
+    std::filesystem::remove(predictionPath, errorCode);
+    std::filesystem::remove(recordPath, errorCode);
+    return annotated;
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes = { 10, 1000, 10000, 100000 };
+    SyntheticModelParams shape;
+    bool explicitShape = false;
+    size_t threadCount = 0;
+    std::string snapshotPath;
+    std::error_code errorCode;
+    std::filesystem::path workDir = std::filesystem::temp_directory_path(errorCode);
+    std::string classifierPath;
+    std::string classifierOutPath;
+    GnnKernelIsa kernelIsa = GetGnnKernelIsa();
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            if (!ParseSizes(argv[++i], sizes)) {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-f") == 0) {
+            shape.floorCount = std::atoi(argv[++i]);
+            explicitShape = true;
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+            shape.roomsPerFloor = std::atoi(argv[++i]);
+            explicitShape = true;
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-d") == 0)
+            shape.doorsPerWall = std::atoi(argv[++i]);
+        else if (i + 1 < argc && strcmp(argv[i], "-j") == 0)
+            threadCount = std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && strcmp(argv[i], "-w") == 0)
+            snapshotPath = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-k") == 0)
+            workDir = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-c") == 0)
+            classifierPath = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-x") == 0)
+            classifierOutPath = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-i") == 0) {
+            if (!ParseKernelIsa(argv[++i], kernelIsa)) {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (!CheckGnnKernels())
+        return 1;
+    if (!SetGnnKernelIsa(kernelIsa)) {
+        std::cerr << "The CPU does not support " << GnnKernelIsaName(kernelIsa) << " kernels" << std::endl;
+        return 1;
+    }
+    std::cout << "kernels " << GnnKernelIsaName(kernelIsa) << std::endl;
+
+    GnnModel classifier;
+    if (!classifierPath.empty()) {
+        HostError err = classifier.Load(classifierPath);
+        if (err != HostNoError) {
+            std::cerr << "Failed to load classifier " << classifierPath << ": " << err << std::endl;
+            return 1;
+        }
+    }
+    else
+        MakeSyntheticGnnModel(64, 2, shape.seed, classifier);
+    if (!classifierOutPath.empty() && classifier.Save(classifierOutPath) != HostNoError) {
+        std::cerr << "Failed to save classifier " << classifierOutPath << std::endl;
+        return 1;
+    }
+
+    if (explicitShape)
+        return RunBenchmark(shape, classifier, threadCount, workDir, snapshotPath) ? 0 : 1;
+
+    for (size_t size : sizes) {
+        if (!RunBenchmark(SyntheticModelParamsForSize(size, shape), classifier, threadCount, workDir, snapshotPath))
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "ElementGraph.hpp"
+#include "ExtractionSnapshot.hpp"
+#include "GnnInference.hpp"
+
+// Quantizes the label type classifier to int8 after training: runs the float classifier over saved
+// extraction snapshots (Extraction_V2Standalone -p) to find the range of the activations, saves
+// the quantized classifier, then compares its predictions with the float ones on the same snapshots.
+//
+// Usage: Extraction_V2Calibrate <classifier weights> <quantized out> <extraction snapshot> [<extraction snapshot>...] [-j <threads>]
+//
+// Calibrate on snapshots of the kind of projects the classifier will see, activations beyond the
+// calibrated ranges are clamped.
+
+static double SecondsSince(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void PrintUsage() {
+    std::cerr << "Usage: Extraction_V2Calibrate <classifier weights> <quantized out> <extraction snapshot> [<extraction snapshot>...]"
+        " [-j <threads>]" << std::endl;
+}
+
+// False with a message if the snapshot cannot be read
+static bool LoadGraph(const std::string& snapshotPath, size_t threadCount, ElementGraph& graph) {
+    ExtractionSnapshot snapshot;
+    HostError err = snapshot.Load(snapshotPath);
+    if (err != HostNoError) {
+        std::cerr << "Failed to load extraction snapshot " << snapshotPath << ": " << err << std::endl;
+        return false;
+    }
+    BuildElementGraph(snapshot, graph, threadCount);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> paths;
+    size_t threadCount = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-j") == 0)
+            threadCount = std::strtoul(argv[++i], nullptr, 10);
+        else if (argv[i][0] == '-') {
+            PrintUsage();
+            return 1;
+        }
+        else
+            paths.push_back(argv[i]);
+    }
+    if (paths.size() < 3) {
+        PrintUsage();
+        return 1;
+    }
+    const std::string& classifierPath = paths[0];
+    const std::string& quantizedPath = paths[1];
+    const std::vector<std::string> snapshotPaths(paths.begin() + 2, paths.end());
+
+    GnnModel classifier;
+    HostError err = classifier.Load(classifierPath);
+    if (err != HostNoError) {
+        std::cerr << "Failed to load classifier " << classifierPath << ": " << err << std::endl;
+        return 1;
+    }
+    if (classifier.quantized) {
+        std::cerr << "The classifier " << classifierPath << " is already quantized" << std::endl;
+        return 1;
+    }
+
+    GnnInference inference;
+    std::vector<GnnPrediction> predictions;
+    GnnActivationRanges ranges;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& snapshotPath : snapshotPaths) {
+        ElementGraph graph;
+        if (!LoadGraph(snapshotPath, threadCount, graph))
+            return 1;
+        if (inference.Run(classifier, graph, predictions, threadCount, nullptr, &ranges) != HostNoError) {
+            std::cerr << snapshotPath << ": " << inference.GetErrorMessage() << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Calibrated on " << ranges.nodeCount << " nodes of " << snapshotPaths.size() << " snapshots in "
+        << SecondsSince(start) << " s" << std::endl;
+
+    GnnModel quantized;
+    if (QuantizeGnnModel(classifier, ranges, quantized) != HostNoError) {
+        std::cerr << "Failed to quantize classifier " << classifierPath << std::endl;
+        return 1;
+    }
+    if (quantized.Save(quantizedPath) != HostNoError) {
+        std::cerr << "Failed to save quantized classifier " << quantizedPath << std::endl;
+        return 1;
+    }
+    char line[512];
+    snprintf(line, sizeof(line), "Weights: %.1f KB float, %.1f KB quantized", classifier.GetWeightSize() / 1024.0,
+        quantized.GetWeightSize() / 1024.0);
+    std::cout << line << std::endl;
+
+    // Same snapshots again: how often the quantized classifier picks the float one's label type
+    for (const std::string& snapshotPath : snapshotPaths) {
+        ElementGraph graph;
+        if (!LoadGraph(snapshotPath, threadCount, graph))
+            return 1;
+        start = std::chrono::steady_clock::now();
+        inference.Run(classifier, graph, predictions, threadCount);
+        double floatSeconds = SecondsSince(start);
+
+        std::vector<GnnPrediction> quantizedPredictions;
+        start = std::chrono::steady_clock::now();
+        inference.Run(quantized, graph, quantizedPredictions, threadCount);
+        double quantizedSeconds = SecondsSince(start);
+
+        size_t agreeing = 0;
+        float maxConfidenceChange = 0.0f;
+        for (size_t i = 0; i < predictions.size(); ++i) {
+            if (predictions[i].labelType == quantizedPredictions[i].labelType)
+                ++agreeing;
+            maxConfidenceChange = std::max(maxConfidenceChange, std::fabs(predictions[i].confidence - quantizedPredictions[i].confidence));
+        }
+        snprintf(line, sizeof(line), "%s: %zu of %zu label types agree (%.2f%%), confidence within %.4f, float %.3f s, int8 %.3f s",
+            snapshotPath.c_str(), agreeing, predictions.size(), predictions.empty() ? 100.0 : 100.0 * agreeing / predictions.size(),
+            maxConfidenceChange, floatSeconds, quantizedSeconds);
+        std::cout << line << std::endl;
+    }
+    return 0;
+}
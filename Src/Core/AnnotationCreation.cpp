@@ -0,0 +1,63 @@
+#include "AnnotationCreation.hpp"
+#include <iostream>
+
+size_t CommitAnnotationPlan(IElementHost& host, const AnnotationPlan& plan, TraceRecorder* trace, std::vector<HostGuid>* created) {
+    static const char* const stepNames[] = { "CreateDimension", "CreateLabel", "CreateZone", "CreateDoorMarker" };
+    TraceScope traceScope(trace, "CommitAnnotationPlan", "annotate");
+    size_t createdCount = 0;
+    if (created != nullptr)
+        created->assign(plan.steps.size(), HostNullGuid);
+
+    host.BeginAnnotationRun();
+    if (!plan.replaced.empty()) {
+        TraceScope deleteScope(trace, "DeleteElements", "annotate");
+        HostError err = host.DeleteElements(plan.replaced);
+        if (err != HostNoError)
+            std::cerr << "Error deleting replaced annotations: " << err << std::endl;
+    }
+    for (size_t stepIndex = 0; stepIndex < plan.steps.size(); ++stepIndex) {
+        const AnnotationStep& step = plan.steps[stepIndex];
+        TraceScope stepScope(trace, stepNames[static_cast<size_t>(step.kind)], "annotate", static_cast<std::int64_t>(stepIndex));
+        HostGuid* newGuid = created != nullptr ? &(*created)[stepIndex] : nullptr;
+        HostError err = HostNoError;
+        switch (step.kind) {
+        case AnnotationKind::Dimension:
+            err = host.CreateDimension(plan.dimensions[step.index], newGuid);
+            if (err != HostNoError)
+                std::cerr << "Error creating element: " << err << std::endl;
+            break;
+        case AnnotationKind::Label:
+            err = host.CreateLabel(plan.labels[step.index], newGuid);
+            if (err != HostNoError)
+                std::cerr << "Error creating label: " << err << std::endl;
+            break;
+        case AnnotationKind::Zone:
+            err = host.CreateZone(plan.zones[step.index], newGuid);
+            if (err != HostNoError)
+                std::cerr << "Error creating zone: " << err << std::endl;
+            break;
+        case AnnotationKind::DoorMarker:
+            err = host.CreateDoorMarker(plan.doorMarkers[step.index], newGuid);
+            if (err != HostNoError)
+                std::cerr << "Error creating detail and door marker: " << err << std::endl;
+            break;
+        }
+
+        if (err == HostNoError)
+            ++createdCount;
+        else if (newGuid != nullptr)
+            *newGuid = HostNullGuid;
+    }
+    host.EndAnnotationRun();
+
+    return createdCount;
+}
+
+// Main function to automatically annotate elements
+void AutomaticAnnotation(IElementHost& host, const std::string& filePath, TraceRecorder* trace) {
+    AnnotationPlan plan;
+    if (PlanAutomaticAnnotation(filePath, plan, 0, trace) != HostNoError)
+        return;
+
+    CommitAnnotationPlan(host, plan, trace);
+}
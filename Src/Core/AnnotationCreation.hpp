@@ -0,0 +1,19 @@
+#ifndef ANNOTATION_CREATION_HPP
+#define ANNOTATION_CREATION_HPP
+
+#include <string>
+#include <vector>
+#include "AnnotationPlan.hpp"
+#include "ElementHost.hpp"
+#include "PredictionCsv.hpp"
+
+// Creates dimensions, labels, door markers and zones from a prediction CSV exported by the GNN
+void AutomaticAnnotation(IElementHost& host, const std::string& filePath, TraceRecorder* trace = nullptr);
+
+// Deletes the replaced annotations of plan, then creates the planned elements in plan order, returns
+// how many were created. With a trace, every create call is a span whose index is the step. With
+// created, it gets the GUID of each step's element, HostNullGuid where creating failed.
+size_t CommitAnnotationPlan(IElementHost& host, const AnnotationPlan& plan, TraceRecorder* trace = nullptr,
+    std::vector<HostGuid>* created = nullptr);
+
+#endif // ANNOTATION_CREATION_HPP
@@ -0,0 +1,403 @@
+#include "AnnotationPlan.hpp"
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <iostream>
+#include <limits>
+#include "ThreadPool.hpp"
+
+namespace {
+
+bool AllFinite(std::initializer_list<double> values) {
+    for (double value : values) {
+        if (!std::isfinite(value))
+            return false;
+    }
+    return true;
+}
+
+// Rows planned per task
+constexpr size_t PlanChunkRows = 2048;
+
+void AddInvalidNumberMessage(const PredictionRecord& record, AnnotationPlan& plan) {
+    plan.messages.push_back("Invalid number in line: " + std::string(record.line));
+}
+
+}
+
+void AnnotationPlan::AddDimension(const HostDimensionSpec& spec, const HostGuid& owner) {
+    steps.push_back({ AnnotationKind::Dimension, static_cast<uint32_t>(dimensions.size()), owner });
+    dimensions.push_back(spec);
+}
+
+void AnnotationPlan::AddLabel(const HostLabelSpec& spec, const HostGuid& owner) {
+    steps.push_back({ AnnotationKind::Label, static_cast<uint32_t>(labels.size()), owner });
+    labels.push_back(spec);
+}
+
+void AnnotationPlan::AddZone(const HostZoneSpec& spec, const HostGuid& owner) {
+    steps.push_back({ AnnotationKind::Zone, static_cast<uint32_t>(zones.size()), owner });
+    zones.push_back(spec);
+}
+
+void AnnotationPlan::AddDoorMarker(const HostDoorMarkerSpec& spec, const HostGuid& owner) {
+    steps.push_back({ AnnotationKind::DoorMarker, static_cast<uint32_t>(doorMarkers.size()), owner });
+    doorMarkers.push_back(spec);
+}
+
+void AnnotationPlan::Append(const AnnotationPlan& other) {
+    for (const AnnotationStep& step : other.steps) {
+        switch (step.kind) {
+        case AnnotationKind::Dimension:     AddDimension(other.dimensions[step.index], step.owner); break;
+        case AnnotationKind::Label:         AddLabel(other.labels[step.index], step.owner); break;
+        case AnnotationKind::Zone:          AddZone(other.zones[step.index], step.owner); break;
+        case AnnotationKind::DoorMarker:    AddDoorMarker(other.doorMarkers[step.index], step.owner); break;
+        }
+    }
+    messages.insert(messages.end(), other.messages.begin(), other.messages.end());
+    replaced.insert(replaced.end(), other.replaced.begin(), other.replaced.end());
+}
+
+void AnnotationPlan::Clear() {
+    steps.clear();
+    dimensions.clear();
+    labels.clear();
+    zones.clear();
+    doorMarkers.clear();
+    messages.clear();
+    replaced.clear();
+}
+
+// Dimension along the longer side of a wall's bounding box
+bool PlanDimensionForWall(const PredictionRecord& record, HostDimensionSpec& dimension) {
+    double bbXMin = record.bounds.xMin;
+    double bbYMin = record.bounds.yMin;
+    double bbXMax = record.bounds.xMax;
+    double bbYMax = record.bounds.yMax;
+    double Width = record.width;
+    //double Length = record.length;
+
+    if (!AllFinite({ bbXMin, bbYMin, bbXMax, bbYMax, Width }))
+        return false;
+
+    bool horizontalWall = (bbYMax - bbYMin) < (bbXMax - bbXMin); // Check if the wall is horizontal
+
+    dimension.textWay = horizontalWall ? HostTextWay::Horizontal : HostTextWay::Vertical; // Set the text way based on wall orientation
+
+    if (horizontalWall) {
+        // For horizontal walls, set reference point and direction accordingly
+        dimension.refC.x = bbXMin;
+        dimension.refC.y = bbYMin;
+
+        // Adjust y-coordinate if bbYMin is 0 or negative
+        if (bbYMin <= 0) {
+            // Add a negative offset to the y-coordinate
+            dimension.refC.y -= Width; // Adjust yOffset as needed
+            dimension.textPos = HostTextPos::Below;
+        }
+        else {
+            // Add a positive offset to the y-coordinate
+            dimension.refC.y += Width + Width; // Adjust yOffset as needed
+            dimension.textPos = HostTextPos::Above;
+        }
+
+        // Set direction and other properties as before
+        dimension.direction.x = 1.0;
+        dimension.direction.y = 0.0;  // Horizontal direction
+
+        dimension.dimElems[0].x = bbXMin;
+        dimension.dimElems[0].y = bbYMin;
+        dimension.dimElems[1].x = bbXMax;
+        dimension.dimElems[1].y = bbYMin; // Same Y-coordinate for horizontal wall
+    }
+    else {
+        // For vertical walls, set reference point and direction accordingly
+        dimension.refC.x = bbXMin;
+        dimension.refC.y = bbYMin;
+
+        // Adjust y-coordinate if bbYMin is 0 or negative
+        if (bbXMin <= 0) {
+            // Add a negative offset to the y-coordinate
+            dimension.refC.x -= Width; // Adjust yOffset as needed
+            dimension.textPos = HostTextPos::Above;
+        }
+        else {
+            // Add a positive offset to the y-coordinate
+            dimension.refC.x += Width + Width; // Adjust yOffset as needed
+            dimension.textPos = HostTextPos::Below;
+        }
+
+        dimension.direction.x = 0.0; // Vertical direction
+        dimension.direction.y = 1.0;
+
+        dimension.dimElems[0].x = bbXMin;
+        dimension.dimElems[0].y = bbYMin;
+        dimension.dimElems[1].x = bbXMin; // Same X-coordinate for vertical wall
+        dimension.dimElems[1].y = bbYMax;
+    }
+
+    return true;
+}
+
+// Label attached to the door, centered below its bounding box
+bool PlanLabelForDoor(const PredictionRecord& record, const HostGuid& doorGuid, HostLabelSpec& label) {
+    if (!AllFinite({ record.bounds.xMin, record.bounds.yMin, record.bounds.xMax }))
+        return false;
+
+    // Extract position for the label based on door bounding box
+    double bbXMin = record.bounds.xMin; // 'bb_xmin' is the reference point x
+    double bbYMin = record.bounds.yMin; // 'bb_ymin' is the reference point y
+    double bbXMax = record.bounds.xMax; // 'bb_xmax' is the maximum x
+
+    double labelX = (bbXMin + bbXMax) / 2.0;
+    double labelY = bbYMin - 0.25; // Adjust Y position as necessary
+
+    // Set label position
+    label.begC.x = labelX;
+    label.begC.y = labelY;
+
+    // Set midC and endC points
+    label.midC = label.begC; // Just for example, you might adjust this based on your needs
+    label.endC = label.begC; // Just for example, you might adjust this based on your needs
+
+    // Set the parent of the label to the door
+    label.parent = doorGuid;
+
+    // Set textWay to parallel for ensuring the label is parallel to the floor
+    label.textWay = HostTextWay::Parallel;
+    return true;
+}
+
+HostDoorMarkerSpec PlanDoorMarker(const HostCoord& position) {
+    HostDoorMarkerSpec marker;
+
+    // Set up detail element
+    marker.pos = position;
+    marker.poly[0] = { position.x - 1.0, position.y };
+    marker.poly[1] = { position.x, position.y - 1.0 };
+    marker.poly[2] = { position.x + 1.0, position.y };
+    marker.poly[3] = { position.x, position.y + 1.0 };
+    marker.poly[4] = marker.poly[0];
+
+    // Set up door marker
+    marker.markerPen = 3; // Example pen color, adjust as needed
+    marker.markerPos.x = position.x + 1.5; // Example offset from detail element, adjust as needed
+    marker.markerPos.y = position.y + 1.0; // Example offset from detail element, adjust as needed
+
+    return marker;
+}
+
+void PlanAnnotation(const PredictionRecord& record, AnnotationPlan& plan) {
+    // Determine labelType and plan the matching elements
+    if (record.labelType == PredLabelDimension) {
+        HostDimensionSpec dimension;
+        if (PlanDimensionForWall(record, dimension))
+            plan.AddDimension(dimension, record.guid);
+        else
+            AddInvalidNumberMessage(record, plan);
+    }
+    else if (record.labelType == PredLabelDoor) {
+        if (!AllFinite({ record.bounds.xMin, record.bounds.yMin, record.bounds.xMax })) {
+            AddInvalidNumberMessage(record, plan);
+            return;
+        }
+
+        plan.AddDoorMarker(PlanDoorMarker({ record.bounds.xMin + 0.5, record.bounds.yMin - 0.5 }), record.guid);
+        if (record.guidStr.empty()) {
+            plan.messages.push_back("Door GUID is empty for line: " + std::string(record.line));
+            return;
+        }
+
+        HostLabelSpec label;
+        if (PlanLabelForDoor(record, record.guid, label))
+            plan.AddLabel(label, record.guid);
+    }
+    else if (record.labelType == PredLabelZone) {
+        if (!AllFinite({ record.pos.x, record.pos.y })) {
+            AddInvalidNumberMessage(record, plan);
+            return;
+        }
+
+        HostZoneSpec zone;
+        zone.pos.x = record.pos.x + 1.0;
+        zone.pos.y = record.pos.y - 1.0;
+        zone.roomName = std::string(record.roomName);
+        zone.roomNoStr = std::string(record.roomNoStr);
+        plan.AddZone(zone, record.guid);
+    }
+}
+
+HostError PlanAutomaticAnnotation(const std::string& filePath, AnnotationPlan& plan, size_t threadCount, TraceRecorder* trace) {
+    TraceScope traceScope(trace, "PlanAutomaticAnnotation", "annotate");
+    PredictionCsvReader reader;
+    HostError err = reader.Open(filePath);
+    if (err == HostErrBadFormat) {
+        // Refuse the whole file rather than annotating from the wrong columns
+        std::cerr << "Unexpected source file columns: " << reader.GetErrorMessage() << std::endl;
+        return err;
+    }
+    if (err != HostNoError) {
+        std::cerr << "Failed to open source file." << std::endl;
+        return err;
+    }
+    if (reader.GetSchema().IsPositional())
+        std::cerr << "No known column names in the header, reading the columns in the fixed layout of the first exporter" << std::endl;
+
+    // Finding the row ends is a cheap sequential scan, splitting and planning the rows is done in parallel
+    std::vector<std::string_view> lines;
+    std::string_view line;
+    while (reader.ReadNextLine(line))
+        lines.push_back(line);
+
+    size_t chunkCount = (lines.size() + PlanChunkRows - 1) / PlanChunkRows;
+    std::vector<AnnotationPlan> chunkPlans(chunkCount);
+    auto planChunk = [&](size_t chunkIndex, size_t begin, size_t end) {
+        AnnotationPlan& chunkPlan = chunkPlans[chunkIndex];
+        std::vector<std::string_view> fields;
+        PredictionRecord record;
+        for (size_t i = begin; i < end; ++i) {
+            TraceScope rowScope(trace, "PlanRow", "annotate", static_cast<std::int64_t>(i));
+            if (reader.ParseRecord(lines[i], fields, record))
+                PlanAnnotation(record, chunkPlan);
+            else
+                chunkPlan.messages.push_back("Not enough tokens in line: " + std::string(lines[i]));
+        }
+    };
+
+    if (threadCount == 0)
+        threadCount = ThreadPool::GetHardwareThreadCount();
+    threadCount = std::min(threadCount, chunkCount);
+    if (threadCount <= 1) {
+        for (size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+            planChunk(chunkIndex, chunkIndex * PlanChunkRows, std::min((chunkIndex + 1) * PlanChunkRows, lines.size()));
+    }
+    else {
+        // The waiting thread works too, so one less background worker
+        ThreadPool pool(threadCount - 1);
+        ParallelForChunks(pool, lines.size(), PlanChunkRows, planChunk);
+    }
+
+    // Merge in row order
+    for (const AnnotationPlan& chunkPlan : chunkPlans)
+        plan.Append(chunkPlan);
+
+    for (const std::string& message : plan.messages)
+        std::cerr << message << std::endl;
+
+    return HostNoError;
+}
+
+void PlanPredictedAnnotation(const ExtractionSnapshot& snapshot, const ElementGraph& graph,
+    const std::vector<GnnPrediction>& predictions, AnnotationPlan& plan)
+{
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+    for (const GnnPrediction& prediction : predictions) {
+        if (prediction.labelType == PredLabelNone)
+            continue;
+        const HostGuid& guid = graph.GetNodes(prediction.type).guids[prediction.row];
+        const ElementReport* report = snapshot.FindElement(guid);
+        if (report == nullptr)
+            continue;
+
+        // The GUID stands in for the CSV line in messages
+        std::string guidStr = HostGuidToString(guid);
+        PredictionRecord record;
+        record.line = guidStr;
+        record.guidStr = guidStr;
+        record.guid = guid;
+        record.length = report->wallLength;
+        record.width = report->type == HostElemType::Door ? report->width : report->wallThickness;
+        record.bounds = report->hasBounds ? report->bounds : HostBox3D{ NaN, NaN, NaN, NaN, NaN, NaN };
+        record.pos = report->pos;
+        record.roomName = report->roomName;
+        record.roomNoStr = report->roomNoStr;
+        record.labelType = prediction.labelType;
+        PlanAnnotation(record, plan);
+    }
+}
+
+HostError PlanModelAnnotation(const GnnModel& model, const ExtractionSnapshot& snapshot, AnnotationPlan& plan,
+    size_t threadCount, TraceRecorder* trace)
+{
+    TraceScope traceScope(trace, "PlanModelAnnotation", "annotate");
+    ElementGraph graph;
+    {
+        TraceScope graphScope(trace, "BuildElementGraph", "graph");
+        BuildElementGraph(snapshot, graph, threadCount);
+    }
+
+    GnnInference inference;
+    std::vector<GnnPrediction> predictions;
+    HostError err = inference.Run(model, graph, predictions, threadCount, trace);
+    if (err != HostNoError) {
+        std::cerr << "Label type prediction failed: " << inference.GetErrorMessage() << std::endl;
+        return err;
+    }
+
+    AnnotationPlan predictedPlan;
+    PlanPredictedAnnotation(snapshot, graph, predictions, predictedPlan);
+    for (const std::string& message : predictedPlan.messages)
+        std::cerr << message << std::endl;
+    plan.Append(predictedPlan);
+    return HostNoError;
+}
+
+void PlanPredictionDeltas(const ExtractionSnapshot& snapshot, const ElementGraph& graph,
+    const std::vector<GnnPredictionDelta>& deltas, AnnotationPlan& plan)
+{
+    std::vector<GnnPrediction> predictions;
+    for (const GnnPredictionDelta& delta : deltas) {
+        if (delta.row < 0 || delta.labelType == PredLabelNone)
+            continue;
+        GnnPrediction prediction;
+        prediction.type = delta.type;
+        prediction.row = static_cast<std::uint32_t>(delta.row);
+        prediction.labelType = delta.labelType;
+        prediction.confidence = delta.confidence;
+        predictions.push_back(prediction);
+    }
+    PlanPredictedAnnotation(snapshot, graph, predictions, plan);
+}
+
+HostError PlanModelAnnotationUpdate(GnnInference& inference, PredictedAnnotations& annotations, const GnnModel& model,
+    const ExtractionSnapshot& snapshot, const ElementChangeTracker& changes, AnnotationPlan& plan, size_t threadCount,
+    TraceRecorder* trace)
+{
+    TraceScope traceScope(trace, "PlanModelAnnotationUpdate", "annotate");
+    ElementGraph graph;
+    {
+        TraceScope graphScope(trace, "BuildElementGraph", "graph");
+        BuildElementGraph(snapshot, graph, threadCount, &annotations.GetElements());
+    }
+
+    // Creating or replacing the annotations made them dirty, they are no input of the prediction
+    ElementChangeTracker userChanges;
+    annotations.RemoveFrom(changes, userChanges);
+
+    std::vector<GnnPrediction> predictions;
+    std::vector<GnnPredictionDelta> deltas;
+    HostError err = inference.RunIncremental(model, graph, userChanges, predictions, deltas, threadCount, trace);
+    if (err != HostNoError) {
+        std::cerr << "Label type prediction failed: " << inference.GetErrorMessage() << std::endl;
+        return err;
+    }
+
+    // Compared with the record rather than the previous run, which a restart does not keep
+    AnnotationPlan predictedPlan;
+    std::vector<GnnPrediction> changedPredictions;
+    GuidHashMap<bool> predictedNodes(predictions.size());
+    for (const GnnPrediction& prediction : predictions) {
+        const HostGuid& guid = graph.GetNodes(prediction.type).guids[prediction.row];
+        predictedNodes.Set(guid, true);
+        if (annotations.GetLabelType(guid) == prediction.labelType)
+            continue;
+        annotations.Replace(guid, prediction.labelType, predictedPlan.replaced);
+        changedPredictions.push_back(prediction);
+    }
+    annotations.ReplaceMissing(predictedNodes, predictedPlan.replaced);
+    PlanPredictedAnnotation(snapshot, graph, changedPredictions, predictedPlan);
+    for (const std::string& message : predictedPlan.messages)
+        std::cerr << message << std::endl;
+    plan.Append(predictedPlan);
+    return HostNoError;
+}
@@ -0,0 +1,89 @@
+#ifndef ANNOTATION_PLAN_HPP
+#define ANNOTATION_PLAN_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ExtractionSnapshot.hpp"
+#include "GnnInference.hpp"
+#include "HostTypes.hpp"
+#include "PredictedAnnotations.hpp"
+#include "PredictionCsv.hpp"
+#include "TraceRecorder.hpp"
+
+// Annotation is done in two phases. Planning turns prediction rows into fully computed element specs
+// without touching the host, the commit phase (CommitAnnotationPlan) creates them.
+
+enum class AnnotationKind : uint8_t {
+    Dimension,
+    Label,
+    Zone,
+    DoorMarker
+};
+
+// One element to create, index points into the vector of its kind
+struct AnnotationStep {
+    AnnotationKind kind;
+    uint32_t       index;
+    HostGuid       owner;           // element whose row or prediction asked for it, HostNullGuid if unknown
+};
+
+struct AnnotationPlan {
+    std::vector<AnnotationStep>     steps;          // creation order, follows the CSV rows
+    std::vector<HostDimensionSpec>  dimensions;
+    std::vector<HostLabelSpec>      labels;
+    std::vector<HostZoneSpec>       zones;
+    std::vector<HostDoorMarkerSpec> doorMarkers;
+    std::vector<std::string>        messages;       // rows that were skipped and why, in row order
+    std::vector<HostGuid>           replaced;       // annotations to delete before creating
+
+    void AddDimension(const HostDimensionSpec& spec, const HostGuid& owner = HostNullGuid);
+    void AddLabel(const HostLabelSpec& spec, const HostGuid& owner = HostNullGuid);
+    void AddZone(const HostZoneSpec& spec, const HostGuid& owner = HostNullGuid);
+    void AddDoorMarker(const HostDoorMarkerSpec& spec, const HostGuid& owner = HostNullGuid);
+    void Append(const AnnotationPlan& other);
+    void Clear();
+};
+
+// Spec for a single row, false if the row lacks a number the element needs. These have no side effects.
+bool               PlanDimensionForWall(const PredictionRecord& record, HostDimensionSpec& dimension);
+bool               PlanLabelForDoor(const PredictionRecord& record, const HostGuid& doorGuid, HostLabelSpec& label);
+HostDoorMarkerSpec PlanDoorMarker(const HostCoord& position);
+
+// Adds whatever the row's labelType asks for, owned by the row's element
+void               PlanAnnotation(const PredictionRecord& record, AnnotationPlan& plan);
+
+// Plans every row of a prediction CSV, the errors are those of PredictionCsvReader::Open.
+// Chunks of rows are planned on threadCount threads (0 uses every hardware thread) and merged
+// in row order, so the plan does not depend on the thread count. Skipped rows go to std::cerr.
+// With a trace, every row is a span on the thread that planned it.
+HostError          PlanAutomaticAnnotation(const std::string& filePath, AnnotationPlan& plan, size_t threadCount = 0, TraceRecorder* trace = nullptr);
+
+// Plans the label types predicted in process for the nodes of graph, in prediction order. The
+// numbers a CSV row would carry come from the node's report in snapshot, the graph's source.
+void               PlanPredictedAnnotation(const ExtractionSnapshot& snapshot, const ElementGraph& graph,
+                       const std::vector<GnnPrediction>& predictions, AnnotationPlan& plan);
+
+// The in-process counterpart of PlanAutomaticAnnotation: builds the element graph of snapshot,
+// predicts the label types with model and plans them. Errors are those of GnnInference::Run, the
+// message goes to std::cerr like the skipped rows.
+HostError          PlanModelAnnotation(const GnnModel& model, const ExtractionSnapshot& snapshot, AnnotationPlan& plan,
+                       size_t threadCount = 0, TraceRecorder* trace = nullptr);
+
+// Plans the nodes of deltas that are still in graph and have a label type now, in delta order.
+// What was annotated for a previous label type is left to the caller.
+void               PlanPredictionDeltas(const ExtractionSnapshot& snapshot, const ElementGraph& graph,
+                       const std::vector<GnnPredictionDelta>& deltas, AnnotationPlan& plan);
+
+// PlanModelAnnotation for the changes since the previous call with inference: predicts with
+// GnnInference::RunIncremental, changes being the elements dirty since then, and plans only the
+// nodes whose label type differs from the one annotations recorded for them. What annotations
+// recorded for such a node, or for a node that is gone, goes to plan.replaced; the recorded
+// elements are left out of the graph and of changes. The caller commits the plan and records
+// what it created in annotations for the next call. A record loaded from a file with a new
+// inference, as after a restart, plans nothing the record already has.
+HostError          PlanModelAnnotationUpdate(GnnInference& inference, PredictedAnnotations& annotations, const GnnModel& model,
+                       const ExtractionSnapshot& snapshot, const ElementChangeTracker& changes, AnnotationPlan& plan,
+                       size_t threadCount = 0, TraceRecorder* trace = nullptr);
+
+#endif // ANNOTATION_PLAN_HPP
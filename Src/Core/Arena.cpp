@@ -0,0 +1,57 @@
+#include "Arena.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+Arena::Arena(size_t chunkSize) :
+    chunkSize(std::max<size_t>(chunkSize, 1024)),
+    currentChunk(0),
+    offset(0),
+    bytesReserved(0)
+{
+}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+    // Try the current chunk, then the ones kept from earlier runs, then add a new one
+    while (currentChunk < chunks.size()) {
+        Chunk& chunk = chunks[currentChunk];
+        uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data.get());
+        size_t aligned = ((base + offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base;
+        if (aligned + size <= chunk.size) {
+            offset = aligned + size;
+            return chunk.data.get() + aligned;
+        }
+        ++currentChunk;
+        offset = 0;
+    }
+
+    Chunk chunk;
+    chunk.size = std::max(chunkSize, size + alignment);
+    chunk.data.reset(new char[chunk.size]);
+    bytesReserved += chunk.size;
+    chunks.push_back(std::move(chunk));
+    currentChunk = chunks.size() - 1;
+    offset = 0;
+    return Allocate(size, alignment);
+}
+
+std::string_view Arena::CopyString(std::string_view str) {
+    if (str.empty())
+        return std::string_view();
+
+    char* copy = static_cast<char*>(Allocate(str.size(), 1));
+    std::memcpy(copy, str.data(), str.size());
+    return std::string_view(copy, str.size());
+}
+
+void Arena::Reset() {
+    currentChunk = 0;
+    offset = 0;
+}
+
+void Arena::Release() {
+    chunks.clear();
+    currentChunk = 0;
+    offset = 0;
+    bytesReserved = 0;
+}
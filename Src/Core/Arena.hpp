@@ -0,0 +1,127 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator for per-run data. Memory is handed out from large chunks and never freed one
+// by one; Reset rewinds to the first chunk in O(1) and keeps the chunks for the next run.
+// Only trivially destructible objects may live here, nothing is destroyed.
+class Arena {
+public:
+    explicit Arena(size_t chunkSize = 64 * 1024);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void*            Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T, typename... Args>
+    T*               New(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed");
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    T*               NewArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed");
+        T* items = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        for (size_t i = 0; i < count; ++i)
+            new (items + i) T();
+        return items;
+    }
+
+    // Copy of str that lives until the next Reset
+    std::string_view CopyString(std::string_view str);
+
+    // Forgets every allocation, O(1)
+    void             Reset();
+
+    // Forgets every allocation and frees the chunks
+    void             Release();
+
+    size_t           GetBytesReserved() const { return bytesReserved; }
+
+private:
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t                  size;
+    };
+
+    size_t             chunkSize;
+    std::vector<Chunk> chunks;
+    size_t             currentChunk;
+    size_t             offset;
+    size_t             bytesReserved;
+};
+
+// Append-only list whose items live in an arena. Grows in segments, so items never move.
+// Clear is O(1); call it whenever the arena is reset.
+template <typename T>
+class ArenaList {
+public:
+    explicit ArenaList(Arena& arena) : arena(arena) {}
+
+    ArenaList(const ArenaList&) = delete;
+    ArenaList& operator=(const ArenaList&) = delete;
+
+    size_t GetSize() const { return size; }
+    bool   IsEmpty() const { return size == 0; }
+
+    T&     PushBack(const T& value) {
+        if (tail == nullptr || tail->count == tail->capacity) {
+            size_t capacity = tail == nullptr ? FirstSegmentSize : std::min(tail->capacity * 2, MaxSegmentSize);
+            Segment* segment = arena.New<Segment>();
+            segment->items = arena.NewArray<T>(capacity);
+            segment->capacity = capacity;
+            if (tail == nullptr)
+                head = segment;
+            else
+                tail->next = segment;
+            tail = segment;
+        }
+        T& item = tail->items[tail->count++];
+        item = value;
+        ++size;
+        return item;
+    }
+
+    void   Clear() {
+        head = nullptr;
+        tail = nullptr;
+        size = 0;
+    }
+
+    // Calls fn(item) for every item in insertion order
+    template <typename Fn>
+    void   ForEach(Fn&& fn) const {
+        for (const Segment* segment = head; segment != nullptr; segment = segment->next) {
+            for (size_t i = 0; i < segment->count; ++i)
+                fn(segment->items[i]);
+        }
+    }
+
+private:
+    static constexpr size_t FirstSegmentSize = 16;
+    static constexpr size_t MaxSegmentSize = 4096;
+
+    struct Segment {
+        T*       items = nullptr;
+        size_t   count = 0;
+        size_t   capacity = 0;
+        Segment* next = nullptr;
+    };
+
+    Arena&   arena;
+    Segment* head = nullptr;
+    Segment* tail = nullptr;
+    size_t   size = 0;
+};
+
+#endif // ARENA_HPP
@@ -0,0 +1,150 @@
+#include "AsyncFileWriter.hpp"
+#include <algorithm>
+#include <cstring>
+
+AsyncFileWriter::AsyncFileWriter(size_t blockSize) :
+    file(nullptr),
+    activeBlock(0),
+    submittedSize(0),
+    pendingBlock(0),
+    pendingSize(0),
+    stopping(false),
+    writeError(HostNoError)
+{
+    blockSize = std::max<size_t>(blockSize, 4096);
+    blocks[0].resize(blockSize);
+    blocks[1].resize(blockSize);
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    Close();
+}
+
+HostError AsyncFileWriter::Open(const std::string& filePath) {
+    Close();
+
+    file = fopen(filePath.c_str(), "wb");
+    if (file == nullptr)
+        return HostErrFileIO;
+
+    // Blocks are already large, stdio buffering would only add a copy
+    setvbuf(file, nullptr, _IONBF, 0);
+
+    activeBlock = 0;
+    submittedSize = 0;
+    pendingSize = 0;
+    stopping = false;
+    writeError = HostNoError;
+    setp(blocks[activeBlock].data(), blocks[activeBlock].data() + blocks[activeBlock].size());
+    writer = std::thread(&AsyncFileWriter::WriterLoop, this);
+    return HostNoError;
+}
+
+HostError AsyncFileWriter::Flush() {
+    if (file == nullptr)
+        return HostErrFileIO;
+
+    SubmitActiveBlock();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    WaitForWriter(lock);
+    if (fflush(file) != 0 && writeError == HostNoError)
+        writeError = HostErrFileIO;
+    return writeError;
+}
+
+HostError AsyncFileWriter::Close() {
+    if (file == nullptr)
+        return HostNoError;
+
+    HostError err = Flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    blockReady.notify_all();
+    writer.join();
+
+    if (fclose(file) != 0 && err == HostNoError)
+        err = HostErrFileIO;
+    file = nullptr;
+    setp(nullptr, nullptr);
+    return err;
+}
+
+AsyncFileWriter::int_type AsyncFileWriter::overflow(int_type ch) {
+    if (file == nullptr)
+        return traits_type::eof();
+
+    SubmitActiveBlock();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize AsyncFileWriter::xsputn(const char* str, std::streamsize count) {
+    if (file == nullptr)
+        return 0;
+
+    std::streamsize written = 0;
+    while (written < count) {
+        if (pptr() == epptr())
+            SubmitActiveBlock();
+
+        size_t chunk = std::min<size_t>(epptr() - pptr(), static_cast<size_t>(count - written));
+        std::memcpy(pptr(), str + written, chunk);
+        pbump(static_cast<int>(chunk));
+        written += chunk;
+    }
+    return written;
+}
+
+int AsyncFileWriter::sync() {
+    // Called for every std::endl, the data reaches the file on Flush or when a block fills up
+    return 0;
+}
+
+// Hands the filled part of the active block to the writer thread and continues in the other block
+void AsyncFileWriter::SubmitActiveBlock() {
+    size_t used = pptr() - pbase();
+    if (used == 0)
+        return;
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        WaitForWriter(lock);
+        pendingBlock = activeBlock;
+        pendingSize = used;
+    }
+    submittedSize += used;
+    blockReady.notify_one();
+
+    activeBlock ^= 1;
+    setp(blocks[activeBlock].data(), blocks[activeBlock].data() + blocks[activeBlock].size());
+}
+
+void AsyncFileWriter::WaitForWriter(std::unique_lock<std::mutex>& lock) {
+    blockWritten.wait(lock, [this] { return pendingSize == 0; });
+}
+
+void AsyncFileWriter::WriterLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        blockReady.wait(lock, [this] { return pendingSize > 0 || stopping; });
+        if (pendingSize == 0)
+            return;
+
+        const char* data = blocks[pendingBlock].data();
+        size_t size = pendingSize;
+        lock.unlock();
+        bool ok = fwrite(data, 1, size, file) == size;
+        lock.lock();
+
+        if (!ok && writeError == HostNoError)
+            writeError = HostErrFileIO;
+        pendingSize = 0;
+        blockWritten.notify_all();
+    }
+}
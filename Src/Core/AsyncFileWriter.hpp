@@ -0,0 +1,65 @@
+#ifndef ASYNC_FILE_WRITER_HPP
+#define ASYNC_FILE_WRITER_HPP
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+#include "HostTypes.hpp"
+
+// Stream buffer that writes a file on a background thread. Output is collected in one of two
+// large blocks; a full block is handed to the writer thread while the other one is filled.
+// std::endl and other stream flushes do not wait for the disk, only Flush and Close do.
+//
+// Usage: AsyncFileWriter sink; sink.Open(path); std::ostream out(&sink); ...; sink.Close();
+class AsyncFileWriter : public std::streambuf {
+public:
+    explicit AsyncFileWriter(size_t blockSize = 1 << 20);
+    ~AsyncFileWriter() override;
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    // Creates or truncates the file and starts the writer thread
+    HostError Open(const std::string& filePath);
+
+    // Returns when everything written so far is in the file
+    HostError Flush();
+
+    // Flushes, stops the writer thread and closes the file. Returns the first write error.
+    HostError Close();
+
+    bool      IsOpen() const { return file != nullptr; }
+
+    // Bytes written since Open, including those still waiting for the writer thread
+    size_t    GetWrittenSize() const { return submittedSize + (pptr() - pbase()); }
+
+protected:
+    int_type        overflow(int_type ch) override;
+    std::streamsize xsputn(const char* str, std::streamsize count) override;
+    int             sync() override;
+
+private:
+    void            SubmitActiveBlock();
+    void            WaitForWriter(std::unique_lock<std::mutex>& lock);
+    void            WriterLoop();
+
+    FILE*                   file;
+    std::vector<char>       blocks[2];
+    size_t                  activeBlock;
+    size_t                  submittedSize;      // bytes handed to the writer thread since Open
+
+    std::thread             writer;
+    std::mutex              mutex;
+    std::condition_variable blockReady;
+    std::condition_variable blockWritten;
+    size_t                  pendingBlock;       // block the writer thread owns, valid while pendingSize > 0
+    size_t                  pendingSize;
+    bool                    stopping;
+    HostError               writeError;
+};
+
+#endif // ASYNC_FILE_WRITER_HPP
@@ -0,0 +1,68 @@
+#ifndef BOUNDS_CACHE_HPP
+#define BOUNDS_CACHE_HPP
+
+#include <cstdint>
+#include <vector>
+#include "ElementHost.hpp"
+#include "GuidHashMap.hpp"
+
+// Results of IElementHost::CalcBounds by GUID, each kept with the modification stamp it was computed
+// at. A box is reused until the stamp passed in differs, so the cache survives between runs and only
+// the elements edited since are recomputed. Zone stamps are looked up with the stamp of their zone,
+// which changes whenever the stamp moves. Incremental runs invalidate the entries of deleted
+// elements, a full run drops every entry it did not look up (BeginRun, EraseUnseen).
+class BoundsCache {
+public:
+    // Starts counting which entries are looked up
+    void   BeginRun() { ++run; }
+
+    // Erases the entries not looked up since BeginRun
+    void   EraseUnseen() {
+        std::vector<HostGuid> unseen;
+        entries.ForEach([&](const HostGuid& guid, const Entry& entry) {
+            if (entry.run != run)
+                unseen.push_back(guid);
+        });
+        for (const HostGuid& guid : unseen)
+            entries.Erase(guid);
+    }
+
+    // Box of guid at modiStamp, computed by host on a miss. Stamp 0 is unknown and is never cached.
+    HostError GetBounds(IElementHost& host, const HostGuid& guid, std::uint64_t modiStamp, HostBox3D& box) {
+        Entry* entry = modiStamp != 0 ? entries.Find(guid) : nullptr;
+        if (entry != nullptr && entry->modiStamp == modiStamp) {
+            ++hitCount;
+            entry->run = run;
+            box = entry->box;
+            return entry->err;
+        }
+
+        ++missCount;
+        HostError err = host.CalcBounds(guid, box);
+        if (modiStamp != 0)
+            entries.Set(guid, Entry { modiStamp, err, box, run });
+        return err;
+    }
+
+    void   Invalidate(const HostGuid& guid) { entries.Erase(guid); }
+    void   Clear() { entries.Clear(); }
+
+    size_t GetSize() const { return entries.GetSize(); }
+    size_t GetHitCount() const { return hitCount; }
+    size_t GetMissCount() const { return missCount; }
+
+private:
+    struct Entry {
+        std::uint64_t modiStamp = 0;
+        HostError     err = HostNoError;    // failures are cached too, a failed box fails again
+        HostBox3D     box;
+        std::uint32_t run = 0;              // of the last lookup
+    };
+
+    GuidHashMap<Entry> entries;
+    std::uint32_t      run = 0;
+    size_t             hitCount = 0;
+    size_t             missCount = 0;
+};
+
+#endif // BOUNDS_CACHE_HPP
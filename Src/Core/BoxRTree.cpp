@@ -0,0 +1,248 @@
+#include "BoxRTree.hpp"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include "ThreadPool.hpp"
+
+namespace {
+
+// Queries per chunk of a batch
+const size_t QueryChunkSize = 1024;
+
+HostBox3D UnionBox(const HostBox3D& lhs, const HostBox3D& rhs) {
+    HostBox3D box;
+    box.xMin = std::min(lhs.xMin, rhs.xMin);
+    box.yMin = std::min(lhs.yMin, rhs.yMin);
+    box.zMin = std::min(lhs.zMin, rhs.zMin);
+    box.xMax = std::max(lhs.xMax, rhs.xMax);
+    box.yMax = std::max(lhs.yMax, rhs.yMax);
+    box.zMax = std::max(lhs.zMax, rhs.zMax);
+    return box;
+}
+
+bool Overlaps(const HostBox3D& lhs, const HostBox3D& rhs, double tolerance) {
+    return lhs.xMin <= rhs.xMax + tolerance && rhs.xMin <= lhs.xMax + tolerance &&
+           lhs.yMin <= rhs.yMax + tolerance && rhs.yMin <= lhs.yMax + tolerance &&
+           lhs.zMin <= rhs.zMax + tolerance && rhs.zMin <= lhs.zMax + tolerance;
+}
+
+double AxisGap(double lhsMin, double lhsMax, double rhsMin, double rhsMax) {
+    return std::max(0.0, std::max(lhsMin - rhsMax, rhsMin - lhsMax));
+}
+
+double DistanceSquared(const HostBox3D& lhs, const HostBox3D& rhs) {
+    double dx = AxisGap(lhs.xMin, lhs.xMax, rhs.xMin, rhs.xMax);
+    double dy = AxisGap(lhs.yMin, lhs.yMax, rhs.yMin, rhs.yMax);
+    double dz = AxisGap(lhs.zMin, lhs.zMax, rhs.zMin, rhs.zMax);
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Sort-Tile-Recursive order of entries: x slabs of S * S pages, y runs of S pages, z order inside a run,
+// where S is the cube root of the page count. Consecutive groups of NodeCapacity then form the nodes.
+// key breaks ties so the order only depends on the input.
+template <typename Entry, typename GetBox, typename GetKey>
+void SortTileRecursive(std::vector<Entry>& entries, GetBox getBox, GetKey getKey) {
+    auto byAxis = [&](int axis) {
+        return [&, axis](const Entry& lhs, const Entry& rhs) {
+            const HostBox3D& a = getBox(lhs);
+            const HostBox3D& b = getBox(rhs);
+            double ca = axis == 0 ? a.xMin + a.xMax : axis == 1 ? a.yMin + a.yMax : a.zMin + a.zMax;
+            double cb = axis == 0 ? b.xMin + b.xMax : axis == 1 ? b.yMin + b.yMax : b.zMin + b.zMax;
+            return ca != cb ? ca < cb : getKey(lhs) < getKey(rhs);
+        };
+    };
+
+    size_t pageCount = (entries.size() + BoxRTree::NodeCapacity - 1) / BoxRTree::NodeCapacity;
+    size_t sliceCount = static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(pageCount))));
+    size_t runSize = sliceCount * BoxRTree::NodeCapacity;
+    size_t slabSize = sliceCount * runSize;
+
+    std::sort(entries.begin(), entries.end(), byAxis(0));
+    for (size_t slab = 0; slab < entries.size(); slab += slabSize) {
+        auto slabEnd = entries.begin() + std::min(slab + slabSize, entries.size());
+        std::sort(entries.begin() + slab, slabEnd, byAxis(1));
+        for (size_t run = slab; run < static_cast<size_t>(slabEnd - entries.begin()); run += runSize) {
+            auto runEnd = entries.begin() + std::min(run + runSize, entries.size());
+            std::sort(entries.begin() + run, runEnd, byAxis(2));
+        }
+    }
+}
+
+// Runs query(begin, end, pairs) over chunks of [0, count) and concatenates the chunk results in order
+template <typename Query>
+void RunBatch(size_t count, size_t threadCount, std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs, Query query) {
+    size_t chunkCount = (count + QueryChunkSize - 1) / QueryChunkSize;
+    std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> chunkPairs(chunkCount);
+    auto runChunk = [&](size_t chunkIndex, size_t begin, size_t end) {
+        query(begin, end, chunkPairs[chunkIndex]);
+    };
+
+    if (threadCount == 0)
+        threadCount = ThreadPool::GetHardwareThreadCount();
+    threadCount = std::min(threadCount, chunkCount);
+    if (threadCount <= 1) {
+        for (size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+            runChunk(chunkIndex, chunkIndex * QueryChunkSize, std::min((chunkIndex + 1) * QueryChunkSize, count));
+    }
+    else {
+        // The waiting thread works too, so one less background worker
+        ThreadPool pool(threadCount - 1);
+        ParallelForChunks(pool, count, QueryChunkSize, runChunk);
+    }
+
+    for (const auto& chunk : chunkPairs)
+        pairs.insert(pairs.end(), chunk.begin(), chunk.end());
+}
+
+}
+
+void BoxRTree::Build(std::vector<RTreeItem> newItems) {
+    items = std::move(newItems);
+    nodes.clear();
+    if (items.empty())
+        return;
+
+    SortTileRecursive(items, [](const RTreeItem& item) -> const HostBox3D& { return item.box; },
+        [](const RTreeItem& item) { return item.id; });
+    for (size_t begin = 0; begin < items.size(); begin += NodeCapacity) {
+        Node leaf;
+        leaf.first = static_cast<std::uint32_t>(begin);
+        leaf.count = static_cast<std::uint32_t>(std::min(NodeCapacity, items.size() - begin));
+        leaf.isLeaf = true;
+        leaf.box = items[begin].box;
+        for (size_t i = begin + 1; i < begin + leaf.count; ++i)
+            leaf.box = UnionBox(leaf.box, items[i].box);
+        nodes.push_back(leaf);
+    }
+
+    // Pack each level into the next until one root is left. Reordering a level is safe,
+    // its nodes only point into the level below.
+    size_t levelBegin = 0;
+    size_t levelEnd = nodes.size();
+    while (levelEnd - levelBegin > 1) {
+        std::vector<Node> level(nodes.begin() + levelBegin, nodes.begin() + levelEnd);
+        SortTileRecursive(level, [](const Node& node) -> const HostBox3D& { return node.box; },
+            [](const Node& node) { return node.first; });
+        std::copy(level.begin(), level.end(), nodes.begin() + levelBegin);
+
+        for (size_t begin = levelBegin; begin < levelEnd; begin += NodeCapacity) {
+            Node parent;
+            parent.first = static_cast<std::uint32_t>(begin);
+            parent.count = static_cast<std::uint32_t>(std::min(NodeCapacity, levelEnd - begin));
+            parent.box = nodes[begin].box;
+            for (size_t i = begin + 1; i < begin + parent.count; ++i)
+                parent.box = UnionBox(parent.box, nodes[i].box);
+            nodes.push_back(parent);
+        }
+        levelBegin = levelEnd;
+        levelEnd = nodes.size();
+    }
+}
+
+void BoxRTree::Clear() {
+    items.clear();
+    nodes.clear();
+}
+
+void BoxRTree::QueryOverlap(const HostBox3D& box, double tolerance, std::vector<std::uint32_t>& ids) const {
+    if (nodes.empty())
+        return;
+
+    // A tree of 2^32 items is 8 levels deep, each level leaves at most NodeCapacity - 1 siblings waiting
+    std::uint32_t stack[8 * NodeCapacity];
+    size_t stackSize = 0;
+    stack[stackSize++] = static_cast<std::uint32_t>(nodes.size() - 1);
+    while (stackSize > 0) {
+        const Node& node = nodes[stack[--stackSize]];
+        if (!Overlaps(node.box, box, tolerance))
+            continue;
+
+        if (node.isLeaf) {
+            for (std::uint32_t i = node.first; i < node.first + node.count; ++i) {
+                if (Overlaps(items[i].box, box, tolerance))
+                    ids.push_back(items[i].id);
+            }
+        }
+        else {
+            for (std::uint32_t i = node.first; i < node.first + node.count; ++i)
+                stack[stackSize++] = i;
+        }
+    }
+}
+
+void BoxRTree::QueryNearest(const HostBox3D& box, size_t k, double maxDistance, std::vector<std::uint32_t>& ids) const {
+    if (nodes.empty() || k == 0)
+        return;
+
+    // Best first: at equal distance nodes come before items, so an item is only taken when every
+    // item at the same distance is already queued, and those come out in id order
+    struct Candidate {
+        double        distance;
+        bool          isItem;
+        std::uint32_t index;
+        std::uint32_t id;
+    };
+    auto farther = [](const Candidate& lhs, const Candidate& rhs) {
+        if (lhs.distance != rhs.distance)
+            return lhs.distance > rhs.distance;
+        if (lhs.isItem != rhs.isItem)
+            return lhs.isItem;
+        return lhs.id > rhs.id;
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(farther)> queue(farther);
+
+    double maxDistanceSquared = maxDistance * maxDistance;
+    std::uint32_t root = static_cast<std::uint32_t>(nodes.size() - 1);
+    queue.push({ DistanceSquared(nodes[root].box, box), false, root, 0 });
+    size_t found = 0;
+    while (!queue.empty() && found < k) {
+        Candidate candidate = queue.top();
+        queue.pop();
+        if (candidate.distance > maxDistanceSquared)
+            break;
+
+        if (candidate.isItem) {
+            ids.push_back(candidate.id);
+            ++found;
+            continue;
+        }
+
+        const Node& node = nodes[candidate.index];
+        for (std::uint32_t i = node.first; i < node.first + node.count; ++i) {
+            const HostBox3D& childBox = node.isLeaf ? items[i].box : nodes[i].box;
+            double distance = DistanceSquared(childBox, box);
+            if (distance <= maxDistanceSquared)
+                queue.push({ distance, node.isLeaf, i, node.isLeaf ? items[i].id : i });
+        }
+    }
+}
+
+void QueryOverlapBatch(const BoxRTree& tree, const std::vector<RTreeItem>& queries, double tolerance,
+    size_t threadCount, std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs)
+{
+    RunBatch(queries.size(), threadCount, pairs, [&](size_t begin, size_t end, std::vector<std::pair<std::uint32_t, std::uint32_t>>& chunkPairs) {
+        std::vector<std::uint32_t> ids;
+        for (size_t i = begin; i < end; ++i) {
+            ids.clear();
+            tree.QueryOverlap(queries[i].box, tolerance, ids);
+            // Tree order is spatial, sort so the pairs of a query do not depend on the packing
+            std::sort(ids.begin(), ids.end());
+            for (std::uint32_t id : ids)
+                chunkPairs.emplace_back(queries[i].id, id);
+        }
+    });
+}
+
+void QueryNearestBatch(const BoxRTree& tree, const std::vector<RTreeItem>& queries, size_t k, double maxDistance,
+    size_t threadCount, std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs)
+{
+    RunBatch(queries.size(), threadCount, pairs, [&](size_t begin, size_t end, std::vector<std::pair<std::uint32_t, std::uint32_t>>& chunkPairs) {
+        std::vector<std::uint32_t> ids;
+        for (size_t i = begin; i < end; ++i) {
+            ids.clear();
+            tree.QueryNearest(queries[i].box, k, maxDistance, ids);
+            for (std::uint32_t id : ids)
+                chunkPairs.emplace_back(queries[i].id, id);
+        }
+    });
+}
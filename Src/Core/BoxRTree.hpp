@@ -0,0 +1,54 @@
+#ifndef BOX_RTREE_HPP
+#define BOX_RTREE_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "HostTypes.hpp"
+
+// A box with the caller's id, the unit of the R-tree
+struct RTreeItem {
+    HostBox3D     box;
+    std::uint32_t id = 0;
+};
+
+// Static R-tree over bounding boxes, bulk-loaded with Sort-Tile-Recursive packing: every level is
+// sorted into x slabs, y runs and z order before it is cut into full nodes, so nodes are compact
+// and the tree has no empty slots. Build it once from all boxes, it cannot be updated.
+class BoxRTree {
+public:
+    static constexpr size_t NodeCapacity = 16;
+
+    void   Build(std::vector<RTreeItem> items);
+    void   Clear();
+
+    size_t GetSize() const { return items.size(); }
+    bool   IsEmpty() const { return items.empty(); }
+
+    // Appends the ids of the items whose box overlaps box grown by tolerance on every side
+    void   QueryOverlap(const HostBox3D& box, double tolerance, std::vector<std::uint32_t>& ids) const;
+
+    // Appends the ids of the k items closest to box (box to box distance, 0 if they overlap) that are
+    // at most maxDistance away, nearest first. Equal distances are ordered by id.
+    void   QueryNearest(const HostBox3D& box, size_t k, double maxDistance, std::vector<std::uint32_t>& ids) const;
+
+private:
+    struct Node {
+        HostBox3D     box;
+        std::uint32_t first = 0;    // first child node, or first item of a leaf
+        std::uint32_t count = 0;
+        bool          isLeaf = false;
+    };
+
+    std::vector<RTreeItem> items;   // in leaf order
+    std::vector<Node>      nodes;   // leaves first, then each upper level, the root is last
+};
+
+// Batched queries, one (query id, item id) pair per hit, in query order. The queries are split into
+// chunks run on threadCount threads (0 uses every hardware thread); the result does not depend on it.
+void QueryOverlapBatch(const BoxRTree& tree, const std::vector<RTreeItem>& queries, double tolerance,
+    size_t threadCount, std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs);
+void QueryNearestBatch(const BoxRTree& tree, const std::vector<RTreeItem>& queries, size_t k, double maxDistance,
+    size_t threadCount, std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs);
+
+#endif // BOX_RTREE_HPP
@@ -0,0 +1,332 @@
+#include "ColumnarReport.hpp"
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace {
+
+const char          ColumnarMagic[8] = { 'E', 'X', 'V', '2', 'C', 'O', 'L', 'S' };
+const std::uint32_t ColumnarVersion = 1;
+
+// Section and column order is part of the file format, append only
+enum SectionIndex { WallSection, SlabSection, ZoneSection, DoorSection, DoorLabelSection, DimensionSection, DimNodeSection, SectionCount };
+
+enum WallColumns { WallGuid, WallBounds, WallLength, WallWidth, WallHeight, WallLabelType, WallInfo };
+enum SlabColumns { SlabGuid, SlabBounds, SlabLabelType, SlabInfo };
+enum ZoneColumns { ZoneGuid, ZoneBounds, ZoneStampGuid, ZoneStampBounds, ZonePosition, ZoneRoomHeight, ZoneRoomName, ZoneRoomNumber, ZoneLabelType, ZoneInfo };
+enum DoorColumns { DoorGuid, DoorBounds, DoorWidth, DoorHeight, DoorMarkerGuid, DoorWallGuid, DoorLabelType, DoorInfo };
+enum DoorLabelColumns { DoorLabelGuid, DoorLabelDoorGuid, DoorLabelBounds };
+enum DimensionColumns { DimensionGuid, DimensionBounds, DimensionLength, DimensionIndex };
+enum DimNodeColumns { DimNodeIndex, DimNodeDimensionGuid, DimNodeAssociatedGuid, DimNodeAssociatedType, DimNodeBounds, DimNodePosition, DimNodeLength, DimNodeNotePosition, DimNodeNoteBounds, DimNodeText };
+
+void WriteRaw(std::ofstream& outFile, const void* data, size_t size) {
+    outFile.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+}
+
+template <typename T>
+void WriteValue(std::ofstream& outFile, T value) {
+    WriteRaw(outFile, &value, sizeof(T));
+}
+
+void WriteName(std::ofstream& outFile, const std::string& name) {
+    WriteValue(outFile, static_cast<std::uint16_t>(name.size()));
+    WriteRaw(outFile, name.data(), name.size());
+}
+
+std::uint64_t AlignUp(std::uint64_t offset) {
+    return (offset + 7) & ~std::uint64_t(7);
+}
+
+}
+
+ColumnarSection::ColumnarSection(const char* name) :
+    name(name),
+    rowCount(0)
+{
+}
+
+size_t ColumnarSection::AddColumn(const char* columnName, ColumnType type, std::uint8_t width) {
+    Column column;
+    column.name = columnName;
+    column.type = type;
+    column.width = width;
+    if (type == ColumnType::String)
+        column.stringOffsets.push_back(0);
+    columns.push_back(column);
+    return columns.size() - 1;
+}
+
+void ColumnarSection::Append(size_t column, const void* bytes, size_t size) {
+    std::vector<std::uint8_t>& data = columns[column].data;
+    const std::uint8_t* begin = static_cast<const std::uint8_t*>(bytes);
+    data.insert(data.end(), begin, begin + size);
+}
+
+void ColumnarSection::PutGuid(size_t column, const HostGuid& guid) {
+    std::uint8_t bytes[16];
+    HostGuidToBytes(guid, bytes);
+    Append(column, bytes, sizeof(bytes));
+}
+
+void ColumnarSection::PutFloat64(size_t column, const double* values) {
+    Append(column, values, columns[column].width * sizeof(double));
+}
+
+void ColumnarSection::PutBox(size_t column, const HostBox3D* box) {
+    double values[6];
+    if (box != nullptr) {
+        const double boxValues[6] = { box->xMin, box->yMin, box->zMin, box->xMax, box->yMax, box->zMax };
+        memcpy(values, boxValues, sizeof(values));
+    }
+    else {
+        for (double& value : values)
+            value = std::numeric_limits<double>::quiet_NaN();
+    }
+    Append(column, values, sizeof(values));
+}
+
+void ColumnarSection::PutUInt8(size_t column, std::uint8_t value) {
+    Append(column, &value, sizeof(value));
+}
+
+void ColumnarSection::PutInt32(size_t column, std::int32_t value) {
+    Append(column, &value, sizeof(value));
+}
+
+void ColumnarSection::PutString(size_t column, const std::string& value) {
+    Append(column, value.data(), value.size());
+    columns[column].stringOffsets.push_back(columns[column].data.size());
+}
+
+void ColumnarSection::Clear() {
+    rowCount = 0;
+    for (Column& column : columns) {
+        column.data.clear();
+        if (column.type == ColumnType::String)
+            column.stringOffsets.assign(1, 0);
+    }
+}
+
+ColumnarReportWriter::ColumnarReportWriter() {
+    sections.reserve(SectionCount);
+
+    ColumnarSection wall("Wall");
+    wall.AddColumn("guid", ColumnType::Guid);
+    wall.AddColumn("bounds", ColumnType::Float64, 6);
+    wall.AddColumn("length", ColumnType::Float64);
+    wall.AddColumn("width", ColumnType::Float64);
+    wall.AddColumn("height", ColumnType::Float64);
+    wall.AddColumn("labelType", ColumnType::UInt8);
+    wall.AddColumn("infoString", ColumnType::String);
+    sections.push_back(wall);
+
+    ColumnarSection slab("Slab");
+    slab.AddColumn("guid", ColumnType::Guid);
+    slab.AddColumn("bounds", ColumnType::Float64, 6);
+    slab.AddColumn("labelType", ColumnType::UInt8);
+    slab.AddColumn("infoString", ColumnType::String);
+    sections.push_back(slab);
+
+    ColumnarSection zone("Zone");
+    zone.AddColumn("guid", ColumnType::Guid);
+    zone.AddColumn("bounds", ColumnType::Float64, 6);
+    zone.AddColumn("stampGuid", ColumnType::Guid);
+    zone.AddColumn("stampBounds", ColumnType::Float64, 6);
+    zone.AddColumn("position", ColumnType::Float64, 2);
+    zone.AddColumn("roomHeight", ColumnType::Float64);
+    zone.AddColumn("roomName", ColumnType::String);
+    zone.AddColumn("roomNumber", ColumnType::String);
+    zone.AddColumn("labelType", ColumnType::UInt8);
+    zone.AddColumn("infoString", ColumnType::String);
+    sections.push_back(zone);
+
+    ColumnarSection door("Door");
+    door.AddColumn("guid", ColumnType::Guid);
+    door.AddColumn("bounds", ColumnType::Float64, 6);
+    door.AddColumn("width", ColumnType::Float64);
+    door.AddColumn("height", ColumnType::Float64);
+    door.AddColumn("markerGuid", ColumnType::Guid);
+    door.AddColumn("wallGuid", ColumnType::Guid);
+    door.AddColumn("labelType", ColumnType::UInt8);
+    door.AddColumn("infoString", ColumnType::String);
+    sections.push_back(door);
+
+    ColumnarSection doorLabel("DoorLabel");
+    doorLabel.AddColumn("guid", ColumnType::Guid);
+    doorLabel.AddColumn("doorGuid", ColumnType::Guid);
+    doorLabel.AddColumn("bounds", ColumnType::Float64, 6);
+    sections.push_back(doorLabel);
+
+    ColumnarSection dimension("Dimension");
+    dimension.AddColumn("guid", ColumnType::Guid);
+    dimension.AddColumn("bounds", ColumnType::Float64, 6);
+    dimension.AddColumn("length", ColumnType::Float64);
+    dimension.AddColumn("index", ColumnType::Int32);
+    sections.push_back(dimension);
+
+    ColumnarSection dimNode("DimNode");
+    dimNode.AddColumn("index", ColumnType::Int32);
+    dimNode.AddColumn("dimensionGuid", ColumnType::Guid);
+    dimNode.AddColumn("associatedGuid", ColumnType::Guid);
+    dimNode.AddColumn("associatedType", ColumnType::UInt8);
+    dimNode.AddColumn("bounds", ColumnType::Float64, 6);
+    dimNode.AddColumn("position", ColumnType::Float64, 2);
+    dimNode.AddColumn("length", ColumnType::Float64);
+    dimNode.AddColumn("notePosition", ColumnType::Float64, 2);
+    dimNode.AddColumn("noteBounds", ColumnType::Float64, 6);
+    dimNode.AddColumn("text", ColumnType::String);
+    sections.push_back(dimNode);
+}
+
+void ColumnarReportWriter::AddElement(const ElementReport& report) {
+    const HostBox3D* bounds = report.hasBounds ? &report.bounds : nullptr;
+    const std::uint8_t labelType = static_cast<std::uint8_t>(report.labelType);
+    const std::string infoString = report.hasInfoString ? report.infoString : std::string();
+
+    switch (report.type) {
+    case HostElemType::Wall: {
+        ColumnarSection& wall = sections[WallSection];
+        wall.PutGuid(WallGuid, report.guid);
+        wall.PutBox(WallBounds, bounds);
+        wall.PutFloat64(WallLength, report.wallLength);
+        wall.PutFloat64(WallWidth, report.wallThickness);
+        wall.PutFloat64(WallHeight, report.wallHeight);
+        wall.PutUInt8(WallLabelType, labelType);
+        wall.PutString(WallInfo, infoString);
+        wall.EndRow();
+        break;
+    }
+    case HostElemType::Slab: {
+        ColumnarSection& slab = sections[SlabSection];
+        slab.PutGuid(SlabGuid, report.guid);
+        slab.PutBox(SlabBounds, bounds);
+        slab.PutUInt8(SlabLabelType, labelType);
+        slab.PutString(SlabInfo, infoString);
+        slab.EndRow();
+        break;
+    }
+    case HostElemType::Zone: {
+        ColumnarSection& zone = sections[ZoneSection];
+        const double position[2] = { report.pos.x, report.pos.y };
+        zone.PutGuid(ZoneGuid, report.guid);
+        zone.PutBox(ZoneBounds, bounds);
+        zone.PutGuid(ZoneStampGuid, report.stampGuid);
+        zone.PutBox(ZoneStampBounds, report.hasStampBounds ? &report.stampBounds : nullptr);
+        zone.PutFloat64(ZonePosition, position);
+        zone.PutFloat64(ZoneRoomHeight, report.roomHeight);
+        zone.PutString(ZoneRoomName, report.roomName);
+        zone.PutString(ZoneRoomNumber, report.roomNoStr);
+        zone.PutUInt8(ZoneLabelType, labelType);
+        zone.PutString(ZoneInfo, infoString);
+        zone.EndRow();
+        break;
+    }
+    case HostElemType::Door: {
+        ColumnarSection& door = sections[DoorSection];
+        door.PutGuid(DoorGuid, report.guid);
+        door.PutBox(DoorBounds, bounds);
+        door.PutFloat64(DoorWidth, report.width);
+        door.PutFloat64(DoorHeight, report.height);
+        door.PutGuid(DoorMarkerGuid, report.markGuid);
+        door.PutGuid(DoorWallGuid, report.hasWall ? report.wallGuid : HostNullGuid);
+        door.PutUInt8(DoorLabelType, labelType);
+        door.PutString(DoorInfo, infoString);
+        door.EndRow();
+
+        ColumnarSection& doorLabel = sections[DoorLabelSection];
+        for (const LabelReport& label : report.labels) {
+            doorLabel.PutGuid(DoorLabelGuid, label.guid);
+            doorLabel.PutGuid(DoorLabelDoorGuid, report.guid);
+            doorLabel.PutBox(DoorLabelBounds, label.hasBounds ? &label.bounds : nullptr);
+            doorLabel.EndRow();
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void ColumnarReportWriter::AddDimension(const DimensionReport& report) {
+    if (!report.hasMemo)
+        return;
+
+    ColumnarSection& dimNode = sections[DimNodeSection];
+    for (const DimNodeReport& node : report.nodes) {
+        const double bounds[6] = { node.bounds[0], node.bounds[1], node.bounds[2], node.bounds[3], node.bounds[4], node.bounds[5] };
+        const double position[2] = { node.dimElem.pos.x, node.dimElem.pos.y };
+        const double notePosition[2] = { node.dimElem.notePos.x, node.dimElem.notePos.y };
+        dimNode.PutInt32(DimNodeIndex, node.index);
+        dimNode.PutGuid(DimNodeDimensionGuid, report.guid);
+        dimNode.PutGuid(DimNodeAssociatedGuid, node.dimElem.baseGuid);
+        dimNode.PutUInt8(DimNodeAssociatedType, static_cast<std::uint8_t>(node.dimElem.baseType));
+        dimNode.PutFloat64(DimNodeBounds, bounds);
+        dimNode.PutFloat64(DimNodePosition, position);
+        dimNode.PutFloat64(DimNodeLength, node.dimElem.dimVal);
+        dimNode.PutFloat64(DimNodeNotePosition, notePosition);
+        dimNode.PutBox(DimNodeNoteBounds, &node.noteBounds);
+        dimNode.PutString(DimNodeText, node.dimElem.noteText);
+        dimNode.EndRow();
+    }
+
+    ColumnarSection& dimension = sections[DimensionSection];
+    dimension.PutGuid(DimensionGuid, report.guid);
+    dimension.PutBox(DimensionBounds, report.hasBounds ? &report.bounds : nullptr);
+    dimension.PutFloat64(DimensionLength, report.totalLength);
+    dimension.PutInt32(DimensionIndex, report.hasBounds ? report.index : -1);
+    dimension.EndRow();
+}
+
+void ColumnarReportWriter::Clear() {
+    for (ColumnarSection& section : sections)
+        section.Clear();
+}
+
+HostError ColumnarReportWriter::Write(const std::string& filePath) const {
+    std::ofstream outFile(filePath, std::ios::binary);
+    if (!outFile.is_open())
+        return HostErrFileIO;
+
+    // Size the schema first so the column offsets can be written in one pass
+    std::uint64_t schemaSize = sizeof(ColumnarMagic) + 2 * sizeof(std::uint32_t);
+    for (const ColumnarSection& section : sections) {
+        schemaSize += sizeof(std::uint16_t) + section.name.size() + sizeof(std::uint64_t) + sizeof(std::uint16_t);
+        for (const ColumnarSection::Column& column : section.columns)
+            schemaSize += sizeof(std::uint16_t) + column.name.size() + 2 * sizeof(std::uint8_t) + 2 * sizeof(std::uint64_t);
+    }
+
+    WriteRaw(outFile, ColumnarMagic, sizeof(ColumnarMagic));
+    WriteValue(outFile, ColumnarVersion);
+    WriteValue(outFile, static_cast<std::uint32_t>(sections.size()));
+
+    std::uint64_t offset = AlignUp(schemaSize);
+    for (const ColumnarSection& section : sections) {
+        WriteName(outFile, section.name);
+        WriteValue(outFile, section.rowCount);
+        WriteValue(outFile, static_cast<std::uint16_t>(section.columns.size()));
+        for (const ColumnarSection::Column& column : section.columns) {
+            std::uint64_t size = column.data.size() + column.stringOffsets.size() * sizeof(std::uint64_t);
+            WriteName(outFile, column.name);
+            WriteValue(outFile, static_cast<std::uint8_t>(column.type));
+            WriteValue(outFile, column.width);
+            WriteValue(outFile, offset);
+            WriteValue(outFile, size);
+            offset = AlignUp(offset + size);
+        }
+    }
+
+    const char padding[8] = {};
+    std::uint64_t written = schemaSize;
+    for (const ColumnarSection& section : sections) {
+        for (const ColumnarSection::Column& column : section.columns) {
+            WriteRaw(outFile, padding, AlignUp(written) - written);
+            written = AlignUp(written);
+            if (!column.stringOffsets.empty())
+                WriteRaw(outFile, column.stringOffsets.data(), column.stringOffsets.size() * sizeof(std::uint64_t));
+            WriteRaw(outFile, column.data.data(), column.data.size());
+            written += column.data.size() + column.stringOffsets.size() * sizeof(std::uint64_t);
+        }
+    }
+
+    return outFile.good() ? HostNoError : HostErrFileIO;
+}
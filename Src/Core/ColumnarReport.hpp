@@ -0,0 +1,86 @@
+#ifndef COLUMNAR_REPORT_HPP
+#define COLUMNAR_REPORT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ElementReport.hpp"
+
+// Binary columnar alternative to the "Key: Value" text report, read directly by the GNN preprocessing.
+//
+// Layout (little-endian):
+//   char[8]  magic "EXV2COLS"
+//   uint32   version
+//   uint32   sectionCount
+//   schema, for each section:
+//     uint16 nameLength, char name[nameLength]
+//     uint64 rowCount
+//     uint16 columnCount
+//     for each column:
+//       uint16 nameLength, char name[nameLength]
+//       uint8  type (ColumnType), uint8 width (values per row)
+//       uint64 offset (from file start, 8 byte aligned), uint64 size (bytes)
+//   column blocks
+//
+// Column blocks hold rowCount * width values back to back. GUIDs are 16 raw bytes in string order,
+// missing bounding boxes are NaN. String blocks start with uint64 offsets[rowCount + 1] into the
+// UTF-8 bytes that follow them.
+
+enum class ColumnType : std::uint8_t {
+    Guid    = 1,
+    Float64 = 2,
+    UInt8   = 3,
+    Int32   = 4,
+    String  = 5
+};
+
+class ColumnarSection {
+public:
+    explicit ColumnarSection(const char* name);
+
+    size_t AddColumn(const char* columnName, ColumnType type, std::uint8_t width = 1);
+
+    void PutGuid(size_t column, const HostGuid& guid);
+    void PutFloat64(size_t column, const double* values);
+    void PutFloat64(size_t column, double value) { PutFloat64(column, &value); }
+    void PutBox(size_t column, const HostBox3D* box);   // nullptr writes NaN
+    void PutUInt8(size_t column, std::uint8_t value);
+    void PutInt32(size_t column, std::int32_t value);
+    void PutString(size_t column, const std::string& value);
+    void EndRow() { ++rowCount; }
+
+    void Clear();
+
+private:
+    struct Column {
+        std::string                 name;
+        ColumnType                  type;
+        std::uint8_t                width;
+        std::vector<std::uint8_t>   data;
+        std::vector<std::uint64_t>  stringOffsets;
+    };
+
+    void Append(size_t column, const void* bytes, size_t size);
+
+    std::string         name;
+    std::uint64_t       rowCount;
+    std::vector<Column> columns;
+
+    friend class ColumnarReportWriter;
+};
+
+class ColumnarReportWriter {
+public:
+    ColumnarReportWriter();
+
+    void AddElement(const ElementReport& report);
+    void AddDimension(const DimensionReport& report);
+
+    void      Clear();
+    HostError Write(const std::string& filePath) const;
+
+private:
+    std::vector<ColumnarSection> sections;
+};
+
+#endif // COLUMNAR_REPORT_HPP
@@ -0,0 +1,30 @@
+#ifndef ELEMENT_CHANGE_TRACKER_HPP
+#define ELEMENT_CHANGE_TRACKER_HPP
+
+#include "GuidHashMap.hpp"
+#include "HostTypes.hpp"
+
+// Elements created, modified or deleted since the last extraction run. Filled from the Archicad
+// element notifications (StartElementObserver) or by MemoryElementHost when it changes its model.
+class ElementChangeTracker {
+public:
+    // A GUID stays dirty until Clear, whatever happens to it in between
+    void   MarkDirty(const HostGuid& guid, HostElemType type) {
+        HostElemType& dirtyType = dirty[guid];
+        if (type != HostElemType::Unknown)
+            dirtyType = type;
+    }
+
+    void   Clear() { dirty.Clear(); }
+    bool   IsEmpty() const { return dirty.IsEmpty(); }
+    size_t GetSize() const { return dirty.GetSize(); }
+
+    // Calls fn(guid, type) for every dirty element
+    template <typename Fn>
+    void   ForEach(Fn&& fn) const { dirty.ForEach(fn); }
+
+private:
+    GuidHashMap<HostElemType> dirty;
+};
+
+#endif // ELEMENT_CHANGE_TRACKER_HPP
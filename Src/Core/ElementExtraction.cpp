@@ -0,0 +1,565 @@
+#include "ElementExtraction.hpp"
+#include <cmath>
+#include <string>
+#include <vector>
+#include "AsyncFileWriter.hpp"
+#include "ReportFormat.hpp"
+
+// Function to process building elements
+void ProcessBuildingElements(IElementHost& host, ExtractionSession& session, const ExtractionOutput& output) {
+    ProfileScope scope(session.profiler, ProfileCounter::ProcessBuildingElements);
+    TraceScope traceScope(session.trace, "ProcessBuildingElements", "extract");
+    session.Reset();
+    session.boundsCache.BeginRun();
+    if (output.snapshot != nullptr)
+        output.snapshot->Clear();
+
+    // Fetch every list up front so the GUID maps can be sized before the first insert
+    HostElemType elementTypes[] = { HostElemType::Wall, HostElemType::Slab, HostElemType::Zone, HostElemType::Door };
+    std::vector<HostGuid> dimensionList;
+    std::vector<HostGuid> elementLists[4];
+
+    if (host.GetElemList(HostElemType::Dimension, dimensionList) != HostNoError)
+        dimensionList.clear();
+    for (size_t i = 0; i < 4; ++i) {
+        if (host.GetElemList(elementTypes[i], elementLists[i]) != HostNoError)
+            elementLists[i].clear();
+    }
+
+    // Every door sits in at most one wall, only walls can be dimensioned
+    session.doorToWallMap.Reserve(elementLists[3].size());
+    session.wallHasDimElems.Reserve(elementLists[0].size());
+
+    // Process dimension elements first to populate wallHasDimElems
+    {
+        TraceScope loopScope(session.trace, "Dimension", "extract");
+        for (const HostGuid& elementGuid : dimensionList) {
+            ReportDimensionElementProperties(host, session, elementGuid, HostElemType::Dimension, output);
+        }
+    }
+
+    // Now, process all other element types, ensuring walls are processed after dimension elements
+    for (size_t i = 0; i < 4; ++i) {
+        TraceScope loopScope(session.trace, HostElemTypeToString(elementTypes[i]), "extract");
+        for (const HostGuid& elementGuid : elementLists[i]) {
+            ReportElementProperties(host, session, elementGuid, elementTypes[i], output);
+        }
+    }
+
+    // Boxes of elements deleted since an earlier run
+    session.boundsCache.EraseUnseen();
+}
+
+// Profiler phase of one ReportElementProperties branch
+static ProfileCounter ReportCounterOf(HostElemType elemType) {
+    switch (elemType) {
+    case HostElemType::Wall:    return ProfileCounter::ReportWall;
+    case HostElemType::Slab:    return ProfileCounter::ReportSlab;
+    case HostElemType::Zone:    return ProfileCounter::ReportZone;
+    case HostElemType::Door:    return ProfileCounter::ReportDoor;
+    default:                    return ProfileCounter::ReportDimension;
+    }
+}
+
+void ReportElementProperties(IElementHost& host, ExtractionSession& session, const HostGuid& elementGuid, HostElemType elemType, const ExtractionOutput& output)
+{
+    ProfileScope scope(session.profiler, ReportCounterOf(elemType));
+    ElementReport report;
+    if (!CollectElementReport(host, session, elementGuid, elemType, report))
+        return;
+
+    if (output.textReport != nullptr)
+        WriteElementReport(*output.textReport, report);
+    if (output.columnarReport != nullptr)
+        output.columnarReport->AddElement(report);
+    if (output.snapshot != nullptr)
+        output.snapshot->SetElement(report);
+}
+
+bool CollectElementReport(IElementHost& host, ExtractionSession& session, const HostGuid& elementGuid, HostElemType elemType, ElementReport& report)
+{
+    HostElement element;
+
+    // Retrieve the element
+    if (session.records.GetElement(host, elementGuid, element) != HostNoError)
+        return false;
+
+    report.guid = elementGuid;
+    report.type = elemType;
+    report.modiStamp = element.modiStamp;
+    report.hasTypeName = session.records.GetElemTypeName(host, elemType, report.typeName) == HostNoError;
+
+    // Handle Zone type specifically
+    if (elemType == HostElemType::Zone) {
+        HostZoneData& zone = element.zone;
+        report.stampGuid = zone.stampGuid;
+        report.pos = zone.pos;
+        report.roomName = zone.roomName;
+        report.roomNoStr = zone.roomNoStr;
+        report.roomHeight = zone.roomHeight;
+
+        // Retrieve the bounding box for the zone stamp
+        if (session.boundsCache.GetBounds(host, zone.stampGuid, element.modiStamp, report.stampBounds) == HostNoError) {
+            report.hasStampBounds = true;
+            ZoneStampInfo info = { zone.stampGuid, report.stampBounds };
+            session.zoneStampInfos.PushBack(info);
+        }
+    }
+
+    else if (elemType == HostElemType::Door) {
+        // Handle Door elements
+        HostDoorData& door = element.door;
+        report.width = door.width;
+        report.height = door.height;
+        report.markGuid = door.markGuid;
+
+        // Retrieve connected labels for the door
+        std::vector<HostGuid> connectedLabels;
+        if (session.records.GetConnectedLabels(host, elementGuid, connectedLabels) == HostNoError) {
+            for (const HostGuid& labelGuid : connectedLabels) {
+                // Retrieve label element data
+                HostElement labelElement;
+                if (session.records.GetElement(host, labelGuid, labelElement) == HostNoError) {
+                    LabelReport label;
+                    label.guid = labelGuid;
+                    label.modiStamp = labelElement.modiStamp;
+                    // Get bounding box for the label
+                    if (session.boundsCache.GetBounds(host, labelGuid, labelElement.modiStamp, label.bounds) == HostNoError) {
+                        label.hasBounds = true;
+                        // Capturing door label info within the existing label processing loop
+                        DoorLabelInfo info = { labelGuid, label.bounds };
+                        session.doorLabelInfos.PushBack(info);
+                    }
+                    report.labels.push_back(label);
+                }
+            }
+        }
+
+        // Include the wall GUID if the door is embedded in a wall
+        if (const HostGuid* wallGuid = session.doorToWallMap.Find(elementGuid)) {
+            report.hasWall = true;
+            report.wallGuid = *wallGuid;
+        }
+    }
+
+    // Handling Wall elements (Check for any Embedded Doors)
+    if (elemType == HostElemType::Wall) {
+        HostWallData& wall = element.wall;
+
+        // Calculate the length of the wall in the XY-plane
+        double dx = wall.begC.x - wall.endC.x;
+        double dy = wall.begC.y - wall.endC.y;
+        report.wallLength = sqrt(dx * dx + dy * dy);
+
+        // Use the thickness at the beginning of the wall as the reported thickness
+        report.wallThickness = wall.thickness;
+
+        // Wall height relative to its bottom
+        report.wallHeight = wall.height;
+
+        HostElementMemo memo;
+        if (session.records.GetMemo(host, elementGuid, memo) == HostNoError) {
+            for (const HostGuid& doorGuid : memo.wallDoors) {
+                session.doorToWallMap.Set(doorGuid, elementGuid); // Map each door to this wall
+            }
+            report.embeddedDoors = memo.wallDoors;
+        }
+    }
+
+    // Retrieve the compound info string for the element
+    report.hasInfoString = host.GetElementInfoString(elementGuid, report.infoString) == HostNoError;
+
+    // Retrieve the bounding box for the element
+    report.hasBounds = session.boundsCache.GetBounds(host, elementGuid, element.modiStamp, report.bounds) == HostNoError;
+
+    // Check for attached label (Label classification)
+    std::vector<HostGuid> connectedLabels;
+    int labelType = 0;
+    // Check for dimension elements associated with walls
+    if (elemType == HostElemType::Wall) {
+        // Check session map filled in ReportDimensionElementProperties
+        labelType = session.wallHasDimElems.Contains(elementGuid) ? 1 : 0;
+    }
+    else if (elemType == HostElemType::Zone) {
+        // For zones, check if the stampGuid is not null to assign a label type
+        labelType = (element.zone.stampGuid != HostNullGuid) ? 4 : 0;
+    }
+    else if (elemType == HostElemType::Door) {
+        // For doors, first check if a marker is present (the element and labels were fetched above)
+        if (element.door.markGuid != HostNullGuid) {
+            // If door marker is present, assign label type 3
+            labelType = 3;
+        }
+        else {
+            // If no marker, check for connected labels and assign label type 2 if found
+            if (session.records.GetConnectedLabels(host, elementGuid, connectedLabels) == HostNoError) {
+                if (!connectedLabels.empty()) {
+                    labelType = 2;
+                }
+            }
+        }
+    }
+    else {
+        // For other element types, check for connected labels
+        if (session.records.GetConnectedLabels(host, elementGuid, connectedLabels) == HostNoError) {
+            if (!connectedLabels.empty()) {
+                labelType = 2; // Assign label type if labels are found
+            }
+        }
+    }
+    report.labelType = labelType;
+
+    return true;
+}
+
+void WriteElementReport(std::ostream& outFile, const ElementReport& report)
+{
+    ReportBuffer& reportStr = GetThreadReportBuffer();
+    const char* typeName = report.hasTypeName ? report.typeName.c_str() : HostElemTypeToString(report.type);
+
+    if (report.type == HostElemType::Zone) {
+        // Report Zone ID first, then the Zone Stamp GUID
+        reportStr.Append("Element Type: Zone, GUID: ").AppendGuid(report.guid)
+            .Append(", Zone Stamp GUID: ").AppendGuid(report.stampGuid)
+            .Append(", Position: (").AppendFixed(report.pos.x).Append(", ").AppendFixed(report.pos.y).Append(')');
+
+        // Room/Zone Name
+        if (!report.roomName.empty()) {
+            reportStr.Append(", Room Name: ").Append(report.roomName);
+        }
+
+        // Room Number
+        if (!report.roomNoStr.empty()) {
+            reportStr.Append(", Room Number: ").Append(report.roomNoStr);
+        }
+
+        // Room Height
+        reportStr.Append(", Room Height: ").AppendFixed(report.roomHeight);
+
+        if (report.hasStampBounds) {
+            reportStr.Append(", Zone Stamp Bounding Box: ").AppendBox(report.stampBounds);
+        }
+        else {
+            reportStr.Append(", Zone Stamp Bounding Box: Not available");
+        }
+    }
+
+    else if (report.type == HostElemType::Door) {
+        reportStr.Append("Element Type: Door, GUID: ").AppendGuid(report.guid)
+            .Append(", Width: ").AppendFixed(report.width)
+            .Append(" , Height: ").AppendFixed(report.height).Append(' ');
+
+        // Check if Marker GUID should be included
+        if (report.markGuid != HostNullGuid) {
+            reportStr.Append(", Marker GUID: ").AppendGuid(report.markGuid);
+        }
+
+        // Append label GUID and bounding box to the door report
+        for (const LabelReport& label : report.labels) {
+            reportStr.Append(", Label GUID: ").AppendGuid(label.guid);
+            if (label.hasBounds) {
+                reportStr.Append(", Label Bounding Box: ").AppendBox(label.bounds);
+            }
+            else {
+                reportStr.Append(", Bounding Box: Not available");
+            }
+        }
+
+        if (report.hasWall) {
+            reportStr.Append(", Embedded in Wall GUID: ").AppendGuid(report.wallGuid);
+        }
+        else {
+            reportStr.Append(", Not embedded in any wall");
+        }
+    }
+
+    else {
+        // Handle other types (walls, slabs, etc.)
+        if (report.hasTypeName) {
+            reportStr.Append("Element Type: ").Append(typeName);
+        }
+        else {
+            reportStr.Append("Element Type: ").AppendInt(static_cast<int>(report.type));
+        }
+        reportStr.Append(", GUID: ").AppendGuid(report.guid);
+    }
+
+    if (report.type == HostElemType::Wall) {
+        // Append wall length, thickness, and height to the report string
+        reportStr.Append(", Length: ").AppendFixed(report.wallLength)
+            .Append(", Width: ").AppendFixed(report.wallThickness)
+            .Append(", Height: ").AppendFixed(report.wallHeight);
+
+        for (size_t i = 0; i < report.embeddedDoors.size(); ++i) {
+            reportStr.Append(i == 0 ? ", Embedded Door GUID: " : ", ").AppendGuid(report.embeddedDoors[i]);
+        }
+    }
+
+    if (report.hasInfoString) {
+        reportStr.Append(", Info String: ").Append(report.infoString);
+    }
+    else {
+        reportStr.Append(", Info String: Not available");
+    }
+
+    if (report.hasBounds) {
+        // Append element type and bounding box info to your report
+        reportStr.Append(", ").Append(typeName).Append(" Bounding Box: ").AppendBox(report.bounds);
+    }
+    else {
+        reportStr.Append(", Bounding Box: Not available");
+    }
+
+    // Append label presence info to your report
+    reportStr.Append(", Label Type: ").AppendInt(report.labelType);
+
+    reportStr.WriteLine(outFile);
+}
+
+// Function to clear all dimensions ,annotations,labels and zones
+void DeleteDimensionsAndAnnotations(IElementHost& host, TraceRecorder* trace) {
+    HostElemType elementTypes[] = { HostElemType::Dimension, HostElemType::Label, HostElemType::Zone /*, other annotation types */ };
+
+    for (HostElemType elemType : elementTypes) {
+        std::vector<HostGuid> elementList;
+
+        // Get the list of elements of the specified type
+        if (host.GetElemList(elemType, elementList) == HostNoError && !elementList.empty()) {
+            // Delete all elements of the current type
+            TraceScope deleteScope(trace, "DeleteElements", "annotate");
+            HostError err = host.DeleteElements(elementList);
+            if (err != HostNoError) {
+                // Handle error (e.g., log it or display a message to the user)
+            }
+        }
+    }
+}
+
+void ReportDimensionElementProperties(IElementHost& host, ExtractionSession& session, const HostGuid& elementGuid, HostElemType elemType, const ExtractionOutput& output) {
+    ProfileScope scope(session.profiler, ProfileCounter::ReportDimension);
+    DimensionReport report;
+    if (elemType != HostElemType::Dimension || !CollectDimensionReport(host, session, elementGuid, report)) {
+        if (output.textReport != nullptr)
+            *output.textReport << "Error or Unsupported Element Type" << std::endl;
+        return;
+    }
+
+    if (output.textReport != nullptr)
+        WriteDimensionReport(*output.textReport, report);
+    if (output.columnarReport != nullptr)
+        output.columnarReport->AddDimension(report);
+    if (output.snapshot != nullptr)
+        output.snapshot->SetDimension(report);
+}
+
+bool CollectDimensionReport(IElementHost& host, ExtractionSession& session, const HostGuid& elementGuid, DimensionReport& report) {
+    HostElement element;
+    if (session.records.GetElement(host, elementGuid, element) != HostNoError)
+        return false;
+
+    report.guid = elementGuid;
+    report.modiStamp = element.modiStamp;
+
+    HostElementMemo memo;
+    if (session.records.GetMemo(host, elementGuid, memo) != HostNoError)
+        return true;
+    report.hasMemo = true;
+
+    for (size_t i = 0; i < memo.dimElems.size(); ++i, ++session.globalDimElemCount) {
+        const HostDimElem& dimElem = memo.dimElems[i];
+        report.totalLength += dimElem.dimVal; // Accumulate the length
+        // If the base element is a wall, record that it has associated dimension elements
+        if (dimElem.baseType == HostElemType::Wall) {
+            session.wallHasDimElems.Set(dimElem.baseGuid, true);
+        }
+
+        double textWidth = 0.5;
+        double textHeight = 0.5;
+        HostCoord textPos = dimElem.notePos; // Assuming this gives the bottom left position of the note
+
+        // Assuming a negligible thickness for the dimension element to simulate a bounding box
+        const float thickness = 0.01f; // Arbitrarily small value to simulate a bounding box
+
+        DimNodeReport node;
+        node.index = session.globalDimElemCount;
+        node.dimElem = dimElem;
+
+        // Calculate the bounding box coordinates based on the dimension point, no Z extent
+        node.bounds[0] = static_cast<float>(dimElem.pos.x - thickness / 2);
+        node.bounds[1] = static_cast<float>(dimElem.pos.y - thickness / 2);
+        node.bounds[2] = 0.0f;
+        node.bounds[3] = static_cast<float>(dimElem.pos.x + thickness / 2);
+        node.bounds[4] = static_cast<float>(dimElem.pos.y + thickness / 2);
+        node.bounds[5] = 0.0f;
+
+        // Calculate bounding box without rotation for simplicity
+        node.noteBounds.xMin = textPos.x;
+        node.noteBounds.yMin = textPos.y;
+        node.noteBounds.zMin = 0.0;
+        node.noteBounds.xMax = textPos.x + textWidth;
+        node.noteBounds.yMax = textPos.y + textHeight;
+        node.noteBounds.zMax = 0.0;
+
+        DimensionNoteInfo noteInfo = {
+            elementGuid, // GUID of the dimension element
+            node.noteBounds, // The calculated or defined bounding box for the note
+            session.arena.CopyString(dimElem.noteText),
+            static_cast<double>(static_cast<int>(dimElem.dimVal)), // Dimension value, cast to int if necessary
+            dimElem.notePos, // Position of the note
+            session.globalDimElemCount
+        };
+
+        // Add the populated instance to the collection
+        session.dimensionNoteInfos.PushBack(noteInfo);
+        report.nodes.push_back(node);
+    }
+
+    // Retrieve the bounding box for the entire dimension element
+    if (session.boundsCache.GetBounds(host, elementGuid, element.modiStamp, report.bounds) == HostNoError) {
+        report.hasBounds = true;
+        report.index = ++session.dimElementCount;
+    }
+
+    return true;
+}
+
+void WriteDimensionReport(std::ostream& outFile, const DimensionReport& report) {
+    if (!report.hasMemo) {
+        outFile << "Error retrieving element memo" << std::endl;
+        return;
+    }
+
+    // The dimension GUID is in every node line, format it once
+    char dimGuidStr[GuidStringLength];
+    FormatGuid(report.guid, dimGuidStr);
+    std::string_view dimGuid(dimGuidStr, GuidStringLength);
+
+    ReportBuffer& reportStr = GetThreadReportBuffer();
+    for (const DimNodeReport& node : report.nodes) {
+        // Format the output string to include both position and bounding box information
+        reportStr.Clear();
+        reportStr.Append("Element Type: DimNode ").AppendInt(node.index)
+            .Append(", GUID: ").Append(dimGuid)
+            .Append(", Associated Element GUID: ").AppendGuid(node.dimElem.baseGuid)
+            .Append(", Text: ").Append(node.dimElem.noteText)
+            .Append(", Length: ").AppendFixed(node.dimElem.dimVal)
+            .Append(", DimNode ").AppendInt(node.index).Append(" Bounding Box: ").AppendBox(node.bounds)
+            .Append(", Position: (").AppendFixed(node.dimElem.pos.x).Append(", ").AppendFixed(node.dimElem.pos.y).Append(')')
+            .Append(", Info String: Dim Node ").AppendInt(node.index);
+
+        reportStr.WriteLine(outFile);
+    }
+
+    reportStr.Clear();
+    if (report.hasBounds) {
+        reportStr.Append("Element Type: Dimension, GUID: ").Append(dimGuid)
+            .Append(", Dimension Bounding Box: ").AppendBox(report.bounds)
+            .Append(", Length: ").AppendFixed(report.totalLength) // Include total length here
+            .Append(", Info String: Dim ").AppendInt(report.index);
+    }
+    else {
+        // Handle error in retrieving the bounding box
+        reportStr.Append("Bounding Box for Dimension Element, GUID: ").Append(dimGuid).Append(": Not available");
+    }
+
+    reportStr.WriteLine(outFile);
+}
+
+static void WriteZoneStampInfo(std::ostream& outFile, const ZoneStampInfo& info) {
+    ReportBuffer& reportStr = GetThreadReportBuffer();
+    reportStr.Append("Element Type: Zone Stamp, GUID: ").AppendGuid(info.guid)
+        .Append(", Zone Stamp Bounding Box: ").AppendBox(info.boundingBox)
+        .Append(", Info String: ").Append(info.infoString);
+    reportStr.WriteLine(outFile);
+}
+
+static void WriteDoorLabelInfo(std::ostream& outFile, const DoorLabelInfo& info) {
+    ReportBuffer& reportStr = GetThreadReportBuffer();
+    reportStr.Append("Element Type: Door Label, GUID: ").AppendGuid(info.guid)
+        .Append(", Label Bounding Box: ").AppendBox(info.boundingBox)
+        .Append(", Info String: ").Append(info.infoString);
+    reportStr.WriteLine(outFile);
+}
+
+static void WriteDimensionNoteInfo(std::ostream& outFile, const DimensionNoteInfo& info) {
+    ReportBuffer& reportStr = GetThreadReportBuffer();
+    reportStr.Append("Element Type: DimText ").AppendInt(info.globalDimElemCount)
+        .Append(", GUID: ").AppendGuid(info.guid)
+        .Append(", DimText ").AppendInt(info.globalDimElemCount).Append(" Bounding Box: ").AppendBox(info.noteBoundingBox)
+        .Append(", Text: ").Append(info.noteText)
+        .Append(", Position: (").AppendFixed(info.position.x).Append(", ").AppendFixed(info.position.y).Append(')')
+        .Append(", Info String: Dim Text ").AppendInt(info.globalDimElemCount);
+    reportStr.WriteLine(outFile);
+}
+
+void OutputAdditionalInfo(std::ostream& outFile, const ExtractionSession& session) {
+    ProfileScope scope(session.profiler, ProfileCounter::OutputAdditionalInfo);
+    TraceScope traceScope(session.trace, "OutputAdditionalInfo", "extract");
+
+    // Output Zone Stamp Info
+    session.zoneStampInfos.ForEach([&](const ZoneStampInfo& info) {
+        WriteZoneStampInfo(outFile, info);
+    });
+
+    // Output Door Label Info
+    session.doorLabelInfos.ForEach([&](const DoorLabelInfo& info) {
+        WriteDoorLabelInfo(outFile, info);
+    });
+
+    // Output Dimension note Info
+    session.dimensionNoteInfos.ForEach([&](const DimensionNoteInfo& info) {
+        WriteDimensionNoteInfo(outFile, info);
+    });
+}
+
+void OutputAdditionalInfo(std::ostream& outFile, const ExtractionSnapshot& snapshot) {
+    // Collected in the same order CollectElementReport and CollectDimensionReport collect them
+    for (const ElementReport& report : snapshot.GetElements(HostElemType::Zone)) {
+        if (report.hasStampBounds)
+            WriteZoneStampInfo(outFile, { report.stampGuid, report.stampBounds });
+    }
+
+    for (const ElementReport& report : snapshot.GetElements(HostElemType::Door)) {
+        for (const LabelReport& label : report.labels) {
+            if (label.hasBounds)
+                WriteDoorLabelInfo(outFile, { label.guid, label.bounds });
+        }
+    }
+
+    for (const DimensionReport& report : snapshot.GetDimensions()) {
+        for (const DimNodeReport& node : report.nodes) {
+            DimensionNoteInfo info = {
+                report.guid,
+                node.noteBounds,
+                node.dimElem.noteText,
+                static_cast<double>(static_cast<int>(node.dimElem.dimVal)),
+                node.dimElem.notePos,
+                node.index
+            };
+            WriteDimensionNoteInfo(outFile, info);
+        }
+    }
+}
+
+HostError WriteTextReport(IElementHost& host, ExtractionSession& session, const std::string& filePath, ColumnarReportWriter* columnarReport) {
+    ProfileScope scope(session.profiler, ProfileCounter::WriteTextReport);
+    TraceScope traceScope(session.trace, "WriteTextReport", "extract");
+    AsyncFileWriter sink;
+    HostError err = sink.Open(filePath);
+    if (err != HostNoError)
+        return err;
+
+    std::ostream outFile(&sink);
+    ExtractionOutput output;
+    output.textReport = &outFile;
+    output.columnarReport = columnarReport;
+    ProcessBuildingElements(host, session, output);
+    OutputAdditionalInfo(outFile, session);
+
+    // The writer thread may still have a block to write
+    TraceScope closeScope(session.trace, "CloseTextReport", "extract");
+    err = sink.Close();
+    if (session.profiler != nullptr)
+        session.profiler->AddBytes(ProfileCounter::WriteTextReport, sink.GetWrittenSize());
+    return err;
+}
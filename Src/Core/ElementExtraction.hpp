@@ -0,0 +1,46 @@
+#ifndef ELEMENT_EXTRACTION_HPP
+#define ELEMENT_EXTRACTION_HPP
+
+#include <ostream>
+#include <string>
+#include "ColumnarReport.hpp"
+#include "ElementHost.hpp"
+#include "ElementReport.hpp"
+#include "ExtractionSession.hpp"
+#include "ExtractionSnapshot.hpp"
+
+// Where extraction writes its results, any output may be left out
+struct ExtractionOutput {
+    std::ostream*         textReport = nullptr;       // "Key: Value" lines (ElementInfo.txt)
+    ColumnarReportWriter* columnarReport = nullptr;   // binary column blocks (ElementInfo.bin)
+    ExtractionSnapshot*   snapshot = nullptr;         // every report, for incremental extraction
+};
+
+// Walks dimensions, walls, slabs, zones and doors and reports every element. Resets the session
+// and the output snapshot first.
+void ProcessBuildingElements(IElementHost& host, ExtractionSession& session, const ExtractionOutput& output);
+
+void ReportElementProperties(IElementHost& host, ExtractionSession& session, const HostGuid& elementGuid, HostElemType elemType, const ExtractionOutput& output);
+void ReportDimensionElementProperties(IElementHost& host, ExtractionSession& session, const HostGuid& elementGuid, HostElemType elemType, const ExtractionOutput& output);
+
+// Gather the report data for one element, return false if the element could not be read
+bool CollectElementReport(IElementHost& host, ExtractionSession& session, const HostGuid& elementGuid, HostElemType elemType, ElementReport& report);
+bool CollectDimensionReport(IElementHost& host, ExtractionSession& session, const HostGuid& elementGuid, DimensionReport& report);
+
+// Format report data as text report lines
+void WriteElementReport(std::ostream& outFile, const ElementReport& report);
+void WriteDimensionReport(std::ostream& outFile, const DimensionReport& report);
+
+// Writes the zone stamps, door labels and dimension notes the session collected while reporting
+void OutputAdditionalInfo(std::ostream& outFile, const ExtractionSession& session);
+// Same lines, taken from the reports of a snapshot
+void OutputAdditionalInfo(std::ostream& outFile, const ExtractionSnapshot& snapshot);
+
+// One extraction run into a fresh text report at filePath: ProcessBuildingElements, then
+// OutputAdditionalInfo. The file is written on a background thread and is complete on return.
+HostError WriteTextReport(IElementHost& host, ExtractionSession& session, const std::string& filePath, ColumnarReportWriter* columnarReport = nullptr);
+
+// Deletes all dimensions, labels and zones
+void DeleteDimensionsAndAnnotations(IElementHost& host, TraceRecorder* trace = nullptr);
+
+#endif // ELEMENT_EXTRACTION_HPP
@@ -0,0 +1,346 @@
+#include "ElementGraph.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include "BoxRTree.hpp"
+
+namespace {
+
+const std::uint32_t GraphFormatVersion = 1;
+
+// Feature columns of each node type, in GraphNodeType order. Part of the file format, append only.
+const std::vector<const char*> NodeFeatureNames[GraphNodeTypeCount] = {
+    { "boundsXMin", "boundsYMin", "boundsZMin", "boundsXMax", "boundsYMax", "boundsZMax", "length", "width", "height", "labelType" },
+    { "boundsXMin", "boundsYMin", "boundsZMin", "boundsXMax", "boundsYMax", "boundsZMax", "labelType" },
+    { "boundsXMin", "boundsYMin", "boundsZMin", "boundsXMax", "boundsYMax", "boundsZMax", "positionX", "positionY", "roomHeight", "labelType" },
+    { "boundsXMin", "boundsYMin", "boundsZMin", "boundsXMax", "boundsYMax", "boundsZMax", "width", "height", "hasMarker", "labelType" },
+    { "boundsXMin", "boundsYMin", "boundsZMin", "boundsXMax", "boundsYMax", "boundsZMax", "length", "nodeCount" },
+    { "boundsXMin", "boundsYMin", "boundsZMin", "boundsXMax", "boundsYMax", "boundsZMax" },
+    { "boundsXMin", "boundsYMin", "boundsZMin", "boundsXMax", "boundsYMax", "boundsZMax" }
+};
+
+const float NaN = std::numeric_limits<float>::quiet_NaN();
+
+// Geometric edges, in meters. Boxes closer than ContactTolerance touch, labels link to the
+// NearestElementCount closest walls and doors within LabelSearchRadius.
+const double ContactTolerance = 0.01;
+const double LabelSearchRadius = 1.0;
+const size_t NearestElementCount = 2;
+
+// Writes the 6 bounding box features, NaN if there is no box
+float* PutBox(float* features, const HostBox3D* box) {
+    const double values[6] = { box ? box->xMin : 0.0, box ? box->yMin : 0.0, box ? box->zMin : 0.0,
+                               box ? box->xMax : 0.0, box ? box->yMax : 0.0, box ? box->zMax : 0.0 };
+    for (double value : values)
+        *features++ = box != nullptr ? static_cast<float>(value) : NaN;
+    return features;
+}
+
+HostError WriteFile(const std::filesystem::path& filePath, const void* data, size_t size) {
+    std::ofstream outFile(filePath, std::ios::binary);
+    if (!outFile.is_open())
+        return HostErrFileIO;
+    outFile.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    outFile.close();
+    return outFile.fail() ? HostErrFileIO : HostNoError;
+}
+
+// Bounding boxes of the nodes of one type that have one, the item id is the node row
+using NodeBoxes = std::vector<RTreeItem>;
+
+// Adds the node and remembers its box for the geometric edges
+std::uint32_t AddNodeWithBox(ElementGraph& graph, GraphNodeType type, const HostGuid& guid, const float* features,
+    const HostBox3D* box, NodeBoxes& boxes)
+{
+    size_t rowCount = graph.GetNodes(type).GetRowCount();
+    std::uint32_t row = graph.AddNode(type, guid, features);
+    if (box != nullptr && row == rowCount)
+        boxes.push_back({ *box, row });
+    return row;
+}
+
+// Edges derived from the bounding boxes alone, which extraction does not report:
+//   wall_touches_wall      walls whose boxes touch or overlap (both directions)
+//   zone_bounded_by_wall   walls touching the zone box, the walls enclosing the zone and the ones crossing it
+//   label_near_wall/door   the closest walls and doors around each label
+void AddGeometricEdges(ElementGraph& graph, const NodeBoxes* boxes, size_t threadCount) {
+    const NodeBoxes& wallBoxes = boxes[static_cast<size_t>(GraphNodeType::Wall)];
+    const NodeBoxes& zoneBoxes = boxes[static_cast<size_t>(GraphNodeType::Zone)];
+    const NodeBoxes& doorBoxes = boxes[static_cast<size_t>(GraphNodeType::Door)];
+    const NodeBoxes& labelBoxes = boxes[static_cast<size_t>(GraphNodeType::Label)];
+
+    BoxRTree wallTree;
+    wallTree.Build(wallBoxes);
+    BoxRTree doorTree;
+    doorTree.Build(doorBoxes);
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+    QueryOverlapBatch(wallTree, wallBoxes, ContactTolerance, threadCount, pairs);
+    pairs.erase(std::remove_if(pairs.begin(), pairs.end(), [](const auto& edge) { return edge.first == edge.second; }), pairs.end());
+    graph.AddEdges("wall_touches_wall", GraphNodeType::Wall, GraphNodeType::Wall, pairs);
+
+    pairs.clear();
+    QueryOverlapBatch(wallTree, zoneBoxes, ContactTolerance, threadCount, pairs);
+    graph.AddEdges("zone_bounded_by_wall", GraphNodeType::Zone, GraphNodeType::Wall, pairs);
+
+    pairs.clear();
+    QueryNearestBatch(wallTree, labelBoxes, NearestElementCount, LabelSearchRadius, threadCount, pairs);
+    graph.AddEdges("label_near_wall", GraphNodeType::Label, GraphNodeType::Wall, pairs);
+
+    pairs.clear();
+    QueryNearestBatch(doorTree, labelBoxes, NearestElementCount, LabelSearchRadius, threadCount, pairs);
+    graph.AddEdges("label_near_door", GraphNodeType::Label, GraphNodeType::Door, pairs);
+}
+
+// "file", "dtype" and "shape" of one array in the manifest
+void WriteArrayEntry(std::ostream& manifest, const char* key, const std::string& fileName, const char* dtype, size_t rows, size_t columns) {
+    manifest << "\"" << key << "\": { \"file\": \"" << fileName << "\", \"dtype\": \"" << dtype << "\", \"shape\": [" << rows;
+    if (columns > 0)
+        manifest << ", " << columns;
+    manifest << "] }";
+}
+
+}
+
+const char* GraphNodeTypeName(GraphNodeType type) {
+    switch (type) {
+    case GraphNodeType::Wall:       return "wall";
+    case GraphNodeType::Slab:       return "slab";
+    case GraphNodeType::Zone:       return "zone";
+    case GraphNodeType::Door:       return "door";
+    case GraphNodeType::Dimension:  return "dimension";
+    case GraphNodeType::ZoneStamp:  return "zone_stamp";
+    case GraphNodeType::Label:      return "label";
+    default:                        return "unknown";
+    }
+}
+
+std::int64_t GraphNodeSet::FindRow(const HostGuid& guid) const {
+    const std::uint32_t* row = rows.Find(guid);
+    return row != nullptr ? static_cast<std::int64_t>(*row) : -1;
+}
+
+ElementGraph::ElementGraph() {
+    Clear();
+}
+
+void ElementGraph::Clear() {
+    for (size_t i = 0; i < GraphNodeTypeCount; ++i) {
+        nodes[i].guids.clear();
+        nodes[i].featureNames = NodeFeatureNames[i];
+        nodes[i].features.clear();
+        nodes[i].rows.Clear();
+    }
+    edgeSets.clear();
+}
+
+std::uint32_t ElementGraph::AddNode(GraphNodeType type, const HostGuid& guid, const float* features) {
+    GraphNodeSet& nodeSet = GetNodes(type);
+    if (const std::uint32_t* existingRow = nodeSet.rows.Find(guid))
+        return *existingRow;
+
+    std::uint32_t row = static_cast<std::uint32_t>(nodeSet.guids.size());
+    nodeSet.rows.Set(guid, row);
+    nodeSet.guids.push_back(guid);
+    nodeSet.features.insert(nodeSet.features.end(), features, features + nodeSet.GetFeatureCount());
+    return row;
+}
+
+const GraphEdgeSet& ElementGraph::AddEdges(const char* name, GraphNodeType source, GraphNodeType target,
+    std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs)
+{
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    GraphEdgeSet edgeSet;
+    edgeSet.name = name;
+    edgeSet.source = source;
+    edgeSet.target = target;
+    edgeSet.offsets.assign(GetNodes(source).GetRowCount() + 1, 0);
+    edgeSet.targets.reserve(pairs.size());
+    for (const auto& edge : pairs) {
+        ++edgeSet.offsets[edge.first + 1];
+        edgeSet.targets.push_back(edge.second);
+    }
+    for (size_t row = 1; row < edgeSet.offsets.size(); ++row)
+        edgeSet.offsets[row] += edgeSet.offsets[row - 1];
+
+    edgeSets.push_back(std::move(edgeSet));
+    return edgeSets.back();
+}
+
+const GraphEdgeSet* ElementGraph::FindEdgeSet(const std::string& name) const {
+    for (const GraphEdgeSet& edgeSet : edgeSets) {
+        if (edgeSet.name == name)
+            return &edgeSet;
+    }
+    return nullptr;
+}
+
+void BuildElementGraph(const ExtractionSnapshot& snapshot, ElementGraph& graph, size_t threadCount, const GuidHashMap<bool>* ignored) {
+    auto isIgnored = [&](const HostGuid& guid) { return ignored != nullptr && ignored->Contains(guid); };
+    graph.Clear();
+    float features[16];
+    NodeBoxes boxes[GraphNodeTypeCount];
+
+    for (const ElementReport& report : snapshot.GetElements(HostElemType::Wall)) {
+        float* f = PutBox(features, report.hasBounds ? &report.bounds : nullptr);
+        *f++ = static_cast<float>(report.wallLength);
+        *f++ = static_cast<float>(report.wallThickness);
+        *f++ = static_cast<float>(report.wallHeight);
+        *f++ = static_cast<float>(report.labelType);
+        AddNodeWithBox(graph, GraphNodeType::Wall, report.guid, features, report.hasBounds ? &report.bounds : nullptr,
+            boxes[static_cast<size_t>(GraphNodeType::Wall)]);
+    }
+
+    for (const ElementReport& report : snapshot.GetElements(HostElemType::Slab)) {
+        float* f = PutBox(features, report.hasBounds ? &report.bounds : nullptr);
+        *f++ = static_cast<float>(report.labelType);
+        graph.AddNode(GraphNodeType::Slab, report.guid, features);
+    }
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> zoneStamps;
+    for (const ElementReport& report : snapshot.GetElements(HostElemType::Zone)) {
+        if (isIgnored(report.guid))
+            continue;
+        float* f = PutBox(features, report.hasBounds ? &report.bounds : nullptr);
+        *f++ = static_cast<float>(report.pos.x);
+        *f++ = static_cast<float>(report.pos.y);
+        *f++ = static_cast<float>(report.roomHeight);
+        *f++ = static_cast<float>(report.labelType);
+        std::uint32_t zoneRow = AddNodeWithBox(graph, GraphNodeType::Zone, report.guid, features,
+            report.hasBounds ? &report.bounds : nullptr, boxes[static_cast<size_t>(GraphNodeType::Zone)]);
+
+        if (report.stampGuid != HostNullGuid) {
+            PutBox(features, report.hasStampBounds ? &report.stampBounds : nullptr);
+            zoneStamps.emplace_back(zoneRow, graph.AddNode(GraphNodeType::ZoneStamp, report.stampGuid, features));
+        }
+    }
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> doorLabels;
+    std::vector<std::pair<std::uint32_t, HostGuid>> doorWalls;
+    for (const ElementReport& report : snapshot.GetElements(HostElemType::Door)) {
+        // Label type 2 comes from the labels, without the ignored ones the door may have none
+        int labelType = report.labelType;
+        if (labelType == 2 && !report.labels.empty() && std::all_of(report.labels.begin(), report.labels.end(),
+                [&](const LabelReport& label) { return isIgnored(label.guid); }))
+            labelType = 0;
+
+        float* f = PutBox(features, report.hasBounds ? &report.bounds : nullptr);
+        *f++ = static_cast<float>(report.width);
+        *f++ = static_cast<float>(report.height);
+        *f++ = report.markGuid != HostNullGuid ? 1.0f : 0.0f;
+        *f++ = static_cast<float>(labelType);
+        std::uint32_t doorRow = AddNodeWithBox(graph, GraphNodeType::Door, report.guid, features,
+            report.hasBounds ? &report.bounds : nullptr, boxes[static_cast<size_t>(GraphNodeType::Door)]);
+
+        for (const LabelReport& label : report.labels) {
+            if (isIgnored(label.guid))
+                continue;
+            PutBox(features, label.hasBounds ? &label.bounds : nullptr);
+            doorLabels.emplace_back(doorRow, AddNodeWithBox(graph, GraphNodeType::Label, label.guid, features,
+                label.hasBounds ? &label.bounds : nullptr, boxes[static_cast<size_t>(GraphNodeType::Label)]));
+        }
+        if (report.hasWall)
+            doorWalls.emplace_back(doorRow, report.wallGuid);
+    }
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> wallDimensions;
+    const GraphNodeSet& walls = graph.GetNodes(GraphNodeType::Wall);
+    for (const DimensionReport& report : snapshot.GetDimensions()) {
+        if (isIgnored(report.guid))
+            continue;
+        float* f = PutBox(features, report.hasBounds ? &report.bounds : nullptr);
+        *f++ = static_cast<float>(report.totalLength);
+        *f++ = static_cast<float>(report.nodes.size());
+        std::uint32_t dimensionRow = graph.AddNode(GraphNodeType::Dimension, report.guid, features);
+
+        for (const DimNodeReport& node : report.nodes) {
+            std::int64_t wallRow = node.dimElem.baseType == HostElemType::Wall ? walls.FindRow(node.dimElem.baseGuid) : -1;
+            if (wallRow >= 0)
+                wallDimensions.emplace_back(static_cast<std::uint32_t>(wallRow), dimensionRow);
+        }
+    }
+
+    // Doors whose wall is not among the extracted walls get no edge
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> doorInWall;
+    for (const auto& doorWall : doorWalls) {
+        std::int64_t wallRow = walls.FindRow(doorWall.second);
+        if (wallRow >= 0)
+            doorInWall.emplace_back(doorWall.first, static_cast<std::uint32_t>(wallRow));
+    }
+
+    graph.AddEdges("door_in_wall", GraphNodeType::Door, GraphNodeType::Wall, doorInWall);
+    graph.AddEdges("wall_dimensioned_by", GraphNodeType::Wall, GraphNodeType::Dimension, wallDimensions);
+    graph.AddEdges("zone_has_stamp", GraphNodeType::Zone, GraphNodeType::ZoneStamp, zoneStamps);
+    graph.AddEdges("door_has_label", GraphNodeType::Door, GraphNodeType::Label, doorLabels);
+
+    AddGeometricEdges(graph, boxes, threadCount);
+}
+
+HostError WriteElementGraph(const ElementGraph& graph, const std::string& directory) {
+    std::error_code errorCode;
+    std::filesystem::path dirPath(directory);
+    std::filesystem::create_directories(dirPath, errorCode);
+    if (errorCode)
+        return HostErrFileIO;
+
+    // The manifest goes last, a directory with a manifest is complete
+    std::filesystem::remove(dirPath / "manifest.json", errorCode);
+
+    std::ostringstream manifest;
+    manifest << "{\n  \"format\": \"exv2-graph\",\n  \"version\": " << GraphFormatVersion << ",\n  \"byteOrder\": \"little\",\n  \"nodeTypes\": [";
+
+    HostError err = HostNoError;
+    for (size_t i = 0; i < GraphNodeTypeCount && err == HostNoError; ++i) {
+        const char* name = GraphNodeTypeName(static_cast<GraphNodeType>(i));
+        const GraphNodeSet& nodeSet = graph.GetNodes(static_cast<GraphNodeType>(i));
+        std::string featureFile = std::string(name) + ".features.f32";
+        std::string guidFile = std::string(name) + ".guids.bin";
+
+        std::vector<std::uint8_t> guidBytes(nodeSet.GetRowCount() * 16);
+        for (size_t row = 0; row < nodeSet.GetRowCount(); ++row)
+            HostGuidToBytes(nodeSet.guids[row], &guidBytes[row * 16]);
+
+        err = WriteFile(dirPath / featureFile, nodeSet.features.data(), nodeSet.features.size() * sizeof(float));
+        if (err == HostNoError)
+            err = WriteFile(dirPath / guidFile, guidBytes.data(), guidBytes.size());
+
+        manifest << (i == 0 ? "\n" : ",\n") << "    { \"name\": \"" << name << "\", \"count\": " << nodeSet.GetRowCount() << ",\n      ";
+        WriteArrayEntry(manifest, "features", featureFile, "float32", nodeSet.GetRowCount(), nodeSet.GetFeatureCount());
+        manifest << ",\n      ";
+        WriteArrayEntry(manifest, "guids", guidFile, "uint8", nodeSet.GetRowCount(), 16);
+        manifest << ",\n      \"featureNames\": [";
+        for (size_t column = 0; column < nodeSet.GetFeatureCount(); ++column)
+            manifest << (column == 0 ? "\"" : ", \"") << nodeSet.featureNames[column] << "\"";
+        manifest << "] }";
+    }
+    manifest << "\n  ],\n  \"edgeTypes\": [";
+
+    const std::vector<GraphEdgeSet>& edgeSets = graph.GetEdgeSets();
+    for (size_t i = 0; i < edgeSets.size() && err == HostNoError; ++i) {
+        const GraphEdgeSet& edgeSet = edgeSets[i];
+        std::string offsetFile = edgeSet.name + ".offsets.u32";
+        std::string targetFile = edgeSet.name + ".targets.u32";
+
+        err = WriteFile(dirPath / offsetFile, edgeSet.offsets.data(), edgeSet.offsets.size() * sizeof(std::uint32_t));
+        if (err == HostNoError)
+            err = WriteFile(dirPath / targetFile, edgeSet.targets.data(), edgeSet.targets.size() * sizeof(std::uint32_t));
+
+        manifest << (i == 0 ? "\n" : ",\n") << "    { \"name\": \"" << edgeSet.name << "\", \"source\": \"" << GraphNodeTypeName(edgeSet.source)
+            << "\", \"target\": \"" << GraphNodeTypeName(edgeSet.target) << "\", \"count\": " << edgeSet.GetEdgeCount() << ",\n      ";
+        WriteArrayEntry(manifest, "offsets", offsetFile, "uint32", edgeSet.offsets.size(), 0);
+        manifest << ",\n      ";
+        WriteArrayEntry(manifest, "targets", targetFile, "uint32", edgeSet.targets.size(), 0);
+        manifest << " }";
+    }
+    manifest << "\n  ]\n}\n";
+
+    if (err == HostNoError) {
+        const std::string text = manifest.str();
+        err = WriteFile(dirPath / "manifest.json", text.data(), text.size());
+    }
+    return err;
+}
@@ -0,0 +1,99 @@
+#ifndef ELEMENT_GRAPH_HPP
+#define ELEMENT_GRAPH_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ExtractionSnapshot.hpp"
+#include "GuidHashMap.hpp"
+
+// Heterogeneous graph of the extracted elements, the input of the GNN.
+//
+// WriteElementGraph writes one directory that numpy/torch can memory-map without parsing:
+//   manifest.json                  node and edge types, row counts, shapes, dtypes and file names
+//   <node>.features.f32            float32[rows][featureCount], row-major, missing values NaN
+//   <node>.guids.bin               uint8[rows][16], GUID bytes in string order
+//   <edge>.offsets.u32             uint32[sourceRows + 1]
+//   <edge>.targets.u32             uint32[edgeCount], target rows
+// Edges are in CSR form: the targets of source row i are targets[offsets[i] .. offsets[i + 1]).
+// All files are little-endian and start at byte 0, so a file maps to an array directly.
+
+enum class GraphNodeType : std::uint8_t {
+    Wall,
+    Slab,
+    Zone,
+    Door,
+    Dimension,
+    ZoneStamp,
+    Label
+};
+
+constexpr size_t GraphNodeTypeCount = 7;
+
+const char* GraphNodeTypeName(GraphNodeType type);
+
+// All nodes of one type, the row of a node is its index in guids
+struct GraphNodeSet {
+    std::vector<HostGuid>       guids;
+    std::vector<const char*>    featureNames;
+    std::vector<float>          features;       // guids.size() * featureNames.size(), row-major
+    GuidHashMap<std::uint32_t>  rows;
+
+    size_t GetRowCount() const { return guids.size(); }
+    size_t GetFeatureCount() const { return featureNames.size(); }
+    const float* GetRow(size_t row) const { return features.data() + row * featureNames.size(); }
+
+    // Row of guid, -1 if the node is not in the set
+    std::int64_t FindRow(const HostGuid& guid) const;
+};
+
+// Edges of one type from source rows to target rows, in CSR form
+struct GraphEdgeSet {
+    std::string                 name;
+    GraphNodeType               source;
+    GraphNodeType               target;
+    std::vector<std::uint32_t>  offsets;        // source row count + 1
+    std::vector<std::uint32_t>  targets;
+
+    size_t GetEdgeCount() const { return targets.size(); }
+};
+
+class ElementGraph {
+public:
+    ElementGraph();
+
+    void Clear();
+
+    GraphNodeSet&       GetNodes(GraphNodeType type) { return nodes[static_cast<size_t>(type)]; }
+    const GraphNodeSet& GetNodes(GraphNodeType type) const { return nodes[static_cast<size_t>(type)]; }
+
+    // Adds a node with GetFeatureCount values, returns its row. A GUID already in the set keeps its first row.
+    std::uint32_t AddNode(GraphNodeType type, const HostGuid& guid, const float* features);
+
+    // Adds an edge type from (source row, target row) pairs. Duplicate pairs are dropped, the
+    // targets of a row are sorted.
+    const GraphEdgeSet& AddEdges(const char* name, GraphNodeType source, GraphNodeType target,
+        std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs);
+
+    const std::vector<GraphEdgeSet>& GetEdgeSets() const { return edgeSets; }
+    const GraphEdgeSet*              FindEdgeSet(const std::string& name) const;
+
+private:
+    GraphNodeSet              nodes[GraphNodeTypeCount];
+    std::vector<GraphEdgeSet> edgeSets;
+};
+
+// Nodes for every report in the snapshot (zone stamps and door labels included), the edges
+// extraction already knows (door_in_wall, wall_dimensioned_by, zone_has_stamp, door_has_label) and
+// the geometric ones found with R-tree queries over the bounding boxes (wall_touches_wall,
+// zone_bounded_by_wall, label_near_wall, label_near_door). The queries run on threadCount threads,
+// 0 uses every hardware thread. The elements in ignored (annotations created from predictions)
+// get no node, and a door does not count them among its labels.
+void BuildElementGraph(const ExtractionSnapshot& snapshot, ElementGraph& graph, size_t threadCount = 0,
+    const GuidHashMap<bool>* ignored = nullptr);
+
+// Writes the graph files and manifest.json into directory, which is created if needed
+HostError WriteElementGraph(const ElementGraph& graph, const std::string& directory);
+
+#endif // ELEMENT_GRAPH_HPP
@@ -0,0 +1,43 @@
+#ifndef ELEMENT_HOST_HPP
+#define ELEMENT_HOST_HPP
+
+#include "HostTypes.hpp"
+
+// Every call the extraction and annotation core makes into Archicad goes through this interface.
+// ACAPIElementHost forwards to the API DevKit, MemoryElementHost serves a loaded model snapshot.
+class IElementHost {
+public:
+    virtual ~IElementHost() = default;
+
+    // ACAPI_Element_GetElemList
+    virtual HostError GetElemList(HostElemType type, std::vector<HostGuid>& guids) = 0;
+    // ACAPI_Element_Get
+    virtual HostError GetElement(const HostGuid& guid, HostElement& element) = 0;
+    // ACAPI_Element_CalcBounds
+    virtual HostError CalcBounds(const HostGuid& guid, HostBox3D& box) = 0;
+    // ACAPI_Element_GetMemo (wallDoors and dimElems only)
+    virtual HostError GetMemo(const HostGuid& guid, HostElementMemo& memo) = 0;
+    // ACAPI_Grouping_GetConnectedElements with API_LabelID
+    virtual HostError GetConnectedLabels(const HostGuid& guid, std::vector<HostGuid>& labels) = 0;
+    // ACAPI_Element_GetElementInfoString
+    virtual HostError GetElementInfoString(const HostGuid& guid, std::string& infoString) = 0;
+    // ACAPI_Element_GetElemTypeName
+    virtual HostError GetElemTypeName(HostElemType type, std::string& name) = 0;
+
+    // ACAPI_Element_GetDefaults + ACAPI_Element_Create
+    virtual HostError CreateDimension(const HostDimensionSpec& spec, HostGuid* newGuid) = 0;
+    virtual HostError CreateLabel(const HostLabelSpec& spec, HostGuid* newGuid) = 0;
+    virtual HostError CreateZone(const HostZoneSpec& spec, HostGuid* newGuid) = 0;
+    // ACAPI_Element_GetDefaultsExt + ACAPI_Element_CreateExt (detail with main marker)
+    virtual HostError CreateDoorMarker(const HostDoorMarkerSpec& spec, HostGuid* newGuid) = 0;
+
+    // ACAPI_Element_Delete
+    virtual HostError DeleteElements(const std::vector<HostGuid>& guids) = 0;
+
+    // Bracket a batch of Create* calls. Element defaults may be fetched once and reused until the run ends,
+    // so tool settings changed in between only apply to the next run.
+    virtual void      BeginAnnotationRun() {}
+    virtual void      EndAnnotationRun() {}
+};
+
+#endif // ELEMENT_HOST_HPP
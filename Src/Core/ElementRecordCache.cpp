@@ -0,0 +1,104 @@
+#include "ElementRecordCache.hpp"
+#include <algorithm>
+
+ElementRecordCache::ElementRecordCache(size_t capacity) :
+    capacity(std::max<size_t>(capacity, 1)),
+    usedCount(0),
+    nextRecord(0),
+    hitCount(0),
+    missCount(0)
+{
+}
+
+ElementRecordCache::Record& ElementRecordCache::FindOrAdd(const HostGuid& guid) {
+    if (const std::uint32_t* position = index.Find(guid))
+        return records[*position];
+
+    if (records.size() < capacity && nextRecord == records.size())
+        records.emplace_back();
+    Record& record = records[nextRecord];
+    if (nextRecord < usedCount)
+        index.Erase(record.guid);
+    else
+        ++usedCount;
+
+    record.guid = guid;
+    record.hasElement = false;
+    record.hasMemo = false;
+    record.hasLabels = false;
+    index.Set(guid, static_cast<std::uint32_t>(nextRecord));
+    nextRecord = (nextRecord + 1) % capacity;
+    return record;
+}
+
+HostError ElementRecordCache::GetElement(IElementHost& host, const HostGuid& guid, HostElement& element) {
+    Record& record = FindOrAdd(guid);
+    if (record.hasElement) {
+        ++hitCount;
+    }
+    else {
+        ++missCount;
+        record.element = HostElement();
+        record.elementErr = host.GetElement(guid, record.element);
+        record.hasElement = true;
+    }
+    if (record.elementErr == HostNoError)
+        element = record.element;
+    return record.elementErr;
+}
+
+HostError ElementRecordCache::GetMemo(IElementHost& host, const HostGuid& guid, HostElementMemo& memo) {
+    Record& record = FindOrAdd(guid);
+    if (record.hasMemo) {
+        ++hitCount;
+    }
+    else {
+        ++missCount;
+        record.memo.wallDoors.clear();
+        record.memo.dimElems.clear();
+        record.memoErr = host.GetMemo(guid, record.memo);
+        record.hasMemo = true;
+    }
+    if (record.memoErr == HostNoError)
+        memo = record.memo;
+    return record.memoErr;
+}
+
+HostError ElementRecordCache::GetConnectedLabels(IElementHost& host, const HostGuid& guid, std::vector<HostGuid>& labels) {
+    Record& record = FindOrAdd(guid);
+    if (record.hasLabels) {
+        ++hitCount;
+    }
+    else {
+        ++missCount;
+        record.labels.clear();
+        record.labelsErr = host.GetConnectedLabels(guid, record.labels);
+        record.hasLabels = true;
+    }
+    if (record.labelsErr == HostNoError)
+        labels = record.labels;
+    return record.labelsErr;
+}
+
+HostError ElementRecordCache::GetElemTypeName(IElementHost& host, HostElemType type, std::string& name) {
+    TypeName& typeName = typeNames[static_cast<size_t>(type)];
+    if (typeName.hasName) {
+        ++hitCount;
+    }
+    else {
+        ++missCount;
+        typeName.err = host.GetElemTypeName(type, typeName.name);
+        typeName.hasName = true;
+    }
+    if (typeName.err == HostNoError)
+        name = typeName.name;
+    return typeName.err;
+}
+
+void ElementRecordCache::Clear() {
+    index.Clear();
+    for (TypeName& typeName : typeNames)
+        typeName.hasName = false;
+    usedCount = 0;
+    nextRecord = 0;
+}
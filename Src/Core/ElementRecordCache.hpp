@@ -0,0 +1,71 @@
+#ifndef ELEMENT_RECORD_CACHE_HPP
+#define ELEMENT_RECORD_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ElementHost.hpp"
+#include "GuidHashMap.hpp"
+
+// What the host returned for an element during one extraction run: the element, its memo and its
+// connected labels, each fetched on first use. Same calls as IElementHost, so a caller only swaps
+// host.GetElement(...) for records.GetElement(host, ...). Type names are kept per HostElemType, they
+// are the same for every element of a type.
+//
+// Records are kept in a ring of fixed capacity: a full run touches every element once, so keeping
+// all of them would only cost memory, while the repeated lookups (a door and its labels within one
+// report, the dirty elements of an incremental update) are close together. Nothing is validated
+// against the model, so the cache must be cleared before the model can change (ExtractionSession::Reset).
+class ElementRecordCache {
+public:
+    static constexpr size_t DefaultCapacity = 4096;
+
+    explicit ElementRecordCache(size_t capacity = DefaultCapacity);
+
+    HostError GetElement(IElementHost& host, const HostGuid& guid, HostElement& element);
+    HostError GetMemo(IElementHost& host, const HostGuid& guid, HostElementMemo& memo);
+    HostError GetConnectedLabels(IElementHost& host, const HostGuid& guid, std::vector<HostGuid>& labels);
+    HostError GetElemTypeName(IElementHost& host, HostElemType type, std::string& name);
+
+    // Forgets every record, the ring keeps its memory
+    void      Clear();
+
+    size_t    GetSize() const { return index.GetSize(); }
+    size_t    GetHitCount() const { return hitCount; }
+    size_t    GetMissCount() const { return missCount; }
+
+private:
+    struct Record {
+        HostGuid              guid;
+        bool                  hasElement = false;
+        bool                  hasMemo = false;
+        bool                  hasLabels = false;
+        HostError             elementErr = HostNoError;
+        HostError             memoErr = HostNoError;
+        HostError             labelsErr = HostNoError;
+        HostElement           element;
+        HostElementMemo       memo;
+        std::vector<HostGuid> labels;
+    };
+
+    // Name of one element type, fetched once per run
+    struct TypeName {
+        bool        hasName = false;
+        HostError   err = HostNoError;
+        std::string name;
+    };
+
+    // Record of guid, a new one replaces the oldest record once the ring is full
+    Record&   FindOrAdd(const HostGuid& guid);
+
+    size_t                      capacity;
+    std::vector<Record>         records;
+    size_t                      usedCount;      // records holding an element, up to capacity
+    size_t                      nextRecord;     // the ring position written next
+    GuidHashMap<std::uint32_t>  index;
+    TypeName                    typeNames[static_cast<size_t>(HostElemType::Detail) + 1];
+    size_t                      hitCount;
+    size_t                      missCount;
+};
+
+#endif // ELEMENT_RECORD_CACHE_HPP
@@ -0,0 +1,72 @@
+#ifndef ELEMENT_REPORT_HPP
+#define ELEMENT_REPORT_HPP
+
+#include <string>
+#include <vector>
+#include "HostTypes.hpp"
+
+// Everything extraction learns about one element, before it is formatted into any output
+
+struct LabelReport {
+    HostGuid      guid;
+    std::uint64_t modiStamp = 0;
+    bool          hasBounds = false;
+    HostBox3D     bounds;
+};
+
+struct ElementReport {
+    HostGuid     guid;
+    HostElemType type = HostElemType::Unknown;
+    std::uint64_t modiStamp = 0;
+    bool         hasTypeName = false;
+    std::string  typeName;
+
+    // Zones
+    HostGuid     stampGuid;
+    HostCoord    pos;
+    std::string  roomName;
+    std::string  roomNoStr;
+    double       roomHeight = 0.0;
+    bool         hasStampBounds = false;
+    HostBox3D    stampBounds;
+
+    // Doors
+    double       width = 0.0;
+    double       height = 0.0;
+    HostGuid     markGuid;
+    std::vector<LabelReport> labels;
+    bool         hasWall = false;
+    HostGuid     wallGuid;
+
+    // Walls
+    double       wallLength = 0.0;
+    double       wallThickness = 0.0;
+    double       wallHeight = 0.0;
+    std::vector<HostGuid> embeddedDoors;
+
+    bool         hasInfoString = false;
+    std::string  infoString;
+    bool         hasBounds = false;
+    HostBox3D    bounds;
+    int          labelType = 0;
+};
+
+struct DimNodeReport {
+    int          index = 0;         // running DimNode counter across all dimensions
+    HostDimElem  dimElem;
+    float        bounds[6] = {};    // thin box around the dimension point
+    HostBox3D    noteBounds;
+};
+
+struct DimensionReport {
+    HostGuid     guid;
+    std::uint64_t modiStamp = 0;
+    bool         hasMemo = false;
+    std::vector<DimNodeReport> nodes;
+    bool         hasBounds = false;
+    HostBox3D    bounds;
+    double       totalLength = 0.0;
+    int          index = 0;         // running Dim counter, valid when hasBounds
+};
+
+#endif // ELEMENT_REPORT_HPP
@@ -0,0 +1,215 @@
+#include "ExtractionProfiler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+const char* ProfileCounterToString(ProfileCounter counter) {
+    switch (counter) {
+    case ProfileCounter::ProcessBuildingElements:   return "ProcessBuildingElements";
+    case ProfileCounter::ReportDimension:           return "ReportDimension";
+    case ProfileCounter::ReportWall:                return "ReportWall";
+    case ProfileCounter::ReportSlab:                return "ReportSlab";
+    case ProfileCounter::ReportZone:                return "ReportZone";
+    case ProfileCounter::ReportDoor:                return "ReportDoor";
+    case ProfileCounter::UpdateExtraction:          return "UpdateExtraction";
+    case ProfileCounter::OutputAdditionalInfo:      return "OutputAdditionalInfo";
+    case ProfileCounter::WriteTextReport:           return "WriteTextReport";
+    case ProfileCounter::WriteColumnarReport:       return "WriteColumnarReport";
+    case ProfileCounter::WriteElementGraph:         return "WriteElementGraph";
+    case ProfileCounter::GetElemList:               return "GetElemList";
+    case ProfileCounter::GetElement:                return "GetElement";
+    case ProfileCounter::CalcBounds:                return "CalcBounds";
+    case ProfileCounter::GetMemo:                   return "GetMemo";
+    case ProfileCounter::GetConnectedLabels:        return "GetConnectedLabels";
+    case ProfileCounter::GetElementInfoString:      return "GetElementInfoString";
+    case ProfileCounter::GetElemTypeName:           return "GetElemTypeName";
+    case ProfileCounter::CreateDimension:           return "CreateDimension";
+    case ProfileCounter::CreateLabel:               return "CreateLabel";
+    case ProfileCounter::CreateZone:                return "CreateZone";
+    case ProfileCounter::CreateDoorMarker:          return "CreateDoorMarker";
+    case ProfileCounter::DeleteElements:            return "DeleteElements";
+    default:                                        return "Unknown";
+    }
+}
+
+// Values below 16 ns get a bucket each, above that every power of two is split into 16 buckets
+int ExtractionProfiler::BucketOf(std::uint64_t nanoseconds) {
+    const std::uint64_t subBucketCount = 1 << SubBucketBits;
+    if (nanoseconds < subBucketCount)
+        return static_cast<int>(nanoseconds);
+
+    int topBit = 63;
+    while ((nanoseconds >> topBit) == 0)
+        --topBit;
+    int shift = topBit - SubBucketBits;
+    int subBucket = static_cast<int>((nanoseconds >> shift) & (subBucketCount - 1));
+    return ((shift + 1) << SubBucketBits) + subBucket;
+}
+
+std::uint64_t ExtractionProfiler::BucketMidpoint(int bucket) {
+    const int subBucketCount = 1 << SubBucketBits;
+    if (bucket < subBucketCount)
+        return static_cast<std::uint64_t>(bucket);
+
+    int shift = (bucket >> SubBucketBits) - 1;
+    std::uint64_t lower = static_cast<std::uint64_t>(subBucketCount + (bucket & (subBucketCount - 1))) << shift;
+    return lower + ((std::uint64_t(1) << shift) >> 1);
+}
+
+void ExtractionProfiler::AddSample(ProfileCounter counter, Clock::duration duration) {
+    Stats& counterStats = stats[Index(counter)];
+    std::uint64_t nanoseconds = static_cast<std::uint64_t>(std::max<std::int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), 0));
+
+    if (counterStats.buckets.empty())
+        counterStats.buckets.resize(BucketCount);
+    ++counterStats.buckets[BucketOf(nanoseconds)];
+    ++counterStats.callCount;
+    counterStats.totalNanoseconds += nanoseconds;
+    counterStats.maxNanoseconds = std::max(counterStats.maxNanoseconds, nanoseconds);
+}
+
+void ExtractionProfiler::AddBytes(ProfileCounter counter, std::uint64_t bytes) {
+    stats[Index(counter)].bytesWritten += bytes;
+}
+
+void ExtractionProfiler::Clear() {
+    for (Stats& counterStats : stats) {
+        counterStats.callCount = 0;
+        counterStats.totalNanoseconds = 0;
+        counterStats.maxNanoseconds = 0;
+        counterStats.bytesWritten = 0;
+        std::fill(counterStats.buckets.begin(), counterStats.buckets.end(), 0);
+    }
+}
+
+double ExtractionProfiler::Percentile(const Stats& counterStats, double fraction) {
+    if (counterStats.callCount == 0)
+        return 0.0;
+
+    // Rank of the sample, counted from 1
+    std::uint64_t rank = std::max<std::uint64_t>(static_cast<std::uint64_t>(fraction * counterStats.callCount + 0.5), 1);
+    std::uint64_t seen = 0;
+    for (int bucket = 0; bucket < BucketCount; ++bucket) {
+        seen += counterStats.buckets[bucket];
+        if (seen >= rank)
+            return std::min(BucketMidpoint(bucket), counterStats.maxNanoseconds) * 1e-9;
+    }
+    return counterStats.maxNanoseconds * 1e-9;
+}
+
+std::vector<ExtractionProfiler::Summary> ExtractionProfiler::GetSummaries() const {
+    std::vector<Summary> summaries;
+    for (size_t i = 0; i < static_cast<size_t>(ProfileCounter::Count); ++i) {
+        const Stats& counterStats = stats[i];
+        if (counterStats.callCount == 0 && counterStats.bytesWritten == 0)
+            continue;
+        summaries.push_back({
+            static_cast<ProfileCounter>(i),
+            counterStats.callCount,
+            counterStats.totalNanoseconds * 1e-9,
+            Percentile(counterStats, 0.50),
+            Percentile(counterStats, 0.99),
+            counterStats.maxNanoseconds * 1e-9,
+            counterStats.bytesWritten
+        });
+    }
+    return summaries;
+}
+
+std::vector<std::string> ExtractionProfiler::FormatSummary() const {
+    std::vector<std::string> lines;
+    char line[256];
+    for (const Summary& summary : GetSummaries()) {
+        int length = snprintf(line, sizeof(line), "%-24s %8llu calls  total %10.3f ms  p50 %9.1f us  p99 %9.1f us  max %9.1f us",
+            ProfileCounterToString(summary.counter), static_cast<unsigned long long>(summary.callCount),
+            summary.totalSeconds * 1e3, summary.p50Seconds * 1e6, summary.p99Seconds * 1e6, summary.maxSeconds * 1e6);
+        if (summary.bytesWritten > 0 && length > 0 && static_cast<size_t>(length) < sizeof(line))
+            snprintf(line + length, sizeof(line) - length, "  %llu bytes", static_cast<unsigned long long>(summary.bytesWritten));
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+HostError ExtractionProfiler::WriteJson(const std::string& filePath) const {
+    std::ofstream outFile(filePath);
+    if (!outFile.is_open())
+        return HostErrFileIO;
+
+    // Seconds with nanosecond resolution
+    outFile.precision(9);
+    outFile << std::fixed << "{\n  \"counters\": [";
+    std::vector<Summary> summaries = GetSummaries();
+    for (size_t i = 0; i < summaries.size(); ++i) {
+        const Summary& summary = summaries[i];
+        outFile << (i == 0 ? "\n" : ",\n") << "    { \"name\": \"" << ProfileCounterToString(summary.counter)
+            << "\", \"calls\": " << summary.callCount
+            << ", \"totalSeconds\": " << summary.totalSeconds
+            << ", \"p50Seconds\": " << summary.p50Seconds
+            << ", \"p99Seconds\": " << summary.p99Seconds
+            << ", \"maxSeconds\": " << summary.maxSeconds
+            << ", \"bytesWritten\": " << summary.bytesWritten << " }";
+    }
+    outFile << "\n  ]\n}\n";
+    return outFile.good() ? HostNoError : HostErrFileIO;
+}
+
+HostError ProfilingElementHost::GetElemList(HostElemType type, std::vector<HostGuid>& guids) {
+    ProfileScope scope(&profiler, ProfileCounter::GetElemList);
+    return host.GetElemList(type, guids);
+}
+
+HostError ProfilingElementHost::GetElement(const HostGuid& guid, HostElement& element) {
+    ProfileScope scope(&profiler, ProfileCounter::GetElement);
+    return host.GetElement(guid, element);
+}
+
+HostError ProfilingElementHost::CalcBounds(const HostGuid& guid, HostBox3D& box) {
+    ProfileScope scope(&profiler, ProfileCounter::CalcBounds);
+    return host.CalcBounds(guid, box);
+}
+
+HostError ProfilingElementHost::GetMemo(const HostGuid& guid, HostElementMemo& memo) {
+    ProfileScope scope(&profiler, ProfileCounter::GetMemo);
+    return host.GetMemo(guid, memo);
+}
+
+HostError ProfilingElementHost::GetConnectedLabels(const HostGuid& guid, std::vector<HostGuid>& labels) {
+    ProfileScope scope(&profiler, ProfileCounter::GetConnectedLabels);
+    return host.GetConnectedLabels(guid, labels);
+}
+
+HostError ProfilingElementHost::GetElementInfoString(const HostGuid& guid, std::string& infoString) {
+    ProfileScope scope(&profiler, ProfileCounter::GetElementInfoString);
+    return host.GetElementInfoString(guid, infoString);
+}
+
+HostError ProfilingElementHost::GetElemTypeName(HostElemType type, std::string& name) {
+    ProfileScope scope(&profiler, ProfileCounter::GetElemTypeName);
+    return host.GetElemTypeName(type, name);
+}
+
+HostError ProfilingElementHost::CreateDimension(const HostDimensionSpec& spec, HostGuid* newGuid) {
+    ProfileScope scope(&profiler, ProfileCounter::CreateDimension);
+    return host.CreateDimension(spec, newGuid);
+}
+
+HostError ProfilingElementHost::CreateLabel(const HostLabelSpec& spec, HostGuid* newGuid) {
+    ProfileScope scope(&profiler, ProfileCounter::CreateLabel);
+    return host.CreateLabel(spec, newGuid);
+}
+
+HostError ProfilingElementHost::CreateZone(const HostZoneSpec& spec, HostGuid* newGuid) {
+    ProfileScope scope(&profiler, ProfileCounter::CreateZone);
+    return host.CreateZone(spec, newGuid);
+}
+
+HostError ProfilingElementHost::CreateDoorMarker(const HostDoorMarkerSpec& spec, HostGuid* newGuid) {
+    ProfileScope scope(&profiler, ProfileCounter::CreateDoorMarker);
+    return host.CreateDoorMarker(spec, newGuid);
+}
+
+HostError ProfilingElementHost::DeleteElements(const std::vector<HostGuid>& guids) {
+    ProfileScope scope(&profiler, ProfileCounter::DeleteElements);
+    return host.DeleteElements(guids);
+}
@@ -0,0 +1,149 @@
+#ifndef EXTRACTION_PROFILER_HPP
+#define EXTRACTION_PROFILER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ElementHost.hpp"
+
+// What the profiler measures. Phases nest: a report phase runs inside ProcessBuildingElements,
+// host calls run inside the phases.
+enum class ProfileCounter {
+    // Extraction phases
+    ProcessBuildingElements,
+    ReportDimension,
+    ReportWall,
+    ReportSlab,
+    ReportZone,
+    ReportDoor,
+    UpdateExtraction,
+    OutputAdditionalInfo,
+    WriteTextReport,
+    WriteColumnarReport,
+    WriteElementGraph,
+
+    // IElementHost calls
+    GetElemList,
+    GetElement,
+    CalcBounds,
+    GetMemo,
+    GetConnectedLabels,
+    GetElementInfoString,
+    GetElemTypeName,
+    CreateDimension,
+    CreateLabel,
+    CreateZone,
+    CreateDoorMarker,
+    DeleteElements,
+
+    Count
+};
+
+const char* ProfileCounterToString(ProfileCounter counter);
+
+// Call counts, latencies and output sizes of one or more extraction runs. Latencies go into a
+// log-linear histogram (16 buckets per power of two), so a percentile is exact to about 6% and
+// recording a sample never allocates. Not thread-safe, one profiler per extracting thread.
+class ExtractionProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Summary {
+        ProfileCounter counter;
+        std::uint64_t  callCount;
+        double         totalSeconds;
+        double         p50Seconds;
+        double         p99Seconds;
+        double         maxSeconds;
+        std::uint64_t  bytesWritten;
+    };
+
+    void          AddSample(ProfileCounter counter, Clock::duration duration);
+    void          AddBytes(ProfileCounter counter, std::uint64_t bytes);
+    void          Clear();
+
+    std::uint64_t GetCallCount(ProfileCounter counter) const { return stats[Index(counter)].callCount; }
+
+    // Counters that were used, in ProfileCounter order
+    std::vector<Summary> GetSummaries() const;
+
+    // One line per used counter, for the Report window or a console
+    std::vector<std::string> FormatSummary() const;
+    HostError     WriteJson(const std::string& filePath) const;
+
+private:
+    static constexpr int SubBucketBits = 4;
+    static constexpr int BucketCount = (64 - SubBucketBits + 1) << SubBucketBits;
+
+    struct Stats {
+        std::uint64_t callCount = 0;
+        std::uint64_t totalNanoseconds = 0;
+        std::uint64_t maxNanoseconds = 0;
+        std::uint64_t bytesWritten = 0;
+        std::vector<std::uint32_t> buckets;     // allocated with the first sample
+    };
+
+    static size_t        Index(ProfileCounter counter) { return static_cast<size_t>(counter); }
+    static int           BucketOf(std::uint64_t nanoseconds);
+    static std::uint64_t BucketMidpoint(int bucket);
+    static double        Percentile(const Stats& stats, double fraction);
+
+    Stats stats[static_cast<size_t>(ProfileCounter::Count)];
+};
+
+// Adds the time from construction to destruction to a counter. A null profiler measures nothing,
+// so call sites can stay in place when profiling is off.
+class ProfileScope {
+public:
+    ProfileScope(ExtractionProfiler* profiler, ProfileCounter counter) :
+        profiler(profiler),
+        counter(counter),
+        start(profiler != nullptr ? ExtractionProfiler::Clock::now() : ExtractionProfiler::Clock::time_point())
+    {
+    }
+
+    ~ProfileScope() {
+        if (profiler != nullptr)
+            profiler->AddSample(counter, ExtractionProfiler::Clock::now() - start);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ExtractionProfiler*                   profiler;
+    ProfileCounter                        counter;
+    ExtractionProfiler::Clock::time_point start;
+};
+
+// Forwards every call to another host and times it, so each host call site is measured without
+// touching it. The wrapped host and the profiler must outlive this one.
+class ProfilingElementHost : public IElementHost {
+public:
+    ProfilingElementHost(IElementHost& host, ExtractionProfiler& profiler) : host(host), profiler(profiler) {}
+
+    HostError GetElemList(HostElemType type, std::vector<HostGuid>& guids) override;
+    HostError GetElement(const HostGuid& guid, HostElement& element) override;
+    HostError CalcBounds(const HostGuid& guid, HostBox3D& box) override;
+    HostError GetMemo(const HostGuid& guid, HostElementMemo& memo) override;
+    HostError GetConnectedLabels(const HostGuid& guid, std::vector<HostGuid>& labels) override;
+    HostError GetElementInfoString(const HostGuid& guid, std::string& infoString) override;
+    HostError GetElemTypeName(HostElemType type, std::string& name) override;
+
+    HostError CreateDimension(const HostDimensionSpec& spec, HostGuid* newGuid) override;
+    HostError CreateLabel(const HostLabelSpec& spec, HostGuid* newGuid) override;
+    HostError CreateZone(const HostZoneSpec& spec, HostGuid* newGuid) override;
+    HostError CreateDoorMarker(const HostDoorMarkerSpec& spec, HostGuid* newGuid) override;
+
+    HostError DeleteElements(const std::vector<HostGuid>& guids) override;
+
+    void      BeginAnnotationRun() override { host.BeginAnnotationRun(); }
+    void      EndAnnotationRun() override { host.EndAnnotationRun(); }
+
+private:
+    IElementHost&       host;
+    ExtractionProfiler& profiler;
+};
+
+#endif // EXTRACTION_PROFILER_HPP
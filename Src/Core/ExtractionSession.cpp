@@ -0,0 +1,25 @@
+#include "ExtractionSession.hpp"
+
+ExtractionSession::ExtractionSession() :
+    arena(1024 * 1024),
+    zoneStampInfos(arena),
+    doorLabelInfos(arena),
+    dimensionNoteInfos(arena),
+    globalDimElemCount(0),
+    dimElementCount(0),
+    profiler(nullptr),
+    trace(nullptr)
+{
+}
+
+void ExtractionSession::Reset() {
+    arena.Reset();
+    doorToWallMap.Clear();
+    wallHasDimElems.Clear();
+    zoneStampInfos.Clear();
+    doorLabelInfos.Clear();
+    dimensionNoteInfos.Clear();
+    records.Clear();
+    globalDimElemCount = 0;
+    dimElementCount = 0;
+}
@@ -0,0 +1,63 @@
+#ifndef EXTRACTION_SESSION_HPP
+#define EXTRACTION_SESSION_HPP
+
+#include <string_view>
+#include "Arena.hpp"
+#include "BoundsCache.hpp"
+#include "ElementRecordCache.hpp"
+#include "ExtractionProfiler.hpp"
+#include "GuidHashMap.hpp"
+#include "HostTypes.hpp"
+#include "TraceRecorder.hpp"
+
+// Collected while reporting, written by OutputAdditionalInfo after all elements
+struct ZoneStampInfo {
+    HostGuid    guid;
+    HostBox3D   boundingBox;
+    const char* infoString = "Zone Stamp";
+};
+
+struct DoorLabelInfo {
+    HostGuid    guid;
+    HostBox3D   boundingBox;
+    const char* infoString = "Door Label";
+};
+
+struct DimensionNoteInfo {
+    HostGuid         guid;
+    HostBox3D        noteBoundingBox;
+    std::string_view noteText;              // in the session arena
+    double           textLength;
+    HostCoord        position;
+    int              globalDimElemCount;
+    const char*      infoString = "Dim Note";
+};
+
+// Everything one extraction run remembers between elements. ProcessBuildingElements resets it
+// at the start of a run; keeping one session across runs reuses its memory instead of growing.
+// The bounds cache is not reset, its boxes stay valid until their element is modified.
+class ExtractionSession {
+public:
+    ExtractionSession();
+
+    ExtractionSession(const ExtractionSession&) = delete;
+    ExtractionSession& operator=(const ExtractionSession&) = delete;
+
+    // Forgets the previous run in O(1), the arena chunks and map tables are kept
+    void Reset();
+
+    Arena                        arena;
+    GuidHashMap<HostGuid>        doorToWallMap;         // filled by walls, read by doors
+    GuidHashMap<bool>            wallHasDimElems;       // filled by dimensions, read by walls
+    ArenaList<ZoneStampInfo>     zoneStampInfos;
+    ArenaList<DoorLabelInfo>     doorLabelInfos;
+    ArenaList<DimensionNoteInfo> dimensionNoteInfos;
+    int                          globalDimElemCount;    // DimNode numbering across all dimensions
+    int                          dimElementCount;       // Dim numbering
+    ElementRecordCache           records;               // host data fetched in this run
+    BoundsCache                  boundsCache;           // kept across runs
+    ExtractionProfiler*          profiler;              // phase timings when not null, kept across runs
+    TraceRecorder*               trace;                 // timeline spans when not null, kept across runs
+};
+
+#endif // EXTRACTION_SESSION_HPP
@@ -0,0 +1,419 @@
+#include "ExtractionSnapshot.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "MappedFile.hpp"
+
+namespace {
+
+const char          SnapshotMagic[8] = { 'E', 'X', 'V', '2', 'S', 'N', 'A', 'P' };
+const std::uint32_t SnapshotVersion = 1;
+
+// Appends the snapshot fields to one buffer, written to the file in one go
+class SnapshotWriter {
+public:
+    void Raw(const void* data, size_t size) { buffer.append(static_cast<const char*>(data), size); }
+
+    template <typename T>
+    void Value(T value) { Raw(&value, sizeof(T)); }
+
+    void Bool(bool value) { Value(static_cast<std::uint8_t>(value ? 1 : 0)); }
+    void Count(size_t count) { Value(static_cast<std::uint32_t>(count)); }
+    void Guid(const HostGuid& guid) { Raw(&guid, sizeof(HostGuid)); }
+    void Coord(const HostCoord& coord) { Value(coord.x); Value(coord.y); }
+    void Box(const HostBox3D& box) { Raw(&box, sizeof(HostBox3D)); }
+
+    void String(const std::string& str) {
+        Count(str.size());
+        Raw(str.data(), str.size());
+    }
+
+    const std::string& GetBuffer() const { return buffer; }
+
+private:
+    std::string buffer;
+};
+
+// Reads the fields back, every read is bounds checked and a short file fails the whole load
+class SnapshotReader {
+public:
+    SnapshotReader(const char* data, size_t size) : data(data), size(size), offset(0), failed(false) {}
+
+    bool IsFailed() const { return failed; }
+    void Fail() { failed = true; }
+
+    void Raw(void* out, size_t count) {
+        if (failed || size - offset < count) {
+            failed = true;
+            std::memset(out, 0, count);
+            return;
+        }
+        std::memcpy(out, data + offset, count);
+        offset += count;
+    }
+
+    template <typename T>
+    T Value() {
+        T value;
+        Raw(&value, sizeof(T));
+        return value;
+    }
+
+    bool Bool() { return Value<std::uint8_t>() != 0; }
+    void Guid(HostGuid& guid) { Raw(&guid, sizeof(HostGuid)); }
+    void Coord(HostCoord& coord) { coord.x = Value<double>(); coord.y = Value<double>(); }
+    void Box(HostBox3D& box) { Raw(&box, sizeof(HostBox3D)); }
+
+    // Counts are checked against the bytes left, so a corrupt count cannot trigger a huge allocation
+    size_t Count(size_t minItemSize) {
+        size_t count = Value<std::uint32_t>();
+        if (failed || count > (size - offset) / minItemSize) {
+            failed = true;
+            return 0;
+        }
+        return count;
+    }
+
+    void String(std::string& str) {
+        size_t length = Count(1);
+        str.assign(failed ? "" : data + offset, length);
+        offset += length;
+    }
+
+private:
+    const char* data;
+    size_t      size;
+    size_t      offset;
+    bool        failed;
+};
+
+static_assert(sizeof(HostBox3D) == 6 * sizeof(double), "HostBox3D is stored as 6 doubles");
+
+void WriteElement(SnapshotWriter& writer, const ElementReport& report) {
+    writer.Guid(report.guid);
+    writer.Value(static_cast<std::uint8_t>(report.type));
+    writer.Value(report.modiStamp);
+    writer.Bool(report.hasTypeName);
+    writer.String(report.typeName);
+
+    writer.Guid(report.stampGuid);
+    writer.Coord(report.pos);
+    writer.String(report.roomName);
+    writer.String(report.roomNoStr);
+    writer.Value(report.roomHeight);
+    writer.Bool(report.hasStampBounds);
+    writer.Box(report.stampBounds);
+
+    writer.Value(report.width);
+    writer.Value(report.height);
+    writer.Guid(report.markGuid);
+    writer.Count(report.labels.size());
+    for (const LabelReport& label : report.labels) {
+        writer.Guid(label.guid);
+        writer.Value(label.modiStamp);
+        writer.Bool(label.hasBounds);
+        writer.Box(label.bounds);
+    }
+    writer.Bool(report.hasWall);
+    writer.Guid(report.wallGuid);
+
+    writer.Value(report.wallLength);
+    writer.Value(report.wallThickness);
+    writer.Value(report.wallHeight);
+    writer.Count(report.embeddedDoors.size());
+    for (const HostGuid& doorGuid : report.embeddedDoors)
+        writer.Guid(doorGuid);
+
+    writer.Bool(report.hasInfoString);
+    writer.String(report.infoString);
+    writer.Bool(report.hasBounds);
+    writer.Box(report.bounds);
+    writer.Value(static_cast<std::int32_t>(report.labelType));
+}
+
+void ReadElement(SnapshotReader& reader, ElementReport& report) {
+    reader.Guid(report.guid);
+    report.type = static_cast<HostElemType>(reader.Value<std::uint8_t>());
+    report.modiStamp = reader.Value<std::uint64_t>();
+    report.hasTypeName = reader.Bool();
+    reader.String(report.typeName);
+
+    reader.Guid(report.stampGuid);
+    reader.Coord(report.pos);
+    reader.String(report.roomName);
+    reader.String(report.roomNoStr);
+    report.roomHeight = reader.Value<double>();
+    report.hasStampBounds = reader.Bool();
+    reader.Box(report.stampBounds);
+
+    report.width = reader.Value<double>();
+    report.height = reader.Value<double>();
+    reader.Guid(report.markGuid);
+    report.labels.resize(reader.Count(sizeof(HostGuid)));
+    for (LabelReport& label : report.labels) {
+        reader.Guid(label.guid);
+        label.modiStamp = reader.Value<std::uint64_t>();
+        label.hasBounds = reader.Bool();
+        reader.Box(label.bounds);
+    }
+    report.hasWall = reader.Bool();
+    reader.Guid(report.wallGuid);
+
+    report.wallLength = reader.Value<double>();
+    report.wallThickness = reader.Value<double>();
+    report.wallHeight = reader.Value<double>();
+    report.embeddedDoors.resize(reader.Count(sizeof(HostGuid)));
+    for (HostGuid& doorGuid : report.embeddedDoors)
+        reader.Guid(doorGuid);
+
+    report.hasInfoString = reader.Bool();
+    reader.String(report.infoString);
+    report.hasBounds = reader.Bool();
+    reader.Box(report.bounds);
+    report.labelType = reader.Value<std::int32_t>();
+}
+
+void WriteDimension(SnapshotWriter& writer, const DimensionReport& report) {
+    writer.Guid(report.guid);
+    writer.Value(report.modiStamp);
+    writer.Bool(report.hasMemo);
+    writer.Count(report.nodes.size());
+    for (const DimNodeReport& node : report.nodes) {
+        writer.Value(static_cast<std::int32_t>(node.index));
+        writer.Guid(node.dimElem.baseGuid);
+        writer.Value(static_cast<std::uint8_t>(node.dimElem.baseType));
+        writer.Coord(node.dimElem.pos);
+        writer.Coord(node.dimElem.notePos);
+        writer.Value(node.dimElem.dimVal);
+        writer.String(node.dimElem.noteText);
+        writer.Raw(node.bounds, sizeof(node.bounds));
+        writer.Box(node.noteBounds);
+    }
+    writer.Bool(report.hasBounds);
+    writer.Box(report.bounds);
+    writer.Value(report.totalLength);
+    writer.Value(static_cast<std::int32_t>(report.index));
+}
+
+void ReadDimension(SnapshotReader& reader, DimensionReport& report) {
+    reader.Guid(report.guid);
+    report.modiStamp = reader.Value<std::uint64_t>();
+    report.hasMemo = reader.Bool();
+    report.nodes.resize(reader.Count(sizeof(HostGuid)));
+    for (DimNodeReport& node : report.nodes) {
+        node.index = reader.Value<std::int32_t>();
+        reader.Guid(node.dimElem.baseGuid);
+        node.dimElem.baseType = static_cast<HostElemType>(reader.Value<std::uint8_t>());
+        reader.Coord(node.dimElem.pos);
+        reader.Coord(node.dimElem.notePos);
+        node.dimElem.dimVal = reader.Value<double>();
+        reader.String(node.dimElem.noteText);
+        reader.Raw(node.bounds, sizeof(node.bounds));
+        reader.Box(node.noteBounds);
+    }
+    report.hasBounds = reader.Bool();
+    reader.Box(report.bounds);
+    report.totalLength = reader.Value<double>();
+    report.index = reader.Value<std::int32_t>();
+}
+
+}
+
+ExtractionSnapshot::ExtractionSnapshot() :
+    removedCount(0)
+{
+}
+
+void ExtractionSnapshot::Clear() {
+    dimensions.clear();
+    for (std::vector<ElementReport>& section : elements)
+        section.clear();
+    index.Clear();
+    removedCount = 0;
+}
+
+int ExtractionSnapshot::SectionOf(HostElemType type) {
+    switch (type) {
+    case HostElemType::Wall:    return 0;
+    case HostElemType::Slab:    return 1;
+    case HostElemType::Zone:    return 2;
+    case HostElemType::Door:    return 3;
+    default:                    return -1;
+    }
+}
+
+void ExtractionSnapshot::SetElement(const ElementReport& report) {
+    int section = SectionOf(report.type);
+    if (section < 0)
+        return;
+
+    Location* location = index.Find(report.guid);
+    if (location != nullptr && location->section == section) {
+        elements[section][location->position] = report;
+        return;
+    }
+    if (location != nullptr)
+        Remove(report.guid);
+
+    Location newLocation;
+    newLocation.section = static_cast<std::uint8_t>(section);
+    newLocation.position = static_cast<std::uint32_t>(elements[section].size());
+    elements[section].push_back(report);
+    index.Set(report.guid, newLocation);
+}
+
+void ExtractionSnapshot::SetDimension(const DimensionReport& report) {
+    Location* location = index.Find(report.guid);
+    if (location != nullptr && location->section == DimensionSection) {
+        dimensions[location->position] = report;
+        return;
+    }
+    if (location != nullptr)
+        Remove(report.guid);
+
+    Location newLocation;
+    newLocation.section = DimensionSection;
+    newLocation.position = static_cast<std::uint32_t>(dimensions.size());
+    dimensions.push_back(report);
+    index.Set(report.guid, newLocation);
+}
+
+bool ExtractionSnapshot::Remove(const HostGuid& guid) {
+    const Location* location = index.Find(guid);
+    if (location == nullptr)
+        return false;
+
+    // Positions of the later reports stay valid until Compact
+    if (location->section == DimensionSection)
+        dimensions[location->position].guid = HostNullGuid;
+    else
+        elements[location->section][location->position].guid = HostNullGuid;
+    index.Erase(guid);
+    ++removedCount;
+    return true;
+}
+
+void ExtractionSnapshot::Compact() {
+    if (removedCount > 0) {
+        auto isRemoved = [](const auto& report) { return report.guid == HostNullGuid; };
+        dimensions.erase(std::remove_if(dimensions.begin(), dimensions.end(), isRemoved), dimensions.end());
+        for (std::vector<ElementReport>& section : elements)
+            section.erase(std::remove_if(section.begin(), section.end(), isRemoved), section.end());
+        removedCount = 0;
+        Reindex();
+    }
+
+    // Same numbering as CollectDimensionReport gives in one run over all dimensions
+    int nodeIndex = 0;
+    int dimensionIndex = 0;
+    for (DimensionReport& report : dimensions) {
+        for (DimNodeReport& node : report.nodes)
+            node.index = nodeIndex++;
+        if (report.hasBounds)
+            report.index = ++dimensionIndex;
+    }
+}
+
+void ExtractionSnapshot::Reindex() {
+    size_t count = dimensions.size();
+    for (const std::vector<ElementReport>& section : elements)
+        count += section.size();
+
+    index.Clear();
+    index.Reserve(count);
+
+    Location location;
+    location.section = DimensionSection;
+    for (size_t i = 0; i < dimensions.size(); ++i) {
+        location.position = static_cast<std::uint32_t>(i);
+        index.Set(dimensions[i].guid, location);
+    }
+    for (std::uint8_t section = 0; section < 4; ++section) {
+        location.section = section;
+        for (size_t i = 0; i < elements[section].size(); ++i) {
+            location.position = static_cast<std::uint32_t>(i);
+            index.Set(elements[section][i].guid, location);
+        }
+    }
+}
+
+const ElementReport* ExtractionSnapshot::FindElement(const HostGuid& guid) const {
+    const Location* location = index.Find(guid);
+    if (location == nullptr || location->section == DimensionSection)
+        return nullptr;
+    return &elements[location->section][location->position];
+}
+
+const DimensionReport* ExtractionSnapshot::FindDimension(const HostGuid& guid) const {
+    const Location* location = index.Find(guid);
+    if (location == nullptr || location->section != DimensionSection)
+        return nullptr;
+    return &dimensions[location->position];
+}
+
+const std::vector<ElementReport>& ExtractionSnapshot::GetElements(HostElemType type) const {
+    static const std::vector<ElementReport> noElements;
+    int section = SectionOf(type);
+    return section < 0 ? noElements : elements[section];
+}
+
+HostError ExtractionSnapshot::Save(const std::string& filePath) const {
+    SnapshotWriter writer;
+    writer.Raw(SnapshotMagic, sizeof(SnapshotMagic));
+    writer.Value(SnapshotVersion);
+
+    auto isKept = [](const auto& report) { return report.guid != HostNullGuid; };
+    writer.Count(std::count_if(dimensions.begin(), dimensions.end(), isKept));
+    for (const DimensionReport& report : dimensions) {
+        if (isKept(report))
+            WriteDimension(writer, report);
+    }
+    for (const std::vector<ElementReport>& section : elements) {
+        writer.Count(std::count_if(section.begin(), section.end(), isKept));
+        for (const ElementReport& report : section) {
+            if (isKept(report))
+                WriteElement(writer, report);
+        }
+    }
+
+    std::ofstream outFile(filePath, std::ios::binary);
+    if (!outFile.is_open())
+        return HostErrFileIO;
+    outFile.write(writer.GetBuffer().data(), static_cast<std::streamsize>(writer.GetBuffer().size()));
+    outFile.close();
+    return outFile.fail() ? HostErrFileIO : HostNoError;
+}
+
+HostError ExtractionSnapshot::Load(const std::string& filePath) {
+    Clear();
+
+    MappedFile file;
+    HostError err = file.Open(filePath);
+    if (err != HostNoError)
+        return err;
+
+    SnapshotReader reader(file.GetData(), file.GetSize());
+    char magic[sizeof(SnapshotMagic)];
+    reader.Raw(magic, sizeof(magic));
+    if (reader.IsFailed() || std::memcmp(magic, SnapshotMagic, sizeof(magic)) != 0 || reader.Value<std::uint32_t>() != SnapshotVersion)
+        return HostErrBadFormat;
+
+    dimensions.resize(reader.Count(sizeof(HostGuid)));
+    for (DimensionReport& report : dimensions)
+        ReadDimension(reader, report);
+    for (int section = 0; section < 4 && !reader.IsFailed(); ++section) {
+        elements[section].resize(reader.Count(sizeof(HostGuid)));
+        for (ElementReport& report : elements[section]) {
+            ReadElement(reader, report);
+            if (SectionOf(report.type) != section)
+                reader.Fail();
+        }
+    }
+
+    if (reader.IsFailed()) {
+        Clear();
+        return HostErrBadFormat;
+    }
+    Reindex();
+    return HostNoError;
+}
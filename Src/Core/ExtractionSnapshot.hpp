@@ -0,0 +1,66 @@
+#ifndef EXTRACTION_SNAPSHOT_HPP
+#define EXTRACTION_SNAPSHOT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ElementReport.hpp"
+#include "GuidHashMap.hpp"
+
+// The reports of the last extraction run in walk order (dimensions, then walls, slabs, zones and
+// doors), indexed by GUID. Incremental extraction replaces the reports of changed elements and
+// writes the text and columnar reports from here instead of walking the whole model again.
+//
+// Saved as a binary file (little-endian):
+//   char[8]  magic "EXV2SNAP"
+//   uint32   version
+//   uint32   dimension count, dimension reports
+//   for walls, slabs, zones and doors: uint32 count, element reports
+// Reports are stored field by field in ElementReport/DimensionReport order, GUIDs as 16 raw bytes,
+// strings as uint32 length and bytes, vectors as uint32 count and items.
+class ExtractionSnapshot {
+public:
+    ExtractionSnapshot();
+
+    bool   IsEmpty() const { return index.IsEmpty(); }
+    size_t GetReportCount() const { return index.GetSize(); }
+    void   Clear();
+
+    // Replaces the report with the same GUID in place, or adds it at the end of its section
+    void   SetElement(const ElementReport& report);
+    void   SetDimension(const DimensionReport& report);
+
+    // Forgets the report of guid, the gap is closed by Compact. Returns false if there was none.
+    bool   Remove(const HostGuid& guid);
+
+    // Drops removed reports and renumbers Dim and DimNode indices in walk order, as a full run would
+    void   Compact();
+
+    const ElementReport*   FindElement(const HostGuid& guid) const;
+    const DimensionReport* FindDimension(const HostGuid& guid) const;
+
+    // Sections in walk order. Removed reports have a null GUID until Compact.
+    const std::vector<DimensionReport>& GetDimensions() const { return dimensions; }
+    const std::vector<ElementReport>&   GetElements(HostElemType type) const;
+
+    HostError Save(const std::string& filePath) const;
+    HostError Load(const std::string& filePath);
+
+private:
+    static constexpr std::uint8_t DimensionSection = 4;
+
+    struct Location {
+        std::uint8_t  section = 0;      // element section (SectionOf) or DimensionSection
+        std::uint32_t position = 0;
+    };
+
+    static int SectionOf(HostElemType type);
+    void       Reindex();
+
+    std::vector<DimensionReport> dimensions;
+    std::vector<ElementReport>   elements[4];
+    GuidHashMap<Location>        index;
+    size_t                       removedCount;
+};
+
+#endif // EXTRACTION_SNAPSHOT_HPP
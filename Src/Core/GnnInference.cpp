@@ -0,0 +1,622 @@
+#include "GnnInference.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include "GnnKernels.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+
+// Rows computed per task, small enough that a block's scratch stays in the L2 cache
+constexpr size_t GnnBlockRows = 256;
+
+// Calls body(begin, end) for the blocks of [0, count), on the pool if there is one
+void ForEachBlock(ThreadPool* pool, size_t count, const std::function<void(size_t, size_t)>& body) {
+    if (pool == nullptr) {
+        for (size_t begin = 0; begin < count; begin += GnnBlockRows)
+            body(begin, std::min(begin + GnnBlockRows, count));
+        return;
+    }
+    ParallelForChunks(*pool, count, GnnBlockRows, [&](size_t, size_t begin, size_t end) { body(begin, end); });
+}
+
+// Column of every model feature in the graph's features of the same node type, -1 if missing
+std::vector<std::int64_t> FindFeatureColumns(const GnnNodeInput& input, const GraphNodeSet& nodeSet) {
+    std::vector<std::int64_t> columns(input.GetFeatureCount(), -1);
+    for (size_t feature = 0; feature < input.GetFeatureCount(); ++feature) {
+        for (size_t column = 0; column < nodeSet.GetFeatureCount(); ++column) {
+            if (input.featureNames[feature] == nodeSet.featureNames[column]) {
+                columns[feature] = static_cast<std::int64_t>(column);
+                break;
+            }
+        }
+    }
+    return columns;
+}
+
+// Largest of 0 and x
+float MaxValue(const float* x, size_t count) {
+    float maxValue = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+        maxValue = std::max(maxValue, x[i]);
+    return maxValue;
+}
+
+// Scales turning the int32 sums of GnnDenseInt8 with weights back to floats
+std::vector<float> SumScales(const GnnQuantizedWeights& weights) {
+    std::vector<float> scales(weights.scales.size());
+    for (size_t output = 0; output < scales.size(); ++output)
+        scales[output] = weights.scales[output] * weights.inputScale;
+    return scales;
+}
+
+// Pool for threadCount threads (0: every hardware thread), but not more than there are blocks of
+// rowCount rows. The waiting thread works too, so one less background worker; nullptr for one thread.
+std::unique_ptr<ThreadPool> MakeThreadPool(size_t threadCount, size_t rowCount) {
+    if (threadCount == 0)
+        threadCount = ThreadPool::GetHardwareThreadCount();
+    threadCount = std::min(threadCount, (rowCount + GnnBlockRows - 1) / GnnBlockRows);
+    return threadCount > 1 ? std::make_unique<ThreadPool>(threadCount - 1) : nullptr;
+}
+
+// h0 of count nodes of input into out, rowOf(k) giving the row of the k-th in nodeSet
+template <typename RowOf>
+void InputLayerRows(const GnnNodeInput& input, const GraphNodeSet& nodeSet, const std::vector<std::int64_t>& columns, size_t hiddenSize,
+    size_t count, RowOf rowOf, float* out)
+{
+    size_t featureCount = input.GetFeatureCount();
+    std::vector<float> x(count * featureCount);
+    for (size_t k = 0; k < count; ++k) {
+        const float* features = nodeSet.GetRow(rowOf(k));
+        float* xRow = x.data() + k * featureCount;
+        for (size_t feature = 0; feature < featureCount; ++feature) {
+            float value = features[columns[feature]];
+            xRow[feature] = std::isnan(value) ? 0.0f : (value - input.featureMeans[feature]) * input.featureScales[feature];
+        }
+    }
+    GnnDense(x.data(), count, featureCount, input.weights.data(), input.bias.data(), hiddenSize, out, false);
+    GnnRelu(out, count * hiddenSize);
+}
+
+// hl+1 of count nodes into out, from their hl rows (self) and the means of their neighbours' (aggregated)
+void LayerRows(const GnnModel& model, const GnnLayer& layer, const std::vector<float>& selfScales, const std::vector<float>& neighbourScales,
+    size_t count, const float* self, const float* aggregated, float* out)
+{
+    const size_t hiddenSize = model.hiddenSize;
+    size_t valueCount = count * hiddenSize;
+    if (model.quantized) {
+        std::vector<std::uint8_t> quantizedInput(valueCount);
+        GnnQuantize(self, valueCount, layer.quantizedSelfWeights.inputScale, quantizedInput.data());
+        GnnDenseInt8(quantizedInput.data(), count, hiddenSize, layer.quantizedSelfWeights.values.data(), selfScales.data(),
+            layer.bias.data(), hiddenSize, out, false);
+        GnnQuantize(aggregated, valueCount, layer.quantizedNeighbourWeights.inputScale, quantizedInput.data());
+        GnnDenseInt8(quantizedInput.data(), count, hiddenSize, layer.quantizedNeighbourWeights.values.data(),
+            neighbourScales.data(), nullptr, hiddenSize, out, true);
+    }
+    else {
+        GnnDense(self, count, hiddenSize, layer.selfWeights.data(), layer.bias.data(), hiddenSize, out, false);
+        GnnDense(aggregated, count, hiddenSize, layer.neighbourWeights.data(), nullptr, hiddenSize, out, true);
+    }
+    GnnRelu(out, valueCount);
+}
+
+// Label type and confidence of count nodes from their last layer rows h, the caller sets type and row
+void OutputRows(const GnnModel& model, const std::vector<float>& outputScales, size_t count, const float* h, GnnPrediction* predictions) {
+    const size_t hiddenSize = model.hiddenSize;
+    const size_t classCount = model.GetClassCount();
+    std::vector<float> logits(count * classCount);
+    if (model.quantized) {
+        std::vector<std::uint8_t> quantizedInput(count * hiddenSize);
+        GnnQuantize(h, quantizedInput.size(), model.quantizedOutputWeights.inputScale, quantizedInput.data());
+        GnnDenseInt8(quantizedInput.data(), count, hiddenSize, model.quantizedOutputWeights.values.data(), outputScales.data(),
+            model.outputBias.data(), classCount, logits.data(), false);
+    }
+    else {
+        GnnDense(h, count, hiddenSize, model.outputWeights.data(), model.outputBias.data(), classCount, logits.data(), false);
+    }
+    for (size_t k = 0; k < count; ++k) {
+        const float* rowLogits = logits.data() + k * classCount;
+        size_t best = std::max_element(rowLogits, rowLogits + classCount) - rowLogits;
+        float sum = 0.0f;
+        for (size_t c = 0; c < classCount; ++c)
+            sum += std::exp(rowLogits[c] - rowLogits[best]);
+        predictions[k].labelType = model.classLabelTypes[best];
+        predictions[k].confidence = 1.0f / sum;
+    }
+}
+
+// Entries of the sorted nodes in [begin, end)
+std::pair<size_t, size_t> NodeRange(const std::vector<std::uint32_t>& nodes, size_t begin, size_t end) {
+    size_t first = std::lower_bound(nodes.begin(), nodes.end(), begin) - nodes.begin();
+    size_t last = std::lower_bound(nodes.begin() + first, nodes.end(), end) - nodes.begin();
+    return { first, last };
+}
+
+}
+
+GnnInference::GnnInference() :
+    nodeCount(0),
+    hasCache(false),
+    cachedModelChecksum(0),
+    updatedNodeCount(0)
+{
+}
+
+HostError GnnInference::BuildAdjacency(const GnnModel& model, const ElementGraph& graph) {
+    std::int64_t inputOf[GraphNodeTypeCount];
+    std::fill(inputOf, inputOf + GraphNodeTypeCount, -1);
+    inputOffsets.assign(1, 0);
+    for (size_t i = 0; i < model.inputs.size(); ++i) {
+        inputOf[static_cast<size_t>(model.inputs[i].type)] = static_cast<std::int64_t>(i);
+        inputOffsets.push_back(inputOffsets.back() + graph.GetNodes(model.inputs[i].type).GetRowCount());
+    }
+    nodeCount = inputOffsets.back();
+
+    // Edges between two node types of the model, as (first node of the source type, first node of the target type, edge set)
+    struct UsedEdgeSet {
+        size_t              sourceOffset;
+        size_t              targetOffset;
+        const GraphEdgeSet* edgeSet;
+    };
+    std::vector<UsedEdgeSet> usedEdgeSets;
+    for (const std::string& edgeType : model.edgeTypes) {
+        const GraphEdgeSet* edgeSet = graph.FindEdgeSet(edgeType);
+        if (edgeSet == nullptr) {
+            errorMessage = "The element graph has no edge type " + edgeType;
+            return HostErrBadFormat;
+        }
+        std::int64_t sourceInput = inputOf[static_cast<size_t>(edgeSet->source)];
+        std::int64_t targetInput = inputOf[static_cast<size_t>(edgeSet->target)];
+        if (sourceInput >= 0 && targetInput >= 0)
+            usedEdgeSets.push_back({ inputOffsets[sourceInput], inputOffsets[targetInput], edgeSet });
+    }
+
+    // Every edge links both of its nodes: count, prefix sum, then fill
+    offsets.assign(nodeCount + 1, 0);
+    for (const UsedEdgeSet& used : usedEdgeSets) {
+        const GraphEdgeSet& edgeSet = *used.edgeSet;
+        for (size_t sourceRow = 0; sourceRow + 1 < edgeSet.offsets.size(); ++sourceRow) {
+            for (std::uint32_t edge = edgeSet.offsets[sourceRow]; edge < edgeSet.offsets[sourceRow + 1]; ++edge) {
+                ++offsets[used.sourceOffset + sourceRow + 1];
+                ++offsets[used.targetOffset + edgeSet.targets[edge] + 1];
+            }
+        }
+    }
+    for (size_t node = 1; node <= nodeCount; ++node)
+        offsets[node] += offsets[node - 1];
+
+    targets.resize(offsets[nodeCount]);
+    std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (const UsedEdgeSet& used : usedEdgeSets) {
+        const GraphEdgeSet& edgeSet = *used.edgeSet;
+        for (size_t sourceRow = 0; sourceRow + 1 < edgeSet.offsets.size(); ++sourceRow) {
+            std::uint32_t source = static_cast<std::uint32_t>(used.sourceOffset + sourceRow);
+            for (std::uint32_t edge = edgeSet.offsets[sourceRow]; edge < edgeSet.offsets[sourceRow + 1]; ++edge) {
+                std::uint32_t target = static_cast<std::uint32_t>(used.targetOffset + edgeSet.targets[edge]);
+                targets[fill[source]++] = target;
+                targets[fill[target]++] = source;
+            }
+        }
+    }
+    return HostNoError;
+}
+
+
+HostError GnnInference::Prepare(const GnnModel& model, const ElementGraph& graph, std::vector<std::vector<std::int64_t>>& featureColumns) {
+    errorMessage.clear();
+    if (!model.IsConsistent()) {
+        errorMessage = "The model is empty or inconsistent";
+        return HostErrBadFormat;
+    }
+
+    featureColumns.clear();
+    for (const GnnNodeInput& input : model.inputs) {
+        featureColumns.push_back(FindFeatureColumns(input, graph.GetNodes(input.type)));
+        for (size_t feature = 0; feature < input.GetFeatureCount(); ++feature) {
+            if (featureColumns.back()[feature] < 0) {
+                errorMessage = std::string("The ") + GraphNodeTypeName(input.type) + " nodes have no feature " + input.featureNames[feature];
+                return HostErrBadFormat;
+            }
+        }
+    }
+    return BuildAdjacency(model, graph);
+}
+
+HostError GnnInference::Run(const GnnModel& model, const ElementGraph& graph, std::vector<GnnPrediction>& predictions,
+    size_t threadCount, TraceRecorder* trace, GnnActivationRanges* ranges)
+{
+    TraceScope traceScope(trace, "GnnInference", "gnn");
+    predictions.clear();
+    std::vector<std::vector<std::int64_t>> featureColumns;
+    HostError err = Prepare(model, graph, featureColumns);
+    if (err != HostNoError)
+        return err;
+
+    const size_t hiddenSize = model.hiddenSize;
+    if (ranges != nullptr) {
+        ranges->selfInputs.resize(model.layers.size(), 0.0f);
+        ranges->neighbourInputs.resize(model.layers.size(), 0.0f);
+        ranges->nodeCount += nodeCount;
+    }
+    embeddings.resize(nodeCount * hiddenSize);
+    nextEmbeddings.resize(nodeCount * hiddenSize);
+    std::unique_ptr<ThreadPool> pool = MakeThreadPool(threadCount, nodeCount);
+
+    // Input layers, one per node type
+    {
+        TraceScope layerScope(trace, "GnnInputLayer", "gnn");
+        for (size_t i = 0; i < model.inputs.size(); ++i) {
+            const GnnNodeInput& input = model.inputs[i];
+            const GraphNodeSet& nodeSet = graph.GetNodes(input.type);
+            const std::vector<std::int64_t>& columns = featureColumns[i];
+            // Weights of a mapped model are checked as their layer comes up, node types without nodes never are
+            if (nodeSet.GetRowCount() > 0 && model.PageInInputLayer(i) != HostNoError) {
+                errorMessage = std::string("The ") + GraphNodeTypeName(input.type) + " input layer weights do not match their checksum";
+                return HostErrBadFormat;
+            }
+            float* out = embeddings.data() + inputOffsets[i] * hiddenSize;
+            ForEachBlock(pool.get(), nodeSet.GetRowCount(), [&](size_t begin, size_t end) {
+                InputLayerRows(input, nodeSet, columns, hiddenSize, end - begin, [begin](size_t k) { return begin + k; },
+                    out + begin * hiddenSize);
+            });
+        }
+    }
+
+    // Message passing
+    for (size_t l = 0; l < model.layers.size(); ++l) {
+        TraceScope layerScope(trace, "GnnLayer", "gnn", static_cast<std::int64_t>(l));
+        const GnnLayer& layer = model.layers[l];
+        if (model.PageInLayer(l) != HostNoError) {
+            errorMessage = "The weights of layer " + std::to_string(l) + " do not match their checksum";
+            return HostErrBadFormat;
+        }
+        std::vector<float> selfScales;
+        std::vector<float> neighbourScales;
+        if (model.quantized) {
+            selfScales = SumScales(layer.quantizedSelfWeights);
+            neighbourScales = SumScales(layer.quantizedNeighbourWeights);
+        }
+        // Largest activations of every block when calibrating
+        size_t blockCount = ranges != nullptr ? (nodeCount + GnnBlockRows - 1) / GnnBlockRows : 0;
+        std::vector<float> selfMax(blockCount, 0.0f);
+        std::vector<float> neighbourMax(blockCount, 0.0f);
+
+        ForEachBlock(pool.get(), nodeCount, [&](size_t begin, size_t end) {
+            size_t valueCount = (end - begin) * hiddenSize;
+            const float* self = embeddings.data() + begin * hiddenSize;
+            std::vector<float> aggregated(valueCount);
+            GnnAggregateMean(offsets.data(), targets.data(), embeddings.data(), hiddenSize, begin, end, aggregated.data());
+            if (ranges != nullptr) {
+                selfMax[begin / GnnBlockRows] = MaxValue(self, valueCount);
+                neighbourMax[begin / GnnBlockRows] = MaxValue(aggregated.data(), valueCount);
+            }
+            LayerRows(model, layer, selfScales, neighbourScales, end - begin, self, aggregated.data(),
+                nextEmbeddings.data() + begin * hiddenSize);
+        });
+        embeddings.swap(nextEmbeddings);
+
+        if (ranges != nullptr) {
+            for (size_t block = 0; block < blockCount; ++block) {
+                ranges->selfInputs[l] = std::max(ranges->selfInputs[l], selfMax[block]);
+                ranges->neighbourInputs[l] = std::max(ranges->neighbourInputs[l], neighbourMax[block]);
+            }
+        }
+    }
+
+    // Classes of the predicted node types
+    TraceScope outputScope(trace, "GnnOutputLayer", "gnn");
+    if (model.PageInOutputLayer() != HostNoError) {
+        errorMessage = "The output layer weights do not match their checksum";
+        return HostErrBadFormat;
+    }
+    std::vector<float> outputScales;
+    if (model.quantized)
+        outputScales = SumScales(model.quantizedOutputWeights);
+    for (size_t i = 0; i < model.inputs.size(); ++i) {
+        const GnnNodeInput& input = model.inputs[i];
+        if (!input.predicted)
+            continue;
+
+        size_t first = predictions.size();
+        size_t rowCount = inputOffsets[i + 1] - inputOffsets[i];
+        predictions.resize(first + rowCount);
+        for (size_t row = 0; row < rowCount; ++row) {
+            predictions[first + row].type = input.type;
+            predictions[first + row].row = static_cast<std::uint32_t>(row);
+        }
+        const float* nodeEmbeddings = embeddings.data() + inputOffsets[i] * hiddenSize;
+        if (ranges != nullptr)
+            ranges->outputInput = std::max(ranges->outputInput, MaxValue(nodeEmbeddings, rowCount * hiddenSize));
+        ForEachBlock(pool.get(), rowCount, [&](size_t begin, size_t end) {
+            OutputRows(model, outputScales, end - begin, nodeEmbeddings + begin * hiddenSize, predictions.data() + first + begin);
+        });
+    }
+    return HostNoError;
+}
+
+HostError GnnInference::RunIncremental(const GnnModel& model, const ElementGraph& graph, const ElementChangeTracker& changes,
+    std::vector<GnnPrediction>& predictions, std::vector<GnnPredictionDelta>& deltas, size_t threadCount, TraceRecorder* trace)
+{
+    TraceScope traceScope(trace, "GnnIncrementalInference", "gnn");
+    predictions.clear();
+    deltas.clear();
+    updatedNodeCount = 0;
+    std::vector<std::vector<std::int64_t>> featureColumns;
+    HostError err = Prepare(model, graph, featureColumns);
+    if (err != HostNoError) {
+        ClearCache();
+        return err;
+    }
+
+    const std::uint32_t NoNode = std::numeric_limits<std::uint32_t>::max();
+    const size_t hiddenSize = model.hiddenSize;
+    const size_t layerCount = model.layers.size();
+    const size_t inputCount = model.inputs.size();
+    std::uint64_t modelChecksum = model.GetChecksum();
+    bool useCache = hasCache && cachedModelChecksum == modelChecksum;
+
+    // Node of the cached run for every node, NoNode for a new one. Cached nodes that are gone
+    // and had a label type are deltas already.
+    std::vector<std::uint32_t> previousNodes(nodeCount, NoNode);
+    std::vector<std::vector<GnnPredictionDelta>> goneDeltas(inputCount);
+    if (useCache) {
+        for (size_t i = 0; i < inputCount; ++i) {
+            const GraphNodeSet& nodeSet = graph.GetNodes(model.inputs[i].type);
+            for (size_t node = cachedInputOffsets[i]; node < cachedInputOffsets[i + 1]; ++node) {
+                std::int64_t row = nodeSet.FindRow(cachedGuids[node]);
+                if (row >= 0) {
+                    previousNodes[inputOffsets[i] + row] = static_cast<std::uint32_t>(node);
+                }
+                else if (cachedLabelTypes[node] != PredLabelNone) {
+                    GnnPredictionDelta delta;
+                    delta.guid = cachedGuids[node];
+                    delta.type = model.inputs[i].type;
+                    delta.previousLabelType = cachedLabelTypes[node];
+                    goneDeltas[i].push_back(delta);
+                }
+            }
+        }
+    }
+
+    // Nodes whose h0 changes: new ones, dirty ones and those whose features differ
+    std::vector<std::uint8_t> affected(nodeCount, 0);
+    std::vector<std::vector<float>> features(inputCount);
+    for (size_t i = 0; i < inputCount; ++i) {
+        const GraphNodeSet& nodeSet = graph.GetNodes(model.inputs[i].type);
+        const std::vector<std::int64_t>& columns = featureColumns[i];
+        size_t featureCount = columns.size();
+        features[i].resize(nodeSet.GetRowCount() * featureCount);
+        for (size_t row = 0; row < nodeSet.GetRowCount(); ++row) {
+            float* values = features[i].data() + row * featureCount;
+            for (size_t feature = 0; feature < featureCount; ++feature)
+                values[feature] = nodeSet.GetRow(row)[columns[feature]];
+
+            size_t node = inputOffsets[i] + row;
+            std::uint32_t previousNode = previousNodes[node];
+            // Compared bitwise, so an unchanged NaN is unchanged
+            affected[node] = previousNode == NoNode || std::memcmp(values,
+                cachedFeatures[i].data() + (previousNode - cachedInputOffsets[i]) * featureCount, featureCount * sizeof(float)) != 0;
+        }
+    }
+    if (useCache) {
+        changes.ForEach([&](const HostGuid& guid, HostElemType) {
+            for (size_t i = 0; i < inputCount; ++i) {
+                std::int64_t row = graph.GetNodes(model.inputs[i].type).FindRow(guid);
+                if (row >= 0)
+                    affected[inputOffsets[i] + row] = 1;
+            }
+        });
+    }
+
+    // Nodes whose neighbours differ: h1 and later change even if no neighbour's h0 does
+    std::vector<std::uint8_t> relinked(nodeCount, 0);
+    if (useCache) {
+        std::vector<std::uint32_t> current;
+        std::vector<std::uint32_t> previous;
+        for (size_t node = 0; node < nodeCount; ++node) {
+            std::uint32_t previousNode = previousNodes[node];
+            if (previousNode == NoNode)
+                continue;
+            current.clear();
+            for (std::uint32_t link = offsets[node]; link < offsets[node + 1]; ++link)
+                current.push_back(previousNodes[targets[link]]);
+            previous.assign(cachedTargets.begin() + cachedOffsets[previousNode], cachedTargets.begin() + cachedOffsets[previousNode + 1]);
+            // Usually in the same order, the lists are only sorted if not
+            if (current == previous)
+                continue;
+            std::sort(current.begin(), current.end());
+            std::sort(previous.begin(), previous.end());
+            relinked[node] = current != previous;
+        }
+    }
+
+    // Nodes to recompute at every level, growing by one hop per layer
+    std::vector<std::vector<std::uint32_t>> updated(layerCount + 1);
+    for (size_t level = 0; level <= layerCount; ++level) {
+        if (level > 0) {
+            for (std::uint32_t node : updated[level - 1]) {
+                for (std::uint32_t link = offsets[node]; link < offsets[node + 1]; ++link)
+                    affected[targets[link]] = 1;
+            }
+        }
+        for (size_t node = 0; node < nodeCount; ++node) {
+            if (level == 1 && relinked[node])
+                affected[node] = 1;
+            if (affected[node])
+                updated[level].push_back(static_cast<std::uint32_t>(node));
+        }
+    }
+    const std::vector<std::uint32_t>& lastUpdated = updated[layerCount];
+    updatedNodeCount = lastUpdated.size();
+
+    // Kept embeddings and predictions in this run's node numbering
+    bool renumbered = !useCache || nodeCount != cachedGuids.size();
+    for (size_t node = 0; node < nodeCount && !renumbered; ++node)
+        renumbered = previousNodes[node] != node;
+    layerEmbeddings.resize(layerCount);
+    std::vector<int> previousLabelTypes(nodeCount, PredLabelNone);
+    std::vector<float> confidences(nodeCount, 0.0f);
+    for (size_t node = 0; node < nodeCount; ++node) {
+        if (previousNodes[node] != NoNode) {
+            previousLabelTypes[node] = cachedLabelTypes[previousNodes[node]];
+            confidences[node] = cachedConfidences[previousNodes[node]];
+        }
+    }
+    if (renumbered) {
+        for (std::vector<float>& levelEmbeddings : layerEmbeddings) {
+            std::vector<float> renumberedEmbeddings(nodeCount * hiddenSize, 0.0f);
+            for (size_t node = 0; node < nodeCount; ++node) {
+                if (previousNodes[node] != NoNode)
+                    std::memcpy(renumberedEmbeddings.data() + node * hiddenSize, levelEmbeddings.data() + previousNodes[node] * hiddenSize,
+                        hiddenSize * sizeof(float));
+            }
+            levelEmbeddings.swap(renumberedEmbeddings);
+        }
+    }
+    std::vector<int> labelTypes = previousLabelTypes;
+
+    // Every level but the last goes to the kept embeddings, the last one to embeddings, in lastUpdated order
+    embeddings.resize(lastUpdated.size() * hiddenSize);
+    auto levelRow = [&](size_t level, size_t index, std::uint32_t node) {
+        return level < layerCount ? layerEmbeddings[level].data() + node * hiddenSize : embeddings.data() + index * hiddenSize;
+    };
+    std::unique_ptr<ThreadPool> pool = MakeThreadPool(threadCount, lastUpdated.size());
+    auto fail = [&](const std::string& message) {
+        errorMessage = message;
+        ClearCache();
+        return HostErrBadFormat;
+    };
+
+    {
+        TraceScope layerScope(trace, "GnnInputLayer", "gnn");
+        const std::vector<std::uint32_t>& nodes = updated[0];
+        for (size_t i = 0; i < inputCount; ++i) {
+            const GnnNodeInput& input = model.inputs[i];
+            std::pair<size_t, size_t> range = NodeRange(nodes, inputOffsets[i], inputOffsets[i + 1]);
+            if (range.first == range.second)
+                continue;
+            if (model.PageInInputLayer(i) != HostNoError)
+                return fail(std::string("The ") + GraphNodeTypeName(input.type) + " input layer weights do not match their checksum");
+            ForEachBlock(pool.get(), range.second - range.first, [&](size_t begin, size_t end) {
+                size_t first = range.first + begin;
+                std::vector<float> out((end - begin) * hiddenSize);
+                InputLayerRows(input, graph.GetNodes(input.type), featureColumns[i], hiddenSize, end - begin,
+                    [&](size_t k) { return nodes[first + k] - inputOffsets[i]; }, out.data());
+                for (size_t k = 0; k < end - begin; ++k)
+                    std::memcpy(levelRow(0, first + k, nodes[first + k]), out.data() + k * hiddenSize, hiddenSize * sizeof(float));
+            });
+        }
+    }
+
+    for (size_t l = 0; l < layerCount; ++l) {
+        TraceScope layerScope(trace, "GnnLayer", "gnn", static_cast<std::int64_t>(l));
+        const GnnLayer& layer = model.layers[l];
+        const std::vector<std::uint32_t>& nodes = updated[l + 1];
+        if (model.PageInLayer(l) != HostNoError)
+            return fail("The weights of layer " + std::to_string(l) + " do not match their checksum");
+        std::vector<float> selfScales;
+        std::vector<float> neighbourScales;
+        if (model.quantized) {
+            selfScales = SumScales(layer.quantizedSelfWeights);
+            neighbourScales = SumScales(layer.quantizedNeighbourWeights);
+        }
+
+        const float* in = layerEmbeddings[l].data();
+        ForEachBlock(pool.get(), nodes.size(), [&](size_t begin, size_t end) {
+            size_t valueCount = (end - begin) * hiddenSize;
+            std::vector<float> self(valueCount);
+            std::vector<float> aggregated(valueCount);
+            std::vector<float> out(valueCount);
+            for (size_t k = 0; k < end - begin; ++k) {
+                std::uint32_t node = nodes[begin + k];
+                std::memcpy(self.data() + k * hiddenSize, in + node * hiddenSize, hiddenSize * sizeof(float));
+                GnnAggregateMean(offsets.data(), targets.data(), in, hiddenSize, node, node + 1, aggregated.data() + k * hiddenSize);
+            }
+            LayerRows(model, layer, selfScales, neighbourScales, end - begin, self.data(), aggregated.data(), out.data());
+            for (size_t k = 0; k < end - begin; ++k)
+                std::memcpy(levelRow(l + 1, begin + k, nodes[begin + k]), out.data() + k * hiddenSize, hiddenSize * sizeof(float));
+        });
+    }
+
+    {
+        TraceScope outputScope(trace, "GnnOutputLayer", "gnn");
+        if (model.PageInOutputLayer() != HostNoError)
+            return fail("The output layer weights do not match their checksum");
+        std::vector<float> outputScales;
+        if (model.quantized)
+            outputScales = SumScales(model.quantizedOutputWeights);
+        for (size_t i = 0; i < inputCount; ++i) {
+            if (!model.inputs[i].predicted)
+                continue;
+            std::pair<size_t, size_t> range = NodeRange(lastUpdated, inputOffsets[i], inputOffsets[i + 1]);
+            ForEachBlock(pool.get(), range.second - range.first, [&](size_t begin, size_t end) {
+                size_t first = range.first + begin;
+                std::vector<GnnPrediction> blockPredictions(end - begin);
+                OutputRows(model, outputScales, end - begin, embeddings.data() + first * hiddenSize, blockPredictions.data());
+                for (size_t k = 0; k < end - begin; ++k) {
+                    labelTypes[lastUpdated[first + k]] = blockPredictions[k].labelType;
+                    confidences[lastUpdated[first + k]] = blockPredictions[k].confidence;
+                }
+            });
+        }
+    }
+
+    // Full predictions from the kept and the recomputed ones, deltas for the label types that changed
+    for (size_t i = 0; i < inputCount; ++i) {
+        const GnnNodeInput& input = model.inputs[i];
+        if (!input.predicted)
+            continue;
+        const GraphNodeSet& nodeSet = graph.GetNodes(input.type);
+        for (size_t row = 0; row < nodeSet.GetRowCount(); ++row) {
+            size_t node = inputOffsets[i] + row;
+            GnnPrediction prediction;
+            prediction.type = input.type;
+            prediction.row = static_cast<std::uint32_t>(row);
+            prediction.labelType = labelTypes[node];
+            prediction.confidence = confidences[node];
+            predictions.push_back(prediction);
+            if (labelTypes[node] != previousLabelTypes[node]) {
+                GnnPredictionDelta delta;
+                delta.guid = nodeSet.guids[row];
+                delta.type = input.type;
+                delta.row = static_cast<std::int64_t>(row);
+                delta.previousLabelType = previousLabelTypes[node];
+                delta.labelType = labelTypes[node];
+                delta.confidence = confidences[node];
+                deltas.push_back(delta);
+            }
+        }
+        deltas.insert(deltas.end(), goneDeltas[i].begin(), goneDeltas[i].end());
+    }
+
+    hasCache = true;
+    cachedModelChecksum = modelChecksum;
+    cachedInputOffsets = inputOffsets;
+    cachedGuids.clear();
+    for (const GnnNodeInput& input : model.inputs) {
+        const std::vector<HostGuid>& guids = graph.GetNodes(input.type).guids;
+        cachedGuids.insert(cachedGuids.end(), guids.begin(), guids.end());
+    }
+    cachedFeatures.swap(features);
+    cachedOffsets = offsets;
+    cachedTargets = targets;
+    cachedLabelTypes.swap(labelTypes);
+    cachedConfidences.swap(confidences);
+    return HostNoError;
+}
+
+void GnnInference::ClearCache() {
+    hasCache = false;
+    cachedModelChecksum = 0;
+    cachedInputOffsets = std::vector<size_t>();
+    cachedGuids = std::vector<HostGuid>();
+    cachedFeatures = std::vector<std::vector<float>>();
+    cachedOffsets = std::vector<std::uint32_t>();
+    cachedTargets = std::vector<std::uint32_t>();
+    layerEmbeddings = std::vector<std::vector<float>>();
+    cachedLabelTypes = std::vector<int>();
+    cachedConfidences = std::vector<float>();
+}
@@ -0,0 +1,98 @@
+#ifndef GNN_INFERENCE_HPP
+#define GNN_INFERENCE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ElementChangeTracker.hpp"
+#include "ElementGraph.hpp"
+#include "GnnModel.hpp"
+#include "GnnQuantization.hpp"
+#include "PredictionCsv.hpp"
+#include "TraceRecorder.hpp"
+
+// Label type predicted for one node
+struct GnnPrediction {
+    GraphNodeType type = GraphNodeType::Wall;
+    std::uint32_t row = 0;              // in graph.GetNodes(type)
+    int           labelType = 0;        // of the most likely class
+    float         confidence = 0.0f;    // softmax probability of that class
+};
+
+// Change of the label type predicted for one node since the previous RunIncremental
+struct GnnPredictionDelta {
+    HostGuid      guid;
+    GraphNodeType type = GraphNodeType::Wall;
+    std::int64_t  row = -1;                             // in graph.GetNodes(type), -1 for a node that is gone
+    int           previousLabelType = PredLabelNone;    // PredLabelNone for a new node
+    int           labelType = PredLabelNone;            // PredLabelNone for a node that is gone
+    float         confidence = 0.0f;
+};
+
+// Runs a GnnModel over an ElementGraph on the CPU, in process. The buffers are kept between runs,
+// so running again on a graph of about the same size does not allocate.
+class GnnInference {
+public:
+    GnnInference();
+
+    // One prediction per node of the model's predicted types, in model input order, then row
+    // order. Rows are computed in blocks on threadCount threads (0 uses every hardware thread), the
+    // result does not depend on it. HostErrBadFormat if the graph lacks a feature or edge type the
+    // model uses, GetErrorMessage tells which. With a trace, every layer is a span. A quantized
+    // model runs its layers on the int8 kernels. With ranges, they are widened to the activations
+    // of this run, for calibrating a quantization of the model.
+    HostError Run(const GnnModel& model, const ElementGraph& graph, std::vector<GnnPrediction>& predictions,
+        size_t threadCount = 0, TraceRecorder* trace = nullptr, GnnActivationRanges* ranges = nullptr);
+
+    // As Run, but only recomputes what changed since the previous RunIncremental with the same
+    // model: the nodes of the dirty elements, nodes that are new or whose features or neighbours
+    // differ, and whatever lies within the model's layer count of them. The embeddings of every
+    // layer but the last are kept for this; a different model or the first run computes every
+    // node. deltas gets the nodes whose predicted label type changed, new and gone nodes
+    // included, in model input order, then row order; gone nodes come after the others of their type.
+    HostError RunIncremental(const GnnModel& model, const ElementGraph& graph, const ElementChangeTracker& changes,
+        std::vector<GnnPrediction>& predictions, std::vector<GnnPredictionDelta>& deltas, size_t threadCount = 0,
+        TraceRecorder* trace = nullptr);
+
+    // Makes the next RunIncremental compute every node, and frees what it kept
+    void      ClearCache();
+
+    const std::string& GetErrorMessage() const { return errorMessage; }
+
+    // Of the last run: nodes taking part and neighbour links (both directions of every edge)
+    size_t    GetNodeCount() const { return nodeCount; }
+    size_t    GetLinkCount() const { return targets.size(); }
+    // Of the last RunIncremental: nodes whose last layer was recomputed
+    size_t    GetUpdatedNodeCount() const { return updatedNodeCount; }
+
+private:
+    // Numbers the nodes of the model's types one input after the other and merges the model's
+    // edge types into one CSR adjacency
+    HostError BuildAdjacency(const GnnModel& model, const ElementGraph& graph);
+
+    // Model checks, feature columns and adjacency shared by both runs
+    HostError Prepare(const GnnModel& model, const ElementGraph& graph, std::vector<std::vector<std::int64_t>>& featureColumns);
+
+    std::string                errorMessage;
+    size_t                     nodeCount;
+    std::vector<size_t>        inputOffsets;        // first node of every model input, then nodeCount
+    std::vector<std::uint32_t> offsets;             // nodeCount + 1
+    std::vector<std::uint32_t> targets;
+    std::vector<float>         embeddings;          // nodeCount * hidden size, the current layer
+    std::vector<float>         nextEmbeddings;
+
+    // Kept by RunIncremental for the next one, in the node numbering of its graph
+    bool                             hasCache;
+    std::uint64_t                    cachedModelChecksum;
+    std::vector<size_t>              cachedInputOffsets;
+    std::vector<HostGuid>            cachedGuids;           // per node
+    std::vector<std::vector<float>>  cachedFeatures;        // per model input: rows * the model's feature count
+    std::vector<std::uint32_t>       cachedOffsets;
+    std::vector<std::uint32_t>       cachedTargets;
+    std::vector<std::vector<float>>  layerEmbeddings;       // h0 .. hL-1, nodeCount * hidden size each
+    std::vector<int>                 cachedLabelTypes;      // per node, PredLabelNone for types not predicted
+    std::vector<float>               cachedConfidences;
+    size_t                           updatedNodeCount;
+};
+
+#endif // GNN_INFERENCE_HPP
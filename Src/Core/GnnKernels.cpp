@@ -0,0 +1,299 @@
+#include "GnnKernels.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+
+void AggregateMeanScalar(const std::uint32_t* offsets, const std::uint32_t* targets, const float* x, size_t columnCount,
+    size_t rowBegin, size_t rowEnd, float* out)
+{
+    for (size_t row = rowBegin; row < rowEnd; ++row) {
+        float* outRow = out + (row - rowBegin) * columnCount;
+        std::fill(outRow, outRow + columnCount, 0.0f);
+
+        std::uint32_t begin = offsets[row];
+        std::uint32_t end = offsets[row + 1];
+        if (begin == end)
+            continue;
+
+        for (std::uint32_t edge = begin; edge < end; ++edge) {
+            const float* neighbour = x + static_cast<size_t>(targets[edge]) * columnCount;
+            for (size_t column = 0; column < columnCount; ++column)
+                outRow[column] += neighbour[column];
+        }
+
+        float scale = 1.0f / static_cast<float>(end - begin);
+        for (size_t column = 0; column < columnCount; ++column)
+            outRow[column] *= scale;
+    }
+}
+
+void DenseScalar(const float* a, size_t rowCount, size_t inputCount, const float* weights, const float* bias, size_t outputCount,
+    float* out, bool accumulate)
+{
+    for (size_t row = 0; row < rowCount; ++row) {
+        const float* aRow = a + row * inputCount;
+        float* outRow = out + row * outputCount;
+        for (size_t output = 0; output < outputCount; ++output) {
+            const float* weightRow = weights + output * inputCount;
+            float sum = bias != nullptr ? bias[output] : 0.0f;
+            for (size_t input = 0; input < inputCount; ++input)
+                sum += aRow[input] * weightRow[input];
+            outRow[output] = accumulate ? outRow[output] + sum : sum;
+        }
+    }
+}
+
+void ReluScalar(float* x, size_t count) {
+    for (size_t i = 0; i < count; ++i)
+        x[i] = std::max(x[i], 0.0f);
+}
+
+// Written so that NaN gives 0, as the SIMD versions do
+void QuantizeScalar(const float* x, size_t count, float scale, std::uint8_t* q) {
+    float inverseScale = 1.0f / scale;
+    for (size_t i = 0; i < count; ++i) {
+        float value = x[i] * inverseScale;
+        value = value > 0.0f ? value : 0.0f;
+        value = value < 127.0f ? value : 127.0f;
+        q[i] = static_cast<std::uint8_t>(std::nearbyint(value));
+    }
+}
+
+void DenseInt8Scalar(const std::uint8_t* a, size_t rowCount, size_t inputCount, const std::int8_t* weights, const float* scales,
+    const float* bias, size_t outputCount, float* out, bool accumulate)
+{
+    for (size_t row = 0; row < rowCount; ++row) {
+        const std::uint8_t* aRow = a + row * inputCount;
+        float* outRow = out + row * outputCount;
+        for (size_t output = 0; output < outputCount; ++output) {
+            const std::int8_t* weightRow = weights + output * inputCount;
+            std::int32_t sum = 0;
+            for (size_t input = 0; input < inputCount; ++input)
+                sum += static_cast<std::int32_t>(aRow[input]) * weightRow[input];
+            float value = (bias != nullptr ? bias[output] : 0.0f) + scales[output] * static_cast<float>(sum);
+            outRow[output] = accumulate ? outRow[output] + value : value;
+        }
+    }
+}
+
+const GnnKernelTable ScalarKernels = { AggregateMeanScalar, DenseScalar, ReluScalar, QuantizeScalar, DenseInt8Scalar };
+
+bool CpuHasAvx2() {
+#if defined(_MSC_VER) && defined(_M_X64)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    // FMA, OSXSAVE and AVX, then the OS must save the YMM registers
+    __cpuid(info, 1);
+    const int fmaOsxsaveAvx = (1 << 12) | (1 << 27) | (1 << 28);
+    if ((info[2] & fmaOsxsaveAvx) != fmaOsxsaveAvx || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+GnnKernelIsa BestIsa() {
+    if (IsGnnKernelIsaSupported(GnnKernelIsa::Avx2))
+        return GnnKernelIsa::Avx2;
+    if (IsGnnKernelIsaSupported(GnnKernelIsa::Neon))
+        return GnnKernelIsa::Neon;
+    return GnnKernelIsa::Scalar;
+}
+
+// Selected on first use. Racing first calls all select the same set.
+std::atomic<int>                   selectedIsa(-1);
+std::atomic<const GnnKernelTable*> selectedKernels(nullptr);
+
+const GnnKernelTable& Kernels() {
+    const GnnKernelTable* kernels = selectedKernels.load(std::memory_order_acquire);
+    if (kernels == nullptr) {
+        GnnKernelIsa isa = BestIsa();
+        kernels = GetGnnKernelTable(isa);
+        selectedIsa.store(static_cast<int>(isa), std::memory_order_relaxed);
+        selectedKernels.store(kernels, std::memory_order_release);
+    }
+    return *kernels;
+}
+
+// Uniform in [-1, 1), splitmix64
+float RandomValue(std::uint64_t& state) {
+    std::uint64_t x = (state += 0x9E3779B97F4A7C15ull);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return static_cast<float>(static_cast<double>(x >> 11) * (1.0 / 9007199254740992.0) * 2.0 - 1.0);
+}
+
+// Largest difference relative to the largest reference value
+double RelativeError(const std::vector<float>& reference, const std::vector<float>& result) {
+    double maxReference = 0.0;
+    double maxDifference = 0.0;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        maxReference = std::max(maxReference, static_cast<double>(std::fabs(reference[i])));
+        maxDifference = std::max(maxDifference, static_cast<double>(std::fabs(reference[i] - result[i])));
+    }
+    return maxReference > 0.0 ? maxDifference / maxReference : maxDifference;
+}
+
+}
+
+const char* GnnKernelIsaName(GnnKernelIsa isa) {
+    switch (isa) {
+    case GnnKernelIsa::Scalar:  return "scalar";
+    case GnnKernelIsa::Avx2:    return "avx2";
+    case GnnKernelIsa::Neon:    return "neon";
+    default:                    return "unknown";
+    }
+}
+
+bool IsGnnKernelIsaSupported(GnnKernelIsa isa) {
+    switch (isa) {
+    case GnnKernelIsa::Scalar:  return true;
+    case GnnKernelIsa::Avx2:    return GnnAvx2KernelTable() != nullptr && CpuHasAvx2();
+    case GnnKernelIsa::Neon:    return GnnNeonKernelTable() != nullptr;     // part of every ARM64 CPU
+    default:                    return false;
+    }
+}
+
+const GnnKernelTable* GetGnnKernelTable(GnnKernelIsa isa) {
+    switch (isa) {
+    case GnnKernelIsa::Scalar:  return &ScalarKernels;
+    case GnnKernelIsa::Avx2:    return GnnAvx2KernelTable();
+    case GnnKernelIsa::Neon:    return GnnNeonKernelTable();
+    default:                    return nullptr;
+    }
+}
+
+GnnKernelIsa GetGnnKernelIsa() {
+    Kernels();
+    return static_cast<GnnKernelIsa>(selectedIsa.load(std::memory_order_relaxed));
+}
+
+bool SetGnnKernelIsa(GnnKernelIsa isa) {
+    if (!IsGnnKernelIsaSupported(isa))
+        return false;
+    selectedIsa.store(static_cast<int>(isa), std::memory_order_relaxed);
+    selectedKernels.store(GetGnnKernelTable(isa), std::memory_order_release);
+    return true;
+}
+
+void GnnAggregateMean(const std::uint32_t* offsets, const std::uint32_t* targets, const float* x, size_t columnCount,
+    size_t rowBegin, size_t rowEnd, float* out)
+{
+    Kernels().aggregateMean(offsets, targets, x, columnCount, rowBegin, rowEnd, out);
+}
+
+void GnnDense(const float* a, size_t rowCount, size_t inputCount, const float* weights, const float* bias, size_t outputCount,
+    float* out, bool accumulate)
+{
+    Kernels().dense(a, rowCount, inputCount, weights, bias, outputCount, out, accumulate);
+}
+
+void GnnRelu(float* x, size_t count) {
+    Kernels().relu(x, count);
+}
+
+void GnnQuantize(const float* x, size_t count, float scale, std::uint8_t* q) {
+    Kernels().quantize(x, count, scale, q);
+}
+
+void GnnDenseInt8(const std::uint8_t* a, size_t rowCount, size_t inputCount, const std::int8_t* weights, const float* scales,
+    const float* bias, size_t outputCount, float* out, bool accumulate)
+{
+    Kernels().denseInt8(a, rowCount, inputCount, weights, scales, bias, outputCount, out, accumulate);
+}
+
+double CompareGnnKernels(GnnKernelIsa isa, size_t rowCount, size_t columnCount, size_t degree, std::uint32_t seed) {
+    const GnnKernelTable* kernels = GetGnnKernelTable(isa);
+    if (kernels == nullptr || !IsGnnKernelIsaSupported(isa) || rowCount == 0 || columnCount == 0)
+        return 0.0;
+
+    // Random adjacency with 0 to 2 * degree neighbours per row, random features and weights
+    std::uint64_t state = seed;
+    std::vector<std::uint32_t> offsets(1, 0);
+    std::vector<std::uint32_t> targets;
+    for (size_t row = 0; row < rowCount; ++row) {
+        size_t neighbourCount = static_cast<size_t>((RandomValue(state) + 1.0f) * degree);
+        for (size_t i = 0; i < neighbourCount; ++i)
+            targets.push_back(static_cast<std::uint32_t>((RandomValue(state) + 1.0f) * 0.5f * (rowCount - 1)));
+        offsets.push_back(static_cast<std::uint32_t>(targets.size()));
+    }
+    auto randomVector = [&](size_t count) {
+        std::vector<float> values(count);
+        for (float& value : values)
+            value = RandomValue(state);
+        return values;
+    };
+    const std::vector<float> x = randomVector(rowCount * columnCount);
+    const std::vector<float> weights = randomVector(columnCount * columnCount);
+    const std::vector<float> bias = randomVector(columnCount);
+    const std::vector<float> previous = randomVector(rowCount * columnCount);
+
+    double error = 0.0;
+    std::vector<float> reference(rowCount * columnCount);
+    std::vector<float> result(rowCount * columnCount);
+
+    // Split in two blocks, so that a block not starting at row 0 is covered
+    size_t split = rowCount / 3;
+    ScalarKernels.aggregateMean(offsets.data(), targets.data(), x.data(), columnCount, 0, split, reference.data());
+    ScalarKernels.aggregateMean(offsets.data(), targets.data(), x.data(), columnCount, split, rowCount, reference.data() + split * columnCount);
+    kernels->aggregateMean(offsets.data(), targets.data(), x.data(), columnCount, 0, split, result.data());
+    kernels->aggregateMean(offsets.data(), targets.data(), x.data(), columnCount, split, rowCount, result.data() + split * columnCount);
+    error = std::max(error, RelativeError(reference, result));
+
+    ScalarKernels.dense(x.data(), rowCount, columnCount, weights.data(), bias.data(), columnCount, reference.data(), false);
+    kernels->dense(x.data(), rowCount, columnCount, weights.data(), bias.data(), columnCount, result.data(), false);
+    error = std::max(error, RelativeError(reference, result));
+
+    reference = previous;
+    result = previous;
+    ScalarKernels.dense(x.data(), rowCount, columnCount, weights.data(), nullptr, columnCount, reference.data(), true);
+    kernels->dense(x.data(), rowCount, columnCount, weights.data(), nullptr, columnCount, result.data(), true);
+    error = std::max(error, RelativeError(reference, result));
+
+    ScalarKernels.relu(reference.data(), reference.size());
+    kernels->relu(result.data(), result.size());
+    error = std::max(error, RelativeError(reference, result));
+
+    // int8: quantized activations must match exactly, int32 sums are exact
+    const float quantizeScale = 1.0f / 127.0f;
+    std::vector<std::uint8_t> referenceQuantized(x.size());
+    std::vector<std::uint8_t> resultQuantized(x.size());
+    ScalarKernels.quantize(x.data(), x.size(), quantizeScale, referenceQuantized.data());
+    kernels->quantize(x.data(), x.size(), quantizeScale, resultQuantized.data());
+    if (referenceQuantized != resultQuantized)
+        return 1.0;
+
+    std::vector<std::int8_t> quantizedWeights(weights.size());
+    for (size_t i = 0; i < weights.size(); ++i)
+        quantizedWeights[i] = static_cast<std::int8_t>(std::nearbyint(weights[i] * 127.0f));
+    std::vector<float> scales(columnCount, quantizeScale / 127.0f);
+    ScalarKernels.denseInt8(referenceQuantized.data(), rowCount, columnCount, quantizedWeights.data(), scales.data(), bias.data(),
+        columnCount, reference.data(), false);
+    kernels->denseInt8(referenceQuantized.data(), rowCount, columnCount, quantizedWeights.data(), scales.data(), bias.data(),
+        columnCount, result.data(), false);
+    error = std::max(error, RelativeError(reference, result));
+
+    reference = previous;
+    result = previous;
+    ScalarKernels.denseInt8(referenceQuantized.data(), rowCount, columnCount, quantizedWeights.data(), scales.data(), nullptr,
+        columnCount, reference.data(), true);
+    kernels->denseInt8(referenceQuantized.data(), rowCount, columnCount, quantizedWeights.data(), scales.data(), nullptr,
+        columnCount, result.data(), true);
+    return std::max(error, RelativeError(reference, result));
+}
@@ -0,0 +1,77 @@
+#ifndef GNN_KERNELS_HPP
+#define GNN_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Kernels of GNN inference over a block of rows. Matrices are row-major float arrays; weights have
+// one row per output, so every output is a dot product with a contiguous weight row.
+//
+// Every kernel has a scalar version and SIMD versions for AVX2 with FMA (x86-64) and NEON (ARM64).
+// The first call picks the best instruction set the CPU supports. SIMD versions sum in a different
+// order, so results differ from the scalar ones in the last bits.
+
+enum class GnnKernelIsa : std::uint8_t {
+    Scalar,
+    Avx2,
+    Neon
+};
+
+const char*  GnnKernelIsaName(GnnKernelIsa isa);
+bool         IsGnnKernelIsaSupported(GnnKernelIsa isa);
+
+// Instruction set the kernels below run on
+GnnKernelIsa GetGnnKernelIsa();
+
+// Switches the kernels to isa, for comparing instruction sets. Returns false and keeps the current
+// one if the CPU does not support isa. Not while inference is running.
+bool         SetGnnKernelIsa(GnnKernelIsa isa);
+
+// out[r] = mean of x[targets[offsets[row] .. offsets[row + 1])] for row = rowBegin + r, zero for a row
+// without neighbours. x and out have columnCount columns.
+void GnnAggregateMean(const std::uint32_t* offsets, const std::uint32_t* targets, const float* x, size_t columnCount,
+    size_t rowBegin, size_t rowEnd, float* out);
+
+// out[r][o] = bias[o] + sum over i of a[r][i] * weights[o][i], for rowCount rows of a. With accumulate
+// the result is added to out. bias may be nullptr.
+void GnnDense(const float* a, size_t rowCount, size_t inputCount, const float* weights, const float* bias, size_t outputCount,
+    float* out, bool accumulate);
+
+// x = max(x, 0)
+void GnnRelu(float* x, size_t count);
+
+// q = round(x / scale) clamped to [0, 127], for the non-negative activations of int8 layers
+void GnnQuantize(const float* x, size_t count, float scale, std::uint8_t* q);
+
+// out[r][o] = bias[o] + scales[o] * sum over i of a[r][i] * weights[o][i], the sum taken exactly in
+// int32. a is quantized by GnnQuantize, weights are int8 in [-127, 127]; scales[o] is the product of
+// the scales of weight row o and of a. Otherwise as GnnDense.
+void GnnDenseInt8(const std::uint8_t* a, size_t rowCount, size_t inputCount, const std::int8_t* weights, const float* scales,
+    const float* bias, size_t outputCount, float* out, bool accumulate);
+
+// Implementations of one instruction set, the functions above call the selected one
+struct GnnKernelTable {
+    void (*aggregateMean)(const std::uint32_t* offsets, const std::uint32_t* targets, const float* x, size_t columnCount,
+        size_t rowBegin, size_t rowEnd, float* out);
+    void (*dense)(const float* a, size_t rowCount, size_t inputCount, const float* weights, const float* bias, size_t outputCount,
+        float* out, bool accumulate);
+    void (*relu)(float* x, size_t count);
+    void (*quantize)(const float* x, size_t count, float scale, std::uint8_t* q);
+    void (*denseInt8)(const std::uint8_t* a, size_t rowCount, size_t inputCount, const std::int8_t* weights, const float* scales,
+        const float* bias, size_t outputCount, float* out, bool accumulate);
+};
+
+// Kernels of isa, nullptr if the build does not target its architecture. Whether the CPU runs
+// them is up to IsGnnKernelIsaSupported.
+const GnnKernelTable* GetGnnKernelTable(GnnKernelIsa isa);
+
+// Defined in GnnKernelsAvx2.cpp and GnnKernelsNeon.cpp, nullptr for other architectures
+const GnnKernelTable* GnnAvx2KernelTable();
+const GnnKernelTable* GnnNeonKernelTable();
+
+// Largest difference between the kernels of isa and the scalar ones on random data of rowCount
+// rows, columnCount columns and about degree neighbours per row, relative to the magnitude of the
+// result. For checking a build or a CPU, 0 if isa is not supported.
+double CompareGnnKernels(GnnKernelIsa isa, size_t rowCount, size_t columnCount, size_t degree, std::uint32_t seed);
+
+#endif // GNN_KERNELS_HPP
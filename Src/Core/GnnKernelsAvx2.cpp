@@ -0,0 +1,338 @@
+#include "GnnKernels.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <cmath>
+#include <immintrin.h>
+
+// Only this file is compiled for AVX2, so the rest of the build keeps running on any x86-64 CPU
+#if defined(__GNUC__) || defined(__clang__)
+#define GNN_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define GNN_AVX2
+#endif
+
+namespace {
+
+// Sums the columns of 32, then 8 at a time in registers over all neighbours, so every output is
+// stored once. Neighbours are added in the same order as the scalar kernel.
+GNN_AVX2 void AggregateMeanAvx2(const std::uint32_t* offsets, const std::uint32_t* targets, const float* x, size_t columnCount,
+    size_t rowBegin, size_t rowEnd, float* out)
+{
+    for (size_t row = rowBegin; row < rowEnd; ++row) {
+        float* outRow = out + (row - rowBegin) * columnCount;
+        std::uint32_t begin = offsets[row];
+        std::uint32_t end = offsets[row + 1];
+        if (begin == end) {
+            for (size_t column = 0; column < columnCount; ++column)
+                outRow[column] = 0.0f;
+            continue;
+        }
+
+        float scale = 1.0f / static_cast<float>(end - begin);
+        __m256 scaleVector = _mm256_set1_ps(scale);
+
+        size_t column = 0;
+        for (; column + 32 <= columnCount; column += 32) {
+            __m256 sum0 = _mm256_setzero_ps();
+            __m256 sum1 = _mm256_setzero_ps();
+            __m256 sum2 = _mm256_setzero_ps();
+            __m256 sum3 = _mm256_setzero_ps();
+            for (std::uint32_t edge = begin; edge < end; ++edge) {
+                const float* neighbour = x + static_cast<size_t>(targets[edge]) * columnCount + column;
+                sum0 = _mm256_add_ps(sum0, _mm256_loadu_ps(neighbour));
+                sum1 = _mm256_add_ps(sum1, _mm256_loadu_ps(neighbour + 8));
+                sum2 = _mm256_add_ps(sum2, _mm256_loadu_ps(neighbour + 16));
+                sum3 = _mm256_add_ps(sum3, _mm256_loadu_ps(neighbour + 24));
+            }
+            _mm256_storeu_ps(outRow + column, _mm256_mul_ps(sum0, scaleVector));
+            _mm256_storeu_ps(outRow + column + 8, _mm256_mul_ps(sum1, scaleVector));
+            _mm256_storeu_ps(outRow + column + 16, _mm256_mul_ps(sum2, scaleVector));
+            _mm256_storeu_ps(outRow + column + 24, _mm256_mul_ps(sum3, scaleVector));
+        }
+        for (; column + 8 <= columnCount; column += 8) {
+            __m256 sum = _mm256_setzero_ps();
+            for (std::uint32_t edge = begin; edge < end; ++edge)
+                sum = _mm256_add_ps(sum, _mm256_loadu_ps(x + static_cast<size_t>(targets[edge]) * columnCount + column));
+            _mm256_storeu_ps(outRow + column, _mm256_mul_ps(sum, scaleVector));
+        }
+        for (; column < columnCount; ++column) {
+            float sum = 0.0f;
+            for (std::uint32_t edge = begin; edge < end; ++edge)
+                sum += x[static_cast<size_t>(targets[edge]) * columnCount + column];
+            outRow[column] = sum * scale;
+        }
+    }
+}
+
+// Lane i is the sum of the lanes of sumi
+GNN_AVX2 inline __m128 HorizontalSum4(__m256 sum0, __m256 sum1, __m256 sum2, __m256 sum3) {
+    __m256 sum = _mm256_hadd_ps(_mm256_hadd_ps(sum0, sum1), _mm256_hadd_ps(sum2, sum3));
+    return _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+}
+
+GNN_AVX2 inline float HorizontalSum(__m256 sum) {
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_movehdup_ps(half));
+    return _mm_cvtss_f32(half);
+}
+
+// Dot products of RowCount rows of a with 4 weight rows from output on, into sums[row]. Every
+// loaded row of a is used for 4 outputs and every weight row for RowCount rows.
+template <size_t RowCount>
+GNN_AVX2 void DenseBlock4(const float* a, size_t inputCount, const float* weights, size_t output, __m128* sums) {
+    const float* weightRows[4];
+    for (size_t k = 0; k < 4; ++k)
+        weightRows[k] = weights + (output + k) * inputCount;
+
+    __m256 acc[RowCount][4];
+    for (size_t r = 0; r < RowCount; ++r) {
+        for (size_t k = 0; k < 4; ++k)
+            acc[r][k] = _mm256_setzero_ps();
+    }
+
+    size_t input = 0;
+    for (; input + 8 <= inputCount; input += 8) {
+        __m256 weight[4];
+        for (size_t k = 0; k < 4; ++k)
+            weight[k] = _mm256_loadu_ps(weightRows[k] + input);
+        for (size_t r = 0; r < RowCount; ++r) {
+            __m256 value = _mm256_loadu_ps(a + r * inputCount + input);
+            for (size_t k = 0; k < 4; ++k)
+                acc[r][k] = _mm256_fmadd_ps(value, weight[k], acc[r][k]);
+        }
+    }
+
+    for (size_t r = 0; r < RowCount; ++r)
+        sums[r] = HorizontalSum4(acc[r][0], acc[r][1], acc[r][2], acc[r][3]);
+    if (input == inputCount)
+        return;
+
+    alignas(16) float tails[RowCount][4] = {};
+    for (; input < inputCount; ++input) {
+        for (size_t r = 0; r < RowCount; ++r) {
+            for (size_t k = 0; k < 4; ++k)
+                tails[r][k] += a[r * inputCount + input] * weightRows[k][input];
+        }
+    }
+    for (size_t r = 0; r < RowCount; ++r)
+        sums[r] = _mm_add_ps(sums[r], _mm_load_ps(tails[r]));
+}
+
+GNN_AVX2 float DenseDot(const float* a, const float* weightRow, size_t inputCount) {
+    __m256 acc = _mm256_setzero_ps();
+    size_t input = 0;
+    for (; input + 8 <= inputCount; input += 8)
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(a + input), _mm256_loadu_ps(weightRow + input), acc);
+    float sum = HorizontalSum(acc);
+    for (; input < inputCount; ++input)
+        sum += a[input] * weightRow[input];
+    return sum;
+}
+
+inline void StoreOutput(float* out, float bias, float sum, bool accumulate) {
+    *out = accumulate ? *out + (bias + sum) : bias + sum;
+}
+
+template <size_t RowCount>
+GNN_AVX2 void DenseRows(const float* a, size_t inputCount, const float* weights, const float* bias, size_t outputCount,
+    float* out, bool accumulate)
+{
+    size_t output = 0;
+    for (; output + 4 <= outputCount; output += 4) {
+        __m128 sums[RowCount];
+        DenseBlock4<RowCount>(a, inputCount, weights, output, sums);
+        __m128 biasVector = bias != nullptr ? _mm_loadu_ps(bias + output) : _mm_setzero_ps();
+        for (size_t r = 0; r < RowCount; ++r) {
+            float* outValues = out + r * outputCount + output;
+            __m128 value = _mm_add_ps(biasVector, sums[r]);
+            if (accumulate)
+                value = _mm_add_ps(_mm_loadu_ps(outValues), value);
+            _mm_storeu_ps(outValues, value);
+        }
+    }
+    for (; output < outputCount; ++output) {
+        for (size_t r = 0; r < RowCount; ++r) {
+            float sum = DenseDot(a + r * inputCount, weights + output * inputCount, inputCount);
+            StoreOutput(out + r * outputCount + output, bias != nullptr ? bias[output] : 0.0f, sum, accumulate);
+        }
+    }
+}
+
+// Two rows at a time: 8 accumulators, 2 + 4 loads per 8 inputs
+GNN_AVX2 void DenseAvx2(const float* a, size_t rowCount, size_t inputCount, const float* weights, const float* bias, size_t outputCount,
+    float* out, bool accumulate)
+{
+    size_t row = 0;
+    for (; row + 2 <= rowCount; row += 2)
+        DenseRows<2>(a + row * inputCount, inputCount, weights, bias, outputCount, out + row * outputCount, accumulate);
+    if (row < rowCount)
+        DenseRows<1>(a + row * inputCount, inputCount, weights, bias, outputCount, out + row * outputCount, accumulate);
+}
+
+// max(0, x) keeps NaN, as std::max(x, 0.0f) does
+GNN_AVX2 void ReluAvx2(float* x, size_t count) {
+    __m256 zero = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(x + i, _mm256_max_ps(zero, _mm256_loadu_ps(x + i)));
+    for (; i < count; ++i)
+        x[i] = x[i] < 0.0f ? 0.0f : x[i];
+}
+
+// 32 values at a time: convert, pack to int16 and int8 with saturation, then undo the lane
+// interleaving of the packs
+GNN_AVX2 void QuantizeAvx2(const float* x, size_t count, float scale, std::uint8_t* q) {
+    float inverseScale = 1.0f / scale;
+    __m256 inverse = _mm256_set1_ps(inverseScale);
+    __m256 zero = _mm256_setzero_ps();
+    __m256 limit = _mm256_set1_ps(127.0f);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i values[4];
+        for (size_t k = 0; k < 4; ++k) {
+            // max(value, 0) gives 0 for NaN
+            __m256 value = _mm256_mul_ps(_mm256_loadu_ps(x + i + k * 8), inverse);
+            values[k] = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(value, zero), limit));
+        }
+        __m256i packed = _mm256_packs_epi16(_mm256_packs_epi32(values[0], values[1]), _mm256_packs_epi32(values[2], values[3]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(q + i), _mm256_permutevar8x32_epi32(packed, order));
+    }
+    for (; i < count; ++i) {
+        float value = x[i] * inverseScale;
+        value = value > 0.0f ? value : 0.0f;
+        value = value < 127.0f ? value : 127.0f;
+        q[i] = static_cast<std::uint8_t>(std::nearbyint(value));
+    }
+}
+
+// Lane i is the sum of the lanes of sumi
+GNN_AVX2 inline __m128i HorizontalSum4(__m256i sum0, __m256i sum1, __m256i sum2, __m256i sum3) {
+    __m256i sum = _mm256_hadd_epi32(_mm256_hadd_epi32(sum0, sum1), _mm256_hadd_epi32(sum2, sum3));
+    return _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+}
+
+// acc += 32 products of unsigned a and signed w, summed by 4. Pairs of products fit maddubs'
+// int16 since a is at most 127: 2 * 127 * 127 < 32767.
+GNN_AVX2 inline __m256i DotStep(__m256i a, __m256i w, __m256i acc) {
+    return _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_maddubs_epi16(a, w), _mm256_set1_epi16(1)));
+}
+
+// As DenseBlock4, with int32 sums
+template <size_t RowCount>
+GNN_AVX2 void DenseInt8Block4(const std::uint8_t* a, size_t inputCount, const std::int8_t* weights, size_t output, __m128i* sums) {
+    const std::int8_t* weightRows[4];
+    for (size_t k = 0; k < 4; ++k)
+        weightRows[k] = weights + (output + k) * inputCount;
+
+    __m256i acc[RowCount][4];
+    for (size_t r = 0; r < RowCount; ++r) {
+        for (size_t k = 0; k < 4; ++k)
+            acc[r][k] = _mm256_setzero_si256();
+    }
+
+    size_t input = 0;
+    for (; input + 32 <= inputCount; input += 32) {
+        __m256i weight[4];
+        for (size_t k = 0; k < 4; ++k)
+            weight[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weightRows[k] + input));
+        for (size_t r = 0; r < RowCount; ++r) {
+            __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + r * inputCount + input));
+            for (size_t k = 0; k < 4; ++k)
+                acc[r][k] = DotStep(value, weight[k], acc[r][k]);
+        }
+    }
+
+    for (size_t r = 0; r < RowCount; ++r)
+        sums[r] = HorizontalSum4(acc[r][0], acc[r][1], acc[r][2], acc[r][3]);
+    if (input == inputCount)
+        return;
+
+    alignas(16) std::int32_t tails[RowCount][4] = {};
+    for (; input < inputCount; ++input) {
+        for (size_t r = 0; r < RowCount; ++r) {
+            for (size_t k = 0; k < 4; ++k)
+                tails[r][k] += static_cast<std::int32_t>(a[r * inputCount + input]) * weightRows[k][input];
+        }
+    }
+    for (size_t r = 0; r < RowCount; ++r)
+        sums[r] = _mm_add_epi32(sums[r], _mm_load_si128(reinterpret_cast<const __m128i*>(tails[r])));
+}
+
+GNN_AVX2 std::int32_t DenseInt8Dot(const std::uint8_t* a, const std::int8_t* weightRow, size_t inputCount) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t input = 0;
+    for (; input + 32 <= inputCount; input += 32) {
+        acc = DotStep(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + input)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weightRow + input)), acc);
+    }
+    alignas(32) std::int32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    std::int32_t sum = 0;
+    for (std::int32_t lane : lanes)
+        sum += lane;
+    for (; input < inputCount; ++input)
+        sum += static_cast<std::int32_t>(a[input]) * weightRow[input];
+    return sum;
+}
+
+inline void StoreInt8Output(float* out, float bias, float scale, std::int32_t sum, bool accumulate) {
+    float value = bias + scale * static_cast<float>(sum);
+    *out = accumulate ? *out + value : value;
+}
+
+template <size_t RowCount>
+GNN_AVX2 void DenseInt8Rows(const std::uint8_t* a, size_t inputCount, const std::int8_t* weights, const float* scales, const float* bias,
+    size_t outputCount, float* out, bool accumulate)
+{
+    size_t output = 0;
+    for (; output + 4 <= outputCount; output += 4) {
+        __m128i sums[RowCount];
+        DenseInt8Block4<RowCount>(a, inputCount, weights, output, sums);
+        __m128 biasVector = bias != nullptr ? _mm_loadu_ps(bias + output) : _mm_setzero_ps();
+        __m128 scaleVector = _mm_loadu_ps(scales + output);
+        for (size_t r = 0; r < RowCount; ++r) {
+            float* outValues = out + r * outputCount + output;
+            __m128 value = _mm_add_ps(biasVector, _mm_mul_ps(scaleVector, _mm_cvtepi32_ps(sums[r])));
+            if (accumulate)
+                value = _mm_add_ps(_mm_loadu_ps(outValues), value);
+            _mm_storeu_ps(outValues, value);
+        }
+    }
+    for (; output < outputCount; ++output) {
+        for (size_t r = 0; r < RowCount; ++r) {
+            std::int32_t sum = DenseInt8Dot(a + r * inputCount, weights + output * inputCount, inputCount);
+            StoreInt8Output(out + r * outputCount + output, bias != nullptr ? bias[output] : 0.0f, scales[output], sum, accumulate);
+        }
+    }
+}
+
+// As DenseAvx2, 32 inputs per step instead of 8
+GNN_AVX2 void DenseInt8Avx2(const std::uint8_t* a, size_t rowCount, size_t inputCount, const std::int8_t* weights, const float* scales,
+    const float* bias, size_t outputCount, float* out, bool accumulate)
+{
+    size_t row = 0;
+    for (; row + 2 <= rowCount; row += 2)
+        DenseInt8Rows<2>(a + row * inputCount, inputCount, weights, scales, bias, outputCount, out + row * outputCount, accumulate);
+    if (row < rowCount)
+        DenseInt8Rows<1>(a + row * inputCount, inputCount, weights, scales, bias, outputCount, out + row * outputCount, accumulate);
+}
+
+const GnnKernelTable Avx2Kernels = { AggregateMeanAvx2, DenseAvx2, ReluAvx2, QuantizeAvx2, DenseInt8Avx2 };
+
+}
+
+const GnnKernelTable* GnnAvx2KernelTable() {
+    return &Avx2Kernels;
+}
+
+#else
+
+const GnnKernelTable* GnnAvx2KernelTable() {
+    return nullptr;
+}
+
+#endif
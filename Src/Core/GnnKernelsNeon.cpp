@@ -0,0 +1,311 @@
+#include "GnnKernels.hpp"
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+
+#include <arm_neon.h>
+#include <cmath>
+
+namespace {
+
+// Sums the columns of 16, then 4 at a time in registers over all neighbours, so every output is
+// stored once. Neighbours are added in the same order as the scalar kernel.
+void AggregateMeanNeon(const std::uint32_t* offsets, const std::uint32_t* targets, const float* x, size_t columnCount,
+    size_t rowBegin, size_t rowEnd, float* out)
+{
+    for (size_t row = rowBegin; row < rowEnd; ++row) {
+        float* outRow = out + (row - rowBegin) * columnCount;
+        std::uint32_t begin = offsets[row];
+        std::uint32_t end = offsets[row + 1];
+        if (begin == end) {
+            for (size_t column = 0; column < columnCount; ++column)
+                outRow[column] = 0.0f;
+            continue;
+        }
+
+        float scale = 1.0f / static_cast<float>(end - begin);
+
+        size_t column = 0;
+        for (; column + 16 <= columnCount; column += 16) {
+            float32x4_t sum0 = vdupq_n_f32(0.0f);
+            float32x4_t sum1 = vdupq_n_f32(0.0f);
+            float32x4_t sum2 = vdupq_n_f32(0.0f);
+            float32x4_t sum3 = vdupq_n_f32(0.0f);
+            for (std::uint32_t edge = begin; edge < end; ++edge) {
+                const float* neighbour = x + static_cast<size_t>(targets[edge]) * columnCount + column;
+                sum0 = vaddq_f32(sum0, vld1q_f32(neighbour));
+                sum1 = vaddq_f32(sum1, vld1q_f32(neighbour + 4));
+                sum2 = vaddq_f32(sum2, vld1q_f32(neighbour + 8));
+                sum3 = vaddq_f32(sum3, vld1q_f32(neighbour + 12));
+            }
+            vst1q_f32(outRow + column, vmulq_n_f32(sum0, scale));
+            vst1q_f32(outRow + column + 4, vmulq_n_f32(sum1, scale));
+            vst1q_f32(outRow + column + 8, vmulq_n_f32(sum2, scale));
+            vst1q_f32(outRow + column + 12, vmulq_n_f32(sum3, scale));
+        }
+        for (; column + 4 <= columnCount; column += 4) {
+            float32x4_t sum = vdupq_n_f32(0.0f);
+            for (std::uint32_t edge = begin; edge < end; ++edge)
+                sum = vaddq_f32(sum, vld1q_f32(x + static_cast<size_t>(targets[edge]) * columnCount + column));
+            vst1q_f32(outRow + column, vmulq_n_f32(sum, scale));
+        }
+        for (; column < columnCount; ++column) {
+            float sum = 0.0f;
+            for (std::uint32_t edge = begin; edge < end; ++edge)
+                sum += x[static_cast<size_t>(targets[edge]) * columnCount + column];
+            outRow[column] = sum * scale;
+        }
+    }
+}
+
+// Lane i is the sum of the lanes of sumi
+inline float32x4_t HorizontalSum4(float32x4_t sum0, float32x4_t sum1, float32x4_t sum2, float32x4_t sum3) {
+    return vpaddq_f32(vpaddq_f32(sum0, sum1), vpaddq_f32(sum2, sum3));
+}
+
+// Dot products of RowCount rows of a with 4 weight rows from output on, into sums[row]. Every
+// loaded row of a is used for 4 outputs and every weight row for RowCount rows.
+template <size_t RowCount>
+void DenseBlock4(const float* a, size_t inputCount, const float* weights, size_t output, float32x4_t* sums) {
+    const float* weightRows[4];
+    for (size_t k = 0; k < 4; ++k)
+        weightRows[k] = weights + (output + k) * inputCount;
+
+    float32x4_t acc[RowCount][4];
+    for (size_t r = 0; r < RowCount; ++r) {
+        for (size_t k = 0; k < 4; ++k)
+            acc[r][k] = vdupq_n_f32(0.0f);
+    }
+
+    size_t input = 0;
+    for (; input + 4 <= inputCount; input += 4) {
+        float32x4_t weight[4];
+        for (size_t k = 0; k < 4; ++k)
+            weight[k] = vld1q_f32(weightRows[k] + input);
+        for (size_t r = 0; r < RowCount; ++r) {
+            float32x4_t value = vld1q_f32(a + r * inputCount + input);
+            for (size_t k = 0; k < 4; ++k)
+                acc[r][k] = vfmaq_f32(acc[r][k], value, weight[k]);
+        }
+    }
+
+    for (size_t r = 0; r < RowCount; ++r)
+        sums[r] = HorizontalSum4(acc[r][0], acc[r][1], acc[r][2], acc[r][3]);
+    if (input == inputCount)
+        return;
+
+    float tails[RowCount][4] = {};
+    for (; input < inputCount; ++input) {
+        for (size_t r = 0; r < RowCount; ++r) {
+            for (size_t k = 0; k < 4; ++k)
+                tails[r][k] += a[r * inputCount + input] * weightRows[k][input];
+        }
+    }
+    for (size_t r = 0; r < RowCount; ++r)
+        sums[r] = vaddq_f32(sums[r], vld1q_f32(tails[r]));
+}
+
+float DenseDot(const float* a, const float* weightRow, size_t inputCount) {
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    size_t input = 0;
+    for (; input + 4 <= inputCount; input += 4)
+        acc = vfmaq_f32(acc, vld1q_f32(a + input), vld1q_f32(weightRow + input));
+    float sum = vaddvq_f32(acc);
+    for (; input < inputCount; ++input)
+        sum += a[input] * weightRow[input];
+    return sum;
+}
+
+inline void StoreOutput(float* out, float bias, float sum, bool accumulate) {
+    *out = accumulate ? *out + (bias + sum) : bias + sum;
+}
+
+template <size_t RowCount>
+void DenseRows(const float* a, size_t inputCount, const float* weights, const float* bias, size_t outputCount,
+    float* out, bool accumulate)
+{
+    size_t output = 0;
+    for (; output + 4 <= outputCount; output += 4) {
+        float32x4_t sums[RowCount];
+        DenseBlock4<RowCount>(a, inputCount, weights, output, sums);
+        float32x4_t biasVector = bias != nullptr ? vld1q_f32(bias + output) : vdupq_n_f32(0.0f);
+        for (size_t r = 0; r < RowCount; ++r) {
+            float* outValues = out + r * outputCount + output;
+            float32x4_t value = vaddq_f32(biasVector, sums[r]);
+            if (accumulate)
+                value = vaddq_f32(vld1q_f32(outValues), value);
+            vst1q_f32(outValues, value);
+        }
+    }
+    for (; output < outputCount; ++output) {
+        for (size_t r = 0; r < RowCount; ++r) {
+            float sum = DenseDot(a + r * inputCount, weights + output * inputCount, inputCount);
+            StoreOutput(out + r * outputCount + output, bias != nullptr ? bias[output] : 0.0f, sum, accumulate);
+        }
+    }
+}
+
+// Two rows at a time: 8 accumulators, 2 + 4 loads per 4 inputs
+void DenseNeon(const float* a, size_t rowCount, size_t inputCount, const float* weights, const float* bias, size_t outputCount,
+    float* out, bool accumulate)
+{
+    size_t row = 0;
+    for (; row + 2 <= rowCount; row += 2)
+        DenseRows<2>(a + row * inputCount, inputCount, weights, bias, outputCount, out + row * outputCount, accumulate);
+    if (row < rowCount)
+        DenseRows<1>(a + row * inputCount, inputCount, weights, bias, outputCount, out + row * outputCount, accumulate);
+}
+
+// vmaxq_f32 keeps NaN, as std::max(x, 0.0f) does
+void ReluNeon(float* x, size_t count) {
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        vst1q_f32(x + i, vmaxq_f32(vld1q_f32(x + i), zero));
+    for (; i < count; ++i)
+        x[i] = x[i] < 0.0f ? 0.0f : x[i];
+}
+
+// 16 values at a time: convert, then narrow to int16 and uint8 with saturation
+void QuantizeNeon(const float* x, size_t count, float scale, std::uint8_t* q) {
+    float inverseScale = 1.0f / scale;
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t limit = vdupq_n_f32(127.0f);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        int32x4_t values[4];
+        for (size_t k = 0; k < 4; ++k) {
+            // vmaxnmq_f32 gives 0 for NaN
+            float32x4_t value = vmulq_n_f32(vld1q_f32(x + i + k * 4), inverseScale);
+            values[k] = vcvtnq_s32_f32(vminq_f32(vmaxnmq_f32(value, zero), limit));
+        }
+        int16x8_t low = vcombine_s16(vqmovn_s32(values[0]), vqmovn_s32(values[1]));
+        int16x8_t high = vcombine_s16(vqmovn_s32(values[2]), vqmovn_s32(values[3]));
+        vst1q_u8(q + i, vcombine_u8(vqmovun_s16(low), vqmovun_s16(high)));
+    }
+    for (; i < count; ++i) {
+        float value = x[i] * inverseScale;
+        value = value > 0.0f ? value : 0.0f;
+        value = value < 127.0f ? value : 127.0f;
+        q[i] = static_cast<std::uint8_t>(std::nearbyint(value));
+    }
+}
+
+// acc += 16 products of a and w, summed by 4. a is at most 127, so it reads as int8 and pairs of
+// products fit int16: 2 * 127 * 127 < 32767.
+inline int32x4_t DotStep(uint8x16_t a, int8x16_t w, int32x4_t acc) {
+    int8x16_t value = vreinterpretq_s8_u8(a);
+    int16x8_t products = vmull_s8(vget_low_s8(value), vget_low_s8(w));
+    products = vmlal_s8(products, vget_high_s8(value), vget_high_s8(w));
+    return vpadalq_s16(acc, products);
+}
+
+// As DenseBlock4, with int32 sums
+template <size_t RowCount>
+void DenseInt8Block4(const std::uint8_t* a, size_t inputCount, const std::int8_t* weights, size_t output, int32x4_t* sums) {
+    const std::int8_t* weightRows[4];
+    for (size_t k = 0; k < 4; ++k)
+        weightRows[k] = weights + (output + k) * inputCount;
+
+    int32x4_t acc[RowCount][4];
+    for (size_t r = 0; r < RowCount; ++r) {
+        for (size_t k = 0; k < 4; ++k)
+            acc[r][k] = vdupq_n_s32(0);
+    }
+
+    size_t input = 0;
+    for (; input + 16 <= inputCount; input += 16) {
+        int8x16_t weight[4];
+        for (size_t k = 0; k < 4; ++k)
+            weight[k] = vld1q_s8(weightRows[k] + input);
+        for (size_t r = 0; r < RowCount; ++r) {
+            uint8x16_t value = vld1q_u8(a + r * inputCount + input);
+            for (size_t k = 0; k < 4; ++k)
+                acc[r][k] = DotStep(value, weight[k], acc[r][k]);
+        }
+    }
+
+    for (size_t r = 0; r < RowCount; ++r)
+        sums[r] = vpaddq_s32(vpaddq_s32(acc[r][0], acc[r][1]), vpaddq_s32(acc[r][2], acc[r][3]));
+    if (input == inputCount)
+        return;
+
+    std::int32_t tails[RowCount][4] = {};
+    for (; input < inputCount; ++input) {
+        for (size_t r = 0; r < RowCount; ++r) {
+            for (size_t k = 0; k < 4; ++k)
+                tails[r][k] += static_cast<std::int32_t>(a[r * inputCount + input]) * weightRows[k][input];
+        }
+    }
+    for (size_t r = 0; r < RowCount; ++r)
+        sums[r] = vaddq_s32(sums[r], vld1q_s32(tails[r]));
+}
+
+std::int32_t DenseInt8Dot(const std::uint8_t* a, const std::int8_t* weightRow, size_t inputCount) {
+    int32x4_t acc = vdupq_n_s32(0);
+    size_t input = 0;
+    for (; input + 16 <= inputCount; input += 16)
+        acc = DotStep(vld1q_u8(a + input), vld1q_s8(weightRow + input), acc);
+    std::int32_t sum = vaddvq_s32(acc);
+    for (; input < inputCount; ++input)
+        sum += static_cast<std::int32_t>(a[input]) * weightRow[input];
+    return sum;
+}
+
+inline void StoreInt8Output(float* out, float bias, float scale, std::int32_t sum, bool accumulate) {
+    float value = bias + scale * static_cast<float>(sum);
+    *out = accumulate ? *out + value : value;
+}
+
+template <size_t RowCount>
+void DenseInt8Rows(const std::uint8_t* a, size_t inputCount, const std::int8_t* weights, const float* scales, const float* bias,
+    size_t outputCount, float* out, bool accumulate)
+{
+    size_t output = 0;
+    for (; output + 4 <= outputCount; output += 4) {
+        int32x4_t sums[RowCount];
+        DenseInt8Block4<RowCount>(a, inputCount, weights, output, sums);
+        float32x4_t biasVector = bias != nullptr ? vld1q_f32(bias + output) : vdupq_n_f32(0.0f);
+        float32x4_t scaleVector = vld1q_f32(scales + output);
+        for (size_t r = 0; r < RowCount; ++r) {
+            float* outValues = out + r * outputCount + output;
+            float32x4_t value = vaddq_f32(biasVector, vmulq_f32(scaleVector, vcvtq_f32_s32(sums[r])));
+            if (accumulate)
+                value = vaddq_f32(vld1q_f32(outValues), value);
+            vst1q_f32(outValues, value);
+        }
+    }
+    for (; output < outputCount; ++output) {
+        for (size_t r = 0; r < RowCount; ++r) {
+            std::int32_t sum = DenseInt8Dot(a + r * inputCount, weights + output * inputCount, inputCount);
+            StoreInt8Output(out + r * outputCount + output, bias != nullptr ? bias[output] : 0.0f, scales[output], sum, accumulate);
+        }
+    }
+}
+
+// As DenseNeon, 16 inputs per step instead of 4
+void DenseInt8Neon(const std::uint8_t* a, size_t rowCount, size_t inputCount, const std::int8_t* weights, const float* scales,
+    const float* bias, size_t outputCount, float* out, bool accumulate)
+{
+    size_t row = 0;
+    for (; row + 2 <= rowCount; row += 2)
+        DenseInt8Rows<2>(a + row * inputCount, inputCount, weights, scales, bias, outputCount, out + row * outputCount, accumulate);
+    if (row < rowCount)
+        DenseInt8Rows<1>(a + row * inputCount, inputCount, weights, scales, bias, outputCount, out + row * outputCount, accumulate);
+}
+
+const GnnKernelTable NeonKernels = { AggregateMeanNeon, DenseNeon, ReluNeon, QuantizeNeon, DenseInt8Neon };
+
+}
+
+const GnnKernelTable* GnnNeonKernelTable() {
+    return &NeonKernels;
+}
+
+#else
+
+const GnnKernelTable* GnnNeonKernelTable() {
+    return nullptr;
+}
+
+#endif
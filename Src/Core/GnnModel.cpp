@@ -0,0 +1,594 @@
+#include "GnnModel.hpp"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include "MappedFile.hpp"
+
+namespace {
+
+const char          ModelMagic[8] = { 'E', 'X', 'V', '2', 'G', 'N', 'N', 'M' };
+const std::uint32_t ModelVersion = 3;
+const std::uint32_t FlaggedModelVersion = 2;   // flags after the version, not mapped
+const std::uint32_t FloatModelVersion = 1;     // without flags, not mapped
+
+const std::uint32_t FlagQuantized = 1;
+
+// Fixed part of the version 3 header, up to and with the checksum
+const size_t HeaderSize = 32;
+const size_t HeaderSizeOffset = 16;
+const size_t ChecksumOffset = 24;
+// Size of an entry of the section table
+const size_t SectionEntrySize = 3 * sizeof(std::uint64_t);
+
+// Sections and arrays start on a cache line, so the SIMD kernels read them without splits
+const size_t Alignment = 64;
+
+// Larger sizes are taken for a corrupt file
+const std::uint32_t MaxHiddenSize = 65536;
+const std::uint32_t MaxLayerCount = 64;
+
+size_t AlignUp(size_t offset) {
+    return (offset + Alignment - 1) / Alignment * Alignment;
+}
+
+// 64-bit FNV-1a, continued from hash
+std::uint64_t Checksum(const char* data, size_t size, std::uint64_t hash = 0xCBF29CE484222325ull) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+// Checksum of a version 3 header, with the checksum field taken as 0
+std::uint64_t HeaderChecksum(const char* data, size_t headerSize) {
+    const char zeros[sizeof(std::uint64_t)] = {};
+    std::uint64_t hash = Checksum(data, ChecksumOffset);
+    hash = Checksum(zeros, sizeof(zeros), hash);
+    return Checksum(data + HeaderSize, headerSize - HeaderSize, hash);
+}
+
+// Appends the model fields to one buffer, written to the file in one go
+class ModelWriter {
+public:
+    void Raw(const void* data, size_t size) { buffer.append(static_cast<const char*>(data), size); }
+
+    template <typename T>
+    void Value(T value) { Raw(&value, sizeof(T)); }
+
+    template <typename T>
+    void Patch(size_t offset, T value) { std::memcpy(&buffer[offset], &value, sizeof(T)); }
+
+    void Count(size_t count) { Value(static_cast<std::uint32_t>(count)); }
+
+    void String(const std::string& str) {
+        Count(str.size());
+        Raw(str.data(), str.size());
+    }
+
+    void Align() { buffer.resize(AlignUp(buffer.size()), '\0'); }
+
+    template <typename T>
+    void Array(const GnnTensor<T>& values) {
+        Align();
+        Raw(values.data(), values.size() * sizeof(T));
+    }
+
+    void Matrix(const GnnTensor<float>& weights, const GnnQuantizedWeights& quantizedWeights, bool quantized) {
+        if (quantized) {
+            Array(quantizedWeights.scales);
+            Array(quantizedWeights.values);
+        }
+        else
+            Array(weights);
+    }
+
+    size_t             GetSize() const { return buffer.size(); }
+    const std::string& GetBuffer() const { return buffer; }
+
+private:
+    std::string buffer;
+};
+
+// Reads the fields back, every read is bounds checked and a short file fails the whole load
+class ModelReader {
+public:
+    ModelReader(const char* data, size_t size) : data(data), size(size), offset(0), failed(false) {}
+
+    bool IsFailed() const { return failed; }
+    void Fail() { failed = true; }
+
+    void Raw(void* out, size_t count) {
+        if (failed || size - offset < count) {
+            failed = true;
+            std::memset(out, 0, count);
+            return;
+        }
+        std::memcpy(out, data + offset, count);
+        offset += count;
+    }
+
+    template <typename T>
+    T Value() {
+        T value;
+        Raw(&value, sizeof(T));
+        return value;
+    }
+
+    // Counts are checked against the bytes left, so a corrupt count cannot trigger a huge allocation
+    size_t Count(size_t minItemSize) {
+        size_t count = Value<std::uint32_t>();
+        if (failed || count > (size - offset) / minItemSize) {
+            failed = true;
+            return 0;
+        }
+        return count;
+    }
+
+    template <typename T>
+    void Array(GnnTensor<T>& values, size_t count) {
+        if (failed || count > (size - offset) / sizeof(T)) {
+            failed = true;
+            values.clear();
+            return;
+        }
+        std::vector<T> array(count);
+        Raw(array.data(), count * sizeof(T));
+        values = std::move(array);
+    }
+
+    void String(std::string& str) {
+        size_t length = Count(1);
+        str.assign(failed ? "" : data + offset, length);
+        offset += length;
+    }
+
+    // Version 2 layout of quantized weights
+    void Quantized(GnnQuantizedWeights& weights, size_t outputCount, size_t inputCount) {
+        weights.inputScale = Value<float>();
+        Array(weights.scales, outputCount);
+        if (failed || (inputCount > 0 && outputCount > (size - offset) / inputCount)) {
+            failed = true;
+            weights.values.clear();
+            return;
+        }
+        Array(weights.values, outputCount * inputCount);
+    }
+
+    void Matrix(GnnTensor<float>& weights, GnnQuantizedWeights& quantizedWeights, bool quantized, size_t outputCount,
+        size_t inputCount)
+    {
+        if (quantized)
+            Quantized(quantizedWeights, outputCount, inputCount);
+        else
+            Array(weights, outputCount * inputCount);
+    }
+
+private:
+    const char* data;
+    size_t      size;
+    size_t      offset;
+    bool        failed;
+};
+
+// Hands out the arrays of one section of a mapped version 3 file as views, in file order
+class SectionReader {
+public:
+    SectionReader(const char* data, size_t size) : data(data), size(size), offset(0), failed(false) {}
+
+    bool IsFailed() const { return failed; }
+
+    template <typename T>
+    void Array(GnnTensor<T>& values, size_t count) {
+        offset = AlignUp(offset);
+        if (failed || offset > size || count > (size - offset) / sizeof(T)) {
+            failed = true;
+            values.clear();
+            return;
+        }
+        values = GnnTensor<T>::View(reinterpret_cast<const T*>(data + offset), count);
+        offset += count * sizeof(T);
+    }
+
+    void Matrix(GnnTensor<float>& weights, GnnQuantizedWeights& quantizedWeights, bool quantized, size_t outputCount,
+        size_t inputCount)
+    {
+        if (quantized) {
+            Array(quantizedWeights.scales, outputCount);
+            Array(quantizedWeights.values, outputCount * inputCount);
+        }
+        else
+            Array(weights, outputCount * inputCount);
+    }
+
+private:
+    const char* data;
+    size_t      size;
+    size_t      offset;
+    bool        failed;
+};
+
+void WriteInputDescription(ModelWriter& writer, const GnnNodeInput& input) {
+    writer.Value(static_cast<std::uint8_t>(input.type));
+    writer.Value(static_cast<std::uint8_t>(input.predicted ? 1 : 0));
+    writer.Count(input.GetFeatureCount());
+    for (size_t feature = 0; feature < input.GetFeatureCount(); ++feature) {
+        writer.String(input.featureNames[feature]);
+        writer.Value(input.featureMeans[feature]);
+        writer.Value(input.featureScales[feature]);
+    }
+}
+
+void ReadInputDescription(ModelReader& reader, GnnNodeInput& input) {
+    input.type = static_cast<GraphNodeType>(reader.Value<std::uint8_t>());
+    input.predicted = reader.Value<std::uint8_t>() != 0;
+    size_t featureCount = reader.Count(sizeof(std::uint32_t) + 2 * sizeof(float));
+    input.featureNames.resize(featureCount);
+    input.featureMeans.resize(featureCount);
+    input.featureScales.resize(featureCount);
+    for (size_t feature = 0; feature < featureCount; ++feature) {
+        reader.String(input.featureNames[feature]);
+        input.featureMeans[feature] = reader.Value<float>();
+        input.featureScales[feature] = reader.Value<float>();
+    }
+}
+
+}
+
+class GnnWeightFile {
+public:
+    struct Section {
+        size_t        offset;
+        size_t        size;
+        std::uint64_t checksum;
+    };
+
+    MappedFile           file;
+    std::vector<Section> sections;
+
+    void ResetPageIn() {
+        pageInOnce.reset(new std::once_flag[sections.size()]);
+        pageInResults.assign(sections.size(), HostNoError);
+    }
+
+    HostError PageIn(size_t section) const {
+        if (section >= sections.size())
+            return HostErrBadFormat;
+        std::call_once(pageInOnce[section], [&]() {
+            const Section& entry = sections[section];
+            pageInResults[section] = Checksum(file.GetData() + entry.offset, entry.size) == entry.checksum ? HostNoError : HostErrBadFormat;
+        });
+        return pageInResults[section];
+    }
+
+private:
+    mutable std::unique_ptr<std::once_flag[]> pageInOnce;
+    mutable std::vector<HostError>            pageInResults;
+};
+
+bool GnnQuantizedWeights::IsConsistent(size_t outputCount, size_t inputCount) const {
+    return values.size() == outputCount * inputCount && scales.size() == outputCount && inputScale > 0.0f && std::isfinite(inputScale);
+}
+
+void GnnModel::Clear() {
+    hiddenSize = 0;
+    classLabelTypes.clear();
+    edgeTypes.clear();
+    inputs.clear();
+    layers.clear();
+    outputWeights.clear();
+    outputBias.clear();
+    quantizedOutputWeights = GnnQuantizedWeights();
+    quantized = false;
+    weightFile.reset();
+    InvalidateChecksum();
+}
+
+const GnnNodeInput* GnnModel::FindInput(GraphNodeType type) const {
+    for (const GnnNodeInput& input : inputs) {
+        if (input.type == type)
+            return &input;
+    }
+    return nullptr;
+}
+
+bool GnnModel::IsConsistent() const {
+    if (hiddenSize == 0 || classLabelTypes.empty() || inputs.empty())
+        return false;
+
+    bool hasPrediction = false;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const GnnNodeInput& input = inputs[i];
+        size_t featureCount = input.GetFeatureCount();
+        if (static_cast<size_t>(input.type) >= GraphNodeTypeCount || FindInput(input.type) != &input ||
+            input.featureMeans.size() != featureCount || input.featureScales.size() != featureCount ||
+            input.weights.size() != hiddenSize * featureCount || input.bias.size() != hiddenSize)
+            return false;
+        hasPrediction = hasPrediction || input.predicted;
+    }
+
+    for (const GnnLayer& layer : layers) {
+        bool weightsFit = quantized ?
+            layer.quantizedSelfWeights.IsConsistent(hiddenSize, hiddenSize) && layer.quantizedNeighbourWeights.IsConsistent(hiddenSize, hiddenSize) :
+            layer.selfWeights.size() == hiddenSize * hiddenSize && layer.neighbourWeights.size() == hiddenSize * hiddenSize;
+        if (!weightsFit || layer.bias.size() != hiddenSize)
+            return false;
+    }
+    bool outputFits = quantized ? quantizedOutputWeights.IsConsistent(GetClassCount(), hiddenSize) :
+        outputWeights.size() == GetClassCount() * hiddenSize;
+    return hasPrediction && outputFits && outputBias.size() == GetClassCount();
+}
+
+size_t GnnModel::GetWeightSize() const {
+    auto quantizedSize = [](const GnnQuantizedWeights& weights) {
+        return weights.values.size() + (weights.scales.size() + 1) * sizeof(float);
+    };
+    size_t size = (outputWeights.size() + outputBias.size()) * sizeof(float) + quantizedSize(quantizedOutputWeights);
+    for (const GnnNodeInput& input : inputs)
+        size += (input.weights.size() + input.bias.size()) * sizeof(float);
+    for (const GnnLayer& layer : layers) {
+        size += (layer.selfWeights.size() + layer.neighbourWeights.size() + layer.bias.size()) * sizeof(float);
+        size += quantizedSize(layer.quantizedSelfWeights) + quantizedSize(layer.quantizedNeighbourWeights);
+    }
+    return size;
+}
+
+HostError GnnModel::PageInInputLayer(size_t input) const {
+    return weightFile != nullptr ? weightFile->PageIn(input) : HostNoError;
+}
+
+HostError GnnModel::PageInLayer(size_t layer) const {
+    return weightFile != nullptr ? weightFile->PageIn(inputs.size() + layer) : HostNoError;
+}
+
+HostError GnnModel::PageInOutputLayer() const {
+    return weightFile != nullptr ? weightFile->PageIn(inputs.size() + layers.size()) : HostNoError;
+}
+
+HostError GnnModel::PageInAll() const {
+    for (size_t section = 0; weightFile != nullptr && section < inputs.size() + layers.size() + 1; ++section) {
+        HostError err = weightFile->PageIn(section);
+        if (err != HostNoError)
+            return err;
+    }
+    return HostNoError;
+}
+
+namespace {
+
+// Version 3 file of model: the header, padded to the first section, and the sections
+void WriteModelFile(const GnnModel& model, ModelWriter& writer, ModelWriter& sections) {
+    // Sections first, at offsets from the end of the header until its size is known
+    std::vector<GnnWeightFile::Section> table;
+    auto beginSection = [&]() {
+        sections.Align();
+        table.push_back({ sections.GetSize(), 0, 0 });
+    };
+    auto endSection = [&]() {
+        GnnWeightFile::Section& section = table.back();
+        section.size = sections.GetSize() - section.offset;
+        section.checksum = Checksum(sections.GetBuffer().data() + section.offset, section.size);
+    };
+    for (const GnnNodeInput& input : model.inputs) {
+        beginSection();
+        sections.Array(input.weights);
+        sections.Array(input.bias);
+        endSection();
+    }
+    for (const GnnLayer& layer : model.layers) {
+        beginSection();
+        sections.Matrix(layer.selfWeights, layer.quantizedSelfWeights, model.quantized);
+        sections.Matrix(layer.neighbourWeights, layer.quantizedNeighbourWeights, model.quantized);
+        sections.Array(layer.bias);
+        endSection();
+    }
+    beginSection();
+    sections.Matrix(model.outputWeights, model.quantizedOutputWeights, model.quantized);
+    sections.Array(model.outputBias);
+    endSection();
+
+    writer.Raw(ModelMagic, sizeof(ModelMagic));
+    writer.Value(ModelVersion);
+    writer.Value(model.quantized ? FlagQuantized : 0);
+    writer.Value(std::uint32_t(0));             // header size, patched below
+    writer.Count(table.size());
+    writer.Value(std::uint64_t(0));             // checksum
+    writer.Count(model.hiddenSize);
+    writer.Count(model.layers.size());
+    writer.Count(model.classLabelTypes.size());
+    for (int labelType : model.classLabelTypes)
+        writer.Value(static_cast<std::int32_t>(labelType));
+
+    writer.Count(model.edgeTypes.size());
+    for (const std::string& edgeType : model.edgeTypes)
+        writer.String(edgeType);
+
+    writer.Count(model.inputs.size());
+    for (const GnnNodeInput& input : model.inputs)
+        WriteInputDescription(writer, input);
+
+    if (model.quantized) {
+        for (const GnnLayer& layer : model.layers) {
+            writer.Value(layer.quantizedSelfWeights.inputScale);
+            writer.Value(layer.quantizedNeighbourWeights.inputScale);
+        }
+        writer.Value(model.quantizedOutputWeights.inputScale);
+    }
+
+    size_t headerSize = writer.GetSize() + table.size() * SectionEntrySize;
+    size_t sectionsOffset = AlignUp(headerSize);
+    for (const GnnWeightFile::Section& section : table) {
+        writer.Value(static_cast<std::uint64_t>(sectionsOffset + section.offset));
+        writer.Value(static_cast<std::uint64_t>(section.size));
+        writer.Value(section.checksum);
+    }
+    writer.Patch(HeaderSizeOffset, static_cast<std::uint32_t>(headerSize));
+    writer.Patch(ChecksumOffset, HeaderChecksum(writer.GetBuffer().data(), headerSize));
+    writer.Align();
+}
+
+}
+
+HostError GnnModel::Save(const std::string& filePath) const {
+    if (!IsConsistent())
+        return HostErrBadFormat;
+
+    ModelWriter writer;
+    ModelWriter sections;
+    WriteModelFile(*this, writer, sections);
+
+    std::ofstream outFile(filePath, std::ios::binary);
+    if (!outFile.is_open())
+        return HostErrFileIO;
+    outFile.write(writer.GetBuffer().data(), static_cast<std::streamsize>(writer.GetBuffer().size()));
+    outFile.write(sections.GetBuffer().data(), static_cast<std::streamsize>(sections.GetBuffer().size()));
+    outFile.close();
+    return outFile.fail() ? HostErrFileIO : HostNoError;
+}
+
+std::uint64_t GnnModel::GetChecksum() const {
+    if (checksum == 0) {
+        ModelWriter writer;
+        ModelWriter sections;
+        WriteModelFile(*this, writer, sections);
+        // The header holds the checksums of the sections
+        checksum = Checksum(writer.GetBuffer().data(), writer.GetBuffer().size());
+    }
+    return checksum;
+}
+
+HostError GnnModel::Load(const std::string& filePath) {
+    Clear();
+
+    std::shared_ptr<GnnWeightFile> file = std::make_shared<GnnWeightFile>();
+    HostError err = file->file.Open(filePath);
+    if (err != HostNoError)
+        return err;
+    const char* data = file->file.GetData();
+    size_t size = file->file.GetSize();
+
+    ModelReader reader(data, size);
+    char magic[sizeof(ModelMagic)];
+    reader.Raw(magic, sizeof(magic));
+    if (reader.IsFailed() || std::memcmp(magic, ModelMagic, sizeof(magic)) != 0)
+        return HostErrBadFormat;
+    std::uint32_t version = reader.Value<std::uint32_t>();
+    if (version != ModelVersion && version != FlaggedModelVersion && version != FloatModelVersion)
+        return HostErrBadFormat;
+    std::uint32_t flags = version == FloatModelVersion ? 0 : reader.Value<std::uint32_t>();
+    if ((flags & ~FlagQuantized) != 0)
+        return HostErrBadFormat;
+    quantized = (flags & FlagQuantized) != 0;
+
+    // Version 3: everything up to the section table is read from a checked copy of the header
+    size_t sectionCount = 0;
+    std::uint64_t headerChecksum = 0;
+    if (version == ModelVersion) {
+        size_t headerSize = reader.Value<std::uint32_t>();
+        sectionCount = reader.Value<std::uint32_t>();
+        headerChecksum = reader.Value<std::uint64_t>();
+        if (reader.IsFailed() || headerSize < HeaderSize || headerSize > size || HeaderChecksum(data, headerSize) != headerChecksum)
+            return HostErrBadFormat;
+        reader = ModelReader(data + HeaderSize, headerSize - HeaderSize);
+    }
+
+    hiddenSize = reader.Value<std::uint32_t>();
+    std::uint32_t layerCount = reader.Value<std::uint32_t>();
+    if (hiddenSize > MaxHiddenSize || layerCount > MaxLayerCount)
+        reader.Fail();
+
+    classLabelTypes.resize(reader.Count(sizeof(std::int32_t)));
+    for (int& labelType : classLabelTypes)
+        labelType = reader.Value<std::int32_t>();
+
+    edgeTypes.resize(reader.Count(sizeof(std::uint32_t)));
+    for (std::string& edgeType : edgeTypes)
+        reader.String(edgeType);
+
+    if (version == ModelVersion) {
+        inputs.resize(reader.Count(2 + sizeof(std::uint32_t)));
+        for (GnnNodeInput& input : inputs)
+            ReadInputDescription(reader, input);
+        layers.resize(reader.IsFailed() ? 0 : layerCount);
+        if (quantized) {
+            for (GnnLayer& layer : layers) {
+                layer.quantizedSelfWeights.inputScale = reader.Value<float>();
+                layer.quantizedNeighbourWeights.inputScale = reader.Value<float>();
+            }
+            quantizedOutputWeights.inputScale = reader.Value<float>();
+        }
+
+        if (sectionCount != inputs.size() + layers.size() + 1)
+            reader.Fail();
+        file->sections.resize(reader.IsFailed() ? 0 : sectionCount);
+        for (GnnWeightFile::Section& section : file->sections) {
+            section.offset = static_cast<size_t>(reader.Value<std::uint64_t>());
+            section.size = static_cast<size_t>(reader.Value<std::uint64_t>());
+            section.checksum = reader.Value<std::uint64_t>();
+            if (section.offset % Alignment != 0 || section.offset > size || section.size > size - section.offset)
+                reader.Fail();
+        }
+        if (reader.IsFailed()) {
+            Clear();
+            return HostErrBadFormat;
+        }
+
+        // Views into the sections, read from disk when a run pages them in
+        bool failed = false;
+        auto sectionReader = [&](size_t section) {
+            return SectionReader(data + file->sections[section].offset, file->sections[section].size);
+        };
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            SectionReader section = sectionReader(i);
+            section.Array(inputs[i].weights, hiddenSize * inputs[i].GetFeatureCount());
+            section.Array(inputs[i].bias, hiddenSize);
+            failed = failed || section.IsFailed();
+        }
+        for (size_t l = 0; l < layers.size(); ++l) {
+            GnnLayer& layer = layers[l];
+            SectionReader section = sectionReader(inputs.size() + l);
+            section.Matrix(layer.selfWeights, layer.quantizedSelfWeights, quantized, hiddenSize, hiddenSize);
+            section.Matrix(layer.neighbourWeights, layer.quantizedNeighbourWeights, quantized, hiddenSize, hiddenSize);
+            section.Array(layer.bias, hiddenSize);
+            failed = failed || section.IsFailed();
+        }
+        SectionReader section = sectionReader(inputs.size() + layers.size());
+        section.Matrix(outputWeights, quantizedOutputWeights, quantized, GetClassCount(), hiddenSize);
+        section.Array(outputBias, GetClassCount());
+        failed = failed || section.IsFailed();
+
+        if (failed || !IsConsistent()) {
+            Clear();
+            return HostErrBadFormat;
+        }
+        file->ResetPageIn();
+        weightFile = std::move(file);
+        // The header was checked against it above and holds the checksums of the sections
+        checksum = headerChecksum;
+        return HostNoError;
+    }
+
+    // Versions 1 and 2: weights next to every input, then the layers, copied into memory
+    inputs.resize(reader.Count(2 + sizeof(std::uint32_t)));
+    for (GnnNodeInput& input : inputs) {
+        ReadInputDescription(reader, input);
+        reader.Array(input.weights, hiddenSize * input.GetFeatureCount());
+        reader.Array(input.bias, hiddenSize);
+    }
+
+    layers.resize(reader.IsFailed() ? 0 : layerCount);
+    for (GnnLayer& layer : layers) {
+        reader.Matrix(layer.selfWeights, layer.quantizedSelfWeights, quantized, hiddenSize, hiddenSize);
+        reader.Matrix(layer.neighbourWeights, layer.quantizedNeighbourWeights, quantized, hiddenSize, hiddenSize);
+        reader.Array(layer.bias, hiddenSize);
+    }
+    reader.Matrix(outputWeights, quantizedOutputWeights, quantized, GetClassCount(), hiddenSize);
+    reader.Array(outputBias, GetClassCount());
+
+    if (reader.IsFailed() || !IsConsistent()) {
+        Clear();
+        return HostErrBadFormat;
+    }
+    return HostNoError;
+}
@@ -0,0 +1,182 @@
+#ifndef GNN_MODEL_HPP
+#define GNN_MODEL_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ElementGraph.hpp"
+#include "HostTypes.hpp"
+
+// Weights of the label type classifier, a GraphSAGE-style node classifier over the element graph.
+// Every node type the model knows gets its own input layer, the hidden layers are shared:
+//   h0(v)     = ReLU(inputWeights[t] * (x(v) - mean) * scale + inputBias[t])     t the type of v
+//   hl+1(v)   = ReLU(selfWeights[l] * hl(v) + neighbourWeights[l] * mean(hl(u), u next to v) + bias[l])
+//   logits(v) = outputWeights * hL(v) + outputBias                               predicted types only
+// Features are picked from the graph by name, NaN counts as the mean. Neighbours follow the
+// model's edge types in both directions; nodes of types the model does not list take no part.
+//
+// A quantized model (QuantizeGnnModel) keeps the hidden and output layer weights as int8 with one
+// scale per output, and quantizes the activations entering them with calibrated scales. The input
+// layers, whose inputs can be negative, and the biases stay float.
+//
+// Saved as a weight container (little-endian) that Load maps read-only instead of copying:
+//   char[8]  magic "EXV2GNNM"
+//   uint32   version (3)
+//   uint32   flags: 1 quantized
+//   uint32   header size, up to the end of the section table
+//   uint32   section count: one per input layer, one per layer, one for the output layer
+//   uint64   checksum of the header, taking this field as 0
+//   uint32   hidden size, layer count, class count
+//   int32    label type of every class (PredLabelNone: no annotation)
+//   uint32   edge type count, edge type names
+//   uint32   node type count, per node type:
+//     uint8  GraphNodeType, uint8 predicted, uint32 feature count
+//     per feature: name, float mean, float scale
+//   quantized only: per layer float self and neighbour input scale, then float output input scale
+//   per section: uint64 offset, uint64 size, uint64 checksum
+// followed by the sections, each at a multiple of 64 bytes, as every array in them:
+//   input layer:  float[hidden size][feature count] weights, float[hidden size] bias
+//   layer:        self weights, neighbour weights, float[hidden size] bias
+//   output layer: output weights, float[class count] bias
+// Names are stored as uint32 length and bytes. Weight matrices are row-major with one row per
+// output: float[rows][columns], or float[rows] row scales and int8[rows][columns] in a quantized
+// model. Checksums are 64-bit FNV-1a. The header is checked by Load, a section the first time its
+// layer is used (PageIn...), so only the layers a run needs are read from disk.
+//
+// Versions 1 (float, no flags) and 2 (flags after the version) stored the description and the
+// arrays one after the other without alignment or checksums, training code may still write
+// them. They are parsed into memory; Save writes version 3.
+
+// Weights of a GnnModel: an array of its own, or a read-only view into the mapped model file.
+// Writing to a view copies it first.
+template <typename T>
+class GnnTensor {
+public:
+    GnnTensor() : view(nullptr), viewSize(0) {}
+    GnnTensor(std::vector<T> values) : values(std::move(values)), view(nullptr), viewSize(0) {}
+
+    static GnnTensor View(const T* data, size_t size) {
+        GnnTensor tensor;
+        tensor.view = size > 0 ? data : nullptr;
+        tensor.viewSize = size;
+        return tensor;
+    }
+
+    bool     IsView() const { return view != nullptr; }
+    size_t   size() const { return view != nullptr ? viewSize : values.size(); }
+    bool     empty() const { return size() == 0; }
+    const T* data() const { return view != nullptr ? view : values.data(); }
+    T*       data() { Own(); return values.data(); }
+    const T& operator[](size_t i) const { return data()[i]; }
+    T&       operator[](size_t i) { Own(); return values[i]; }
+
+    void     assign(size_t count, T value) { clear(); values.assign(count, value); }
+    void     resize(size_t count) { Own(); values.resize(count); }
+    void     clear() { view = nullptr; viewSize = 0; values.clear(); }
+
+private:
+    void Own() {
+        if (view != nullptr) {
+            values.assign(view, view + viewSize);
+            view = nullptr;
+            viewSize = 0;
+        }
+    }
+
+    std::vector<T> values;
+    const T*       view;
+    size_t         viewSize;
+};
+
+// Weights quantized to int8 with one scale per output row: weight = value * scales[row]. The
+// activations they multiply are quantized with inputScale: value = round(x / inputScale).
+struct GnnQuantizedWeights {
+    GnnTensor<std::int8_t> values;              // output count * input count, in [-127, 127]
+    GnnTensor<float>       scales;              // output count
+    float                  inputScale = 0.0f;
+
+    bool IsConsistent(size_t outputCount, size_t inputCount) const;
+};
+
+struct GnnNodeInput {
+    GraphNodeType            type = GraphNodeType::Wall;
+    bool                     predicted = false;
+    std::vector<std::string> featureNames;
+    std::vector<float>       featureMeans;
+    std::vector<float>       featureScales;
+    GnnTensor<float>         weights;           // hidden size * feature count
+    GnnTensor<float>         bias;              // hidden size
+
+    size_t GetFeatureCount() const { return featureNames.size(); }
+};
+
+// A quantized model has the quantized weights, the float ones are empty
+struct GnnLayer {
+    GnnTensor<float>    selfWeights;            // hidden size * hidden size
+    GnnTensor<float>    neighbourWeights;       // hidden size * hidden size
+    GnnTensor<float>    bias;                   // hidden size
+    GnnQuantizedWeights quantizedSelfWeights;
+    GnnQuantizedWeights quantizedNeighbourWeights;
+};
+
+// Mapped file of a loaded model, shared by its copies
+class GnnWeightFile;
+
+struct GnnModel {
+    size_t                    hiddenSize = 0;
+    std::vector<int>          classLabelTypes;
+    std::vector<std::string>  edgeTypes;
+    std::vector<GnnNodeInput> inputs;
+    std::vector<GnnLayer>     layers;
+    GnnTensor<float>          outputWeights;    // class count * hidden size
+    GnnTensor<float>          outputBias;       // class count
+    GnnQuantizedWeights       quantizedOutputWeights;
+    bool                      quantized = false;
+    std::shared_ptr<const GnnWeightFile> weightFile;      // of a version 3 file, weights are views into it
+
+    bool      IsEmpty() const { return inputs.empty(); }
+    size_t    GetClassCount() const { return classLabelTypes.size(); }
+    void      Clear();
+
+    // Input of type, nullptr if the model does not use it
+    const GnnNodeInput* FindInput(GraphNodeType type) const;
+
+    // False if a matrix does not have the size the counts give, or a quantized model has an input
+    // scale that is not positive
+    bool      IsConsistent() const;
+
+    // Bytes of the weights and biases, in memory or mapped
+    size_t    GetWeightSize() const;
+
+    // Check the weights of an input layer, a layer or the output layer of a mapped model against
+    // their checksum, once; reading them brings them in from disk. HostErrBadFormat if they do not
+    // match. Thread-safe, and HostNoError at once for weights in memory.
+    HostError PageInInputLayer(size_t input) const;
+    HostError PageInLayer(size_t layer) const;
+    HostError PageInOutputLayer() const;
+    HostError PageInAll() const;
+
+    // Checksum of the description and every weight, for telling models apart. A model loaded from a
+    // version 3 file has the checksum of its header, which holds those of the sections, so no weight
+    // is read; a model in memory is serialized once and the result kept in checksum. The same model
+    // saved and loaded again has a different checksum. Not thread-safe until the checksum is known.
+    std::uint64_t GetChecksum() const;
+
+    // Forgets the kept checksum. Clear and Load do it; code that changes the description or the
+    // weights of a model calls it when done, or GnnInference::RunIncremental reuses embeddings of
+    // the old weights.
+    void      InvalidateChecksum() { checksum = 0; }
+
+    // Not to the file the model is mapped from
+    HostError Save(const std::string& filePath) const;
+    // HostErrBadFormat for a file that is not a model, truncated, inconsistent or, for version 3,
+    // whose header does not match its checksum. The file stays mapped while the model or a copy
+    // of it exists.
+    HostError Load(const std::string& filePath);
+
+private:
+    mutable std::uint64_t checksum = 0;         // of GetChecksum once known, 0 before
+};
+
+#endif // GNN_MODEL_HPP
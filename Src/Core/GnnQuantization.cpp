@@ -0,0 +1,62 @@
+#include "GnnQuantization.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const float Int8Limit = 127.0f;
+
+GnnQuantizedWeights QuantizeWeights(const GnnTensor<float>& weights, size_t outputCount, float inputRange) {
+    GnnQuantizedWeights quantized;
+    quantized.inputScale = inputRange > 0.0f && std::isfinite(inputRange) ? inputRange / Int8Limit : 1.0f;
+    quantized.scales.resize(outputCount);
+    quantized.values.resize(weights.size());
+
+    size_t inputCount = weights.size() / outputCount;
+    for (size_t output = 0; output < outputCount; ++output) {
+        const float* row = weights.data() + output * inputCount;
+        float maxAbs = 0.0f;
+        for (size_t input = 0; input < inputCount; ++input)
+            maxAbs = std::max(maxAbs, std::fabs(row[input]));
+        // A row of zeros keeps scale 1, scales must be positive
+        float scale = maxAbs > 0.0f ? maxAbs / Int8Limit : 1.0f;
+        quantized.scales[output] = scale;
+        for (size_t input = 0; input < inputCount; ++input) {
+            float value = std::min(std::max(std::nearbyint(row[input] / scale), -Int8Limit), Int8Limit);
+            quantized.values[output * inputCount + input] = static_cast<std::int8_t>(value);
+        }
+    }
+    return quantized;
+}
+
+}
+
+void GnnActivationRanges::Clear() {
+    selfInputs.clear();
+    neighbourInputs.clear();
+    outputInput = 0.0f;
+    nodeCount = 0;
+}
+
+HostError QuantizeGnnModel(const GnnModel& model, const GnnActivationRanges& ranges, GnnModel& quantized) {
+    if (!model.IsConsistent() || model.quantized || ranges.selfInputs.size() != model.layers.size() ||
+        ranges.neighbourInputs.size() != model.layers.size())
+        return HostErrBadFormat;
+    HostError err = model.PageInAll();
+    if (err != HostNoError)
+        return err;
+
+    quantized = model;
+    for (size_t l = 0; l < quantized.layers.size(); ++l) {
+        GnnLayer& layer = quantized.layers[l];
+        layer.quantizedSelfWeights = QuantizeWeights(layer.selfWeights, model.hiddenSize, ranges.selfInputs[l]);
+        layer.quantizedNeighbourWeights = QuantizeWeights(layer.neighbourWeights, model.hiddenSize, ranges.neighbourInputs[l]);
+        layer.selfWeights.clear();
+        layer.neighbourWeights.clear();
+    }
+    quantized.quantizedOutputWeights = QuantizeWeights(model.outputWeights, model.GetClassCount(), ranges.outputInput);
+    quantized.outputWeights.clear();
+    quantized.quantized = true;
+    quantized.InvalidateChecksum();
+    return HostNoError;
+}
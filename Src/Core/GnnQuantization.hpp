@@ -0,0 +1,25 @@
+#ifndef GNN_QUANTIZATION_HPP
+#define GNN_QUANTIZATION_HPP
+
+#include <vector>
+#include "GnnModel.hpp"
+#include "HostTypes.hpp"
+
+// Largest activation entering every int8 layer of a quantized model, gathered by GnnInference::Run
+// over calibration graphs. These activations follow a ReLU, so they are never negative.
+struct GnnActivationRanges {
+    std::vector<float> selfInputs;              // per layer: the embeddings
+    std::vector<float> neighbourInputs;         // per layer: the means of the neighbours' embeddings
+    float              outputInput = 0.0f;      // the last embeddings of the predicted nodes
+    size_t             nodeCount = 0;           // seen over all runs
+
+    void Clear();
+};
+
+// Post-training quantization of a float model. The layer and output weights become int8 with one
+// symmetric scale per output row, the activations entering them are scaled so that their range
+// maps to 127; larger values met later are clamped. The input layers stay float. HostErrBadFormat
+// if the model is inconsistent or already quantized, or the ranges have another layer count.
+HostError QuantizeGnnModel(const GnnModel& model, const GnnActivationRanges& ranges, GnnModel& quantized);
+
+#endif // GNN_QUANTIZATION_HPP
@@ -0,0 +1,183 @@
+#ifndef GUID_HASH_MAP_HPP
+#define GUID_HASH_MAP_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "HostTypes.hpp"
+
+// Hash of the two 64-bit words of a GUID. Archicad GUIDs are random, but generated ones
+// (MemoryElementHost, counters in time_low) are not, so the words are mixed (splitmix64 finalizer).
+inline uint64_t HashGuid(const HostGuid& guid) {
+    static_assert(sizeof(HostGuid) == 16, "HostGuid must be 128 bits");
+    uint64_t words[2];
+    std::memcpy(words, &guid, sizeof(words));
+
+    uint64_t hash = words[0] ^ (words[1] * 0x9E3779B97F4A7C15ULL);
+    hash ^= hash >> 30;
+    hash *= 0xBF58476D1CE4E5B9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94D049BB133111EBULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+inline bool EqualGuids(const HostGuid& lhs, const HostGuid& rhs) {
+    return std::memcmp(&lhs, &rhs, sizeof(HostGuid)) == 0;
+}
+
+// Open addressing hash map keyed by GUID: one contiguous slot array, linear probing,
+// backward shift deletion. Pointers to values are invalidated by inserts that grow the table.
+// Slots belong to the current generation, so Clear is O(1) and keeps the table for reuse.
+template <typename Value>
+class GuidHashMap {
+public:
+    GuidHashMap() = default;
+    explicit GuidHashMap(size_t expectedCount) { Reserve(expectedCount); }
+
+    size_t GetSize() const { return count; }
+    bool   IsEmpty() const { return count == 0; }
+
+    // Sizes the table so that expectedCount entries fit without rehashing
+    void Reserve(size_t expectedCount) {
+        size_t capacity = MinCapacity;
+        while (capacity * MaxLoadNum < expectedCount * MaxLoadDen)
+            capacity *= 2;
+        if (capacity > slots.size())
+            Rehash(capacity);
+    }
+
+    // Removes every entry but keeps the slot array. Old values are only overwritten when their slot is reused.
+    void Clear() {
+        if (++generation == 0) {
+            for (Slot& slot : slots)
+                slot.generation = 0;
+            generation = 1;
+        }
+        count = 0;
+    }
+
+    Value* Find(const HostGuid& key) {
+        size_t index;
+        return FindIndex(key, index) ? &slots[index].value : nullptr;
+    }
+
+    const Value* Find(const HostGuid& key) const {
+        size_t index;
+        return FindIndex(key, index) ? &slots[index].value : nullptr;
+    }
+
+    bool Contains(const HostGuid& key) const {
+        size_t index;
+        return FindIndex(key, index);
+    }
+
+    // Value of key, default constructed if it was not in the map
+    Value& operator[](const HostGuid& key) {
+        return slots[InsertIndex(key)].value;
+    }
+
+    // Sets the value of key, returns true if key was new
+    bool Set(const HostGuid& key, Value value) {
+        size_t oldCount = count;
+        slots[InsertIndex(key)].value = std::move(value);
+        return count != oldCount;
+    }
+
+    bool Erase(const HostGuid& key) {
+        size_t hole;
+        if (!FindIndex(key, hole))
+            return false;
+
+        // Shift later entries of the probe sequence back so lookups never stop early at the hole
+        size_t mask = slots.size() - 1;
+        for (size_t next = (hole + 1) & mask; IsUsed(slots[next]); next = (next + 1) & mask) {
+            size_t home = HashGuid(slots[next].key) & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                slots[hole] = std::move(slots[next]);
+                hole = next;
+            }
+        }
+        slots[hole].generation = 0;
+        slots[hole].value = Value();
+        --count;
+        return true;
+    }
+
+    // Calls fn(key, value) for every entry, in slot order
+    template <typename Fn>
+    void ForEach(Fn&& fn) const {
+        for (const Slot& slot : slots) {
+            if (IsUsed(slot))
+                fn(slot.key, slot.value);
+        }
+    }
+
+private:
+    static constexpr size_t MinCapacity = 16;
+    static constexpr size_t MaxLoadNum = 3;     // grow above 3/4 full
+    static constexpr size_t MaxLoadDen = 4;
+
+    struct Slot {
+        HostGuid key;
+        uint32_t generation = 0;    // in use if equal to the map's generation
+        Value    value = Value();
+    };
+
+    bool IsUsed(const Slot& slot) const { return slot.generation == generation; }
+
+    bool FindIndex(const HostGuid& key, size_t& index) const {
+        if (slots.empty())
+            return false;
+
+        size_t mask = slots.size() - 1;
+        for (index = HashGuid(key) & mask; IsUsed(slots[index]); index = (index + 1) & mask) {
+            if (EqualGuids(slots[index].key, key))
+                return true;
+        }
+        return false;
+    }
+
+    size_t InsertIndex(const HostGuid& key) {
+        if ((count + 1) * MaxLoadDen > slots.size() * MaxLoadNum)
+            Rehash(slots.empty() ? MinCapacity : slots.size() * 2);
+
+        size_t mask = slots.size() - 1;
+        size_t index = HashGuid(key) & mask;
+        for (; IsUsed(slots[index]); index = (index + 1) & mask) {
+            if (EqualGuids(slots[index].key, key))
+                return index;
+        }
+
+        slots[index].key = key;
+        slots[index].generation = generation;
+        slots[index].value = Value();
+        ++count;
+        return index;
+    }
+
+    void Rehash(size_t capacity) {
+        std::vector<Slot> oldSlots(capacity);
+        oldSlots.swap(slots);
+
+        size_t mask = slots.size() - 1;
+        uint32_t oldGeneration = generation;
+        generation = 1;
+        for (Slot& slot : oldSlots) {
+            if (slot.generation != oldGeneration)
+                continue;
+            size_t index = HashGuid(slot.key) & mask;
+            while (IsUsed(slots[index]))
+                index = (index + 1) & mask;
+            slots[index] = std::move(slot);
+            slots[index].generation = generation;
+        }
+    }
+
+    std::vector<Slot> slots;
+    size_t            count = 0;
+    uint32_t          generation = 1;
+};
+
+#endif // GUID_HASH_MAP_HPP
@@ -0,0 +1,684 @@
+#include "HostCallRecording.hpp"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include "MappedFile.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char          RecordingMagic[8] = { 'E', 'X', 'V', '2', 'C', 'A', 'L', 'L' };
+const std::uint32_t RecordingVersion = 1;
+
+// Appends call fields to a buffer
+class CallWriter {
+public:
+    explicit CallWriter(std::string& buffer) : buffer(buffer) {}
+
+    void Raw(const void* data, size_t size) { buffer.append(static_cast<const char*>(data), size); }
+
+    template <typename T>
+    void Value(T value) { Raw(&value, sizeof(T)); }
+
+    void Kind(HostCallKind kind) { Value(static_cast<std::uint8_t>(kind)); }
+    void Type(HostElemType type) { Value(static_cast<std::uint8_t>(type)); }
+    void Count(size_t count) { Value(static_cast<std::uint32_t>(count)); }
+    void Guid(const HostGuid& guid) { Raw(&guid, sizeof(HostGuid)); }
+    void Coord(const HostCoord& coord) { Value(coord.x); Value(coord.y); }
+    void Box(const HostBox3D& box) { Raw(&box, sizeof(HostBox3D)); }
+
+    void String(const std::string& str) {
+        Count(str.size());
+        Raw(str.data(), str.size());
+    }
+
+    void Guids(const std::vector<HostGuid>& guids) {
+        Count(guids.size());
+        Raw(guids.data(), guids.size() * sizeof(HostGuid));
+    }
+
+    void Element(const HostElement& element) {
+        Guid(element.guid);
+        Type(element.type);
+        Value(element.modiStamp);
+        Guid(element.owner);
+        Coord(element.wall.begC);
+        Coord(element.wall.endC);
+        Value(element.wall.thickness);
+        Value(element.wall.height);
+        Value(element.door.width);
+        Value(element.door.height);
+        Guid(element.door.markGuid);
+        Guid(element.zone.stampGuid);
+        Coord(element.zone.pos);
+        String(element.zone.roomName);
+        String(element.zone.roomNoStr);
+        Value(element.zone.roomHeight);
+    }
+
+    void Memo(const HostElementMemo& memo) {
+        Guids(memo.wallDoors);
+        Count(memo.dimElems.size());
+        for (const HostDimElem& dimElem : memo.dimElems) {
+            Guid(dimElem.baseGuid);
+            Type(dimElem.baseType);
+            Coord(dimElem.pos);
+            Coord(dimElem.notePos);
+            Value(dimElem.dimVal);
+            String(dimElem.noteText);
+        }
+    }
+
+    void Spec(const HostDimensionSpec& spec) {
+        Coord(spec.refC);
+        Coord(spec.direction);
+        Value(static_cast<std::uint8_t>(spec.textWay));
+        Value(static_cast<std::uint8_t>(spec.textPos));
+        Coord(spec.dimElems[0]);
+        Coord(spec.dimElems[1]);
+    }
+
+    void Spec(const HostLabelSpec& spec) {
+        Guid(spec.parent);
+        Coord(spec.begC);
+        Coord(spec.midC);
+        Coord(spec.endC);
+        Value(static_cast<std::uint8_t>(spec.textWay));
+        String(spec.predefinedText);
+    }
+
+    void Spec(const HostZoneSpec& spec) {
+        Coord(spec.pos);
+        String(spec.roomName);
+        String(spec.roomNoStr);
+    }
+
+    void Spec(const HostDoorMarkerSpec& spec) {
+        Coord(spec.pos);
+        for (const HostCoord& coord : spec.poly)
+            Coord(coord);
+        Coord(spec.markerPos);
+        Value(static_cast<std::int16_t>(spec.markerPen));
+    }
+
+private:
+    std::string& buffer;
+};
+
+// Reads the fields back, every read is bounds checked and a short file fails the whole load
+class CallReader {
+public:
+    CallReader(const char* data, size_t size, size_t offset) : data(data), size(size), offset(offset), failed(false) {}
+
+    bool   IsFailed() const { return failed; }
+    bool   IsAtEnd() const { return offset >= size; }
+    size_t GetOffset() const { return offset; }
+
+    void Raw(void* out, size_t count) {
+        if (failed || size - offset < count) {
+            failed = true;
+            std::memset(out, 0, count);
+            return;
+        }
+        std::memcpy(out, data + offset, count);
+        offset += count;
+    }
+
+    template <typename T>
+    T Value() {
+        T value;
+        Raw(&value, sizeof(T));
+        return value;
+    }
+
+    HostElemType Type() { return static_cast<HostElemType>(Value<std::uint8_t>()); }
+    void Guid(HostGuid& guid) { Raw(&guid, sizeof(HostGuid)); }
+    void Coord(HostCoord& coord) { coord.x = Value<double>(); coord.y = Value<double>(); }
+    void Box(HostBox3D& box) { Raw(&box, sizeof(HostBox3D)); }
+
+    // Counts are checked against the bytes left, so a corrupt count cannot trigger a huge allocation
+    size_t Count(size_t minItemSize) {
+        size_t count = Value<std::uint32_t>();
+        if (failed || count > (size - offset) / minItemSize) {
+            failed = true;
+            return 0;
+        }
+        return count;
+    }
+
+    void String(std::string& str) {
+        size_t length = Count(1);
+        str.assign(failed ? "" : data + offset, length);
+        offset += length;
+    }
+
+    void Guids(std::vector<HostGuid>& guids) {
+        guids.resize(Count(sizeof(HostGuid)));
+        Raw(guids.data(), guids.size() * sizeof(HostGuid));
+    }
+
+    void Element(HostElement& element) {
+        Guid(element.guid);
+        element.type = Type();
+        element.modiStamp = Value<std::uint64_t>();
+        Guid(element.owner);
+        Coord(element.wall.begC);
+        Coord(element.wall.endC);
+        element.wall.thickness = Value<double>();
+        element.wall.height = Value<double>();
+        element.door.width = Value<double>();
+        element.door.height = Value<double>();
+        Guid(element.door.markGuid);
+        Guid(element.zone.stampGuid);
+        Coord(element.zone.pos);
+        String(element.zone.roomName);
+        String(element.zone.roomNoStr);
+        element.zone.roomHeight = Value<double>();
+    }
+
+    void Memo(HostElementMemo& memo) {
+        Guids(memo.wallDoors);
+        memo.dimElems.resize(Count(sizeof(HostGuid)));
+        for (HostDimElem& dimElem : memo.dimElems) {
+            Guid(dimElem.baseGuid);
+            dimElem.baseType = Type();
+            Coord(dimElem.pos);
+            Coord(dimElem.notePos);
+            dimElem.dimVal = Value<double>();
+            String(dimElem.noteText);
+        }
+    }
+
+    void Spec(HostDimensionSpec& spec) {
+        Coord(spec.refC);
+        Coord(spec.direction);
+        spec.textWay = static_cast<HostTextWay>(Value<std::uint8_t>());
+        spec.textPos = static_cast<HostTextPos>(Value<std::uint8_t>());
+        Coord(spec.dimElems[0]);
+        Coord(spec.dimElems[1]);
+    }
+
+    void Spec(HostLabelSpec& spec) {
+        Guid(spec.parent);
+        Coord(spec.begC);
+        Coord(spec.midC);
+        Coord(spec.endC);
+        spec.textWay = static_cast<HostTextWay>(Value<std::uint8_t>());
+        String(spec.predefinedText);
+    }
+
+    void Spec(HostZoneSpec& spec) {
+        Coord(spec.pos);
+        String(spec.roomName);
+        String(spec.roomNoStr);
+    }
+
+    void Spec(HostDoorMarkerSpec& spec) {
+        Coord(spec.pos);
+        for (HostCoord& coord : spec.poly)
+            Coord(coord);
+        Coord(spec.markerPos);
+        spec.markerPen = Value<std::int16_t>();
+    }
+
+private:
+    const char* data;
+    size_t      size;
+    size_t      offset;
+    bool        failed;
+};
+
+static_assert(sizeof(HostBox3D) == 6 * sizeof(double), "HostBox3D is stored as 6 doubles");
+
+// Create, delete and annotation run calls are replayed in order, their inputs are not matched
+bool IsOrderedCall(HostCallKind kind) {
+    return kind >= HostCallKind::CreateDimension;
+}
+
+// Reads past the inputs of a call
+void SkipInputs(CallReader& reader, HostCallKind kind) {
+    HostGuid guid;
+    std::vector<HostGuid> guids;
+    switch (kind) {
+    case HostCallKind::GetElemList:
+    case HostCallKind::GetElemTypeName:
+        reader.Type();
+        break;
+    case HostCallKind::GetElement:
+    case HostCallKind::CalcBounds:
+    case HostCallKind::GetMemo:
+    case HostCallKind::GetConnectedLabels:
+    case HostCallKind::GetElementInfoString:
+        reader.Guid(guid);
+        break;
+    case HostCallKind::CreateDimension: { HostDimensionSpec spec; reader.Spec(spec); break; }
+    case HostCallKind::CreateLabel: { HostLabelSpec spec; reader.Spec(spec); break; }
+    case HostCallKind::CreateZone: { HostZoneSpec spec; reader.Spec(spec); break; }
+    case HostCallKind::CreateDoorMarker: { HostDoorMarkerSpec spec; reader.Spec(spec); break; }
+    case HostCallKind::DeleteElements:
+        reader.Guids(guids);
+        break;
+    default:
+        break;
+    }
+}
+
+// Reads past the outputs of a successful call
+void SkipOutputs(CallReader& reader, HostCallKind kind) {
+    HostGuid guid;
+    HostElement element;
+    HostBox3D box;
+    HostElementMemo memo;
+    std::vector<HostGuid> guids;
+    std::string str;
+    switch (kind) {
+    case HostCallKind::GetElemList:
+    case HostCallKind::GetConnectedLabels:
+        reader.Guids(guids);
+        break;
+    case HostCallKind::GetElement:
+        reader.Element(element);
+        break;
+    case HostCallKind::CalcBounds:
+        reader.Box(box);
+        break;
+    case HostCallKind::GetMemo:
+        reader.Memo(memo);
+        break;
+    case HostCallKind::GetElementInfoString:
+    case HostCallKind::GetElemTypeName:
+        reader.String(str);
+        break;
+    case HostCallKind::CreateDimension:
+    case HostCallKind::CreateLabel:
+    case HostCallKind::CreateZone:
+    case HostCallKind::CreateDoorMarker:
+        reader.Guid(guid);
+        break;
+    default:
+        break;
+    }
+}
+
+// Times invoke and appends the call: header, inputs, then the outputs if it succeeded
+template <typename Inputs, typename Invoke, typename Outputs>
+HostError RecordCall(std::string& buffer, HostCallKind kind, Inputs&& writeInputs, Invoke&& invoke, Outputs&& writeOutputs) {
+    Clock::time_point start = Clock::now();
+    HostError err = invoke();
+    std::uint64_t latency = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+
+    CallWriter writer(buffer);
+    writer.Kind(kind);
+    writer.Value(latency);
+    writer.Value(static_cast<std::int32_t>(err));
+    writeInputs(writer);
+    if (err == HostNoError)
+        writeOutputs(writer);
+    return err;
+}
+
+// Replay key of a call: its kind, followed by the inputs unless it is replayed in order
+std::string CallKey(HostCallKind kind) {
+    std::string key;
+    CallWriter(key).Kind(kind);
+    return key;
+}
+
+std::string CallKey(HostCallKind kind, HostElemType type) {
+    std::string key = CallKey(kind);
+    CallWriter(key).Type(type);
+    return key;
+}
+
+std::string CallKey(HostCallKind kind, const HostGuid& guid) {
+    std::string key = CallKey(kind);
+    CallWriter(key).Guid(guid);
+    return key;
+}
+
+}
+
+bool IsHostCallRecording(const std::string& filePath) {
+    std::ifstream inFile(filePath, std::ios::binary);
+    char magic[sizeof(RecordingMagic)];
+    return inFile.read(magic, sizeof(magic)) && std::memcmp(magic, RecordingMagic, sizeof(magic)) == 0;
+}
+
+RecordingElementHost::RecordingElementHost(IElementHost& host) :
+    host(host),
+    callCount(0)
+{
+}
+
+void RecordingElementHost::Clear() {
+    buffer.clear();
+    callCount = 0;
+}
+
+HostError RecordingElementHost::Save(const std::string& filePath) const {
+    std::ofstream outFile(filePath, std::ios::binary);
+    if (!outFile.is_open())
+        return HostErrFileIO;
+
+    outFile.write(RecordingMagic, sizeof(RecordingMagic));
+    outFile.write(reinterpret_cast<const char*>(&RecordingVersion), sizeof(RecordingVersion));
+    outFile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return outFile.good() ? HostNoError : HostErrFileIO;
+}
+
+HostError RecordingElementHost::GetElemList(HostElemType type, std::vector<HostGuid>& guids) {
+    ++callCount;
+    return RecordCall(buffer, HostCallKind::GetElemList,
+        [&](CallWriter& writer) { writer.Type(type); },
+        [&] { return host.GetElemList(type, guids); },
+        [&](CallWriter& writer) { writer.Guids(guids); });
+}
+
+HostError RecordingElementHost::GetElement(const HostGuid& guid, HostElement& element) {
+    ++callCount;
+    return RecordCall(buffer, HostCallKind::GetElement,
+        [&](CallWriter& writer) { writer.Guid(guid); },
+        [&] { return host.GetElement(guid, element); },
+        [&](CallWriter& writer) { writer.Element(element); });
+}
+
+HostError RecordingElementHost::CalcBounds(const HostGuid& guid, HostBox3D& box) {
+    ++callCount;
+    return RecordCall(buffer, HostCallKind::CalcBounds,
+        [&](CallWriter& writer) { writer.Guid(guid); },
+        [&] { return host.CalcBounds(guid, box); },
+        [&](CallWriter& writer) { writer.Box(box); });
+}
+
+HostError RecordingElementHost::GetMemo(const HostGuid& guid, HostElementMemo& memo) {
+    ++callCount;
+    return RecordCall(buffer, HostCallKind::GetMemo,
+        [&](CallWriter& writer) { writer.Guid(guid); },
+        [&] { return host.GetMemo(guid, memo); },
+        [&](CallWriter& writer) { writer.Memo(memo); });
+}
+
+HostError RecordingElementHost::GetConnectedLabels(const HostGuid& guid, std::vector<HostGuid>& labels) {
+    ++callCount;
+    return RecordCall(buffer, HostCallKind::GetConnectedLabels,
+        [&](CallWriter& writer) { writer.Guid(guid); },
+        [&] { return host.GetConnectedLabels(guid, labels); },
+        [&](CallWriter& writer) { writer.Guids(labels); });
+}
+
+HostError RecordingElementHost::GetElementInfoString(const HostGuid& guid, std::string& infoString) {
+    ++callCount;
+    return RecordCall(buffer, HostCallKind::GetElementInfoString,
+        [&](CallWriter& writer) { writer.Guid(guid); },
+        [&] { return host.GetElementInfoString(guid, infoString); },
+        [&](CallWriter& writer) { writer.String(infoString); });
+}
+
+HostError RecordingElementHost::GetElemTypeName(HostElemType type, std::string& name) {
+    ++callCount;
+    return RecordCall(buffer, HostCallKind::GetElemTypeName,
+        [&](CallWriter& writer) { writer.Type(type); },
+        [&] { return host.GetElemTypeName(type, name); },
+        [&](CallWriter& writer) { writer.String(name); });
+}
+
+// The new GUID is always asked for, so that a replay can hand it out
+template <typename Spec>
+static HostError RecordCreate(std::string& buffer, HostCallKind kind, const Spec& spec, HostGuid* newGuid, HostError (IElementHost::*create)(const Spec&, HostGuid*), IElementHost& host) {
+    HostGuid guid;
+    HostError err = RecordCall(buffer, kind,
+        [&](CallWriter& writer) { writer.Spec(spec); },
+        [&] { return (host.*create)(spec, &guid); },
+        [&](CallWriter& writer) { writer.Guid(guid); });
+    if (err == HostNoError && newGuid != nullptr)
+        *newGuid = guid;
+    return err;
+}
+
+HostError RecordingElementHost::CreateDimension(const HostDimensionSpec& spec, HostGuid* newGuid) {
+    ++callCount;
+    return RecordCreate(buffer, HostCallKind::CreateDimension, spec, newGuid, &IElementHost::CreateDimension, host);
+}
+
+HostError RecordingElementHost::CreateLabel(const HostLabelSpec& spec, HostGuid* newGuid) {
+    ++callCount;
+    return RecordCreate(buffer, HostCallKind::CreateLabel, spec, newGuid, &IElementHost::CreateLabel, host);
+}
+
+HostError RecordingElementHost::CreateZone(const HostZoneSpec& spec, HostGuid* newGuid) {
+    ++callCount;
+    return RecordCreate(buffer, HostCallKind::CreateZone, spec, newGuid, &IElementHost::CreateZone, host);
+}
+
+HostError RecordingElementHost::CreateDoorMarker(const HostDoorMarkerSpec& spec, HostGuid* newGuid) {
+    ++callCount;
+    return RecordCreate(buffer, HostCallKind::CreateDoorMarker, spec, newGuid, &IElementHost::CreateDoorMarker, host);
+}
+
+HostError RecordingElementHost::DeleteElements(const std::vector<HostGuid>& guids) {
+    ++callCount;
+    return RecordCall(buffer, HostCallKind::DeleteElements,
+        [&](CallWriter& writer) { writer.Guids(guids); },
+        [&] { return host.DeleteElements(guids); },
+        [](CallWriter&) {});
+}
+
+void RecordingElementHost::BeginAnnotationRun() {
+    ++callCount;
+    RecordCall(buffer, HostCallKind::BeginAnnotationRun,
+        [](CallWriter&) {},
+        [&] { host.BeginAnnotationRun(); return HostNoError; },
+        [](CallWriter&) {});
+}
+
+void RecordingElementHost::EndAnnotationRun() {
+    ++callCount;
+    RecordCall(buffer, HostCallKind::EndAnnotationRun,
+        [](CallWriter&) {},
+        [&] { host.EndAnnotationRun(); return HostNoError; },
+        [](CallWriter&) {});
+}
+
+ReplayElementHost::ReplayElementHost() :
+    latencyScale(1.0),
+    missCount(0)
+{
+}
+
+HostError ReplayElementHost::Load(const std::string& filePath) {
+    data.clear();
+    calls.clear();
+    answers.clear();
+    missCount = 0;
+
+    MappedFile file;
+    HostError err = file.Open(filePath);
+    if (err != HostNoError)
+        return err;
+    data.assign(file.GetData(), file.GetSize());
+    file.Close();
+
+    CallReader reader(data.data(), data.size(), 0);
+    char magic[sizeof(RecordingMagic)];
+    reader.Raw(magic, sizeof(magic));
+    if (reader.IsFailed() || std::memcmp(magic, RecordingMagic, sizeof(magic)) != 0 || reader.Value<std::uint32_t>() != RecordingVersion)
+        return HostErrBadFormat;
+
+    while (!reader.IsAtEnd() && !reader.IsFailed()) {
+        std::uint8_t kindValue = reader.Value<std::uint8_t>();
+        HostCallKind kind = static_cast<HostCallKind>(kindValue);
+        Call call;
+        call.latencyNanoseconds = reader.Value<std::uint64_t>();
+        call.err = reader.Value<std::int32_t>();
+        if (kindValue >= static_cast<std::uint8_t>(HostCallKind::Count))
+            return HostErrBadFormat;
+
+        size_t inputOffset = reader.GetOffset();
+        SkipInputs(reader, kind);
+        std::string key = CallKey(kind);
+        if (!IsOrderedCall(kind))
+            key.append(data, inputOffset, reader.GetOffset() - inputOffset);
+
+        call.outputOffset = reader.GetOffset();
+        if (call.err == HostNoError)
+            SkipOutputs(reader, kind);
+
+        answers[key].calls.push_back(static_cast<std::uint32_t>(calls.size()));
+        calls.push_back(call);
+    }
+
+    if (reader.IsFailed()) {
+        calls.clear();
+        answers.clear();
+        return HostErrBadFormat;
+    }
+    return HostNoError;
+}
+
+void ReplayElementHost::Rewind() {
+    for (auto& keyAnswers : answers)
+        keyAnswers.second.next = 0;
+    missCount = 0;
+}
+
+const ReplayElementHost::Call* ReplayElementHost::Answer(const std::string& key, bool repeatLast) {
+    auto it = answers.find(key);
+    if (it == answers.end() || it->second.calls.empty()) {
+        ++missCount;
+        return nullptr;
+    }
+
+    Answers& keyAnswers = it->second;
+    if (keyAnswers.next == keyAnswers.calls.size()) {
+        if (!repeatLast) {
+            ++missCount;
+            return nullptr;
+        }
+        --keyAnswers.next;
+    }
+    const Call& call = calls[keyAnswers.calls[keyAnswers.next++]];
+    Wait(call);
+    return &call;
+}
+
+void ReplayElementHost::Wait(const Call& call) const {
+    if (latencyScale <= 0.0)
+        return;
+
+    Clock::time_point end = Clock::now() + std::chrono::nanoseconds(static_cast<std::int64_t>(call.latencyNanoseconds * latencyScale));
+    while (Clock::now() < end) {
+    }
+}
+
+HostError ReplayElementHost::GetElemList(HostElemType type, std::vector<HostGuid>& guids) {
+    const Call* call = Answer(CallKey(HostCallKind::GetElemList, type), true);
+    if (call == nullptr)
+        return HostErrBadType;
+    if (call->err == HostNoError)
+        CallReader(data.data(), data.size(), call->outputOffset).Guids(guids);
+    return call->err;
+}
+
+HostError ReplayElementHost::GetElement(const HostGuid& guid, HostElement& element) {
+    const Call* call = Answer(CallKey(HostCallKind::GetElement, guid), true);
+    if (call == nullptr)
+        return HostErrBadId;
+    if (call->err == HostNoError)
+        CallReader(data.data(), data.size(), call->outputOffset).Element(element);
+    return call->err;
+}
+
+HostError ReplayElementHost::CalcBounds(const HostGuid& guid, HostBox3D& box) {
+    const Call* call = Answer(CallKey(HostCallKind::CalcBounds, guid), true);
+    if (call == nullptr)
+        return HostErrBadId;
+    if (call->err == HostNoError)
+        CallReader(data.data(), data.size(), call->outputOffset).Box(box);
+    return call->err;
+}
+
+HostError ReplayElementHost::GetMemo(const HostGuid& guid, HostElementMemo& memo) {
+    const Call* call = Answer(CallKey(HostCallKind::GetMemo, guid), true);
+    if (call == nullptr)
+        return HostErrBadId;
+    if (call->err == HostNoError)
+        CallReader(data.data(), data.size(), call->outputOffset).Memo(memo);
+    return call->err;
+}
+
+HostError ReplayElementHost::GetConnectedLabels(const HostGuid& guid, std::vector<HostGuid>& labels) {
+    const Call* call = Answer(CallKey(HostCallKind::GetConnectedLabels, guid), true);
+    if (call == nullptr)
+        return HostErrBadId;
+    if (call->err == HostNoError)
+        CallReader(data.data(), data.size(), call->outputOffset).Guids(labels);
+    return call->err;
+}
+
+HostError ReplayElementHost::GetElementInfoString(const HostGuid& guid, std::string& infoString) {
+    const Call* call = Answer(CallKey(HostCallKind::GetElementInfoString, guid), true);
+    if (call == nullptr)
+        return HostErrBadId;
+    if (call->err == HostNoError)
+        CallReader(data.data(), data.size(), call->outputOffset).String(infoString);
+    return call->err;
+}
+
+HostError ReplayElementHost::GetElemTypeName(HostElemType type, std::string& name) {
+    const Call* call = Answer(CallKey(HostCallKind::GetElemTypeName, type), true);
+    if (call == nullptr)
+        return HostErrBadType;
+    if (call->err == HostNoError)
+        CallReader(data.data(), data.size(), call->outputOffset).String(name);
+    return call->err;
+}
+
+HostError ReplayElementHost::CreateDimension(const HostDimensionSpec&, HostGuid* newGuid) {
+    const Call* call = Answer(CallKey(HostCallKind::CreateDimension), false);
+    if (call == nullptr)
+        return HostErrBadId;
+    if (call->err == HostNoError && newGuid != nullptr)
+        CallReader(data.data(), data.size(), call->outputOffset).Guid(*newGuid);
+    return call->err;
+}
+
+HostError ReplayElementHost::CreateLabel(const HostLabelSpec&, HostGuid* newGuid) {
+    const Call* call = Answer(CallKey(HostCallKind::CreateLabel), false);
+    if (call == nullptr)
+        return HostErrBadId;
+    if (call->err == HostNoError && newGuid != nullptr)
+        CallReader(data.data(), data.size(), call->outputOffset).Guid(*newGuid);
+    return call->err;
+}
+
+HostError ReplayElementHost::CreateZone(const HostZoneSpec&, HostGuid* newGuid) {
+    const Call* call = Answer(CallKey(HostCallKind::CreateZone), false);
+    if (call == nullptr)
+        return HostErrBadId;
+    if (call->err == HostNoError && newGuid != nullptr)
+        CallReader(data.data(), data.size(), call->outputOffset).Guid(*newGuid);
+    return call->err;
+}
+
+HostError ReplayElementHost::CreateDoorMarker(const HostDoorMarkerSpec&, HostGuid* newGuid) {
+    const Call* call = Answer(CallKey(HostCallKind::CreateDoorMarker), false);
+    if (call == nullptr)
+        return HostErrBadId;
+    if (call->err == HostNoError && newGuid != nullptr)
+        CallReader(data.data(), data.size(), call->outputOffset).Guid(*newGuid);
+    return call->err;
+}
+
+HostError ReplayElementHost::DeleteElements(const std::vector<HostGuid>&) {
+    const Call* call = Answer(CallKey(HostCallKind::DeleteElements), false);
+    return call != nullptr ? call->err : HostErrBadId;
+}
+
+void ReplayElementHost::BeginAnnotationRun() {
+    Answer(CallKey(HostCallKind::BeginAnnotationRun), false);
+}
+
+void ReplayElementHost::EndAnnotationRun() {
+    Answer(CallKey(HostCallKind::EndAnnotationRun), false);
+}
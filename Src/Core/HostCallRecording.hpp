@@ -0,0 +1,141 @@
+#ifndef HOST_CALL_RECORDING_HPP
+#define HOST_CALL_RECORDING_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ElementHost.hpp"
+
+// Host call recordings capture what a real host answered, so a session in Archicad can be replayed
+// on any machine: RecordingElementHost wraps the ACAPI host and logs every call, ReplayElementHost
+// serves the logged answers to the core.
+//
+// Saved as a binary file (little-endian):
+//   char[8]  magic "EXV2CALL"
+//   uint32   version
+//   calls until the end of the file:
+//     uint8  call (HostCallKind), uint64 latency in nanoseconds, int32 HostError
+//     inputs: the GUID or element type asked for, the spec of a Create call, the GUIDs to delete
+//     outputs, only when the call succeeded: the list, element, box, memo, string or new GUID
+// Values are stored field by field in struct order, GUIDs as 16 raw bytes, strings as uint32 length
+// and bytes, vectors as uint32 count and items.
+
+// Order is part of the file format, append only
+enum class HostCallKind : std::uint8_t {
+    GetElemList,
+    GetElement,
+    CalcBounds,
+    GetMemo,
+    GetConnectedLabels,
+    GetElementInfoString,
+    GetElemTypeName,
+    CreateDimension,
+    CreateLabel,
+    CreateZone,
+    CreateDoorMarker,
+    DeleteElements,
+    BeginAnnotationRun,
+    EndAnnotationRun,
+    Count
+};
+
+// True if filePath starts like a host call recording
+bool IsHostCallRecording(const std::string& filePath);
+
+// Forwards every call to another host and appends it, with its answer and how long it took, to an
+// in-memory recording. The wrapped host must outlive this one.
+class RecordingElementHost : public IElementHost {
+public:
+    explicit RecordingElementHost(IElementHost& host);
+
+    size_t    GetCallCount() const { return callCount; }
+    size_t    GetRecordingSize() const { return buffer.size(); }
+    void      Clear();
+    HostError Save(const std::string& filePath) const;
+
+    HostError GetElemList(HostElemType type, std::vector<HostGuid>& guids) override;
+    HostError GetElement(const HostGuid& guid, HostElement& element) override;
+    HostError CalcBounds(const HostGuid& guid, HostBox3D& box) override;
+    HostError GetMemo(const HostGuid& guid, HostElementMemo& memo) override;
+    HostError GetConnectedLabels(const HostGuid& guid, std::vector<HostGuid>& labels) override;
+    HostError GetElementInfoString(const HostGuid& guid, std::string& infoString) override;
+    HostError GetElemTypeName(HostElemType type, std::string& name) override;
+
+    HostError CreateDimension(const HostDimensionSpec& spec, HostGuid* newGuid) override;
+    HostError CreateLabel(const HostLabelSpec& spec, HostGuid* newGuid) override;
+    HostError CreateZone(const HostZoneSpec& spec, HostGuid* newGuid) override;
+    HostError CreateDoorMarker(const HostDoorMarkerSpec& spec, HostGuid* newGuid) override;
+
+    HostError DeleteElements(const std::vector<HostGuid>& guids) override;
+
+    void      BeginAnnotationRun() override;
+    void      EndAnnotationRun() override;
+
+private:
+    IElementHost& host;
+    std::string   buffer;
+    size_t        callCount;
+};
+
+// Serves the answers of a recording. Reads are matched by call and input, so the core may ask in a
+// different order than the recorded session did: repeated questions get the recorded answers in
+// turn, and the last one again once they run out. Create and delete calls are answered in recorded
+// order whatever their spec. Questions the recording cannot answer fail with HostErrBadId and are
+// counted as misses.
+class ReplayElementHost : public IElementHost {
+public:
+    ReplayElementHost();
+
+    HostError Load(const std::string& filePath);
+
+    // 0 answers at once, 1 waits as long as the recorded call took (busy, to keep microseconds)
+    void      SetLatencyScale(double scale) { latencyScale = scale; }
+    // Serves every answer from the start again
+    void      Rewind();
+
+    size_t    GetRecordedCallCount() const { return calls.size(); }
+    size_t    GetMissCount() const { return missCount; }
+
+    HostError GetElemList(HostElemType type, std::vector<HostGuid>& guids) override;
+    HostError GetElement(const HostGuid& guid, HostElement& element) override;
+    HostError CalcBounds(const HostGuid& guid, HostBox3D& box) override;
+    HostError GetMemo(const HostGuid& guid, HostElementMemo& memo) override;
+    HostError GetConnectedLabels(const HostGuid& guid, std::vector<HostGuid>& labels) override;
+    HostError GetElementInfoString(const HostGuid& guid, std::string& infoString) override;
+    HostError GetElemTypeName(HostElemType type, std::string& name) override;
+
+    HostError CreateDimension(const HostDimensionSpec& spec, HostGuid* newGuid) override;
+    HostError CreateLabel(const HostLabelSpec& spec, HostGuid* newGuid) override;
+    HostError CreateZone(const HostZoneSpec& spec, HostGuid* newGuid) override;
+    HostError CreateDoorMarker(const HostDoorMarkerSpec& spec, HostGuid* newGuid) override;
+
+    HostError DeleteElements(const std::vector<HostGuid>& guids) override;
+
+    void      BeginAnnotationRun() override;
+    void      EndAnnotationRun() override;
+
+private:
+    struct Call {
+        std::uint64_t latencyNanoseconds = 0;
+        HostError     err = HostNoError;
+        size_t        outputOffset = 0;     // into data, valid when err is HostNoError
+    };
+
+    struct Answers {
+        std::vector<std::uint32_t> calls;
+        size_t                     next = 0;
+    };
+
+    // Recorded answer to the call with this key, nullptr if there is none left
+    const Call* Answer(const std::string& key, bool repeatLast);
+    void        Wait(const Call& call) const;
+
+    std::string                              data;
+    std::vector<Call>                        calls;
+    std::unordered_map<std::string, Answers> answers;   // by call kind and input bytes
+    double                                   latencyScale;
+    size_t                                   missCount;
+};
+
+#endif // HOST_CALL_RECORDING_HPP
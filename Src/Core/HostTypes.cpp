@@ -0,0 +1,102 @@
+#include "HostTypes.hpp"
+#include <cstdio>
+#include <cstring>
+#include "ReportFormat.hpp"
+
+const HostGuid HostNullGuid = {};
+
+bool operator==(const HostGuid& lhs, const HostGuid& rhs) {
+    return std::memcmp(&lhs, &rhs, sizeof(HostGuid)) == 0;
+}
+
+bool operator!=(const HostGuid& lhs, const HostGuid& rhs) {
+    return !(lhs == rhs);
+}
+
+bool operator<(const HostGuid& lhs, const HostGuid& rhs) {
+    return std::memcmp(&lhs, &rhs, sizeof(HostGuid)) < 0;
+}
+
+std::string HostGuidToString(const HostGuid& guid) {
+    char str[GuidStringLength];
+    return std::string(str, FormatGuid(guid, str));
+}
+
+// Parses one hex digit, returns -1 for anything else
+static int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool HostGuidFromString(std::string_view str, HostGuid& guid) {
+    if (str.size() != 36 || str[8] != '-' || str[13] != '-' || str[18] != '-' || str[23] != '-')
+        return false;
+
+    std::uint8_t bytes[16];
+    size_t pos = 0;
+    for (int i = 0; i < 16; ++i) {
+        if (str[pos] == '-')
+            ++pos;
+        int hi = HexValue(str[pos]);
+        int lo = HexValue(str[pos + 1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        bytes[i] = static_cast<std::uint8_t>((hi << 4) | lo);
+        pos += 2;
+    }
+
+    guid = HostGuidFromBytes(bytes);
+    return true;
+}
+
+void HostGuidToBytes(const HostGuid& guid, std::uint8_t bytes[16]) {
+    bytes[0] = static_cast<std::uint8_t>(guid.time_low >> 24);
+    bytes[1] = static_cast<std::uint8_t>(guid.time_low >> 16);
+    bytes[2] = static_cast<std::uint8_t>(guid.time_low >> 8);
+    bytes[3] = static_cast<std::uint8_t>(guid.time_low);
+    bytes[4] = static_cast<std::uint8_t>(guid.time_mid >> 8);
+    bytes[5] = static_cast<std::uint8_t>(guid.time_mid);
+    bytes[6] = static_cast<std::uint8_t>(guid.time_hi_and_version >> 8);
+    bytes[7] = static_cast<std::uint8_t>(guid.time_hi_and_version);
+    bytes[8] = guid.clock_seq_hi_and_reserved;
+    bytes[9] = guid.clock_seq_low;
+    std::memcpy(bytes + 10, guid.node, 6);
+}
+
+HostGuid HostGuidFromBytes(const std::uint8_t bytes[16]) {
+    HostGuid guid;
+    guid.time_low = (std::uint32_t(bytes[0]) << 24) | (std::uint32_t(bytes[1]) << 16) | (std::uint32_t(bytes[2]) << 8) | bytes[3];
+    guid.time_mid = static_cast<std::uint16_t>((bytes[4] << 8) | bytes[5]);
+    guid.time_hi_and_version = static_cast<std::uint16_t>((bytes[6] << 8) | bytes[7]);
+    guid.clock_seq_hi_and_reserved = bytes[8];
+    guid.clock_seq_low = bytes[9];
+    std::memcpy(guid.node, bytes + 10, 6);
+    return guid;
+}
+
+const char* HostElemTypeToString(HostElemType type) {
+    switch (type) {
+    case HostElemType::Wall:        return "Wall";
+    case HostElemType::Slab:        return "Slab";
+    case HostElemType::Zone:        return "Zone";
+    case HostElemType::Door:        return "Door";
+    case HostElemType::Dimension:   return "Dimension";
+    case HostElemType::Label:       return "Label";
+    case HostElemType::Detail:      return "Detail";
+    default:                        return "Unknown";
+    }
+}
+
+HostElemType HostElemTypeFromString(std::string_view str) {
+    static const HostElemType types[] = {
+        HostElemType::Wall, HostElemType::Slab, HostElemType::Zone, HostElemType::Door,
+        HostElemType::Dimension, HostElemType::Label, HostElemType::Detail
+    };
+    for (HostElemType type : types) {
+        if (str == HostElemTypeToString(type))
+            return type;
+    }
+    return HostElemType::Unknown;
+}
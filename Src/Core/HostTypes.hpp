@@ -0,0 +1,168 @@
+#ifndef HOST_TYPES_HPP
+#define HOST_TYPES_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Host-neutral mirrors of the Archicad API types used by the extraction and annotation core.
+// Nothing in here depends on the API DevKit, so the core builds and runs outside Archicad.
+
+// Error codes returned by IElementHost. The ACAPI backend passes GSErrCode values through unchanged.
+using HostError = std::int32_t;
+
+constexpr HostError HostNoError       = 0;
+constexpr HostError HostErrGeneral    = -1;
+constexpr HostError HostErrBadId      = -2;
+constexpr HostError HostErrBadType    = -3;
+constexpr HostError HostErrFileIO     = -4;
+constexpr HostError HostErrBadFormat  = -5;
+
+// Same layout as API_Guid, so the ACAPI backend converts with a plain copy
+struct HostGuid {
+    std::uint32_t time_low = 0;
+    std::uint16_t time_mid = 0;
+    std::uint16_t time_hi_and_version = 0;
+    std::uint8_t  clock_seq_hi_and_reserved = 0;
+    std::uint8_t  clock_seq_low = 0;
+    std::uint8_t  node[6] = {};
+};
+
+static_assert(sizeof(HostGuid) == 16, "HostGuid must match the API_Guid layout");
+
+extern const HostGuid HostNullGuid;
+
+bool operator==(const HostGuid& lhs, const HostGuid& rhs);
+bool operator!=(const HostGuid& lhs, const HostGuid& rhs);
+bool operator<(const HostGuid& lhs, const HostGuid& rhs);
+
+// Formats as "XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX", the same text APIGuidToString produces
+std::string HostGuidToString(const HostGuid& guid);
+bool        HostGuidFromString(std::string_view str, HostGuid& guid);
+
+// 16 bytes in the order they appear in the string form (RFC 4122 byte order)
+void        HostGuidToBytes(const HostGuid& guid, std::uint8_t bytes[16]);
+HostGuid    HostGuidFromBytes(const std::uint8_t bytes[16]);
+
+// Element types the add-on works with (subset of API_ElemTypeID)
+enum class HostElemType : std::uint8_t {
+    Unknown = 0,
+    Wall,
+    Slab,
+    Zone,
+    Door,
+    Dimension,
+    Label,
+    Detail
+};
+
+const char*  HostElemTypeToString(HostElemType type);
+HostElemType HostElemTypeFromString(std::string_view str);
+
+struct HostCoord {
+    double x = 0.0;
+    double y = 0.0;
+};
+
+struct HostBox3D {
+    double xMin = 0.0;
+    double yMin = 0.0;
+    double zMin = 0.0;
+    double xMax = 0.0;
+    double yMax = 0.0;
+    double zMax = 0.0;
+};
+
+// Subset of API_Element read by the extraction core
+struct HostWallData {
+    HostCoord begC;
+    HostCoord endC;
+    double    thickness = 0.0;
+    double    height = 0.0;
+};
+
+struct HostDoorData {
+    double   width = 0.0;
+    double   height = 0.0;
+    HostGuid markGuid;
+};
+
+struct HostZoneData {
+    HostGuid    stampGuid;
+    HostCoord   pos;
+    std::string roomName;
+    std::string roomNoStr;
+    double      roomHeight = 0.0;
+};
+
+struct HostElement {
+    HostGuid      guid;
+    HostElemType  type = HostElemType::Unknown;
+    std::uint64_t modiStamp = 0;
+    HostGuid      owner;            // hosting wall of a door, parent of a label
+    HostWallData  wall;
+    HostDoorData  door;
+    HostZoneData  zone;
+};
+
+// Subset of API_DimElem
+struct HostDimElem {
+    HostGuid     baseGuid;
+    HostElemType baseType = HostElemType::Unknown;
+    HostCoord    pos;
+    HostCoord    notePos;
+    double       dimVal = 0.0;
+    std::string  noteText;
+};
+
+// Subset of API_ElementMemo
+struct HostElementMemo {
+    std::vector<HostGuid>    wallDoors;
+    std::vector<HostDimElem> dimElems;
+};
+
+// Creation requests. The host fills everything else from the element defaults.
+enum class HostTextPos : std::uint8_t {
+    Above,
+    Below
+};
+
+enum class HostTextWay : std::uint8_t {
+    Default,        // keep the value from the element defaults
+    Horizontal,
+    Vertical,
+    Parallel
+};
+
+struct HostDimensionSpec {
+    HostCoord   refC;
+    HostCoord   direction;
+    HostTextWay textWay = HostTextWay::Horizontal;
+    HostTextPos textPos = HostTextPos::Above;
+    HostCoord   dimElems[2];
+};
+
+struct HostLabelSpec {
+    HostGuid    parent;
+    HostCoord   begC;
+    HostCoord   midC;
+    HostCoord   endC;
+    HostTextWay textWay = HostTextWay::Default;
+    std::string predefinedText = "Door";
+};
+
+struct HostZoneSpec {
+    HostCoord   pos;
+    std::string roomName;
+    std::string roomNoStr;
+};
+
+struct HostDoorMarkerSpec {
+    HostCoord pos;
+    HostCoord poly[5];
+    HostCoord markerPos;
+    short     markerPen = 3;
+};
+
+#endif // HOST_TYPES_HPP
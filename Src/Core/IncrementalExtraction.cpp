@@ -0,0 +1,308 @@
+#include "IncrementalExtraction.hpp"
+#include <algorithm>
+#include <vector>
+#include "AsyncFileWriter.hpp"
+
+namespace {
+
+// Dirty GUIDs of one update, the value is set once the element was found in its list and reported again
+using DirtySet = GuidHashMap<bool>;
+
+void MarkDimensionedWalls(const DimensionReport& report, DirtySet& dirty) {
+    for (const DimNodeReport& node : report.nodes) {
+        if (node.dimElem.baseType == HostElemType::Wall)
+            dirty[node.dimElem.baseGuid];
+    }
+}
+
+// Doors that went into or out of a wall change the "Embedded in Wall" part of their report
+void MarkMovedDoors(const std::vector<HostGuid>& oldDoors, const std::vector<HostGuid>& newDoors, DirtySet& dirty) {
+    for (const HostGuid& doorGuid : oldDoors) {
+        if (std::find(newDoors.begin(), newDoors.end(), doorGuid) == newDoors.end())
+            dirty[doorGuid];
+    }
+    for (const HostGuid& doorGuid : newDoors) {
+        if (std::find(oldDoors.begin(), oldDoors.end(), doorGuid) == oldDoors.end())
+            dirty[doorGuid];
+    }
+}
+
+// Labels are not reported themselves, they make the element they are attached to dirty
+void MarkLabelOwners(IElementHost& host, ExtractionSession& session, const ExtractionSnapshot& snapshot, const std::vector<HostGuid>& labels, DirtySet& dirty) {
+    GuidHashMap<HostGuid> doorOfLabel;
+    for (const ElementReport& report : snapshot.GetElements(HostElemType::Door)) {
+        for (const LabelReport& label : report.labels)
+            doorOfLabel.Set(label.guid, report.guid);
+    }
+
+    bool unresolved = false;
+    for (const HostGuid& labelGuid : labels) {
+        bool resolved = false;
+        if (const HostGuid* doorGuid = doorOfLabel.Find(labelGuid)) {
+            dirty[*doorGuid];
+            resolved = true;
+        }
+        HostElement label;
+        if (session.records.GetElement(host, labelGuid, label) == HostNoError) {
+            if (label.owner != HostNullGuid)
+                dirty[label.owner];
+            resolved = true;
+        }
+        unresolved = unresolved || !resolved;
+    }
+
+    // A deleted label that was not on a door may have been the last label of a slab
+    if (unresolved) {
+        for (const ElementReport& report : snapshot.GetElements(HostElemType::Slab)) {
+            if (report.labelType == 2)
+                dirty[report.guid];
+        }
+    }
+}
+
+// Dirty reports of this type that were not in the element list belong to deleted elements
+// Drops the reports of deleted elements, and the boxes of the elements, zone stamps and door labels they had
+void RemoveDeleted(ExtractionSnapshot& snapshot, DirtySet& dirty, HostElemType type, BoundsCache& boundsCache) {
+    std::vector<HostGuid> deleted;
+    dirty.ForEach([&](const HostGuid& guid, bool reported) {
+        if (reported)
+            return;
+        if (type == HostElemType::Dimension) {
+            if (snapshot.FindDimension(guid) != nullptr)
+                deleted.push_back(guid);
+        }
+        else {
+            const ElementReport* report = snapshot.FindElement(guid);
+            if (report != nullptr && report->type == type)
+                deleted.push_back(guid);
+        }
+    });
+
+    for (const HostGuid& guid : deleted) {
+        boundsCache.Invalidate(guid);
+        if (const ElementReport* report = snapshot.FindElement(guid)) {
+            if (report->stampGuid != HostNullGuid)
+                boundsCache.Invalidate(report->stampGuid);
+            for (const LabelReport& label : report->labels)
+                boundsCache.Invalidate(label.guid);
+        }
+        if (type == HostElemType::Wall)
+            MarkMovedDoors(snapshot.FindElement(guid)->embeddedDoors, {}, dirty);
+        snapshot.Remove(guid);
+    }
+}
+
+}
+
+void UpdateExtraction(IElementHost& host, ExtractionSession& session, ExtractionSnapshot& snapshot, const ElementChangeTracker& changes) {
+    ProfileScope scope(session.profiler, ProfileCounter::UpdateExtraction);
+    TraceScope traceScope(session.trace, "UpdateExtraction", "extract");
+    session.Reset();
+
+    // Dependents known from the old reports, before they are replaced
+    DirtySet dirty(changes.GetSize() * 2);
+    std::vector<HostGuid> dirtyLabels;
+    changes.ForEach([&](const HostGuid& guid, HostElemType type) {
+        dirty[guid];
+        // A changed element gets a new stamp and misses anyway, a deleted one must not stay
+        session.boundsCache.Invalidate(guid);
+        if (type == HostElemType::Label) {
+            dirtyLabels.push_back(guid);
+        }
+        else if (type == HostElemType::Door) {
+            const ElementReport* oldReport = snapshot.FindElement(guid);
+            if (oldReport != nullptr && oldReport->hasWall)
+                dirty[oldReport->wallGuid];
+            HostElement door;
+            if (session.records.GetElement(host, guid, door) == HostNoError && door.owner != HostNullGuid)
+                dirty[door.owner];
+        }
+        else if (type == HostElemType::Dimension) {
+            if (const DimensionReport* oldReport = snapshot.FindDimension(guid))
+                MarkDimensionedWalls(*oldReport, dirty);
+        }
+    });
+    if (!dirtyLabels.empty())
+        MarkLabelOwners(host, session, snapshot, dirtyLabels, dirty);
+
+    // Walk the element lists so that new elements are added in the order a full run reports them
+    std::vector<HostGuid> elementList;
+
+    // Dimensions first, they decide which walls are dimensioned
+    if (host.GetElemList(HostElemType::Dimension, elementList) != HostNoError)
+        elementList.clear();
+    for (const HostGuid& elementGuid : elementList) {
+        bool* reported = dirty.Find(elementGuid);
+        if (reported == nullptr)
+            continue;
+        *reported = true;
+
+        DimensionReport report;
+        if (!CollectDimensionReport(host, session, elementGuid, report)) {
+            snapshot.Remove(elementGuid);
+            continue;
+        }
+        MarkDimensionedWalls(report, dirty);
+        snapshot.SetDimension(report);
+    }
+    RemoveDeleted(snapshot, dirty, HostElemType::Dimension, session.boundsCache);
+
+    for (const DimensionReport& report : snapshot.GetDimensions()) {
+        if (report.guid == HostNullGuid)
+            continue;
+        for (const DimNodeReport& node : report.nodes) {
+            if (node.dimElem.baseType == HostElemType::Wall)
+                session.wallHasDimElems.Set(node.dimElem.baseGuid, true);
+        }
+    }
+
+    // Walls, slabs, zones and doors; the walls decide which wall each door is embedded in
+    const HostElemType elementTypes[] = { HostElemType::Wall, HostElemType::Slab, HostElemType::Zone, HostElemType::Door };
+    for (HostElemType elemType : elementTypes) {
+        if (elemType == HostElemType::Door) {
+            for (const ElementReport& report : snapshot.GetElements(HostElemType::Wall)) {
+                if (report.guid == HostNullGuid)
+                    continue;
+                for (const HostGuid& doorGuid : report.embeddedDoors)
+                    session.doorToWallMap.Set(doorGuid, report.guid);
+            }
+        }
+
+        if (host.GetElemList(elemType, elementList) != HostNoError)
+            elementList.clear();
+        for (const HostGuid& elementGuid : elementList) {
+            bool* reported = dirty.Find(elementGuid);
+            if (reported == nullptr)
+                continue;
+            *reported = true;
+
+            ElementReport report;
+            if (!CollectElementReport(host, session, elementGuid, elemType, report)) {
+                snapshot.Remove(elementGuid);
+                continue;
+            }
+            if (elemType == HostElemType::Wall) {
+                const ElementReport* oldReport = snapshot.FindElement(elementGuid);
+                MarkMovedDoors(oldReport != nullptr ? oldReport->embeddedDoors : std::vector<HostGuid>(), report.embeddedDoors, dirty);
+            }
+            snapshot.SetElement(report);
+        }
+        RemoveDeleted(snapshot, dirty, elemType, session.boundsCache);
+    }
+
+    snapshot.Compact();
+}
+
+void MarkChangesSinceSnapshot(IElementHost& host, const ExtractionSnapshot& snapshot, ElementChangeTracker& changes) {
+    GuidHashMap<bool> listed(snapshot.GetReportCount());
+    std::vector<HostGuid> elementList;
+    HostElement element;
+
+    const HostElemType elementTypes[] = { HostElemType::Dimension, HostElemType::Wall, HostElemType::Slab, HostElemType::Zone, HostElemType::Door };
+    for (HostElemType elemType : elementTypes) {
+        if (host.GetElemList(elemType, elementList) != HostNoError)
+            continue;
+        for (const HostGuid& elementGuid : elementList) {
+            listed.Set(elementGuid, true);
+
+            bool known = false;
+            std::uint64_t modiStamp = 0;
+            if (elemType == HostElemType::Dimension) {
+                const DimensionReport* report = snapshot.FindDimension(elementGuid);
+                known = report != nullptr;
+                modiStamp = known ? report->modiStamp : 0;
+            }
+            else {
+                const ElementReport* report = snapshot.FindElement(elementGuid);
+                known = report != nullptr && report->type == elemType;
+                modiStamp = known ? report->modiStamp : 0;
+            }
+            if (!known || host.GetElement(elementGuid, element) != HostNoError || element.modiStamp != modiStamp)
+                changes.MarkDirty(elementGuid, elemType);
+        }
+    }
+
+    // Reports of elements that are gone
+    for (const DimensionReport& report : snapshot.GetDimensions()) {
+        if (!listed.Contains(report.guid))
+            changes.MarkDirty(report.guid, HostElemType::Dimension);
+    }
+    GuidHashMap<std::uint64_t> doorLabelStamps;
+    for (HostElemType elemType : { HostElemType::Wall, HostElemType::Slab, HostElemType::Zone, HostElemType::Door }) {
+        for (const ElementReport& report : snapshot.GetElements(elemType)) {
+            // The labels of a slab are not in the snapshot, a deleted one would go unnoticed
+            if (!listed.Contains(report.guid) || (elemType == HostElemType::Slab && report.labelType == 2))
+                changes.MarkDirty(report.guid, report.type);
+            for (const LabelReport& label : report.labels)
+                doorLabelStamps.Set(label.guid, label.modiStamp);
+        }
+    }
+
+    // Only door labels are in the snapshot, every other label is taken as changed
+    if (host.GetElemList(HostElemType::Label, elementList) != HostNoError)
+        return;
+    for (const HostGuid& labelGuid : elementList) {
+        const std::uint64_t* modiStamp = doorLabelStamps.Find(labelGuid);
+        if (modiStamp == nullptr || host.GetElement(labelGuid, element) != HostNoError || element.modiStamp != *modiStamp)
+            changes.MarkDirty(labelGuid, HostElemType::Label);
+        doorLabelStamps.Erase(labelGuid);
+    }
+    doorLabelStamps.ForEach([&](const HostGuid& labelGuid, std::uint64_t) {
+        changes.MarkDirty(labelGuid, HostElemType::Label);
+    });
+}
+
+void WriteSnapshotReport(const ExtractionSnapshot& snapshot, const ExtractionOutput& output) {
+    for (const DimensionReport& report : snapshot.GetDimensions()) {
+        if (output.textReport != nullptr)
+            WriteDimensionReport(*output.textReport, report);
+        if (output.columnarReport != nullptr)
+            output.columnarReport->AddDimension(report);
+    }
+
+    const HostElemType elementTypes[] = { HostElemType::Wall, HostElemType::Slab, HostElemType::Zone, HostElemType::Door };
+    for (HostElemType elemType : elementTypes) {
+        for (const ElementReport& report : snapshot.GetElements(elemType)) {
+            if (output.textReport != nullptr)
+                WriteElementReport(*output.textReport, report);
+            if (output.columnarReport != nullptr)
+                output.columnarReport->AddElement(report);
+        }
+    }
+
+    if (output.textReport != nullptr)
+        OutputAdditionalInfo(*output.textReport, snapshot);
+}
+
+HostError WriteIncrementalTextReport(IElementHost& host, ExtractionSession& session, ExtractionSnapshot& snapshot,
+    ElementChangeTracker& changes, const std::string& filePath, ColumnarReportWriter* columnarReport)
+{
+    ProfileScope scope(session.profiler, ProfileCounter::WriteTextReport);
+    TraceScope traceScope(session.trace, "WriteIncrementalTextReport", "extract");
+    if (snapshot.IsEmpty()) {
+        ExtractionOutput fullOutput;
+        fullOutput.snapshot = &snapshot;
+        ProcessBuildingElements(host, session, fullOutput);
+    }
+    else if (!changes.IsEmpty()) {
+        UpdateExtraction(host, session, snapshot, changes);
+    }
+    changes.Clear();
+
+    AsyncFileWriter sink;
+    HostError err = sink.Open(filePath);
+    if (err != HostNoError)
+        return err;
+
+    std::ostream outFile(&sink);
+    ExtractionOutput output;
+    output.textReport = &outFile;
+    output.columnarReport = columnarReport;
+    WriteSnapshotReport(snapshot, output);
+
+    TraceScope closeScope(session.trace, "CloseTextReport", "extract");
+    err = sink.Close();
+    if (session.profiler != nullptr)
+        session.profiler->AddBytes(ProfileCounter::WriteTextReport, sink.GetWrittenSize());
+    return err;
+}
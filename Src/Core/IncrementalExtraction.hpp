@@ -0,0 +1,30 @@
+#ifndef INCREMENTAL_EXTRACTION_HPP
+#define INCREMENTAL_EXTRACTION_HPP
+
+#include <string>
+#include "ElementChangeTracker.hpp"
+#include "ElementExtraction.hpp"
+#include "ExtractionSnapshot.hpp"
+
+// Re-reports the dirty elements and the elements whose report depends on them, and patches the
+// snapshot with the result:
+//   door       -> the wall it was and the wall it is embedded in
+//   dimension  -> the walls it dimensioned before and after the change
+//   wall       -> doors added to or removed from it
+//   label      -> the element it is attached to
+// Unchanged reports are not touched, so the run costs host calls for the changed elements only.
+void UpdateExtraction(IElementHost& host, ExtractionSession& session, ExtractionSnapshot& snapshot, const ElementChangeTracker& changes);
+
+// Marks every element that was added, deleted or modified (by modification stamp) since the
+// snapshot was taken. Used when the snapshot comes from disk and no notifications were observed.
+void MarkChangesSinceSnapshot(IElementHost& host, const ExtractionSnapshot& snapshot, ElementChangeTracker& changes);
+
+// Writes the snapshot as a full run would have written it
+void WriteSnapshotReport(const ExtractionSnapshot& snapshot, const ExtractionOutput& output);
+
+// Brings the snapshot up to date (a full run if it is empty), clears the changes and rewrites the
+// text report at filePath from the snapshot
+HostError WriteIncrementalTextReport(IElementHost& host, ExtractionSession& session, ExtractionSnapshot& snapshot,
+    ElementChangeTracker& changes, const std::string& filePath, ColumnarReportWriter* columnarReport = nullptr);
+
+#endif // INCREMENTAL_EXTRACTION_HPP
@@ -0,0 +1,128 @@
+#include "MappedFile.hpp"
+
+#if defined (_WIN32)
+    #if !defined (WIN32_LEAN_AND_MEAN)
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #if !defined (NOMINMAX)
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+MappedFile::MappedFile() :
+    isOpen(false),
+    data(nullptr),
+    size(0)
+#if defined (_WIN32)
+    , fileHandle(nullptr),
+    mappingHandle(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+#if defined (_WIN32)
+
+HostError MappedFile::Open(const std::string& filePath) {
+    Close();
+
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return HostErrFileIO;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return HostErrFileIO;
+    }
+
+    // Empty files cannot be mapped, they are simply open with no data
+    if (fileSize.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+            CloseHandle(file);
+            return HostErrFileIO;
+        }
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return HostErrFileIO;
+        }
+        mappingHandle = mapping;
+        data = static_cast<const char*>(view);
+        size = static_cast<size_t>(fileSize.QuadPart);
+    }
+
+    fileHandle = file;
+    isOpen = true;
+    return HostNoError;
+}
+
+void MappedFile::Close() {
+    if (data != nullptr)
+        UnmapViewOfFile(data);
+    if (mappingHandle != nullptr)
+        CloseHandle(static_cast<HANDLE>(mappingHandle));
+    if (fileHandle != nullptr)
+        CloseHandle(static_cast<HANDLE>(fileHandle));
+
+    isOpen = false;
+    data = nullptr;
+    size = 0;
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+}
+
+#else
+
+HostError MappedFile::Open(const std::string& filePath) {
+    Close();
+
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return HostErrFileIO;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0) {
+        close(fd);
+        return HostErrFileIO;
+    }
+
+    // Empty files cannot be mapped, they are simply open with no data
+    if (fileStat.st_size > 0) {
+        void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            close(fd);
+            return HostErrFileIO;
+        }
+        madvise(view, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+        data = static_cast<const char*>(view);
+        size = static_cast<size_t>(fileStat.st_size);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    isOpen = true;
+    return HostNoError;
+}
+
+void MappedFile::Close() {
+    if (data != nullptr)
+        munmap(const_cast<char*>(data), size);
+
+    isOpen = false;
+    data = nullptr;
+    size = 0;
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "HostTypes.hpp"
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    HostError Open(const std::string& filePath);
+    void      Close();
+
+    bool             IsOpen() const { return isOpen; }
+    const char*      GetData() const { return data; }
+    size_t           GetSize() const { return size; }
+    std::string_view GetView() const { return std::string_view(data, size); }
+
+private:
+    bool        isOpen;
+    const char* data;
+    size_t      size;
+#if defined (_WIN32)
+    void*       fileHandle;
+    void*       mappingHandle;
+#endif
+};
+
+#endif // MAPPED_FILE_HPP
@@ -0,0 +1,526 @@
+#include "MemoryElementHost.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include "ElementChangeTracker.hpp"
+
+namespace {
+
+// Splits a snapshot line into whitespace separated tokens, honouring double quotes
+bool TokenizeLine(const std::string& line, std::vector<std::string>& tokens) {
+    size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r'))
+            ++i;
+        if (i >= line.size() || line[i] == '#')
+            break;
+
+        std::string token;
+        bool quoted = false;
+        while (i < line.size()) {
+            char c = line[i];
+            if (quoted) {
+                if (c == '\\' && i + 1 < line.size()) {
+                    token += line[i + 1];
+                    i += 2;
+                    continue;
+                }
+                if (c == '"')
+                    quoted = false;
+                else
+                    token += c;
+            }
+            else {
+                if (c == ' ' || c == '\t' || c == '\r')
+                    break;
+                if (c == '"')
+                    quoted = true;
+                else
+                    token += c;
+            }
+            ++i;
+        }
+        if (quoted)
+            return false;
+        tokens.push_back(token);
+    }
+    return true;
+}
+
+std::string Quote(const std::string& value) {
+    std::string quoted = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        quoted += c;
+    }
+    quoted += '"';
+    return quoted;
+}
+
+bool ParseDoubles(const std::string& value, double* out, int count) {
+    const char* p = value.c_str();
+    for (int i = 0; i < count; ++i) {
+        char* end = nullptr;
+        out[i] = strtod(p, &end);
+        if (end == p)
+            return false;
+        p = end;
+        if (i + 1 < count) {
+            if (*p != ',')
+                return false;
+            ++p;
+        }
+    }
+    return *p == '\0';
+}
+
+bool ParseCoord(const std::string& value, HostCoord& coord) {
+    double v[2];
+    if (!ParseDoubles(value, v, 2))
+        return false;
+    coord = { v[0], v[1] };
+    return true;
+}
+
+bool ParseBox(const std::string& value, HostBox3D& box) {
+    double v[6];
+    if (!ParseDoubles(value, v, 6))
+        return false;
+    box = { v[0], v[1], v[2], v[3], v[4], v[5] };
+    return true;
+}
+
+std::string FormatDouble(double value) {
+    char str[32];
+    snprintf(str, sizeof(str), "%.17g", value);
+    return str;
+}
+
+std::string FormatCoord(const HostCoord& c) {
+    return FormatDouble(c.x) + "," + FormatDouble(c.y);
+}
+
+std::string FormatBox(const HostBox3D& b) {
+    return FormatDouble(b.xMin) + "," + FormatDouble(b.yMin) + "," + FormatDouble(b.zMin) + "," +
+        FormatDouble(b.xMax) + "," + FormatDouble(b.yMax) + "," + FormatDouble(b.zMax);
+}
+
+HostBox3D BoundsOf(const HostCoord* coords, size_t count) {
+    HostBox3D box = { coords[0].x, coords[0].y, 0.0, coords[0].x, coords[0].y, 0.0 };
+    for (size_t i = 1; i < count; ++i) {
+        box.xMin = std::min(box.xMin, coords[i].x);
+        box.yMin = std::min(box.yMin, coords[i].y);
+        box.xMax = std::max(box.xMax, coords[i].x);
+        box.yMax = std::max(box.yMax, coords[i].y);
+    }
+    return box;
+}
+
+void EraseGuid(std::vector<HostGuid>& list, const HostGuid& guid) {
+    list.erase(std::remove(list.begin(), list.end(), guid), list.end());
+}
+
+}
+
+MemoryElementHost::MemoryElementHost() :
+    guidCounter(0),
+    modiStampCounter(0),
+    changeTracker(nullptr)
+{
+}
+
+void MemoryElementHost::Clear() {
+    elements.clear();
+    extraBounds.clear();
+    wallDoors.clear();
+    connectedLabels.clear();
+    for (std::vector<HostGuid>& list : typeLists)
+        list.clear();
+}
+
+// Created elements get GUIDs with a fixed node part. Snapshots saved after annotation already
+// contain some of them, those are skipped.
+HostGuid MemoryElementHost::NewGuid() {
+    HostGuid guid;
+    do {
+        ++guidCounter;
+        guid.time_low = static_cast<std::uint32_t>(guidCounter);
+        guid.time_mid = static_cast<std::uint16_t>(guidCounter >> 32);
+        guid.time_hi_and_version = 0x4000;
+        guid.clock_seq_hi_and_reserved = 0x80;
+        const std::uint8_t node[6] = { 'M', 'E', 'M', 'H', 'S', 'T' };
+        std::copy(node, node + 6, guid.node);
+    } while (elements.count(guid) != 0 || extraBounds.count(guid) != 0);
+    return guid;
+}
+
+void MemoryElementHost::Link(const ModelElementData& data) {
+    if (data.owner == HostNullGuid)
+        return;
+    if (data.element.type == HostElemType::Door)
+        wallDoors[data.owner].push_back(data.element.guid);
+    else if (data.element.type == HostElemType::Label)
+        connectedLabels[data.owner].push_back(data.element.guid);
+}
+
+void MemoryElementHost::Unlink(const ModelElementData& data) {
+    if (data.owner == HostNullGuid)
+        return;
+    if (data.element.type == HostElemType::Door)
+        EraseGuid(wallDoors[data.owner], data.element.guid);
+    else if (data.element.type == HostElemType::Label)
+        EraseGuid(connectedLabels[data.owner], data.element.guid);
+}
+
+void MemoryElementHost::AddElement(const ModelElementData& data) {
+    // A replaced element of the same type keeps its place in the element list, like a modified one
+    auto it = elements.find(data.element.guid);
+    bool keepsPlace = it != elements.end() && it->second.element.type == data.element.type;
+    if (it != elements.end()) {
+        Unlink(it->second);
+        if (!keepsPlace)
+            EraseGuid(typeLists[static_cast<int>(it->second.element.type)], data.element.guid);
+        elements.erase(it);
+    }
+
+    ModelElementData& stored = elements[data.element.guid];
+    stored = data;
+    stored.element.modiStamp = ++modiStampCounter;
+    if (!keepsPlace)
+        typeLists[static_cast<int>(data.element.type)].push_back(data.element.guid);
+    Link(stored);
+
+    if (changeTracker != nullptr)
+        changeTracker->MarkDirty(data.element.guid, data.element.type);
+}
+
+void MemoryElementHost::AddBounds(const HostGuid& guid, const HostBox3D& box) {
+    extraBounds[guid] = box;
+}
+
+HostError MemoryElementHost::ParseLine(const std::string& line) {
+    std::vector<std::string> tokens;
+    if (!TokenizeLine(line, tokens))
+        return HostErrBadFormat;
+    if (tokens.empty())
+        return HostNoError;
+    if (tokens.size() < 2)
+        return HostErrBadFormat;
+
+    HostGuid guid;
+    if (!HostGuidFromString(tokens[1], guid))
+        return HostErrBadFormat;
+
+    if (tokens[0] == "Bounds") {
+        HostBox3D box;
+        if (tokens.size() != 3 || !ParseBox(tokens[2], box))
+            return HostErrBadFormat;
+        AddBounds(guid, box);
+        return HostNoError;
+    }
+
+    bool isDimNode = tokens[0] == "DimNode";
+    HostElemType type = isDimNode ? HostElemType::Dimension : HostElemTypeFromString(tokens[0]);
+    if (type == HostElemType::Unknown)
+        return HostErrBadType;
+
+    ModelElementData data;
+    HostDimElem dimElem;
+    data.element.guid = guid;
+    data.element.type = type;
+
+    for (size_t i = 2; i < tokens.size(); ++i) {
+        size_t eq = tokens[i].find('=');
+        if (eq == std::string::npos)
+            return HostErrBadFormat;
+        std::string key = tokens[i].substr(0, eq);
+        std::string value = tokens[i].substr(eq + 1);
+
+        bool ok = true;
+        if (isDimNode) {
+            if (key == "baseType")        dimElem.baseType = HostElemTypeFromString(value);
+            else if (key == "baseGuid")   ok = HostGuidFromString(value, dimElem.baseGuid);
+            else if (key == "pos")        ok = ParseCoord(value, dimElem.pos);
+            else if (key == "note")       ok = ParseCoord(value, dimElem.notePos);
+            else if (key == "value")      ok = ParseDoubles(value, &dimElem.dimVal, 1);
+            else if (key == "text")       dimElem.noteText = value;
+        }
+        else if (key == "bounds")         ok = data.hasBounds = ParseBox(value, data.bounds);
+        else if (key == "info")           { data.infoString = value; data.hasInfoString = true; }
+        else if (key == "begC")           ok = ParseCoord(value, data.element.wall.begC);
+        else if (key == "endC")           ok = ParseCoord(value, data.element.wall.endC);
+        else if (key == "thickness")      ok = ParseDoubles(value, &data.element.wall.thickness, 1);
+        else if (key == "height")         ok = ParseDoubles(value, type == HostElemType::Door ? &data.element.door.height : &data.element.wall.height, 1);
+        else if (key == "width")          ok = ParseDoubles(value, &data.element.door.width, 1);
+        else if (key == "mark")           ok = HostGuidFromString(value, data.element.door.markGuid);
+        else if (key == "wall" || key == "parent") ok = HostGuidFromString(value, data.owner);
+        else if (key == "stamp")          ok = HostGuidFromString(value, data.element.zone.stampGuid);
+        else if (key == "pos")            ok = ParseCoord(value, data.element.zone.pos);
+        else if (key == "name")           data.element.zone.roomName = value;
+        else if (key == "number")         data.element.zone.roomNoStr = value;
+        else if (key == "roomHeight")     ok = ParseDoubles(value, &data.element.zone.roomHeight, 1);
+        if (!ok)
+            return HostErrBadFormat;
+    }
+
+    if (isDimNode) {
+        auto it = elements.find(guid);
+        if (it == elements.end() || it->second.element.type != HostElemType::Dimension)
+            return HostErrBadId;
+        it->second.dimElems.push_back(dimElem);
+        return HostNoError;
+    }
+
+    AddElement(data);
+    return HostNoError;
+}
+
+HostError MemoryElementHost::LoadSnapshot(const std::string& filePath) {
+    std::ifstream inFile(filePath);
+    if (!inFile.is_open())
+        return HostErrFileIO;
+
+    Clear();
+    std::string line;
+    while (std::getline(inFile, line)) {
+        HostError err = ParseLine(line);
+        if (err != HostNoError)
+            return err;
+    }
+    return HostNoError;
+}
+
+HostError MemoryElementHost::SaveSnapshot(const std::string& filePath) const {
+    std::ofstream outFile(filePath);
+    if (!outFile.is_open())
+        return HostErrFileIO;
+
+    outFile << "# Extraction_V2 model snapshot\n";
+    for (const std::vector<HostGuid>& list : typeLists) {
+        for (const HostGuid& guid : list) {
+            const ModelElementData& data = elements.at(guid);
+            const HostElement& element = data.element;
+            outFile << HostElemTypeToString(element.type) << ' ' << HostGuidToString(guid);
+
+            switch (element.type) {
+            case HostElemType::Wall:
+            case HostElemType::Slab:
+                outFile << " begC=" << FormatCoord(element.wall.begC) << " endC=" << FormatCoord(element.wall.endC)
+                    << " thickness=" << FormatDouble(element.wall.thickness) << " height=" << FormatDouble(element.wall.height);
+                break;
+            case HostElemType::Door:
+                outFile << " width=" << FormatDouble(element.door.width) << " height=" << FormatDouble(element.door.height);
+                if (element.door.markGuid != HostNullGuid)
+                    outFile << " mark=" << HostGuidToString(element.door.markGuid);
+                if (data.owner != HostNullGuid)
+                    outFile << " wall=" << HostGuidToString(data.owner);
+                break;
+            case HostElemType::Zone:
+                outFile << " stamp=" << HostGuidToString(element.zone.stampGuid) << " pos=" << FormatCoord(element.zone.pos)
+                    << " name=" << Quote(element.zone.roomName) << " number=" << Quote(element.zone.roomNoStr)
+                    << " roomHeight=" << FormatDouble(element.zone.roomHeight);
+                break;
+            case HostElemType::Label:
+                if (data.owner != HostNullGuid)
+                    outFile << " parent=" << HostGuidToString(data.owner);
+                break;
+            default:
+                break;
+            }
+
+            if (data.hasBounds)
+                outFile << " bounds=" << FormatBox(data.bounds);
+            if (data.hasInfoString)
+                outFile << " info=" << Quote(data.infoString);
+            outFile << '\n';
+
+            for (const HostDimElem& dimElem : data.dimElems) {
+                outFile << "DimNode " << HostGuidToString(guid)
+                    << " baseType=" << HostElemTypeToString(dimElem.baseType) << " baseGuid=" << HostGuidToString(dimElem.baseGuid)
+                    << " pos=" << FormatCoord(dimElem.pos) << " note=" << FormatCoord(dimElem.notePos)
+                    << " value=" << FormatDouble(dimElem.dimVal) << " text=" << Quote(dimElem.noteText) << '\n';
+            }
+        }
+    }
+
+    for (const auto& bounds : extraBounds)
+        outFile << "Bounds " << HostGuidToString(bounds.first) << ' ' << FormatBox(bounds.second) << '\n';
+
+    return outFile.good() ? HostNoError : HostErrFileIO;
+}
+
+HostError MemoryElementHost::GetElemList(HostElemType type, std::vector<HostGuid>& guids) {
+    guids = typeLists[static_cast<int>(type)];
+    return HostNoError;
+}
+
+HostError MemoryElementHost::GetElement(const HostGuid& guid, HostElement& element) {
+    auto it = elements.find(guid);
+    if (it == elements.end())
+        return HostErrBadId;
+    element = it->second.element;
+    element.owner = it->second.owner;
+    return HostNoError;
+}
+
+HostError MemoryElementHost::CalcBounds(const HostGuid& guid, HostBox3D& box) {
+    auto it = elements.find(guid);
+    if (it != elements.end()) {
+        if (!it->second.hasBounds)
+            return HostErrGeneral;
+        box = it->second.bounds;
+        return HostNoError;
+    }
+
+    auto extraIt = extraBounds.find(guid);
+    if (extraIt == extraBounds.end())
+        return HostErrBadId;
+    box = extraIt->second;
+    return HostNoError;
+}
+
+HostError MemoryElementHost::GetMemo(const HostGuid& guid, HostElementMemo& memo) {
+    auto it = elements.find(guid);
+    if (it == elements.end())
+        return HostErrBadId;
+
+    memo.wallDoors.clear();
+    memo.dimElems = it->second.dimElems;
+    auto doorsIt = wallDoors.find(guid);
+    if (doorsIt != wallDoors.end())
+        memo.wallDoors = doorsIt->second;
+    return HostNoError;
+}
+
+HostError MemoryElementHost::GetConnectedLabels(const HostGuid& guid, std::vector<HostGuid>& labels) {
+    if (elements.find(guid) == elements.end())
+        return HostErrBadId;
+
+    labels.clear();
+    auto it = connectedLabels.find(guid);
+    if (it != connectedLabels.end())
+        labels = it->second;
+    return HostNoError;
+}
+
+HostError MemoryElementHost::GetElementInfoString(const HostGuid& guid, std::string& infoString) {
+    auto it = elements.find(guid);
+    if (it == elements.end())
+        return HostErrBadId;
+    if (!it->second.hasInfoString)
+        return HostErrGeneral;
+    infoString = it->second.infoString;
+    return HostNoError;
+}
+
+HostError MemoryElementHost::GetElemTypeName(HostElemType type, std::string& name) {
+    if (type == HostElemType::Unknown)
+        return HostErrBadType;
+    name = HostElemTypeToString(type);
+    return HostNoError;
+}
+
+HostError MemoryElementHost::CreateDimension(const HostDimensionSpec& spec, HostGuid* newGuid) {
+    ModelElementData data;
+    data.element.guid = NewGuid();
+    data.element.type = HostElemType::Dimension;
+
+    for (const HostCoord& loc : spec.dimElems) {
+        HostDimElem dimElem;
+        dimElem.pos = loc;
+        dimElem.notePos = loc;
+        data.dimElems.push_back(dimElem);
+    }
+    double dx = spec.dimElems[1].x - spec.dimElems[0].x;
+    double dy = spec.dimElems[1].y - spec.dimElems[0].y;
+    data.dimElems[1].dimVal = sqrt(dx * dx + dy * dy);
+
+    const HostCoord extent[3] = { spec.dimElems[0], spec.dimElems[1], spec.refC };
+    data.bounds = BoundsOf(extent, 3);
+    data.hasBounds = true;
+
+    AddElement(data);
+    if (newGuid != nullptr)
+        *newGuid = data.element.guid;
+    return HostNoError;
+}
+
+HostError MemoryElementHost::CreateLabel(const HostLabelSpec& spec, HostGuid* newGuid) {
+    if (spec.parent != HostNullGuid && elements.find(spec.parent) == elements.end())
+        return HostErrBadId;
+
+    ModelElementData data;
+    data.element.guid = NewGuid();
+    data.element.type = HostElemType::Label;
+    data.owner = spec.parent;
+
+    const HostCoord extent[3] = { spec.begC, spec.midC, spec.endC };
+    data.bounds = BoundsOf(extent, 3);
+    data.bounds.xMax += 0.1 * static_cast<double>(spec.predefinedText.size());
+    data.bounds.yMax += 0.25;
+    data.hasBounds = true;
+
+    AddElement(data);
+    if (newGuid != nullptr)
+        *newGuid = data.element.guid;
+    return HostNoError;
+}
+
+HostError MemoryElementHost::CreateZone(const HostZoneSpec& spec, HostGuid* newGuid) {
+    ModelElementData data;
+    data.element.guid = NewGuid();
+    data.element.type = HostElemType::Zone;
+    data.element.zone.pos = spec.pos;
+    data.element.zone.roomName = spec.roomName;
+    data.element.zone.roomNoStr = spec.roomNoStr;
+    data.element.zone.stampGuid = NewGuid();
+
+    HostBox3D stampBox = { spec.pos.x - 0.5, spec.pos.y - 0.25, 0.0, spec.pos.x + 0.5, spec.pos.y + 0.25, 0.0 };
+    AddBounds(data.element.zone.stampGuid, stampBox);
+    data.bounds = stampBox;
+    data.hasBounds = true;
+
+    AddElement(data);
+    if (newGuid != nullptr)
+        *newGuid = data.element.guid;
+    return HostNoError;
+}
+
+HostError MemoryElementHost::CreateDoorMarker(const HostDoorMarkerSpec& spec, HostGuid* newGuid) {
+    ModelElementData data;
+    data.element.guid = NewGuid();
+    data.element.type = HostElemType::Detail;
+    data.bounds = BoundsOf(spec.poly, 5);
+    data.hasBounds = true;
+
+    AddElement(data);
+    if (newGuid != nullptr)
+        *newGuid = data.element.guid;
+    return HostNoError;
+}
+
+HostError MemoryElementHost::DeleteElements(const std::vector<HostGuid>& guids) {
+    std::set<HostGuid> deleted;
+    for (const HostGuid& guid : guids) {
+        auto it = elements.find(guid);
+        if (it == elements.end())
+            continue;
+        if (changeTracker != nullptr)
+            changeTracker->MarkDirty(guid, it->second.element.type);
+        Unlink(it->second);
+        wallDoors.erase(guid);
+        connectedLabels.erase(guid);
+        elements.erase(it);
+        deleted.insert(guid);
+    }
+
+    for (std::vector<HostGuid>& list : typeLists) {
+        list.erase(std::remove_if(list.begin(), list.end(),
+            [&](const HostGuid& guid) { return deleted.count(guid) != 0; }), list.end());
+    }
+    return HostNoError;
+}
@@ -0,0 +1,75 @@
+#ifndef MEMORY_ELEMENT_HOST_HPP
+#define MEMORY_ELEMENT_HOST_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include "ElementHost.hpp"
+
+class ElementChangeTracker;
+
+// One element of an in-memory model
+struct ModelElementData {
+    HostElement              element;
+    bool                     hasBounds = false;
+    HostBox3D                bounds;
+    bool                     hasInfoString = false;
+    std::string              infoString;
+    HostGuid                 owner;         // hosting wall of a door, parent of a label
+    std::vector<HostDimElem> dimElems;      // dimensions only
+};
+
+// IElementHost backend that serves a model snapshot from memory, used to run the core outside Archicad.
+//
+// Snapshot files are line based, one record per line, '#' starts a comment:
+//   <Type> <guid> key=value ...        element record, Type is Wall, Slab, Zone, Door, Dimension, Label or Detail
+//   DimNode <dimension guid> key=value  dimension node appended to an earlier Dimension record
+//   Bounds <guid> x,y,z,x,y,z          bounds of a non-element object (zone stamps)
+// Values containing spaces or commas are double quoted, with \" and \\ escapes.
+class MemoryElementHost : public IElementHost {
+public:
+    MemoryElementHost();
+
+    HostError LoadSnapshot(const std::string& filePath);
+    HostError SaveSnapshot(const std::string& filePath) const;
+
+    void      Clear();
+    void      AddElement(const ModelElementData& data);
+    void      AddBounds(const HostGuid& guid, const HostBox3D& box);
+    size_t    GetElementCount() const { return elements.size(); }
+    HostGuid  NewGuid();
+
+    // Every element added, replaced or deleted from now on is marked dirty in tracker (nullptr stops)
+    void      SetChangeTracker(ElementChangeTracker* tracker) { changeTracker = tracker; }
+
+    HostError GetElemList(HostElemType type, std::vector<HostGuid>& guids) override;
+    HostError GetElement(const HostGuid& guid, HostElement& element) override;
+    HostError CalcBounds(const HostGuid& guid, HostBox3D& box) override;
+    HostError GetMemo(const HostGuid& guid, HostElementMemo& memo) override;
+    HostError GetConnectedLabels(const HostGuid& guid, std::vector<HostGuid>& labels) override;
+    HostError GetElementInfoString(const HostGuid& guid, std::string& infoString) override;
+    HostError GetElemTypeName(HostElemType type, std::string& name) override;
+
+    HostError CreateDimension(const HostDimensionSpec& spec, HostGuid* newGuid) override;
+    HostError CreateLabel(const HostLabelSpec& spec, HostGuid* newGuid) override;
+    HostError CreateZone(const HostZoneSpec& spec, HostGuid* newGuid) override;
+    HostError CreateDoorMarker(const HostDoorMarkerSpec& spec, HostGuid* newGuid) override;
+
+    HostError DeleteElements(const std::vector<HostGuid>& guids) override;
+
+private:
+    HostError ParseLine(const std::string& line);
+    void      Link(const ModelElementData& data);
+    void      Unlink(const ModelElementData& data);
+
+    std::map<HostGuid, ModelElementData>        elements;
+    std::map<HostGuid, HostBox3D>               extraBounds;
+    std::map<HostGuid, std::vector<HostGuid>>   wallDoors;
+    std::map<HostGuid, std::vector<HostGuid>>   connectedLabels;
+    std::vector<HostGuid>                       typeLists[8];
+    std::uint64_t                               guidCounter;
+    std::uint64_t                               modiStampCounter;
+    ElementChangeTracker*                       changeTracker;
+};
+
+#endif // MEMORY_ELEMENT_HOST_HPP
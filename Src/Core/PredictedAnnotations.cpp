@@ -0,0 +1,181 @@
+#include "PredictedAnnotations.hpp"
+#include <cstring>
+#include <fstream>
+#include "AnnotationPlan.hpp"
+#include "MappedFile.hpp"
+
+namespace {
+
+const char          RecordMagic[8] = { 'E', 'X', 'V', '2', 'A', 'N', 'N', 'O' };
+const std::uint32_t RecordVersion = 1;
+
+void WriteValue(std::string& buffer, const void* data, size_t size) {
+    buffer.append(static_cast<const char*>(data), size);
+}
+
+void WriteCount(std::string& buffer, size_t count) {
+    std::uint32_t value = static_cast<std::uint32_t>(count);
+    WriteValue(buffer, &value, sizeof(value));
+}
+
+// Bounds checked reads, a short file fails the whole load
+class RecordReader {
+public:
+    RecordReader(const char* data, size_t size) : data(data), size(size), offset(0), failed(false) {}
+
+    bool IsFailed() const { return failed; }
+
+    void Raw(void* out, size_t count) {
+        if (failed || size - offset < count) {
+            failed = true;
+            std::memset(out, 0, count);
+            return;
+        }
+        std::memcpy(out, data + offset, count);
+        offset += count;
+    }
+
+    template <typename T>
+    T Value() {
+        T value;
+        Raw(&value, sizeof(T));
+        return value;
+    }
+
+    // Checked against the bytes left, so a corrupt count cannot trigger a huge allocation
+    size_t Count(size_t minItemSize) {
+        size_t count = Value<std::uint32_t>();
+        if (failed || count > (size - offset) / minItemSize) {
+            failed = true;
+            return 0;
+        }
+        return count;
+    }
+
+private:
+    const char* data;
+    size_t      size;
+    size_t      offset;
+    bool        failed;
+};
+
+}
+
+void PredictedAnnotations::Record(const AnnotationPlan& plan, const std::vector<HostGuid>& created) {
+    for (size_t stepIndex = 0; stepIndex < plan.steps.size() && stepIndex < created.size(); ++stepIndex) {
+        const HostGuid& owner = plan.steps[stepIndex].owner;
+        if (owner == HostNullGuid || created[stepIndex] == HostNullGuid)
+            continue;
+        NodeAnnotations* node = nodes.Find(owner);
+        if (node == nullptr) {
+            node = &nodes[owner];
+            node->labelType = PredLabelNone;
+        }
+        node->elements.push_back(created[stepIndex]);
+        elements.Set(created[stepIndex], true);
+    }
+}
+
+int PredictedAnnotations::GetLabelType(const HostGuid& node) const {
+    const NodeAnnotations* annotations = nodes.Find(node);
+    return annotations != nullptr ? annotations->labelType : PredLabelNone;
+}
+
+void PredictedAnnotations::Replace(const HostGuid& node, int labelType, std::vector<HostGuid>& replaced) {
+    NodeAnnotations* annotations = nodes.Find(node);
+    if (annotations != nullptr)
+        replaced.insert(replaced.end(), annotations->elements.begin(), annotations->elements.end());
+
+    if (labelType == PredLabelNone) {
+        nodes.Erase(node);
+        return;
+    }
+    if (annotations == nullptr)
+        annotations = &nodes[node];
+    annotations->labelType = labelType;
+    annotations->elements.clear();
+}
+
+void PredictedAnnotations::ReplaceMissing(const GuidHashMap<bool>& present, std::vector<HostGuid>& replaced) {
+    std::vector<HostGuid> missing;
+    nodes.ForEach([&](const HostGuid& node, const NodeAnnotations&) {
+        if (!present.Contains(node))
+            missing.push_back(node);
+    });
+    for (const HostGuid& node : missing)
+        Replace(node, PredLabelNone, replaced);
+}
+
+void PredictedAnnotations::RemoveFrom(const ElementChangeTracker& changes, ElementChangeTracker& remaining) const {
+    remaining.Clear();
+    changes.ForEach([&](const HostGuid& guid, HostElemType type) {
+        if (!elements.Contains(guid))
+            remaining.MarkDirty(guid, type);
+    });
+}
+
+void PredictedAnnotations::Clear() {
+    nodes.Clear();
+    elements.Clear();
+}
+
+HostError PredictedAnnotations::Save(const std::string& filePath) const {
+    std::string buffer;
+    WriteValue(buffer, RecordMagic, sizeof(RecordMagic));
+    WriteValue(buffer, &RecordVersion, sizeof(RecordVersion));
+
+    WriteCount(buffer, elements.GetSize());
+    elements.ForEach([&](const HostGuid& guid, bool) {
+        WriteValue(buffer, &guid, sizeof(HostGuid));
+    });
+    WriteCount(buffer, nodes.GetSize());
+    nodes.ForEach([&](const HostGuid& node, const NodeAnnotations& annotations) {
+        std::int32_t labelType = annotations.labelType;
+        WriteValue(buffer, &node, sizeof(HostGuid));
+        WriteValue(buffer, &labelType, sizeof(labelType));
+        WriteCount(buffer, annotations.elements.size());
+        for (const HostGuid& guid : annotations.elements)
+            WriteValue(buffer, &guid, sizeof(HostGuid));
+    });
+
+    std::ofstream outFile(filePath, std::ios::binary);
+    if (!outFile.is_open())
+        return HostErrFileIO;
+    outFile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    outFile.close();
+    return outFile.fail() ? HostErrFileIO : HostNoError;
+}
+
+HostError PredictedAnnotations::Load(const std::string& filePath) {
+    Clear();
+
+    MappedFile file;
+    HostError err = file.Open(filePath);
+    if (err != HostNoError)
+        return err;
+
+    RecordReader reader(file.GetData(), file.GetSize());
+    char magic[sizeof(RecordMagic)];
+    reader.Raw(magic, sizeof(magic));
+    if (reader.IsFailed() || std::memcmp(magic, RecordMagic, sizeof(magic)) != 0 || reader.Value<std::uint32_t>() != RecordVersion)
+        return HostErrBadFormat;
+
+    size_t elementCount = reader.Count(sizeof(HostGuid));
+    for (size_t i = 0; i < elementCount; ++i)
+        elements.Set(reader.Value<HostGuid>(), true);
+    size_t nodeCount = reader.Count(sizeof(HostGuid) + 2 * sizeof(std::uint32_t));
+    for (size_t i = 0; i < nodeCount && !reader.IsFailed(); ++i) {
+        HostGuid node = reader.Value<HostGuid>();
+        NodeAnnotations& annotations = nodes[node];
+        annotations.labelType = reader.Value<std::int32_t>();
+        annotations.elements.resize(reader.Count(sizeof(HostGuid)));
+        for (HostGuid& guid : annotations.elements)
+            guid = reader.Value<HostGuid>();
+    }
+
+    if (reader.IsFailed()) {
+        Clear();
+        return HostErrBadFormat;
+    }
+    return HostNoError;
+}
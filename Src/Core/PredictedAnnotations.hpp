@@ -0,0 +1,61 @@
+#ifndef PREDICTED_ANNOTATIONS_HPP
+#define PREDICTED_ANNOTATIONS_HPP
+
+#include <string>
+#include <vector>
+#include "ElementChangeTracker.hpp"
+#include "GuidHashMap.hpp"
+#include "HostTypes.hpp"
+
+struct AnnotationPlan;
+
+// Elements created for the predicted label types, by the node they annotate, and the label type
+// they were created for. An update replaces those of a node whose label type differs or that is
+// gone instead of adding to them. The elements stay out of the element graph and the changes the
+// prediction sees, also once replaced, so annotating does not change what is predicted.
+//
+// Saved as a binary file (little-endian), so a restart does not annotate again:
+//   char[8]  magic "EXV2ANNO"
+//   uint32   version
+//   uint32   element count, GUIDs of every element
+//   uint32   node count, per node: GUID, int32 label type, uint32 element count, element GUIDs
+class PredictedAnnotations {
+public:
+    // Adds the elements created for the steps of plan that have an owner. created has one GUID per
+    // step, as CommitAnnotationPlan returns them, HostNullGuid where creating failed.
+    void      Record(const AnnotationPlan& plan, const std::vector<HostGuid>& created);
+
+    // Label type node was annotated for, PredLabelNone if it has no annotations
+    int       GetLabelType(const HostGuid& node) const;
+
+    // Appends the elements created for node to replaced; node is then annotated for labelType,
+    // its new elements come with Record
+    void      Replace(const HostGuid& node, int labelType, std::vector<HostGuid>& replaced);
+
+    // Replace(node, PredLabelNone) for every node not in present
+    void      ReplaceMissing(const GuidHashMap<bool>& present, std::vector<HostGuid>& replaced);
+
+    // Every element Record was given, for BuildElementGraph
+    const GuidHashMap<bool>& GetElements() const { return elements; }
+
+    // changes without the elements of GetElements
+    void      RemoveFrom(const ElementChangeTracker& changes, ElementChangeTracker& remaining) const;
+
+    bool      IsEmpty() const { return elements.IsEmpty() && nodes.IsEmpty(); }
+    void      Clear();
+
+    HostError Save(const std::string& filePath) const;
+    // HostErrBadFormat for a file that is not a record or is truncated, the record is then empty
+    HostError Load(const std::string& filePath);
+
+private:
+    struct NodeAnnotations {
+        int                   labelType;
+        std::vector<HostGuid> elements;
+    };
+
+    GuidHashMap<NodeAnnotations> nodes;
+    GuidHashMap<bool>            elements;
+};
+
+#endif // PREDICTED_ANNOTATIONS_HPP
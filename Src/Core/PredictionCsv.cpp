@@ -0,0 +1,264 @@
+#include "PredictionCsv.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+std::string_view TrimBlanks(std::string_view str) {
+    while (!str.empty() && (str.front() == ' ' || str.front() == '\t'))
+        str.remove_prefix(1);
+    while (!str.empty() && (str.back() == ' ' || str.back() == '\t'))
+        str.remove_suffix(1);
+    return str;
+}
+
+double FieldToDouble(std::string_view field) {
+    double value;
+    return ParseCsvDouble(field, value) ? value : NaN;
+}
+
+constexpr size_t NoPosition = std::numeric_limits<size_t>::max();
+
+struct ColumnDesc {
+    const char* name;
+    bool        required;
+    size_t      position;       // in the fixed layout of exports without these names, NoPosition if not there
+};
+
+// Header names written by the GNN export, in PredictionField order
+const ColumnDesc ColumnDescs[PredFieldCount] = {
+    { "guid",        true,  2          },
+    { "length",      false, 3          },
+    { "width",       true,  4          },
+    { "bb_xmin",     true,  9          },
+    { "bb_ymin",     true,  10         },
+    { "bb_zmin",     false, NoPosition },
+    { "bb_xmax",     true,  12         },
+    { "bb_ymax",     true,  13         },
+    { "bb_zmax",     false, NoPosition },
+    { "pos_x",       true,  16         },
+    { "pos_y",       true,  17         },
+    { "room_name",   true,  18         },
+    { "room_number", true,  19         },
+    { "labelType",   true,  23         }
+};
+
+// Fields of a row in the fixed layout
+constexpr size_t PositionalColumnCount = 24;
+
+void SplitCsvLine(std::string_view line, std::vector<std::string_view>& fields) {
+    fields.clear();
+
+    size_t start = 0;
+    bool quoted = false;
+    for (size_t i = 0; i <= line.size(); ++i) {
+        if (i < line.size()) {
+            if (line[i] == '"')
+                quoted = !quoted;
+            if (line[i] != ',' || quoted)
+                continue;
+        }
+
+        // Room names may be quoted when they contain commas, the quotes are not part of the value
+        std::string_view field = line.substr(start, i - start);
+        if (field.size() >= 2 && field.front() == '"' && field.back() == '"')
+            field = field.substr(1, field.size() - 2);
+        fields.push_back(field);
+        start = i + 1;
+    }
+}
+
+int FieldToLabelType(std::string_view field) {
+    // Label types are written as 1 or 1.0 depending on the exporter
+    double value;
+    if (!ParseCsvDouble(field, value) || value != std::floor(value) || std::fabs(value) > 1e6)
+        return PredLabelNone;
+    return static_cast<int>(value);
+}
+
+}
+
+bool ParseCsvDouble(std::string_view field, double& value) {
+    field = TrimBlanks(field);
+    if (!field.empty() && field.front() == '+')
+        field.remove_prefix(1);
+    if (field.empty())
+        return false;
+
+#if defined (__cpp_lib_to_chars)
+    const char* end = field.data() + field.size();
+    std::from_chars_result result = std::from_chars(field.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end;
+#else
+    // Standard libraries without floating point from_chars
+    char buffer[64];
+    if (field.size() >= sizeof(buffer))
+        return false;
+    field.copy(buffer, field.size());
+    buffer[field.size()] = '\0';
+    char* end = nullptr;
+    value = std::strtod(buffer, &end);
+    return end == buffer + field.size();
+#endif
+}
+
+const char* PredictionSchema::GetColumnName(PredictionField field) {
+    return ColumnDescs[field].name;
+}
+
+HostError PredictionSchema::Bind(std::string_view header, std::string& errorMessage) {
+    std::vector<std::string_view> names;
+    SplitCsvLine(header, names);
+
+    // A header without any known name is taken for an export in the fixed layout, if it has its column count
+    positional = true;
+    for (size_t field = 0; field < PredFieldCount && positional; ++field) {
+        for (std::string_view name : names)
+            positional = positional && TrimBlanks(name) != ColumnDescs[field].name;
+    }
+    if (positional) {
+        if (names.size() != PositionalColumnCount) {
+            positional = false;
+            errorMessage = "No known column names and " + std::to_string(names.size()) + " columns instead of the " +
+                std::to_string(PositionalColumnCount) + " of the fixed layout";
+            return HostErrBadFormat;
+        }
+        columnCount = PositionalColumnCount;
+        for (size_t field = 0; field < PredFieldCount; ++field)
+            columns[field] = ColumnDescs[field].position != NoPosition ? ColumnDescs[field].position : columnCount;
+        return HostNoError;
+    }
+
+    columnCount = names.size();
+    for (size_t field = 0; field < PredFieldCount; ++field) {
+        columns[field] = columnCount;
+        for (size_t column = 0; column < names.size(); ++column) {
+            if (TrimBlanks(names[column]) != ColumnDescs[field].name)
+                continue;
+            if (columns[field] != columnCount) {
+                errorMessage = std::string("Duplicate column '") + ColumnDescs[field].name + "'";
+                return HostErrBadFormat;
+            }
+            columns[field] = column;
+        }
+
+        if (columns[field] == columnCount && ColumnDescs[field].required) {
+            errorMessage = std::string("Missing column '") + ColumnDescs[field].name + "'";
+            return HostErrBadFormat;
+        }
+    }
+
+    return HostNoError;
+}
+
+PredictionCsvReader::PredictionCsvReader() :
+    pos(0),
+    lineNumber(0)
+{
+}
+
+HostError PredictionCsvReader::Open(const std::string& filePath) {
+    HostError err = file.Open(filePath);
+    pos = 0;
+    lineNumber = 0;
+    if (err != HostNoError)
+        return err;
+
+    // Skip the UTF-8 byte order mark some spreadsheet tools write
+    std::string_view data = file.GetView();
+    if (data.substr(0, 3) == "\xEF\xBB\xBF")
+        pos = 3;
+
+    errorMessage.clear();
+    std::string_view header;
+    if (!NextLine(header)) {
+        errorMessage = "Missing header line";
+        return HostErrBadFormat;
+    }
+
+    err = schema.Bind(header, errorMessage);
+    if (err != HostNoError)
+        return err;
+
+    fields.reserve(schema.GetColumnCount() + 1);
+    return HostNoError;
+}
+
+void PredictionCsvReader::Close() {
+    file.Close();
+    pos = 0;
+    lineNumber = 0;
+}
+
+bool PredictionCsvReader::NextLine(std::string_view& line) {
+    std::string_view data = file.GetView();
+    if (pos >= data.size())
+        return false;
+
+    size_t end = data.find('\n', pos);
+    if (end == std::string_view::npos)
+        end = data.size();
+
+    line = data.substr(pos, end - pos);
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+
+    pos = end + 1;
+    ++lineNumber;
+    return true;
+}
+
+bool PredictionCsvReader::ReadNextLine(std::string_view& line) {
+    while (NextLine(line)) {
+        if (!line.empty())
+            return true;
+    }
+    return false;
+}
+
+bool PredictionCsvReader::ParseRecord(std::string_view line, std::vector<std::string_view>& fields, PredictionRecord& record) const {
+    SplitCsvLine(line, fields);
+    if (fields.size() < schema.GetColumnCount())
+        return false;
+
+    // Extra trailing fields are ignored, the slot after the last column stands in for missing optional columns
+    fields.resize(schema.GetColumnCount());
+    fields.emplace_back();
+
+    record.line = line;
+    record.guidStr = TrimBlanks(fields[schema.GetColumn(PredFieldGuid)]);
+    record.guid = HostNullGuid;
+    if (!record.guidStr.empty() && !HostGuidFromString(record.guidStr, record.guid))
+        record.guid = HostNullGuid;
+
+    record.length = FieldToDouble(fields[schema.GetColumn(PredFieldLength)]);
+    record.width = FieldToDouble(fields[schema.GetColumn(PredFieldWidth)]);
+    record.bounds.xMin = FieldToDouble(fields[schema.GetColumn(PredFieldBBXMin)]);
+    record.bounds.yMin = FieldToDouble(fields[schema.GetColumn(PredFieldBBYMin)]);
+    record.bounds.zMin = FieldToDouble(fields[schema.GetColumn(PredFieldBBZMin)]);
+    record.bounds.xMax = FieldToDouble(fields[schema.GetColumn(PredFieldBBXMax)]);
+    record.bounds.yMax = FieldToDouble(fields[schema.GetColumn(PredFieldBBYMax)]);
+    record.bounds.zMax = FieldToDouble(fields[schema.GetColumn(PredFieldBBZMax)]);
+    record.pos.x = FieldToDouble(fields[schema.GetColumn(PredFieldPosX)]);
+    record.pos.y = FieldToDouble(fields[schema.GetColumn(PredFieldPosY)]);
+    record.roomName = fields[schema.GetColumn(PredFieldRoomName)];
+    record.roomNoStr = fields[schema.GetColumn(PredFieldRoomNo)];
+    record.labelType = FieldToLabelType(fields[schema.GetColumn(PredFieldLabelType)]);
+    return true;
+}
+
+bool PredictionCsvReader::ReadNext(PredictionRecord& record) {
+    std::string_view line;
+    while (ReadNextLine(line)) {
+        if (ParseRecord(line, fields, record))
+            return true;
+        std::cerr << "Not enough tokens in line: " << line << std::endl;
+    }
+
+    return false;
+}
@@ -0,0 +1,116 @@
+#ifndef PREDICTION_CSV_HPP
+#define PREDICTION_CSV_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "HostTypes.hpp"
+#include "MappedFile.hpp"
+
+// Fields the annotation reads from the prediction CSV exported by the GNN
+enum PredictionField : size_t {
+    PredFieldGuid,
+    PredFieldLength,
+    PredFieldWidth,
+    PredFieldBBXMin,
+    PredFieldBBYMin,
+    PredFieldBBZMin,
+    PredFieldBBXMax,
+    PredFieldBBYMax,
+    PredFieldBBZMax,
+    PredFieldPosX,
+    PredFieldPosY,
+    PredFieldRoomName,
+    PredFieldRoomNo,
+    PredFieldLabelType,
+    PredFieldCount
+};
+
+// Column positions of the fields, resolved once from the header line. A header of exactly 24 columns
+// that names none of the fields is taken for an export in the fixed layout the first exporter wrote:
+// guid, length and width in columns 2-4, bb_xmin, bb_ymin in 9-10, bb_xmax, bb_ymax in 12-13, pos_x,
+// pos_y, room_name, room_number in 16-19 and labelType in 23. Any other header without the names is refused.
+class PredictionSchema {
+public:
+    // Fails with HostErrBadFormat if a required column is missing, a name appears twice or a header
+    // without names does not have the column count of the fixed layout
+    HostError Bind(std::string_view header, std::string& errorMessage);
+
+    // True if the header named none of the fields and the fixed layout is used
+    bool      IsPositional() const { return positional; }
+
+    // Every row must have at least this many fields
+    size_t    GetColumnCount() const { return columnCount; }
+
+    // Optional columns that are not in the file point one past the last column, the reader keeps an empty field there
+    size_t    GetColumn(PredictionField field) const { return columns[field]; }
+
+    static const char* GetColumnName(PredictionField field);
+
+private:
+    size_t    columnCount = 0;
+    size_t    columns[PredFieldCount] = {};
+    bool      positional = false;
+};
+
+// Label types predicted for an element
+constexpr int PredLabelNone      = -1;
+constexpr int PredLabelDimension = 1;
+constexpr int PredLabelDoor      = 2;
+constexpr int PredLabelZone      = 4;
+
+// One parsed CSV row. Strings are views into the mapped file and stay valid while the reader is open,
+// numbers that are missing or do not parse are NaN.
+struct PredictionRecord {
+    std::string_view line;          // raw row, for messages
+    std::string_view guidStr;
+    HostGuid         guid;          // HostNullGuid if guidStr is empty or invalid
+    double           length = 0.0;
+    double           width = 0.0;
+    HostBox3D        bounds;        // bb_xmin ... bb_zmax
+    HostCoord        pos;           // pos_x, pos_y
+    std::string_view roomName;
+    std::string_view roomNoStr;
+    int              labelType = PredLabelNone;
+};
+
+// Streams PredictionRecords out of a memory mapped CSV, each row is split exactly once
+class PredictionCsvReader {
+public:
+    PredictionCsvReader();
+
+    // Maps the file and binds the schema from the header line. Returns HostErrBadFormat
+    // if the header does not match, GetErrorMessage tells why.
+    HostError Open(const std::string& filePath);
+    void      Close();
+
+    // Fills the next complete row, rows with fewer fields than the header are reported and skipped. Returns false at the end of the file.
+    bool      ReadNext(PredictionRecord& record);
+
+    // Next non-empty row as raw text, for callers that parse rows themselves. Returns false at the end of the file.
+    bool      ReadNextLine(std::string_view& line);
+
+    // Parses one row with the bound schema, false if it has fewer fields than the header.
+    // Safe to call from several threads, each with its own fields buffer.
+    bool      ParseRecord(std::string_view line, std::vector<std::string_view>& fields, PredictionRecord& record) const;
+
+    size_t    GetLineNumber() const { return lineNumber; }
+    const PredictionSchema& GetSchema() const { return schema; }
+    const std::string&      GetErrorMessage() const { return errorMessage; }
+
+private:
+    bool      NextLine(std::string_view& line);
+
+    MappedFile                    file;
+    PredictionSchema              schema;
+    std::string                   errorMessage;
+    size_t                        pos;
+    size_t                        lineNumber;
+    std::vector<std::string_view> fields;
+};
+
+// Locale independent number parsing for CSV fields, surrounding blanks are ignored
+bool ParseCsvDouble(std::string_view field, double& value);
+
+#endif // PREDICTION_CSV_HPP
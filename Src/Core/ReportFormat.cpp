@@ -0,0 +1,135 @@
+#include "ReportFormat.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// Two uppercase hex digits for every byte value
+struct HexPairTable {
+    char pairs[256][2];
+
+    constexpr HexPairTable() : pairs() {
+        const char digits[] = "0123456789ABCDEF";
+        for (int i = 0; i < 256; ++i) {
+            pairs[i][0] = digits[i >> 4];
+            pairs[i][1] = digits[i & 0x0F];
+        }
+    }
+};
+
+constexpr HexPairTable HexPairs;
+
+// Bytes written before each dash of the text form
+constexpr int GuidGroupBytes[] = { 4, 2, 2, 2, 6 };
+
+// Longest %.Nf output kept on the fast path, larger values are rare (and huge)
+constexpr size_t MaxFixedLength = 64;
+
+}
+
+char* FormatGuid(const HostGuid& guid, char* out) {
+    uint8_t bytes[16];
+    HostGuidToBytes(guid, bytes);
+
+    const uint8_t* byte = bytes;
+    for (int group = 0; group < 5; ++group) {
+        if (group > 0)
+            *out++ = '-';
+        for (int i = 0; i < GuidGroupBytes[group]; ++i, ++byte) {
+            out[0] = HexPairs.pairs[*byte][0];
+            out[1] = HexPairs.pairs[*byte][1];
+            out += 2;
+        }
+    }
+    return out;
+}
+
+ReportBuffer::ReportBuffer() :
+    size(0)
+{
+    data.resize(1024);
+}
+
+char* ReportBuffer::Reserve(size_t count) {
+    if (size + count > data.size())
+        data.resize(std::max(data.size() * 2, size + count));
+    return &data[size];
+}
+
+ReportBuffer& ReportBuffer::Append(std::string_view text) {
+    if (text.empty())
+        return *this;
+    std::memcpy(Reserve(text.size()), text.data(), text.size());
+    size += text.size();
+    return *this;
+}
+
+ReportBuffer& ReportBuffer::Append(char c) {
+    *Reserve(1) = c;
+    ++size;
+    return *this;
+}
+
+ReportBuffer& ReportBuffer::AppendGuid(const HostGuid& guid) {
+    FormatGuid(guid, Reserve(GuidStringLength));
+    size += GuidStringLength;
+    return *this;
+}
+
+ReportBuffer& ReportBuffer::AppendInt(int64_t value) {
+    char* out = Reserve(24);
+    size += std::to_chars(out, out + 24, value).ptr - out;
+    return *this;
+}
+
+ReportBuffer& ReportBuffer::AppendFixed(double value, int precision) {
+    char* out = Reserve(MaxFixedLength);
+#if defined (__cpp_lib_to_chars)
+    std::to_chars_result result = std::to_chars(out, out + MaxFixedLength, value, std::chars_format::fixed, precision);
+    if (result.ec == std::errc()) {
+        size += result.ptr - out;
+        return *this;
+    }
+#else
+    int length = snprintf(out, MaxFixedLength, "%.*f", precision, value);
+    if (length >= 0 && static_cast<size_t>(length) < MaxFixedLength) {
+        size += length;
+        return *this;
+    }
+#endif
+
+    // Does not fit the fast path, let printf size it
+    int needed = snprintf(nullptr, 0, "%.*f", precision, value);
+    if (needed > 0) {
+        out = Reserve(needed + 1);
+        snprintf(out, needed + 1, "%.*f", precision, value);
+        size += needed;
+    }
+    return *this;
+}
+
+ReportBuffer& ReportBuffer::AppendBox(const HostBox3D& box) {
+    Append("[(").AppendFixed(box.xMin).Append(", ").AppendFixed(box.yMin).Append(", ").AppendFixed(box.zMin);
+    Append("), (").AppendFixed(box.xMax).Append(", ").AppendFixed(box.yMax).Append(", ").AppendFixed(box.zMax);
+    return Append(")]");
+}
+
+ReportBuffer& ReportBuffer::AppendBox(const float box[6]) {
+    Append("[(").AppendFixed(box[0]).Append(", ").AppendFixed(box[1]).Append(", ").AppendFixed(box[2]);
+    Append("), (").AppendFixed(box[3]).Append(", ").AppendFixed(box[4]).Append(", ").AppendFixed(box[5]);
+    return Append(")]");
+}
+
+void ReportBuffer::WriteLine(std::ostream& outFile) {
+    // Newline without std::endl, flushing every record is up to the stream's owner
+    Append('\n');
+    outFile.write(data.data(), size);
+}
+
+ReportBuffer& GetThreadReportBuffer() {
+    thread_local ReportBuffer buffer;
+    buffer.Clear();
+    return buffer;
+}
@@ -0,0 +1,48 @@
+#ifndef REPORT_FORMAT_HPP
+#define REPORT_FORMAT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "HostTypes.hpp"
+
+// Length of the 8-4-4-4-12 GUID text form
+constexpr size_t GuidStringLength = 36;
+
+// Writes the uppercase text form of guid to out (GuidStringLength chars, no terminator), returns the end
+char* FormatGuid(const HostGuid& guid, char* out);
+
+// Growable text buffer for building report lines without heap allocations once it has grown.
+// Numbers are formatted like printf in the "C" locale.
+class ReportBuffer {
+public:
+    ReportBuffer();
+
+    void             Clear() { size = 0; }
+    size_t           GetSize() const { return size; }
+    std::string_view GetView() const { return std::string_view(data.data(), size); }
+
+    ReportBuffer&    Append(std::string_view text);
+    ReportBuffer&    Append(char c);
+    ReportBuffer&    AppendGuid(const HostGuid& guid);
+    ReportBuffer&    AppendInt(int64_t value);
+    ReportBuffer&    AppendFixed(double value, int precision = 2);                // %.2f
+    ReportBuffer&    AppendBox(const HostBox3D& box);                               // [(x, y, z), (x, y, z)] with %.2f
+    ReportBuffer&    AppendBox(const float box[6]);
+
+    // Appends a newline and writes the buffer
+    void             WriteLine(std::ostream& outFile);
+
+private:
+    char*            Reserve(size_t count);
+
+    std::string      data;
+    size_t           size;
+};
+
+// Report buffer of the calling thread, cleared before it is returned
+ReportBuffer& GetThreadReportBuffer();
+
+#endif // REPORT_FORMAT_HPP
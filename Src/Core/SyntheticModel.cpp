@@ -0,0 +1,352 @@
+#include "SyntheticModel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include "PredictionCsv.hpp"
+
+namespace {
+
+const double WallThickness = 0.2;
+const double DoorWidth = 0.9;
+const double DoorHeight = 2.1;
+
+// Grid of one floor, rooms fill it row by row so the last row may be short
+struct FloorGrid {
+    int roomCount;
+    int columns;
+    int rows;
+
+    explicit FloorGrid(int roomCount) :
+        roomCount(std::max(roomCount, 1)),
+        columns(static_cast<int>(std::ceil(std::sqrt(static_cast<double>(std::max(roomCount, 1)))))),
+        rows((std::max(roomCount, 1) + columns - 1) / columns)
+    {
+    }
+
+    bool HasRoom(int row, int column) const {
+        return row >= 0 && row < rows && column >= 0 && column < columns && row * columns + column < roomCount;
+    }
+
+    // Walls on the grid lines next to at least one room, horizontal ones first
+    template <typename Function>
+    void ForEachWall(Function&& function) const {
+        for (int row = 0; row <= rows; ++row) {
+            for (int column = 0; column < columns; ++column) {
+                if (HasRoom(row - 1, column) || HasRoom(row, column))
+                    function(column, row, column + 1, row);
+            }
+        }
+        for (int column = 0; column <= columns; ++column) {
+            for (int row = 0; row < rows; ++row) {
+                if (HasRoom(row, column - 1) || HasRoom(row, column))
+                    function(column, row, column, row + 1);
+            }
+        }
+    }
+
+    int GetWallCount() const {
+        int wallCount = 0;
+        ForEachWall([&](int, int, int, int) { ++wallCount; });
+        return wallCount;
+    }
+};
+
+// Deterministic choice of item index of a stream, true for about share of the items
+bool Pick(std::uint32_t seed, std::uint64_t stream, std::uint64_t index, double share) {
+    // splitmix64 finalizer
+    std::uint64_t x = (static_cast<std::uint64_t>(seed) << 32) ^ (stream * 0x9E3779B97F4A7C15ull) ^ index;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return static_cast<double>(x >> 11) * (1.0 / 9007199254740992.0) < share;
+}
+
+enum PickStream : std::uint64_t {
+    PickDimension = 1,
+    PickLabel = 2,
+    PickMarker = 3
+};
+
+// Door k of doorCount along a wall, as the position of its center
+HostCoord DoorPosition(const HostCoord& begC, const HostCoord& endC, int k, int doorCount) {
+    double t = static_cast<double>(k + 1) / (doorCount + 1);
+    return { begC.x + (endC.x - begC.x) * t, begC.y + (endC.y - begC.y) * t };
+}
+
+HostBox3D AroundSegment(const HostCoord& begC, const HostCoord& endC, double halfWidth, double zMin, double zMax) {
+    return {
+        std::min(begC.x, endC.x) - halfWidth, std::min(begC.y, endC.y) - halfWidth, zMin,
+        std::max(begC.x, endC.x) + halfWidth, std::max(begC.y, endC.y) + halfWidth, zMax
+    };
+}
+
+// Uniform in [-range, range), splitmix64 so that the weights are the same everywhere
+float RandomWeight(std::uint64_t& state, float range) {
+    std::uint64_t x = (state += 0x9E3779B97F4A7C15ull);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return static_cast<float>((static_cast<double>(x >> 11) * (1.0 / 9007199254740992.0) * 2.0 - 1.0) * range);
+}
+
+void FillRandom(GnnTensor<float>& values, size_t count, std::uint64_t& state, float range) {
+    std::vector<float> random(count);
+    for (float& value : random)
+        value = RandomWeight(state, range);
+    values = std::move(random);
+}
+
+std::string FormatLength(double value) {
+    char str[32];
+    snprintf(str, sizeof(str), "%.2f", value);
+    return str;
+}
+
+}
+
+size_t CountSyntheticElements(const SyntheticModelParams& params) {
+    FloorGrid grid(params.roomsPerFloor);
+    int wallCount = grid.GetWallCount();
+    size_t doorsPerWall = static_cast<size_t>(std::max(params.doorsPerWall, 0));
+
+    size_t count = 0;
+    std::uint64_t wallIndex = 0;
+    std::uint64_t doorIndex = 0;
+    for (int floor = 0; floor < std::max(params.floorCount, 1); ++floor) {
+        count += 1 + wallCount + wallCount * doorsPerWall + grid.roomCount;    // slab, walls, doors, zones
+        for (int wall = 0; wall < wallCount; ++wall, ++wallIndex) {
+            if (Pick(params.seed, PickDimension, wallIndex, params.dimensionedWallShare))
+                ++count;
+            for (size_t door = 0; door < doorsPerWall; ++door, ++doorIndex) {
+                if (Pick(params.seed, PickLabel, doorIndex, params.labelledDoorShare))
+                    ++count;
+            }
+        }
+    }
+    return count;
+}
+
+SyntheticModelParams SyntheticModelParamsForSize(size_t elementCount, const SyntheticModelParams& shape) {
+    SyntheticModelParams params = shape;
+
+    // A room brings about two walls, their doors and a zone
+    double perRoom = 3.0 + 2.0 * std::max(shape.doorsPerWall, 0) * (1.0 + shape.labelledDoorShare) + 2.0 * shape.dimensionedWallShare;
+    double roomCount = std::max(static_cast<double>(elementCount) / perRoom, 1.0);
+    params.floorCount = std::max(static_cast<int>(std::cbrt(roomCount / 16.0)), 1);
+
+    // Largest floor that stays within elementCount
+    int low = 1;
+    int high = std::max(static_cast<int>(roomCount / params.floorCount) * 2, 1);
+    while (low < high) {
+        int middle = low + (high - low + 1) / 2;
+        params.roomsPerFloor = middle;
+        if (CountSyntheticElements(params) <= elementCount)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    params.roomsPerFloor = low;
+    return params;
+}
+
+void GenerateSyntheticModel(const SyntheticModelParams& params, MemoryElementHost& host) {
+    FloorGrid grid(params.roomsPerFloor);
+    int doorsPerWall = std::max(params.doorsPerWall, 0);
+
+    std::uint64_t wallIndex = 0;
+    std::uint64_t doorIndex = 0;
+    for (int floor = 0; floor < std::max(params.floorCount, 1); ++floor) {
+        double zMin = floor * params.floorHeight;
+        double zMax = zMin + params.floorHeight;
+        std::string floorName = std::to_string(floor);
+
+        ModelElementData slab;
+        slab.element.guid = host.NewGuid();
+        slab.element.type = HostElemType::Slab;
+        slab.element.wall.begC = { 0.0, 0.0 };
+        slab.element.wall.endC = { grid.columns * params.roomWidth, grid.rows * params.roomDepth };
+        slab.element.wall.thickness = 0.3;
+        slab.element.wall.height = 0.3;
+        slab.hasBounds = true;
+        slab.bounds = { 0.0, 0.0, zMin - 0.3, grid.columns * params.roomWidth, grid.rows * params.roomDepth, zMin };
+        slab.hasInfoString = true;
+        slab.infoString = "S" + floorName;
+        host.AddElement(slab);
+
+        int wallNumber = 0;
+        grid.ForEachWall([&](int column0, int row0, int column1, int row1) {
+            HostCoord begC = { column0 * params.roomWidth, row0 * params.roomDepth };
+            HostCoord endC = { column1 * params.roomWidth, row1 * params.roomDepth };
+            double length = std::hypot(endC.x - begC.x, endC.y - begC.y);
+
+            ModelElementData wall;
+            wall.element.guid = host.NewGuid();
+            wall.element.type = HostElemType::Wall;
+            wall.element.wall.begC = begC;
+            wall.element.wall.endC = endC;
+            wall.element.wall.thickness = WallThickness;
+            wall.element.wall.height = params.floorHeight;
+            wall.hasBounds = true;
+            wall.bounds = AroundSegment(begC, endC, WallThickness / 2, zMin, zMax);
+            wall.hasInfoString = true;
+            wall.infoString = "W" + floorName + "-" + std::to_string(++wallNumber);
+            host.AddElement(wall);
+
+            for (int k = 0; k < doorsPerWall; ++k, ++doorIndex) {
+                HostCoord center = DoorPosition(begC, endC, k, doorsPerWall);
+                HostCoord half = { (endC.x - begC.x) / length * DoorWidth / 2, (endC.y - begC.y) / length * DoorWidth / 2 };
+
+                ModelElementData door;
+                door.element.guid = host.NewGuid();
+                door.element.type = HostElemType::Door;
+                door.element.door.width = DoorWidth;
+                door.element.door.height = DoorHeight;
+                door.owner = wall.element.guid;
+                door.hasBounds = true;
+                door.bounds = AroundSegment({ center.x - half.x, center.y - half.y }, { center.x + half.x, center.y + half.y },
+                    WallThickness / 2, zMin, zMin + DoorHeight);
+                if (Pick(params.seed, PickMarker, doorIndex, params.markedDoorShare)) {
+                    door.element.door.markGuid = host.NewGuid();
+                    host.AddBounds(door.element.door.markGuid, { center.x + 0.5, center.y + 0.5, zMin, center.x + 1.0, center.y + 1.0, zMin });
+                }
+                host.AddElement(door);
+
+                if (Pick(params.seed, PickLabel, doorIndex, params.labelledDoorShare)) {
+                    ModelElementData label;
+                    label.element.guid = host.NewGuid();
+                    label.element.type = HostElemType::Label;
+                    label.owner = door.element.guid;
+                    label.hasBounds = true;
+                    label.bounds = { center.x + 0.3, center.y + 0.3, zMin, center.x + 1.3, center.y + 0.6, zMin };
+                    host.AddElement(label);
+                }
+            }
+
+            if (Pick(params.seed, PickDimension, wallIndex++, params.dimensionedWallShare)) {
+                // Dimension line parallel to the wall, half a meter off
+                HostCoord offset = { -(endC.y - begC.y) / length * 0.5, (endC.x - begC.x) / length * 0.5 };
+                ModelElementData dimension;
+                dimension.element.guid = host.NewGuid();
+                dimension.element.type = HostElemType::Dimension;
+                dimension.hasBounds = true;
+                dimension.bounds = AroundSegment({ begC.x + offset.x, begC.y + offset.y }, { endC.x + offset.x, endC.y + offset.y }, 0.0, zMin, zMin);
+                for (int node = 0; node < 2; ++node) {
+                    HostDimElem dimElem;
+                    dimElem.baseType = HostElemType::Wall;
+                    dimElem.baseGuid = wall.element.guid;
+                    dimElem.pos = node == 0 ? HostCoord { begC.x + offset.x, begC.y + offset.y } : HostCoord { endC.x + offset.x, endC.y + offset.y };
+                    dimElem.notePos = { (begC.x + endC.x) / 2 + offset.x, (begC.y + endC.y) / 2 + offset.y };
+                    dimElem.dimVal = node == 0 ? 0.0 : length;
+                    dimElem.noteText = FormatLength(length);
+                    dimension.dimElems.push_back(dimElem);
+                }
+                host.AddElement(dimension);
+            }
+        });
+
+        for (int room = 0; room < grid.roomCount; ++room) {
+            double x = (room % grid.columns) * params.roomWidth;
+            double y = (room / grid.columns) * params.roomDepth;
+
+            ModelElementData zone;
+            zone.element.guid = host.NewGuid();
+            zone.element.type = HostElemType::Zone;
+            zone.element.zone.stampGuid = host.NewGuid();
+            zone.element.zone.pos = { x + params.roomWidth / 2, y + params.roomDepth / 2 };
+            zone.element.zone.roomName = "Room " + std::to_string(room + 1);
+            zone.element.zone.roomNoStr = floorName + "." + std::to_string(room + 1);
+            zone.element.zone.roomHeight = params.floorHeight - 0.3;
+            zone.hasBounds = true;
+            zone.bounds = { x, y, zMin, x + params.roomWidth, y + params.roomDepth, zMax - 0.3 };
+            host.AddBounds(zone.element.zone.stampGuid, { zone.element.zone.pos.x - 0.5, zone.element.zone.pos.y - 0.25, zMin,
+                zone.element.zone.pos.x + 0.5, zone.element.zone.pos.y + 0.25, zMin });
+            host.AddElement(zone);
+        }
+    }
+}
+
+size_t WriteSyntheticPredictions(MemoryElementHost& host, const std::string& filePath) {
+    std::ofstream outFile(filePath, std::ios::binary);
+    if (!outFile.is_open())
+        return 0;
+
+    outFile << "guid,length,width,bb_xmin,bb_ymin,bb_zmin,bb_xmax,bb_ymax,bb_zmax,pos_x,pos_y,room_name,room_number,labelType\n";
+
+    size_t rowCount = 0;
+    char numbers[256];
+    std::vector<HostGuid> elementList;
+    const HostElemType elementTypes[] = { HostElemType::Wall, HostElemType::Door, HostElemType::Zone };
+    for (HostElemType elemType : elementTypes) {
+        if (host.GetElemList(elemType, elementList) != HostNoError)
+            continue;
+        for (const HostGuid& guid : elementList) {
+            HostElement element;
+            HostBox3D box;
+            if (host.GetElement(guid, element) != HostNoError || host.CalcBounds(guid, box) != HostNoError)
+                continue;
+
+            double length = std::hypot(element.wall.endC.x - element.wall.begC.x, element.wall.endC.y - element.wall.begC.y);
+            double width = elemType == HostElemType::Door ? element.door.width : element.wall.thickness;
+            HostCoord pos = elemType == HostElemType::Zone ? element.zone.pos : HostCoord { (box.xMin + box.xMax) / 2, (box.yMin + box.yMax) / 2 };
+            int labelType = elemType == HostElemType::Wall ? PredLabelDimension : elemType == HostElemType::Door ? PredLabelDoor : PredLabelZone;
+
+            snprintf(numbers, sizeof(numbers), "%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f",
+                elemType == HostElemType::Wall ? length : 0.0, width,
+                box.xMin, box.yMin, box.zMin, box.xMax, box.yMax, box.zMax, pos.x, pos.y);
+            outFile << HostGuidToString(guid) << ',' << numbers << ',' << element.zone.roomName << ',' << element.zone.roomNoStr << ',' << labelType << '\n';
+            ++rowCount;
+        }
+    }
+    return outFile.good() ? rowCount : 0;
+}
+
+void MakeSyntheticGnnModel(size_t hiddenSize, size_t layerCount, std::uint32_t seed, GnnModel& model) {
+    // Hidden units 0 to 2 carry the answer for walls, doors and zones, unit 3 "no annotation"
+    // for the other node types. The random weights are too small to change it.
+    const GraphNodeType nodeTypes[] = { GraphNodeType::Wall, GraphNodeType::Door, GraphNodeType::Zone,
+        GraphNodeType::Dimension, GraphNodeType::ZoneStamp, GraphNodeType::Label };
+    const float SignalBias = 4.0f;
+    const float FeatureScale = 0.01f;
+    const float WeightRange = 0.02f;
+
+    model.Clear();
+    model.hiddenSize = std::max<size_t>(hiddenSize, 4);
+    model.classLabelTypes = { PredLabelNone, PredLabelDimension, PredLabelDoor, PredLabelZone };
+    model.edgeTypes = { "door_in_wall", "wall_dimensioned_by", "zone_has_stamp", "door_has_label", "wall_touches_wall", "zone_bounded_by_wall" };
+
+    std::uint64_t state = seed;
+    ElementGraph graph;
+    for (size_t i = 0; i < sizeof(nodeTypes) / sizeof(nodeTypes[0]); ++i) {
+        GnnNodeInput input;
+        input.type = nodeTypes[i];
+        input.predicted = i < 3;
+        for (const char* name : graph.GetNodes(input.type).featureNames) {
+            if (std::string(name) != "labelType")
+                input.featureNames.push_back(name);
+        }
+        input.featureMeans.assign(input.GetFeatureCount(), 0.0f);
+        input.featureScales.assign(input.GetFeatureCount(), FeatureScale);
+        FillRandom(input.weights, model.hiddenSize * input.GetFeatureCount(), state, WeightRange);
+        input.bias.assign(model.hiddenSize, 0.0f);
+        input.bias[std::min<size_t>(i, 3)] = SignalBias;
+        model.inputs.push_back(std::move(input));
+    }
+
+    model.layers.resize(layerCount);
+    for (GnnLayer& layer : model.layers) {
+        FillRandom(layer.selfWeights, model.hiddenSize * model.hiddenSize, state, WeightRange);
+        for (size_t unit = 0; unit < model.hiddenSize; ++unit)
+            layer.selfWeights[unit * model.hiddenSize + unit] += 1.0f;
+        FillRandom(layer.neighbourWeights, model.hiddenSize * model.hiddenSize, state, WeightRange);
+        layer.bias.assign(model.hiddenSize, 0.0f);
+    }
+
+    // Class 0 (none) reads unit 3, classes 1 to 3 read units 0 to 2
+    FillRandom(model.outputWeights, model.GetClassCount() * model.hiddenSize, state, WeightRange);
+    for (size_t c = 0; c < model.GetClassCount(); ++c)
+        model.outputWeights[c * model.hiddenSize + (c == 0 ? 3 : c - 1)] += 1.0f;
+    model.outputBias.assign(model.GetClassCount(), 0.0f);
+    model.InvalidateChecksum();
+}
@@ -0,0 +1,47 @@
+#ifndef SYNTHETIC_MODEL_HPP
+#define SYNTHETIC_MODEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "GnnModel.hpp"
+#include "MemoryElementHost.hpp"
+
+// Shape of a generated building. Every floor is a grid of rectangular rooms with a slab, walls on
+// the grid lines, doors evenly spaced along every wall and one zone with its stamp per room.
+// Existing annotations are spread deterministically from seed: a share of the walls carries a
+// dimension and a share of the doors a label or a door marker.
+struct SyntheticModelParams {
+    int           floorCount = 1;
+    int           roomsPerFloor = 4;
+    int           doorsPerWall = 1;
+    double        dimensionedWallShare = 0.25;
+    double        labelledDoorShare = 0.5;
+    double        markedDoorShare = 0.25;
+    double        roomWidth = 5.0;
+    double        roomDepth = 4.0;
+    double        floorHeight = 3.0;
+    std::uint32_t seed = 1;
+};
+
+// Number of elements GenerateSyntheticModel adds for params, labels and dimensions included
+size_t               CountSyntheticElements(const SyntheticModelParams& params);
+
+// Params for a model of about elementCount elements (at least one room), floors grow with the
+// cube root of the size so that large models are both tall and wide
+SyntheticModelParams SyntheticModelParamsForSize(size_t elementCount, const SyntheticModelParams& shape = SyntheticModelParams());
+
+// Adds the building to host, GUIDs come from host.NewGuid
+void                 GenerateSyntheticModel(const SyntheticModelParams& params, MemoryElementHost& host);
+
+// Writes a prediction CSV for the elements of host, the way the GNN would label the generated
+// building: a dimension for every wall, a door marker and label for every door, a zone for every
+// zone. Returns the number of rows written, 0 if the file could not be written.
+size_t               WriteSyntheticPredictions(MemoryElementHost& host, const std::string& filePath);
+
+// Label type classifier with random weights around the same answer as WriteSyntheticPredictions,
+// for timing inference: it has learnt nothing, but its predictions are stable. Takes every graph
+// feature but labelType, hiddenSize is at least 4.
+void                 MakeSyntheticGnnModel(size_t hiddenSize, size_t layerCount, std::uint32_t seed, GnnModel& model);
+
+#endif // SYNTHETIC_MODEL_HPP
@@ -0,0 +1,125 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threadCount) :
+    nextQueue(0),
+    queuedCount(0),
+    pendingCount(0),
+    stopping(false)
+{
+    // The calling thread uses queue 0 while it waits, so there is always at least one queue
+    size_t queueCount = std::max<size_t>(threadCount, 1);
+    for (size_t i = 0; i < queueCount; ++i)
+        queues.push_back(std::make_unique<WorkQueue>());
+
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+size_t ThreadPool::GetHardwareThreadCount() {
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        ++queuedCount;
+        ++pendingCount;
+    }
+
+    WorkQueue& queue = *queues[nextQueue++ % queues.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    workAvailable.notify_one();
+}
+
+bool ThreadPool::TryRunTask(size_t ownQueue) {
+    std::function<void()> task;
+    for (size_t i = 0; i < queues.size() && !task; ++i) {
+        WorkQueue& queue = *queues[(ownQueue + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            continue;
+
+        // Newest from the own queue while it is still warm in cache, oldest when stealing
+        if (i == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+    if (!task)
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        --queuedCount;
+    }
+
+    std::exception_ptr exception;
+    try {
+        task();
+    }
+    catch (...) {
+        exception = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (exception && !firstException)
+        firstException = exception;
+    if (--pendingCount == 0)
+        allDone.notify_all();
+    return true;
+}
+
+void ThreadPool::WorkerLoop(size_t ownQueue) {
+    while (true) {
+        if (TryRunTask(ownQueue))
+            continue;
+
+        std::unique_lock<std::mutex> lock(stateMutex);
+        workAvailable.wait(lock, [this] { return stopping || queuedCount > 0; });
+        if (stopping && queuedCount == 0)
+            return;
+    }
+}
+
+void ThreadPool::Wait() {
+    while (TryRunTask(0))
+        ;
+
+    std::unique_lock<std::mutex> lock(stateMutex);
+    allDone.wait(lock, [this] { return pendingCount == 0; });
+
+    if (firstException) {
+        std::exception_ptr exception = firstException;
+        firstException = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+void ParallelForChunks(ThreadPool& pool, size_t count, size_t chunkSize, const std::function<void(size_t, size_t, size_t)>& body) {
+    chunkSize = std::max<size_t>(chunkSize, 1);
+    size_t chunkIndex = 0;
+    for (size_t begin = 0; begin < count; begin += chunkSize, ++chunkIndex) {
+        size_t end = std::min(begin + chunkSize, count);
+        pool.Submit([&body, chunkIndex, begin, end] { body(chunkIndex, begin, end); });
+    }
+    pool.Wait();
+}
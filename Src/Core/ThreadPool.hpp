@@ -0,0 +1,64 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work stealing thread pool. Every worker owns a task queue and takes its newest task first,
+// idle workers steal the oldest task of another queue. The thread calling Wait helps out.
+//
+// Create the pool for the duration of a job, do not keep one in a static: joining threads
+// while the add-on is being unloaded can dead-lock.
+class ThreadPool {
+public:
+    // threadCount background workers, 0 runs every task on the thread calling Wait
+    explicit ThreadPool(size_t threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t GetThreadCount() const { return workers.size(); }
+
+    void   Submit(std::function<void()> task);
+
+    // Returns when every submitted task has finished, rethrows the first exception a task threw
+    void   Wait();
+
+    // Number of hardware threads, at least 1
+    static size_t GetHardwareThreadCount();
+
+private:
+    struct WorkQueue {
+        std::mutex                        mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool TryRunTask(size_t ownQueue);
+    void WorkerLoop(size_t ownQueue);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread>                workers;
+    std::atomic<size_t>                     nextQueue;
+
+    std::mutex                              stateMutex;
+    std::condition_variable                 workAvailable;
+    std::condition_variable                 allDone;
+    size_t                                  queuedCount;        // tasks waiting in the queues
+    size_t                                  pendingCount;       // tasks submitted but not finished
+    bool                                    stopping;
+    std::exception_ptr                      firstException;
+};
+
+// Calls body(chunkIndex, begin, end) for the consecutive chunks of [0, count) on the pool and waits for all of them
+void ParallelForChunks(ThreadPool& pool, size_t count, size_t chunkSize, const std::function<void(size_t, size_t, size_t)>& body);
+
+#endif // THREAD_POOL_HPP
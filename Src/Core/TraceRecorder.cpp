@@ -0,0 +1,62 @@
+#include "TraceRecorder.hpp"
+#include <algorithm>
+#include <fstream>
+
+TraceRecorder::TraceRecorder(size_t capacity) :
+    origin(Clock::now()),
+    spans(std::max<size_t>(capacity, 1)),
+    nextSpan(0)
+{
+}
+
+// Small numbers are easier to read in a trace viewer than native thread ids
+std::uint32_t TraceRecorder::CurrentThreadId() {
+    static std::atomic<std::uint32_t> nextThreadId(0);
+    thread_local std::uint32_t threadId = ++nextThreadId;
+    return threadId;
+}
+
+void TraceRecorder::AddSpan(const char* name, const char* category, Clock::time_point start, Clock::time_point end, std::int64_t index) {
+    Span& span = spans[nextSpan.fetch_add(1, std::memory_order_relaxed) % spans.size()];
+    span.name = name;
+    span.category = category;
+    span.startNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin).count();
+    span.durationNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    span.index = index;
+    span.threadId = CurrentThreadId();
+}
+
+void TraceRecorder::Clear() {
+    origin = Clock::now();
+    nextSpan.store(0, std::memory_order_relaxed);
+}
+
+size_t TraceRecorder::GetSpanCount() const {
+    return std::min(GetRecordedCount(), spans.size());
+}
+
+HostError TraceRecorder::WriteJson(const std::string& filePath) const {
+    std::ofstream outFile(filePath);
+    if (!outFile.is_open())
+        return HostErrFileIO;
+
+    // Timestamps are in microseconds, keep the nanoseconds
+    outFile.precision(3);
+    outFile << std::fixed << "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [";
+
+    // Oldest span first, after a wrap that is the one next to be overwritten
+    size_t recordedCount = GetRecordedCount();
+    size_t spanCount = GetSpanCount();
+    size_t first = recordedCount > spans.size() ? recordedCount % spans.size() : 0;
+    for (size_t i = 0; i < spanCount; ++i) {
+        const Span& span = spans[(first + i) % spans.size()];
+        outFile << (i == 0 ? "\n" : ",\n") << "    { \"name\": \"" << span.name << "\", \"cat\": \"" << span.category
+            << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << span.threadId
+            << ", \"ts\": " << span.startNanoseconds * 1e-3 << ", \"dur\": " << span.durationNanoseconds * 1e-3;
+        if (span.index >= 0)
+            outFile << ", \"args\": { \"index\": " << span.index << " }";
+        outFile << " }";
+    }
+    outFile << "\n  ]\n}\n";
+    return outFile.good() ? HostNoError : HostErrFileIO;
+}
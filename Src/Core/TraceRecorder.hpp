@@ -0,0 +1,83 @@
+#ifndef TRACE_RECORDER_HPP
+#define TRACE_RECORDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "HostTypes.hpp"
+
+// Timeline of the extract and annotate pipeline, written as Chrome trace-event JSON (open it in
+// chrome://tracing or ui.perfetto.dev). Spans go into a ring of fixed capacity: recording one is an
+// atomic increment and a slot write, and once the ring is full the oldest spans are overwritten.
+// Spans may be recorded from several threads at once, but not while Clear or WriteJson run.
+// Names and categories are not copied, pass string literals.
+class TraceRecorder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t DefaultCapacity = 1 << 16;
+
+    explicit TraceRecorder(size_t capacity = DefaultCapacity);
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    // A span from start to end on the calling thread, index is shown as an argument unless negative
+    void      AddSpan(const char* name, const char* category, Clock::time_point start, Clock::time_point end, std::int64_t index = -1);
+    void      Clear();
+
+    // Spans kept, at most the capacity
+    size_t    GetSpanCount() const;
+    // Spans recorded since Clear, including the overwritten ones
+    size_t    GetRecordedCount() const { return nextSpan.load(std::memory_order_relaxed); }
+
+    HostError WriteJson(const std::string& filePath) const;
+
+private:
+    struct Span {
+        const char*   name = nullptr;
+        const char*   category = nullptr;
+        std::int64_t  startNanoseconds = 0;     // since origin
+        std::int64_t  durationNanoseconds = 0;
+        std::int64_t  index = -1;
+        std::uint32_t threadId = 0;
+    };
+
+    static std::uint32_t CurrentThreadId();
+
+    Clock::time_point   origin;
+    std::vector<Span>   spans;
+    std::atomic<size_t> nextSpan;
+};
+
+// Records a span from construction to destruction. A null recorder records nothing.
+class TraceScope {
+public:
+    TraceScope(TraceRecorder* trace, const char* name, const char* category, std::int64_t index = -1) :
+        trace(trace),
+        name(name),
+        category(category),
+        index(index),
+        start(trace != nullptr ? TraceRecorder::Clock::now() : TraceRecorder::Clock::time_point())
+    {
+    }
+
+    ~TraceScope() {
+        if (trace != nullptr)
+            trace->AddSpan(name, category, start, TraceRecorder::Clock::now(), index);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceRecorder*                   trace;
+    const char*                      name;
+    const char*                      category;
+    std::int64_t                     index;
+    TraceRecorder::Clock::time_point start;
+};
+
+#endif // TRACE_RECORDER_HPP
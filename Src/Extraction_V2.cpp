@@ -2,23 +2,31 @@
 #include "ACAPinc.h"   // Also includes APIdefs.h
 #include "APICommon.h"
 #include "ResourceIds.hpp"
-#include <fstream>
 #include <APIdefs_Elements.h>
 #include <APIdefs_Base.h>
+#include <cstdlib>
 #include <set>
 #include <vector>
 #include <string>
 #include <iomanip>
+#include "AnnotationCreation.hpp"
 #include "AutomaticAnnotation.hpp"
+#include "ACAPIElementHost.hpp"
+#include "ElementExtraction.hpp"
+#include "ElementGraph.hpp"
+#include "ExtractionProfiler.hpp"
+#include "GnnModel.hpp"
+#include "HostCallRecording.hpp"
+#include "IncrementalExtraction.hpp"
 
 // Forward declaration of functions
 static GSErrCode __ACENV_CALL MenuCommandHandler(const API_MenuParams* menuParams);
 void ProcessBuildingElements();
-void ReportElementProperties(const API_Guid& elementGuid, API_ElemTypeID elemType, std::ofstream& outFile);
-void ReportDimensionElementProperties(const API_Guid& elementGuid, API_ElemTypeID elemType, std::ofstream& outFile);
+void ProcessBuildingElementsColumnar();
+void ProcessBuildingElementsIncremental();
+void ExportElementGraph();
 void DeleteDimensionsAndAnnotations();
 void Messagebox();
-void OutputAdditionalInfo(std::ofstream& outFile);
 
 
 // Unique IDs for the Add-On (change these to actual unique IDs)
@@ -33,11 +41,103 @@ static const Int32 AddOnCommandID = 1;
 
 static const Int32 ClearAnnotationsCommandID = 3; // Adjust the ID as needed
 
-// Output file for element information
-std::ofstream outFile;
-std::map<API_Guid, std::set<API_Guid>> wallDoors;
-std::map<API_Guid, API_Guid> doorToWallMap; // Global declaration
-std::map<API_Guid, bool> wallHasDimElems;
+// Output file for element information, rewritten by every extraction run
+static const char* ElementInfoPath = "ElementInfo.txt";
+
+// State of the last extraction run, reset by the next one so its memory is reused
+static ExtractionSession extractionSession;
+
+// Reports of the last incremental run and the elements changed since, kept next to ElementInfo.txt
+static const char* ElementSnapshotPath = "ElementInfo.snapshot";
+static ExtractionSnapshot extractionSnapshot;
+static ElementChangeTracker elementChanges;
+static bool observingElements = false;
+
+// Directory of the GNN graph files (manifest.json, features and CSR edges)
+static const char* ElementGraphPath = "ElementGraph";
+
+// Weights of the label type classifier. When the file is there, Automatic Annotation predicts in
+// process from the element graph instead of reading the prediction CSV.
+static const char* LabelClassifierPath = "LabelClassifier.gnn";
+
+// Embeddings and predictions of the last Automatic Annotation, so the next one only recomputes
+// the neighbourhood of what changed and annotates the label types that changed
+static GnnInference labelInference;
+
+// Annotations created by Automatic Annotation per element, replaced when its label type changes.
+// Kept next to ElementInfo.snapshot and loaded with it, so a restart does not annotate again.
+static const char* PredictedAnnotationsPath = "ElementInfo.annotations";
+static PredictedAnnotations predictedAnnotations;
+
+// The observer, the dirty set, the embeddings and the annotation record only live while the
+// add-on is loaded. Every command keeps it loaded while they are in use, so a command that does
+// not use them cannot drop them.
+static void KeepStateInMemory() {
+    ACAPI_KeepInMemory(observingElements || !predictedAnnotations.IsEmpty());
+}
+
+// Timings of the last extraction command, summarized in the Report window and written next to ElementInfo.txt
+static const char* ExtractionProfilePath = "ElementInfo.profile.json";
+static ExtractionProfiler extractionProfiler;
+
+// Timeline of the extraction, annotation and delete commands run while the add-on stays loaded,
+// rewritten after each one (Chrome trace-event JSON)
+static const char* PipelineTracePath = "Pipeline.trace.json";
+static TraceRecorder pipelineTrace;
+
+static void WritePipelineTrace() {
+    if (pipelineTrace.WriteJson(PipelineTracePath) != HostNoError)
+        WriteReport_Alert("Failed to write %s", PipelineTracePath);
+}
+
+// When this environment variable names a file, every host call of every command is recorded into
+// it for Extraction_V2Standalone to replay. The add-on then stays loaded, so one recording covers
+// the whole session; the file is rewritten after each command.
+static const char* HostCallRecordingVariable = "EXTRACTION_V2_RECORD_HOST_CALLS";
+static ACAPIElementHost addOnHost;
+static RecordingElementHost hostCallRecording(addOnHost);
+
+static const char* HostCallRecordingPath() {
+    const char* path = std::getenv(HostCallRecordingVariable);
+    return path != nullptr && *path != '\0' ? path : nullptr;
+}
+
+// Host the commands work through, recording when asked to
+static IElementHost& CommandHost() {
+    if (HostCallRecordingPath() != nullptr)
+        return hostCallRecording;
+    return addOnHost;
+}
+
+static void SaveHostCallRecording() {
+    const char* path = HostCallRecordingPath();
+    if (path == nullptr)
+        return;
+    ACAPI_KeepInMemory(true);
+    if (hostCallRecording.Save(path) != HostNoError)
+        WriteReport_Alert("Failed to write %s", path);
+}
+
+// Starts profiling one extraction command, host calls are timed through the returned host
+static ProfilingElementHost BeginProfiling(IElementHost& host) {
+    extractionProfiler.Clear();
+    extractionSession.profiler = &extractionProfiler;
+    extractionSession.trace = &pipelineTrace;
+    return ProfilingElementHost(host, extractionProfiler);
+}
+
+static void EndProfiling(const char* commandName) {
+    extractionSession.profiler = nullptr;
+    extractionSession.trace = nullptr;
+    WritePipelineTrace();
+    SaveHostCallRecording();
+
+    ACAPI_WriteReport(GS::UniString::Printf("%s profile:", commandName), false);
+    for (const std::string& line : extractionProfiler.FormatSummary())
+        ACAPI_WriteReport(line.c_str(), false);
+    if (extractionProfiler.WriteJson(ExtractionProfilePath) != HostNoError)
+        WriteReport_Alert("Failed to write %s", ExtractionProfilePath);
+}
 
 // Check environment function
 API_AddonType __ACDLL_CALL CheckEnvironment(API_EnvirParams* envir)
@@ -72,532 +172,134 @@ GSErrCode __ACENV_CALL	RegisterInterface(void)
 // Free data function
 GSErrCode __ACENV_CALL FreeData(void)
 {
-    // Ensure any final data gets written out before closing the file.
-    OutputAdditionalInfo(outFile);
-    // Close the output file
-    outFile.close();
+    if (observingElements)
+        StopElementObserver();
     return NoError;
 }
 
 // Function to process building elements
 void ProcessBuildingElements() {
-    GS::Array<API_Guid> elementList;
-
-    // Process dimension elements first to populate wallHasDimElems
-    if (ACAPI_Element_GetElemList(API_DimensionID, &elementList) == NoError && !elementList.IsEmpty()) {
-        for (const API_Guid& elementGuid : elementList) {
-            ReportDimensionElementProperties(elementGuid, API_DimensionID, outFile);
-        }
-    }
-
-    // Clear the list before processing other types
-    elementList.Clear();
-
-    // Now, process all other element types, ensuring walls are processed after dimension elements
-    API_ElemTypeID elementTypes[] = { API_WallID, API_SlabID, API_ZoneID, API_DoorID };
+    ProfilingElementHost host = BeginProfiling(CommandHost());
+    if (WriteTextReport(host, extractionSession, ElementInfoPath) != HostNoError)
+        WriteReport_Alert("Failed to write %s", ElementInfoPath);
+    EndProfiling("Extract BE");
+}
 
-    for (API_ElemTypeID elemType : elementTypes) {
-        if (ACAPI_Element_GetElemList(elemType, &elementList) == NoError && !elementList.IsEmpty()) {
-            for (const API_Guid& elementGuid : elementList) {
-                ReportElementProperties(elementGuid, elemType, outFile);
-            }
-        }
-        // Clear the list after each type to prepare for the next
-        elementList.Clear();
+// Function to process building elements into the binary columnar report
+void ProcessBuildingElementsColumnar() {
+    ProfilingElementHost host = BeginProfiling(CommandHost());
+    ColumnarReportWriter columnarReport;
+    ExtractionOutput output;
+    output.columnarReport = &columnarReport;
+    ProcessBuildingElements(host, extractionSession, output);
+    {
+        ProfileScope scope(&extractionProfiler, ProfileCounter::WriteColumnarReport);
+        if (columnarReport.Write("ElementInfo.bin") != HostNoError)
+            WriteReport_Alert("Failed to write ElementInfo.bin");
     }
+    EndProfiling("Extract BE (columnar)");
 }
-// Function to report properties of an element
-struct ZoneStampInfo {
-    std::string guid;
-    API_Box3D boundingBox;
-    std::string infoString = "Zone Stamp";
-};
-
-struct DoorLabelInfo {
-    std::string guid;
-    API_Box3D boundingBox;
-    std::string infoString = "Door Label";
-};
-
-struct DimensionNoteInfo {
-    std::string guid;
-    API_Box3D noteBoundingBox;
-    std::string noteText;
-    double textLength;
-    API_Coord position;
-    int globalDimElemCount;
-    std::string infoString = "Dim Note";
-    // Add other fields as necessary
-};
-
-std::vector<ZoneStampInfo> zoneStampInfos;
-std::vector<DoorLabelInfo> doorLabelInfos;
-std::vector<DimensionNoteInfo> dimensionNoteInfos;
-
-void ReportElementProperties(const API_Guid& elementGuid, API_ElemTypeID elemType, std::ofstream& outFile)
-{
-    char reportStr[1024];
-    API_Element element;
-    BNZeroMemory(&element, sizeof(API_Element));
-    element.header.guid = elementGuid;
-
-    // Retrieve the element
-    if (ACAPI_Element_Get(&element) == NoError) {
-        GS::UniString elemName;
-        
-        // Handle Zone type specifically
-        if (elemType == API_ZoneID) {
-            API_ZoneType& zone = element.zone;
-
-            // Report Zone ID first
-            char zoneIdStr[256];
-            sprintf(zoneIdStr, "Element Type: Zone, GUID: %s, ", APIGuidToString(element.header.guid).ToCStr().Get());
-            strcpy_s(reportStr, zoneIdStr); // Start with Zone ID
-
-            // Add Zone Stamp GUID
-            GS::Guid gsGuid = APIGuid2GSGuid(zone.stampGuid);
-            std::string guidStr = (const char*)gsGuid.ToUniString().ToCStr().Get();
-            char stampIdStr[256];
-            sprintf(stampIdStr, "Zone Stamp GUID: %s, Position: (%.2f, %.2f)", guidStr.c_str(), zone.pos.x, zone.pos.y);
-            strcat_s(reportStr, stampIdStr);
-
-            // Room/Zone Name
-            if (zone.roomName[0]) {
-                strcat_s(reportStr, ", Room Name: ");
-                strcat_s(reportStr, GS::UniString(zone.roomName).ToCStr());
-            }
-
-            // Room Number
-            if (zone.roomNoStr[0]) {
-                strcat_s(reportStr, ", Room Number: ");
-                strcat_s(reportStr, GS::UniString(zone.roomNoStr).ToCStr());
-            }
-
-            // Room Height
-            char roomHeightStr[64];
-            sprintf(roomHeightStr, ", Room Height: %.2f", zone.roomHeight);
-            strcat_s(reportStr, roomHeightStr);
-
-
-            // Retrieve the bounding box for the zone stamp
-            API_Element zoneStampElement;
-            BNZeroMemory(&zoneStampElement, sizeof(API_Element));
-            zoneStampElement.header.guid = zone.stampGuid;
-
-            API_Box3D extent3D;
-            if (ACAPI_Element_CalcBounds(&zoneStampElement.header, &extent3D) == NoError) {
-
-                ZoneStampInfo info = { APIGuidToString(zone.stampGuid).ToCStr().Get(), extent3D };
-                zoneStampInfos.push_back(info);
-
-                // Append bounding box info for the zone stamp to your report
-                char boundingBoxStr[512];
-                sprintf(boundingBoxStr, ", Zone Stamp Bounding Box: [(%.2f, %.2f, %.2f), (%.2f, %.2f, %.2f)]",
-                    extent3D.xMin, extent3D.yMin, extent3D.zMin,
-                    extent3D.xMax, extent3D.yMax, extent3D.zMax);
-                strcat_s(reportStr, boundingBoxStr);
-
 
-            }
-            else {
-                // Handle error in retrieving the bounding box
-                strcat_s(reportStr, ", Zone Stamp Bounding Box: Not available");
-            }
-        
-        }
-
-        else if (elemType == API_DoorID) {
-            // Handle Door elements
-            API_DoorType& door = element.door;
-            GS::Guid markGuid = APIGuid2GSGuid(door.openingBase.markGuid);
-            std::string markGuidStr = (const char*)markGuid.ToUniString().ToCStr().Get();
-            sprintf(reportStr, "Element Type: Door, GUID: %s, Width: %.2f , Height: %.2f ",
-                APIGuidToString(elementGuid).ToCStr().Get(),
-                door.openingBase.width,
-                door.openingBase.height);
-
-            // Check if Marker GUID should be included
-            if (!markGuidStr.empty() && markGuidStr != "00000000-0000-0000-0000-000000000000") {
-                // Append Marker GUID to the report string
-                sprintf(reportStr + strlen(reportStr), ", Marker GUID: %s", markGuidStr.c_str());
-            }
-            // Retrieve connected labels for the door
-            GS::Array<API_Guid> connectedLabels;
-            if (ACAPI_Grouping_GetConnectedElements(elementGuid, API_LabelID, &connectedLabels) == NoError) {
-                for (const API_Guid& labelGuid : connectedLabels) {
-                    // Retrieve label element data
-                    API_Element labelElement;
-                    BNZeroMemory(&labelElement, sizeof(API_Element));
-                    labelElement.header.guid = labelGuid;
-
-                    if (ACAPI_Element_Get(&labelElement) == NoError) {
-                        // Get bounding box for the label
-                        API_Box3D boundingBox;
-                        if (ACAPI_Element_CalcBounds(&labelElement.header, &boundingBox) == NoError) {
-                            
-                                
-                            // Capturing door label info within the existing label processing loop
-                            DoorLabelInfo info = { APIGuidToString(labelGuid).ToCStr().Get(), boundingBox };
-                            doorLabelInfos.push_back(info);
-
-                            // Append label GUID and bounding box to the door report
-                            sprintf(reportStr + strlen(reportStr), ", Label GUID: %s, Label Bounding Box: [(%.2f, %.2f, %.2f), (%.2f, %.2f, %.2f)]",
-                                APIGuidToString(labelGuid).ToCStr().Get(),
-                                boundingBox.xMin, boundingBox.yMin, boundingBox.zMin,
-                                boundingBox.xMax, boundingBox.yMax, boundingBox.zMax);
-
-                           
-
-                        }
-                        else {
-                            // Handle error in retrieving the bounding box
-                            sprintf(reportStr + strlen(reportStr), ", Label GUID: %s, Bounding Box: Not available",
-                                APIGuidToString(labelGuid).ToCStr().Get());
-                        }
-                    }
-                }
-            }
-
-
-            // Include the wall GUID if the door is embedded in a wall
-            auto wallIt = doorToWallMap.find(elementGuid);
-            if (wallIt != doorToWallMap.end()) {
-                API_Guid wallGuid = wallIt->second;
-                sprintf(reportStr + strlen(reportStr), ", Embedded in Wall GUID: %s", APIGuidToString(wallGuid).ToCStr().Get());
-            }
-            else {
-                strcat(reportStr, ", Not embedded in any wall");
-            }
+// Brings the snapshot and ElementInfo.txt up to date, re-extracting only the elements changed since the last run.
+// The changes are copied to changed first when it is not null.
+static void UpdateElementInfo(IElementHost& host, ElementChangeTracker* changed = nullptr) {
+    // Notifications only arrive while the add-on is loaded. Changes made before the first run
+    // (or while it was unloaded) are found by comparing the saved snapshot with the model.
+    if (!observingElements) {
+        if (extractionSnapshot.IsEmpty() && extractionSnapshot.Load(ElementSnapshotPath) == HostNoError) {
+            MarkChangesSinceSnapshot(host, extractionSnapshot, elementChanges);
+            if (predictedAnnotations.IsEmpty())
+                predictedAnnotations.Load(PredictedAnnotationsPath);
         }
-        
-
-
-        else {
-            // Handle other types (walls, slabs, etc.)
-            if (ACAPI_Element_GetElemTypeName(elemType, elemName) == NoError) {
-                sprintf(reportStr, "Element Type: %s, GUID: %s", (const char*)elemName.ToCStr(), APIGuidToString(elementGuid).ToCStr().Get());
-            }
-            else {
-                sprintf(reportStr, "Element Type: %d, GUID: %s", elemType, APIGuidToString(elementGuid).ToCStr().Get());
-            }
-        }
-
-        // Handling Wall elements (Check for any Embedded Doors)
-
-        if (elemType == API_WallID) {
-            API_WallType& wall = element.wall;
-
-            // Calculate the length of the wall in the XY-plane
-            double dx = wall.begC.x - wall.endC.x;
-            double dy = wall.begC.y - wall.endC.y;
-            double wallLength = sqrt(dx * dx + dy * dy);
-
-            // Use the thickness at the beginning of the wall as the reported thickness
-            double wallThickness = wall.thickness;
-
-            // Wall height relative to its bottom
-            double wallHeight = wall.height;
-
-            // Append wall length, thickness, and height to the report string
-            sprintf(reportStr + strlen(reportStr), ", Length: %.2f, Width: %.2f, Height: %.2f", wallLength, wallThickness, wallHeight);
-
-        }
-
-
-
-        if (elemType == API_WallID) {
-            API_ElementMemo memo;
-            BNZeroMemory(&memo, sizeof(API_ElementMemo));
-            if (ACAPI_Element_GetMemo(elementGuid, &memo) == NoError) {
-                std::string doorsStr;
-                if (memo.wallDoors != nullptr) {
-                    // Calculate the number of doors
-                    GSSize doorCount = BMGetPtrSize(reinterpret_cast<GSPtr>(memo.wallDoors)) / sizeof(API_Guid);
-                    for (GSSize i = 0; i < doorCount; i++) {
-                        const API_Guid& doorGuid = memo.wallDoors[i];
-                        doorToWallMap[doorGuid] = elementGuid; // Map each door to this wall
-                        if (!doorsStr.empty()) doorsStr += ", ";
-                        doorsStr += APIGuidToString(doorGuid).ToCStr().Get();
-                    }
-                }
-                if (!doorsStr.empty()) {
-                    sprintf(reportStr + strlen(reportStr), ", Embedded Door GUID: %s", doorsStr.c_str());
-                }
-                ACAPI_DisposeElemMemoHdls(&memo);
-            }
-        }
-
-        // Retrieve the compound info string for the element
-        GS::UniString infoString;
-        if (ACAPI_Element_GetElementInfoString(&elementGuid, &infoString) == NoError) {
-            std::string infoStr = (const char*)infoString.ToCStr().Get();
-            // Append the info string to your report
-            sprintf(reportStr + strlen(reportStr), ", Info String: %s", infoStr.c_str());
-        }
-        else {
-            // Handle error in retrieving the info string
-            strcat(reportStr, ", Info String: Not available");
-        }
-
-        // Retrieve the bounding box for the element
-        API_Box3D extent3D;
-        if (ACAPI_Element_CalcBounds(&element.header, &extent3D) == NoError) {
-            // Get the name of the element type
-            GS::UniString elemName;
-            char elemTypeStr[64] = { 0 };
-            if (ACAPI_Element_GetElemTypeName(elemType, elemName) == NoError) {
-                sprintf(elemTypeStr, "%s", (const char*)elemName.ToCStr());
-            }
-            else {
-                sprintf(elemTypeStr, ", Type: %d", elemType);
-            }
-
-            // Append element type and bounding box info to your report
-            sprintf(reportStr + strlen(reportStr), ", %s Bounding Box: [(%.2f, %.2f, %.2f), (%.2f, %.2f, %.2f)]",
-                elemTypeStr, // Element type
-                extent3D.xMin, extent3D.yMin, extent3D.zMin, // Bounding Box minimum coordinates
-                extent3D.xMax, extent3D.yMax, extent3D.zMax); // Bounding Box maximum coordinates
-        }
-        else {
-            // Handle error in retrieving the bounding box
-            strcat(reportStr, ", Bounding Box: Not available");
-        }
-
-        // Check for attached label (Label classification)
-       
-        GS::Array<API_Guid> connectedLabels;
-        API_ElementMemo memo{};
-        int labelType = 0;
-        // Check for dimension elements associated with walls
-        if (elemType == API_WallID) {
-            // Check global map filled in ReportDimensionElementProperties
-            labelType = wallHasDimElems.find(elementGuid) != wallHasDimElems.end() ? 1 : 0;
-        }
-        else if (elemType == API_ZoneID) {
-            // For zones, check if the stampGuid is not null to assign a label type
-            labelType = (element.zone.stampGuid != APINULLGuid) ? 4 : 0;
-        }
-        else if (elemType == API_DoorID) {
-            // For doors, first check if a marker is present
-            API_Element doorElement;
-            BNZeroMemory(&doorElement, sizeof(API_Element));
-            doorElement.header.guid = elementGuid;
-
-            if (ACAPI_Element_Get(&doorElement) == NoError) {
-                API_DoorType& door = doorElement.door;
-                if (door.openingBase.markGuid != APINULLGuid) {
-                    // If door marker is present, assign label type 3
-                    labelType = 3;
-                }
-                else {
-                    // If no marker, check for connected labels and assign label type 2 if found
-                    if (ACAPI_Grouping_GetConnectedElements(elementGuid, API_LabelID, &connectedLabels) == NoError) {
-                        if (!connectedLabels.IsEmpty()) {
-                            labelType = 2;
-                        }
-                    }
-                }
-            }
-        }
-        else {
-            // For other element types, check for connected labels
-            if (ACAPI_Grouping_GetConnectedElements(elementGuid, API_LabelID, &connectedLabels) == NoError) {
-                if (!connectedLabels.IsEmpty()) {
-                    labelType = 2; // Assign label type if labels are found
-                }
-            }
-        }
-
-        // Append label presence info to your report
-        sprintf(reportStr + strlen(reportStr), ", Label Type: %d", labelType);
-
-
-        outFile << reportStr << std::endl;
-        // Clear element data
-        BNZeroMemory(&element, sizeof(API_Element));
+        observingElements = StartElementObserver(elementChanges) == HostNoError;
     }
+    KeepStateInMemory();
+
+    if (changed != nullptr)
+        *changed = elementChanges;
+    if (WriteIncrementalTextReport(host, extractionSession, extractionSnapshot, elementChanges, ElementInfoPath) != HostNoError)
+        WriteReport_Alert("Failed to write %s", ElementInfoPath);
+    if (extractionSnapshot.Save(ElementSnapshotPath) != HostNoError)
+        WriteReport_Alert("Failed to write %s", ElementSnapshotPath);
 }
 
+static void SavePredictedAnnotations() {
+    if (predictedAnnotations.Save(PredictedAnnotationsPath) != HostNoError)
+        WriteReport_Alert("Failed to write %s", PredictedAnnotationsPath);
+}
 
-
-// Function to clear all dimensions ,annotations,labels and zones
-void DeleteDimensionsAndAnnotations() {
-    API_ElemTypeID elementTypes[] = { API_DimensionID ,API_LabelID, API_ZoneID /*, other annotation types */ };
-
-    for (API_ElemTypeID elemType : elementTypes) {
-        GS::Array<API_Guid> elementList;
-
-        // Get the list of elements of the specified type
-        if (ACAPI_Element_GetElemList(elemType, &elementList) == NoError && !elementList.IsEmpty()) {
-            // Delete all elements of the current type
-            GSErrCode err = ACAPI_Element_Delete(elementList);
-            if (err != NoError) {
-                // Handle error (e.g., log it or display a message to the user)
-            }
-        }
-    }
+// Without notifications the next run starts over from the saved snapshot
+static void ReleaseElementInfo() {
+    if (!observingElements)
+        extractionSnapshot.Clear();
 }
 
-void ReportDimensionElementProperties(const API_Guid& elementGuid, API_ElemTypeID elemType, std::ofstream& outFile) {
-    char reportStr[1024];
-    API_Element element;
-    BNZeroMemory(&element, sizeof(API_Element));
-    element.header.guid = elementGuid;
-    static Int32 globalDimElemCount = 0;
-    static Int32 dimElementCount = 0; // Counter for dimension elements
-    GSErrCode err = ACAPI_Element_Get(&element);
-    if (err == NoError && elemType == API_DimensionID) {
-        API_ElementMemo memo;
-        BNZeroMemory(&memo, sizeof(API_ElementMemo));
-        double totalLength = 0.0; // Variable to accumulate total length
-        if (ACAPI_Element_GetMemo(element.header.guid, &memo) == NoError) {
-            Int32 numDimElems = BMGetHandleSize((GSHandle)memo.dimElems) / sizeof(API_DimElem);
-            for (Int32 i = 0; i < numDimElems; ++i, ++globalDimElemCount) {
-                API_DimElem& dimElem = (*memo.dimElems)[i];
-                API_Base base = reinterpret_cast<API_Base&>(dimElem.base);
-                totalLength += dimElem.dimVal; // Accumulate the length
-                // Extracting Dimension Text
-                GS::UniString dimText = (dimElem.note.contentUStr != nullptr) ?
-                    *(dimElem.note.contentUStr) :
-                    GS::UniString(dimElem.note.content);
-                // If the base element is a wall, record that it has associated dimension elements
-                if (base.type == API_WallID) {
-                    wallHasDimElems[base.guid] = true;
-                }
-                // Formatting the output string for each dimension element
-
-                 // Assuming average character width is roughly 60% of the noteSize
-                
-                double textWidth = 0.5;
-                double textHeight = 0.5;
-                API_Coord textPos = dimElem.note.pos; // Assuming this gives the bottom left position of the note
-                
-
-                // Calculate bounding box without rotation for simplicity
-                double textbbXMin = textPos.x;
-                double textbbYMin = textPos.y;
-                double textbbXMax = textPos.x + textWidth;
-                double textbbYMax = textPos.y + textHeight;
-                float  textbbZMin = 0.0f; // No conversion issue here, literal 0.0f is already float
-                float  textbbZMax = 0.0f; // Same as abo
-                // Assuming a negligible thickness for the dimension element to simulate a bounding box
-                const float thickness = 0.01f; // Arbitrarily small value to simulate a bounding box
-
-                // Calculate the bounding box coordinates based on the dimension point
-                float bbXMin = static_cast<float>(dimElem.pos.x - thickness / 2); // Slightly reduce for visual representation
-                float bbYMin = static_cast<float>(dimElem.pos.y - thickness / 2);
-                float bbXMax = static_cast<float>(dimElem.pos.x + thickness / 2); // Slightly increase for visual representation
-                float bbYMax = static_cast<float>(dimElem.pos.y + thickness / 2);
-
-                // Since we are not considering Z coordinate, set a default value for ZMin and ZMax if needed
-                float bbZMin = 0.0f; // No conversion issue here, literal 0.0f is already float
-                float bbZMax = 0.0f; // Same as above
-
-                API_Box3D noteBoundingBox;
-                noteBoundingBox.xMin = textbbXMin;
-                noteBoundingBox.yMin = textbbYMin;
-                noteBoundingBox.zMin = textbbZMin;
-                noteBoundingBox.xMax = textbbXMax;
-                noteBoundingBox.yMax = textbbYMax;
-                noteBoundingBox.zMax = textbbZMax;
-
-                DimensionNoteInfo noteInfo = {
-                    APIGuidToString(element.header.guid).ToCStr().Get(), // GUID of the dimension element
-                    noteBoundingBox, // The calculated or defined bounding box for the note
-                    dimText.ToCStr().Get(), // Converting UniString to C-style string
-                    static_cast<int>(dimElem.dimVal), // Dimension value, cast to int if necessary
-                    dimElem.note.pos, // Position of the note
-                    globalDimElemCount
-                };
-
-                // Add the populated instance to the collection
-                dimensionNoteInfos.push_back(noteInfo);
-
-                // Now, format the output string to include both position and bounding box information
-                sprintf(reportStr,
-                    "Element Type: DimNode %d, GUID: %s, Associated Element GUID: %s, Text: %s, Length: %.2f, "
-                    "DimNode %d Bounding Box: [(%.2f, %.2f, %.2f), (%.2f, %.2f, %.2f)], Position: (%.2f, %.2f), "
-                    "Info String: Dim Node %d",
-                    globalDimElemCount,
-                    APIGuidToString(element.header.guid).ToCStr().Get(),
-                    APIGuidToString(base.guid).ToCStr().Get(),
-                    dimText.ToCStr().Get(),
-                    dimElem.dimVal,
-                    globalDimElemCount, // Used again, make sure it's an int
-                    bbXMin, bbYMin, bbZMin,
-                    bbXMax, bbYMax, bbZMax,
-                    dimElem.pos.x, dimElem.pos.y,
-                    globalDimElemCount); // Make sure the final count matches the type expected by '%d'
-
-               
-
-                outFile << reportStr << std::endl;
-            }
+// Function to re-extract only the elements changed since the last incremental run
+void ProcessBuildingElementsIncremental() {
+    ProfilingElementHost host = BeginProfiling(CommandHost());
+    UpdateElementInfo(host);
+    ReleaseElementInfo();
+    EndProfiling("Incremental extraction");
+}
 
-            // Retrieve and report the bounding box for the entire dimension element
-            API_Box3D boundingBox;
-            if (ACAPI_Element_CalcBounds(&element.header, &boundingBox) == NoError) {
-
-                ++dimElementCount;
-                sprintf(reportStr, "Element Type: Dimension, GUID: %s, Dimension Bounding Box: [(%.2f, %.2f, %.2f), (%.2f, %.2f, %.2f)], Length: %.2f, Info String: Dim %d",
-                    APIGuidToString(elementGuid).ToCStr().Get(),
-                    boundingBox.xMin, boundingBox.yMin, boundingBox.zMin,
-                    boundingBox.xMax, boundingBox.yMax, boundingBox.zMax,
-                    totalLength,
-                    dimElementCount); // Include total length here
-            }
-            else {
-                // Handle error in retrieving the bounding box
-                sprintf(reportStr, "Bounding Box for Dimension Element, GUID: %s: Not available",
-                    APIGuidToString(elementGuid).ToCStr().Get());
-            }
+// Function to export the element graph for the GNN, after an incremental extraction
+void ExportElementGraph() {
+    ProfilingElementHost host = BeginProfiling(CommandHost());
+    UpdateElementInfo(host);
 
-            outFile << reportStr << std::endl;
-            ACAPI_DisposeElemMemoHdls(&memo);
-        }
-        else {
-            strcat(reportStr, "Error retrieving element memo");
-            outFile << reportStr << std::endl;
-        }
+    ElementGraph graph;
+    {
+        TraceScope traceScope(&pipelineTrace, "BuildElementGraph", "graph");
+        BuildElementGraph(extractionSnapshot, graph);
     }
-    else {
-        strcat(reportStr, "Error or Unsupported Element Type");
-        outFile << reportStr << std::endl;
+    {
+        ProfileScope scope(&extractionProfiler, ProfileCounter::WriteElementGraph);
+        TraceScope traceScope(&pipelineTrace, "WriteElementGraph", "graph");
+        if (WriteElementGraph(graph, ElementGraphPath) != HostNoError)
+            WriteReport_Alert("Failed to write the element graph to %s", ElementGraphPath);
     }
+    ReleaseElementInfo();
+    EndProfiling("Export element graph");
 }
 
-void OutputAdditionalInfo(std::ofstream& outFile) {
-    // Output Zone Stamp Info
-    for (const auto& info : zoneStampInfos) {
-        outFile << "Element Type: Zone Stamp, GUID: " << info.guid
-            << ", Zone Stamp Bounding Box: [(" << std::fixed << std::setprecision(2) << info.boundingBox.xMin << ", " << info.boundingBox.yMin << ", " << info.boundingBox.zMin
-            << "), (" << info.boundingBox.xMax << ", " << info.boundingBox.yMax << ", " << info.boundingBox.zMax << ")]"
-            << ", Info String: " << info.infoString
-            << "\n";
+// Function to create the annotations predicted by the GNN
+static void AnnotateFromPredictions() {
+    GnnModel classifier;
+    HostError err = classifier.Load(LabelClassifierPath);
+    if (err == HostErrBadFormat)
+        WriteReport_Alert("%s is not a label classifier, reading the prediction CSV instead", LabelClassifierPath);
+    if (err == HostNoError) {
+        IElementHost& host = CommandHost();
+        ElementChangeTracker changed;
+        UpdateElementInfo(host, &changed);
+        AnnotationPlan plan;
+        if (PlanModelAnnotationUpdate(labelInference, predictedAnnotations, classifier, extractionSnapshot, changed, plan, 0,
+                &pipelineTrace) == HostNoError) {
+            std::vector<HostGuid> created;
+            CommitAnnotationPlan(host, plan, &pipelineTrace, &created);
+            predictedAnnotations.Record(plan, created);
+            SavePredictedAnnotations();
+            KeepStateInMemory();
+        }
+        else
+            WriteReport_Alert("%s does not fit the element graph", LabelClassifierPath);
+        ReleaseElementInfo();
     }
+    else
+        AutomaticAnnotation(CommandHost(), &pipelineTrace);
+    WritePipelineTrace();
+    SaveHostCallRecording();
+}
 
-    // Output Door Label Info
-    for (const auto& info : doorLabelInfos) {
-        outFile << "Element Type: Door Label, GUID: " << info.guid
-            << ", Label Bounding Box: [(" << std::fixed << std::setprecision(2) << info.boundingBox.xMin << ", " << info.boundingBox.yMin << ", " << info.boundingBox.zMin
-            << "), (" << info.boundingBox.xMax << ", " << info.boundingBox.yMax << ", " << info.boundingBox.zMax << ")]"
-            << ", Info String: " << info.infoString
-            << "\n";
-    }
-    // Output Dimension note Info
-    for (const auto& info : dimensionNoteInfos) {
-        outFile << "Element Type: DimText " << info.globalDimElemCount << ", GUID: " << info.guid
-            << ", DimText " << info.globalDimElemCount << " Bounding Box: [("
-            << std::fixed << std::setprecision(2)
-            << info.noteBoundingBox.xMin << ", " << info.noteBoundingBox.yMin << ", " << info.noteBoundingBox.zMin
-            << "), ("
-            << info.noteBoundingBox.xMax << ", " << info.noteBoundingBox.yMax << ", " << info.noteBoundingBox.zMax << ")]"
-            << ", Text: " << info.noteText
-            << ", Position: ("
-            << info.position.x << ", " << info.position.y << ")"
-            << ", Info String: Dim Text " << info.globalDimElemCount
-            << std::endl;
-    }
+// Function to clear all dimensions ,annotations,labels and zones
+void DeleteDimensionsAndAnnotations() {
+    DeleteDimensionsAndAnnotations(CommandHost(), &pipelineTrace);
+    // What was annotated is gone, the next Automatic Annotation plans every prediction again
+    labelInference.ClearCache();
+    predictedAnnotations.Clear();
+    SavePredictedAnnotations();
+    WritePipelineTrace();
+    SaveHostCallRecording();
 }
 
 
@@ -616,13 +318,16 @@ void Messagebox() {
 
 GSErrCode __ACENV_CALL ProcessBuildingElements(const API_MenuParams* menuParams)
 {
-    ACAPI_KeepInMemory(false);
+    KeepStateInMemory();
 
     return ACAPI_CallUndoableCommand("Element Test API Function",
         [&]() -> GSErrCode {
 
             switch (menuParams->menuItemRef.itemIndex) {
             case 1:		ProcessBuildingElements();							break;
+            case 2:		ProcessBuildingElementsColumnar();					break;
+            case 3:		ProcessBuildingElementsIncremental();				break;
+            case 4:		ExportElementGraph();								break;
             
             default:
                 break;
@@ -635,7 +340,7 @@ GSErrCode __ACENV_CALL ProcessBuildingElements(const API_MenuParams* menuParams)
 // Menu command handler function 
 GSErrCode __ACENV_CALL DeleteDimensionsAndAnnotations(const API_MenuParams* menuParams)
 {
-    ACAPI_KeepInMemory(false);
+    KeepStateInMemory();
 
     return ACAPI_CallUndoableCommand("Element Test API Function",
         [&]() -> GSErrCode {
@@ -654,7 +359,7 @@ GSErrCode __ACENV_CALL DeleteDimensionsAndAnnotations(const API_MenuParams* menu
 // Menu command handler function 
 GSErrCode __ACENV_CALL Messagebox(const API_MenuParams* menuParams)
 {
-    ACAPI_KeepInMemory(false);
+    KeepStateInMemory();
 
     return ACAPI_CallUndoableCommand("Element Test API Function",
         [&]() -> GSErrCode {
@@ -675,13 +380,13 @@ GSErrCode __ACENV_CALL Messagebox(const API_MenuParams* menuParams)
 // Menu command handler function 
 GSErrCode __ACENV_CALL AutomaticAnnotation(const API_MenuParams* menuParams)
 {
-    ACAPI_KeepInMemory(false);
+    KeepStateInMemory();
 
     return ACAPI_CallUndoableCommand("Element Test API Function",
         [&]() -> GSErrCode {
 
             switch (menuParams->menuItemRef.itemIndex) {
-            case 1:		AutomaticAnnotation();  						break;
+            case 1:		AnnotateFromPredictions();  					break;
 
             default:
                 break;
@@ -704,9 +409,6 @@ GSErrCode __ACENV_CALL	Initialize(void)
     err = ACAPI_MenuItem_InstallMenuHandler(32503, AutomaticAnnotation);
     err = ACAPI_MenuItem_InstallMenuHandler(32504, Messagebox);
 
-    // Open the output file for writing
-    outFile.open("ElementInfo.txt");
-
     return err;
 }		/* Initialize */
 
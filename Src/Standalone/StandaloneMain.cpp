@@ -0,0 +1,243 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "AnnotationCreation.hpp"
+#include "ElementExtraction.hpp"
+#include "ElementGraph.hpp"
+#include "ExtractionProfiler.hpp"
+#include "GnnModel.hpp"
+#include "HostCallRecording.hpp"
+#include "IncrementalExtraction.hpp"
+#include "MemoryElementHost.hpp"
+#include "TraceRecorder.hpp"
+
+// Runs the extraction and annotation core against a model snapshot or a host call recording,
+// without Archicad.
+//
+// Usage: Extraction_V2Standalone <model snapshot | host call recording> [-o <report>] [-b <columnar report>] [-a <prediction csv>] [-s <snapshot out>] [-j <threads>]
+//     [-p <extraction snapshot>] [-u <updated report>] [-g <graph directory>] [-m <profile json>]
+//     [-t <trace json>] [-R <recording out>] [-L <latency scale>] [-n <classifier weights>]
+//
+// -p keeps the extraction snapshot in a file: an existing one is brought up to date instead of
+// extracting everything, and it is rewritten after every extraction. -u re-extracts incrementally
+// after annotation, only the elements the annotation created and their dependents. -g writes the
+// GNN graph of the last extraction. -m times every phase and host call, prints the summary and
+// writes it as JSON. -t writes a Chrome trace-event timeline of the whole run. -R records every host
+// call of the run. A recording given as the model is replayed, host calls taking their recorded
+// time multiplied by -L (default 1, 0 answers at once). -n annotates from the label types the
+// classifier predicts over the element graph, in process, instead of a prediction CSV.
+
+static double SecondsSince(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void PrintUsage() {
+    std::cerr << "Usage: Extraction_V2Standalone <model snapshot | host call recording> [-o <report>] [-b <columnar report>] [-a <prediction csv>] [-s <snapshot out>] [-j <threads>]"
+        " [-p <extraction snapshot>] [-u <updated report>] [-g <graph directory>] [-m <profile json>] [-t <trace json>]"
+        " [-R <recording out>] [-L <latency scale>] [-n <classifier weights>]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::string snapshotPath = argv[1];
+    std::string reportPath = "ElementInfo.txt";
+    std::string columnarPath;
+    std::string predictionPath;
+    std::string snapshotOutPath;
+    std::string extractionSnapshotPath;
+    std::string updatedReportPath;
+    std::string graphPath;
+    std::string profilePath;
+    std::string tracePath;
+    std::string recordingPath;
+    double latencyScale = 1.0;
+    std::string classifierPath;
+    size_t threadCount = 0;
+    for (int i = 2; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-o") == 0)
+            reportPath = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-b") == 0)
+            columnarPath = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-a") == 0)
+            predictionPath = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-s") == 0)
+            snapshotOutPath = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-j") == 0)
+            threadCount = std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && strcmp(argv[i], "-p") == 0)
+            extractionSnapshotPath = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-u") == 0)
+            updatedReportPath = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-g") == 0)
+            graphPath = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-m") == 0)
+            profilePath = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-t") == 0)
+            tracePath = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-R") == 0)
+            recordingPath = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-L") == 0)
+            latencyScale = std::strtod(argv[++i], nullptr);
+        else if (i + 1 < argc && strcmp(argv[i], "-n") == 0)
+            classifierPath = argv[++i];
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    MemoryElementHost host;
+    ReplayElementHost replayHost;
+    bool replay = IsHostCallRecording(snapshotPath);
+    if (replay && !snapshotOutPath.empty()) {
+        std::cerr << "A host call recording cannot be saved as a snapshot" << std::endl;
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    HostError err = replay ? replayHost.Load(snapshotPath) : host.LoadSnapshot(snapshotPath);
+    if (err != HostNoError) {
+        std::cerr << "Failed to load " << (replay ? "host call recording " : "snapshot ") << snapshotPath << ": " << err << std::endl;
+        return 1;
+    }
+    if (replay) {
+        replayHost.SetLatencyScale(latencyScale);
+        std::cout << "Loaded " << replayHost.GetRecordedCallCount() << " host calls in " << SecondsSince(start) << " s" << std::endl;
+    }
+    else
+        std::cout << "Loaded " << host.GetElementCount() << " elements in " << SecondsSince(start) << " s" << std::endl;
+
+    // Everything below the loading goes through coreHost, recorded and timed on request
+    IElementHost& modelHost = replay ? static_cast<IElementHost&>(replayHost) : host;
+    RecordingElementHost recordingHost(modelHost);
+    IElementHost& recordedHost = recordingPath.empty() ? modelHost : recordingHost;
+    ExtractionProfiler profiler;
+    ProfilingElementHost profilingHost(recordedHost, profiler);
+    IElementHost& coreHost = profilePath.empty() ? recordedHost : profilingHost;
+
+    ExtractionSession session;
+    if (!profilePath.empty())
+        session.profiler = &profiler;
+    TraceRecorder trace;
+    if (!tracePath.empty())
+        session.trace = &trace;
+    ExtractionSnapshot extractionSnapshot;
+    ElementChangeTracker changes;
+    bool incremental = !extractionSnapshotPath.empty() || !updatedReportPath.empty() || !graphPath.empty() || !classifierPath.empty();
+    ColumnarReportWriter columnarReport;
+    start = std::chrono::steady_clock::now();
+    if (!extractionSnapshotPath.empty() && extractionSnapshot.Load(extractionSnapshotPath) == HostNoError)
+        MarkChangesSinceSnapshot(coreHost, extractionSnapshot, changes);
+    if (incremental)
+        err = WriteIncrementalTextReport(coreHost, session, extractionSnapshot, changes, reportPath, columnarPath.empty() ? nullptr : &columnarReport);
+    else
+        err = WriteTextReport(coreHost, session, reportPath, columnarPath.empty() ? nullptr : &columnarReport);
+    if (err != HostNoError) {
+        std::cerr << "Failed to write " << reportPath << std::endl;
+        return 1;
+    }
+    if (!columnarPath.empty()) {
+        ProfileScope scope(session.profiler, ProfileCounter::WriteColumnarReport);
+        if (columnarReport.Write(columnarPath) != HostNoError) {
+            std::cerr << "Failed to write " << columnarPath << std::endl;
+            return 1;
+        }
+    }
+    if (!extractionSnapshotPath.empty() && extractionSnapshot.Save(extractionSnapshotPath) != HostNoError) {
+        std::cerr << "Failed to save extraction snapshot " << extractionSnapshotPath << std::endl;
+        return 1;
+    }
+    std::cout << "Extraction: " << SecondsSince(start) << " s" << std::endl;
+    host.SetChangeTracker(&changes);
+
+    if (!predictionPath.empty() || !classifierPath.empty()) {
+        // Same as AutomaticAnnotation, with the two phases timed separately
+        AnnotationPlan plan;
+        start = std::chrono::steady_clock::now();
+        if (!classifierPath.empty()) {
+            GnnModel classifier;
+            err = classifier.Load(classifierPath);
+            if (err != HostNoError) {
+                std::cerr << "Failed to load classifier " << classifierPath << ": " << err << std::endl;
+                return 1;
+            }
+            if (PlanModelAnnotation(classifier, extractionSnapshot, plan, threadCount, session.trace) != HostNoError)
+                return 1;
+        }
+        else if (PlanAutomaticAnnotation(predictionPath, plan, threadCount, session.trace) != HostNoError)
+            return 1;
+        double planSeconds = SecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        size_t createdCount = CommitAnnotationPlan(coreHost, plan, session.trace);
+        std::cout << "Annotation: plan " << planSeconds << " s, commit " << SecondsSince(start) << " s, "
+            << createdCount << " elements created" << std::endl;
+    }
+
+    if (!updatedReportPath.empty()) {
+        size_t changedCount = changes.GetSize();
+        start = std::chrono::steady_clock::now();
+        if (WriteIncrementalTextReport(coreHost, session, extractionSnapshot, changes, updatedReportPath) != HostNoError) {
+            std::cerr << "Failed to write " << updatedReportPath << std::endl;
+            return 1;
+        }
+        if (!extractionSnapshotPath.empty() && extractionSnapshot.Save(extractionSnapshotPath) != HostNoError) {
+            std::cerr << "Failed to save extraction snapshot " << extractionSnapshotPath << std::endl;
+            return 1;
+        }
+        std::cout << "Incremental extraction: " << SecondsSince(start) << " s, " << changedCount << " changed elements" << std::endl;
+    }
+
+    if (!graphPath.empty()) {
+        start = std::chrono::steady_clock::now();
+        ElementGraph graph;
+        {
+            TraceScope traceScope(session.trace, "BuildElementGraph", "graph");
+            BuildElementGraph(extractionSnapshot, graph, threadCount);
+        }
+        ProfileScope scope(session.profiler, ProfileCounter::WriteElementGraph);
+        TraceScope traceScope(session.trace, "WriteElementGraph", "graph");
+        if (WriteElementGraph(graph, graphPath) != HostNoError) {
+            std::cerr << "Failed to write the graph to " << graphPath << std::endl;
+            return 1;
+        }
+        std::cout << "Graph export: " << SecondsSince(start) << " s" << std::endl;
+    }
+
+    if (!profilePath.empty()) {
+        for (const std::string& line : profiler.FormatSummary())
+            std::cout << line << std::endl;
+        if (profiler.WriteJson(profilePath) != HostNoError) {
+            std::cerr << "Failed to write " << profilePath << std::endl;
+            return 1;
+        }
+    }
+
+    if (!tracePath.empty() && trace.WriteJson(tracePath) != HostNoError) {
+        std::cerr << "Failed to write " << tracePath << std::endl;
+        return 1;
+    }
+
+    if (!recordingPath.empty()) {
+        if (recordingHost.Save(recordingPath) != HostNoError) {
+            std::cerr << "Failed to write " << recordingPath << std::endl;
+            return 1;
+        }
+        std::cout << "Recorded " << recordingHost.GetCallCount() << " host calls, " << recordingHost.GetRecordingSize() << " bytes" << std::endl;
+    }
+
+    if (replay && replayHost.GetMissCount() != 0)
+        std::cout << "Replay: " << replayHost.GetMissCount() << " host calls not in the recording" << std::endl;
+
+    if (!snapshotOutPath.empty() && host.SaveSnapshot(snapshotOutPath) != HostNoError) {
+        std::cerr << "Failed to save snapshot " << snapshotOutPath << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -162,10 +162,12 @@ function (GenerateAddOnProject acVersion devKitDir addOnName addOnSourcesFolder
     file (GLOB AddOnHeaderFiles CONFIGURE_DEPENDS
         ${addOnSourcesFolder}/*.h
         ${addOnSourcesFolder}/*.hpp
+        ${addOnSourcesFolder}/Core/*.hpp
     )
     file (GLOB AddOnSourceFiles CONFIGURE_DEPENDS
         ${addOnSourcesFolder}/*.c
         ${addOnSourcesFolder}/*.cpp
+        ${addOnSourcesFolder}/Core/*.cpp
     )
     set (
         AddOnFiles
@@ -199,6 +201,7 @@ function (GenerateAddOnProject acVersion devKitDir addOnName addOnSourcesFolder
 
     target_include_directories (${addOnName} PUBLIC
         ${addOnSourcesFolder}
+        ${addOnSourcesFolder}/Core
         ${devKitDir}/Inc
     )
 
@@ -208,3 +211,55 @@ function (GenerateAddOnProject acVersion devKitDir addOnName addOnSourcesFolder
     SetCompilerOptions (${addOnName} ${acVersion})
 
 endfunction ()
+
+function (SetStandaloneCompilerOptions target)
+
+    target_compile_features (${target} PUBLIC cxx_std_17)
+    target_compile_options (${target} PUBLIC "$<$<CONFIG:Debug>:-DDEBUG>")
+    if (WIN32)
+        target_compile_options (${target} PUBLIC /W4 /WX
+            /EHsc
+            -D_CRT_SECURE_NO_WARNINGS
+        )
+    else ()
+        target_compile_options (${target} PUBLIC -Wall -Wextra -Werror
+            -Wno-unused-parameter
+        )
+    endif ()
+
+endfunction ()
+
+# Builds the DevKit-free part of the add-on (Src/Core) as a static library, plus the
+# command line driver in Src/Standalone that runs it against a model snapshot.
+function (GenerateStandaloneCoreProject addOnName addOnSourcesFolder)
+
+    file (GLOB CoreHeaderFiles CONFIGURE_DEPENDS
+        ${addOnSourcesFolder}/Core/*.hpp
+    )
+    file (GLOB CoreSourceFiles CONFIGURE_DEPENDS
+        ${addOnSourcesFolder}/Core/*.cpp
+    )
+
+    source_group ("Sources" FILES ${CoreHeaderFiles} ${CoreSourceFiles})
+    add_library (${addOnName}Core STATIC ${CoreHeaderFiles} ${CoreSourceFiles})
+    target_include_directories (${addOnName}Core PUBLIC
+        ${addOnSourcesFolder}/Core
+    )
+    SetStandaloneCompilerOptions (${addOnName}Core)
+
+    find_package (Threads REQUIRED)
+    target_link_libraries (${addOnName}Core PUBLIC Threads::Threads)
+
+    add_executable (${addOnName}Standalone ${addOnSourcesFolder}/Standalone/StandaloneMain.cpp)
+    target_link_libraries (${addOnName}Standalone ${addOnName}Core)
+    SetStandaloneCompilerOptions (${addOnName}Standalone)
+
+    add_executable (${addOnName}Benchmark ${addOnSourcesFolder}/Benchmark/BenchmarkMain.cpp)
+    target_link_libraries (${addOnName}Benchmark ${addOnName}Core)
+    SetStandaloneCompilerOptions (${addOnName}Benchmark)
+
+    add_executable (${addOnName}Calibrate ${addOnSourcesFolder}/Calibrate/CalibrateMain.cpp)
+    target_link_libraries (${addOnName}Calibrate ${addOnName}Core)
+    SetStandaloneCompilerOptions (${addOnName}Calibrate)
+
+endfunction ()